@@ -0,0 +1,554 @@
+#ifndef ARVORE_GENERICA_H
+#define ARVORE_GENERICA_H
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   ÁRVORES GENÉRICAS (ESPECIALIZAÇÃO EM TEMPO DE COMPILAÇÃO)
+   ============================================================ */
+
+/*
+ * Versões da AVL (questao01) e da Rubro-Negra (questao02) parametrizadas pelo
+ * tipo da chave, pelo tipo do valor associado e por um comparador. Cada macro
+ * DEFINIR_* gera um tipo de nó e funções static inline com o prefixo escolhido:
+ *
+ *     DEFINIR_AVL(mapa, int64_t, double, COMPARAR_NUMEROS)
+ *     mapaArvore arvore = {0};
+ *     mapaInserir(&arvore, 42, 1.5, &status);
+ *
+ * O comparador é uma macro COMPARAR(a, b) que resulta em um número negativo,
+ * zero ou positivo, expandida dentro de cada função: não há ponteiro para
+ * função no caminho das operações, e para chaves inteiras o código gerado é o
+ * mesmo das árvores de int dos programas. O valor fica dentro do próprio nó.
+ *
+ * As chaves não se repetem. As funções usam o enum Status do programa que
+ * inclui este arquivo, então as macros DEFINIR_* devem ser usadas depois dele.
+ * Chaves que são ponteiros (como textos) não são copiadas: quem insere deve
+ * mantê-las vivas enquanto estiverem na árvore.
+ */
+
+/**
+ * Comparador para chaves numéricas (inteiros de qualquer largura e reais).
+ * Testar a igualdade primeiro deixa o compilador gerar, na pesquisa, a mesma
+ * comparação seguida de um cmov das árvores de int; a forma (a > b) - (a < b)
+ * alonga a cadeia de dependências entre um nível e o seguinte e deixa a
+ * pesquisa em árvores grandes duas vezes mais lenta.
+ */
+#define COMPARAR_NUMEROS(a, b) ((a) == (b) ? 0 : (a) < (b) ? -1 : 1)
+
+/** Comparador para chaves do tipo const char *. */
+#define COMPARAR_TEXTOS(a, b) strcmp((a), (b))
+
+/* ============================================================
+   ALOCADOR DE NÓS (POOL)
+   ============================================================ */
+
+#define ARVORE_BLOCO_INICIAL 1024     // capacidade do primeiro bloco (em nós)
+#define ARVORE_BLOCO_MAXIMO  1048576  // limite para o crescimento dos blocos
+#define ARVORE_CAMINHO       64       // maior que a altura de qualquer AVL com até 2^31 nós
+
+/*
+ * Cada árvore genérica tem o seu próprio pool, igual ao dos programas: os nós
+ * são entregues a partir de blocos contíguos, cuja capacidade dobra a cada novo
+ * bloco, e os nós removidos voltam por uma lista de livres. Assim, os nós
+ * vizinhos na ordem de inserção ficam próximos na memória, nenhuma inserção
+ * paga uma chamada a malloc e destruir a árvore só libera os blocos.
+ * As macros abaixo são usadas por DEFINIR_AVL e DEFINIR_RN.
+ */
+
+/** Bloco contíguo de nós; os blocos formam uma lista para serem liberados juntos. */
+#define ARVORE_GENERICA_BLOCO(P)                                                        \
+                                                                                        \
+typedef struct P##Bloco {                                                               \
+    struct P##Bloco *proximo;                                                           \
+    size_t capacidade;                                                                  \
+    P##No nos[];                                                                        \
+} P##Bloco;
+
+/** Campos do pool dentro de P##Arvore (todos zerados em uma árvore vazia). */
+#define ARVORE_GENERICA_CAMPOS_POOL(P)                                                  \
+    P##Bloco *blocos; /* bloco atual (início da lista de blocos) */                     \
+    size_t usados;    /* nós já entregues do bloco atual */                             \
+    P##No *livres;    /* nós devolvidos, encadeados pelo ponteiro esquerdo */
+
+/** Funções do pool: P##Alocar, P##Devolver e P##LiberarBlocos. */
+#define ARVORE_GENERICA_POOL(P)                                                         \
+                                                                                        \
+/* Obtém um nó do pool da árvore, priorizando os nós devolvidos */                      \
+static inline P##No *P##Alocar(P##Arvore *arvore) {                                     \
+    if (arvore->livres) {                                                               \
+        P##No *no = arvore->livres;                                                     \
+        arvore->livres = no->esquerdo;                                                  \
+        return no;                                                                      \
+    }                                                                                   \
+    if (arvore->blocos == NULL || arvore->usados == arvore->blocos->capacidade) {       \
+        size_t capacidade = arvore->blocos ? arvore->blocos->capacidade * 2             \
+                                           : ARVORE_BLOCO_INICIAL;                      \
+        if (capacidade > ARVORE_BLOCO_MAXIMO) capacidade = ARVORE_BLOCO_MAXIMO;         \
+        P##Bloco *bloco = malloc(sizeof(P##Bloco) + capacidade * sizeof(P##No));        \
+        if (bloco == NULL) return NULL;                                                 \
+        bloco->proximo = arvore->blocos;                                                \
+        bloco->capacidade = capacidade;                                                 \
+        arvore->blocos = bloco;                                                         \
+        arvore->usados = 0;                                                             \
+    }                                                                                   \
+    return &arvore->blocos->nos[arvore->usados++];                                      \
+}                                                                                       \
+                                                                                        \
+/* Devolve um nó ao pool, para que seja reutilizado em uma próxima alocação */          \
+static inline void P##Devolver(P##Arvore *arvore, P##No *no) {                          \
+    no->esquerdo = arvore->livres;                                                      \
+    arvore->livres = no;                                                                \
+}                                                                                       \
+                                                                                        \
+/* Libera todos os blocos de uma só vez, sem percorrer a árvore */                      \
+static inline void P##LiberarBlocos(P##Arvore *arvore) {                                \
+    while (arvore->blocos) {                                                            \
+        P##Bloco *proximo = arvore->blocos->proximo;                                    \
+        free(arvore->blocos);                                                           \
+        arvore->blocos = proximo;                                                       \
+    }                                                                                   \
+    arvore->usados = 0;                                                                 \
+    arvore->livres = NULL;                                                              \
+}
+
+/* ============================================================
+   AVL GENÉRICA
+   ============================================================ */
+
+/**
+ * Gera uma árvore AVL com chaves TipoChave e valores TipoValor.
+ * Tipos gerados: P##No e P##Arvore (iniciada com {0}).
+ * Funções geradas: P##Pesquisar, P##Inserir, P##Remover e P##Destruir.
+ */
+#define DEFINIR_AVL(P, TipoChave, TipoValor, COMPARAR)                                  \
+                                                                                        \
+typedef struct P##No {                                                                  \
+    TipoChave chave;                                                                    \
+    TipoValor valor;                                                                    \
+    struct P##No *esquerdo, *direito;                                                   \
+    int altura;                                                                         \
+} P##No;                                                                                \
+                                                                                        \
+ARVORE_GENERICA_BLOCO(P)                                                                \
+                                                                                        \
+typedef struct {                                                                        \
+    P##No *raiz;                                                                        \
+    size_t quantidade;                                                                  \
+    ARVORE_GENERICA_CAMPOS_POOL(P)                                                      \
+} P##Arvore;                                                                            \
+                                                                                        \
+ARVORE_GENERICA_POOL(P)                                                                 \
+                                                                                        \
+static inline int P##Altura(const P##No *no) {                                          \
+    return no ? no->altura : -1;                                                        \
+}                                                                                       \
+                                                                                        \
+static inline void P##Atualizar(P##No *no) {                                            \
+    const int esquerda = P##Altura(no->esquerdo), direita = P##Altura(no->direito);     \
+    no->altura = (esquerda > direita ? esquerda : direita) + 1;                         \
+}                                                                                       \
+                                                                                        \
+static inline P##No *P##RotacaoEsq(P##No *raiz) {                                       \
+    P##No *u = raiz->direito;                                                           \
+    raiz->direito = u->esquerdo;                                                        \
+    u->esquerdo = raiz;                                                                 \
+    P##Atualizar(raiz);                                                                 \
+    P##Atualizar(u);                                                                    \
+    return u;                                                                           \
+}                                                                                       \
+                                                                                        \
+static inline P##No *P##RotacaoDir(P##No *raiz) {                                       \
+    P##No *u = raiz->esquerdo;                                                          \
+    raiz->esquerdo = u->direito;                                                        \
+    u->direito = raiz;                                                                  \
+    P##Atualizar(raiz);                                                                 \
+    P##Atualizar(u);                                                                    \
+    return u;                                                                           \
+}                                                                                       \
+                                                                                        \
+/* Atualiza a altura do nó e aplica a rotação simples ou dupla necessária */            \
+static inline P##No *P##Balancear(P##No *raiz) {                                        \
+    P##Atualizar(raiz);                                                                 \
+    const int fator = P##Altura(raiz->esquerdo) - P##Altura(raiz->direito);             \
+    if (fator > 1) {                                                                    \
+        if (P##Altura(raiz->esquerdo->esquerdo) < P##Altura(raiz->esquerdo->direito))   \
+            raiz->esquerdo = P##RotacaoEsq(raiz->esquerdo);                             \
+        return P##RotacaoDir(raiz);                                                     \
+    }                                                                                   \
+    if (fator < -1) {                                                                   \
+        if (P##Altura(raiz->direito->direito) < P##Altura(raiz->direito->esquerdo))     \
+            raiz->direito = P##RotacaoDir(raiz->direito);                               \
+        return P##RotacaoEsq(raiz);                                                     \
+    }                                                                                   \
+    return raiz;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* Balanceia o caminho de baixo para cima, até o primeiro nó que manteve a altura */    \
+static inline void P##AjustarCaminho(P##No **caminho[], int topo) {                     \
+    while (topo > 0) {                                                                  \
+        P##No **ligacao = caminho[--topo];                                              \
+        const int alturaAnterior = (*ligacao)->altura;                                  \
+        *ligacao = P##Balancear(*ligacao);                                              \
+        if ((*ligacao)->altura == alturaAnterior) break;                                \
+    }                                                                                   \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Busca uma chave na árvore.                                                           \
+ * @return Endereço do valor associado à chave (que pode ser alterado) ou NULL          \
+ */                                                                                     \
+static inline TipoValor *P##Pesquisar(const P##Arvore *arvore, TipoChave chave) {       \
+    P##No *no = arvore->raiz;                                                           \
+    while (no) {                                                                        \
+        const int c = COMPARAR(chave, no->chave);                                       \
+        if (c == 0) return &no->valor;                                                  \
+        no = c < 0 ? no->esquerdo : no->direito;                                        \
+    }                                                                                   \
+    return NULL;                                                                        \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Insere uma chave com o seu valor, descendo sem recursão.                             \
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA               \
+ */                                                                                     \
+static inline void P##Inserir(P##Arvore *arvore, TipoChave chave,                       \
+                              TipoValor valor, Status *status) {                        \
+    P##No **caminho[ARVORE_CAMINHO];                                                    \
+    int topo = 0;                                                                       \
+    P##No **ligacao = &arvore->raiz;                                                    \
+                                                                                        \
+    while (*ligacao) {                                                                  \
+        const int c = COMPARAR(chave, (*ligacao)->chave);                               \
+        if (c == 0) {                                                                   \
+            *status = STATUS_DUPLICADA;                                                 \
+            return;                                                                     \
+        }                                                                               \
+        caminho[topo++] = ligacao;                                                      \
+        ligacao = c < 0 ? &(*ligacao)->esquerdo : &(*ligacao)->direito;                 \
+    }                                                                                   \
+                                                                                        \
+    P##No *novo = P##Alocar(arvore);                                                    \
+    if (novo == NULL) {                                                                 \
+        *status = STATUS_SEM_MEMORIA;                                                   \
+        return;                                                                         \
+    }                                                                                   \
+    novo->chave = chave;                                                                \
+    novo->valor = valor;                                                                \
+    novo->esquerdo = novo->direito = NULL;                                              \
+    novo->altura = 0;                                                                   \
+    *ligacao = novo;                                                                    \
+    arvore->quantidade++;                                                               \
+    *status = STATUS_OK;                                                                \
+                                                                                        \
+    P##AjustarCaminho(caminho, topo);                                                   \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Remove uma chave da árvore, descendo sem recursão.                                   \
+ * @param valor Recebe o valor que estava associado à chave (pode ser NULL)             \
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE                                     \
+ */                                                                                     \
+static inline void P##Remover(P##Arvore *arvore, TipoChave chave,                       \
+                              TipoValor *valor, Status *status) {                       \
+    P##No **caminho[ARVORE_CAMINHO];                                                    \
+    int topo = 0;                                                                       \
+    P##No **ligacao = &arvore->raiz;                                                    \
+                                                                                        \
+    while (*ligacao) {                                                                  \
+        const int c = COMPARAR(chave, (*ligacao)->chave);                               \
+        if (c == 0) break;                                                              \
+        caminho[topo++] = ligacao;                                                      \
+        ligacao = c < 0 ? &(*ligacao)->esquerdo : &(*ligacao)->direito;                 \
+    }                                                                                   \
+    if (*ligacao == NULL) {                                                             \
+        *status = STATUS_AUSENTE;                                                       \
+        return;                                                                         \
+    }                                                                                   \
+    *status = STATUS_OK;                                                                \
+                                                                                        \
+    P##No *no = *ligacao;                                                               \
+    if (valor) *valor = no->valor;                                                      \
+                                                                                        \
+    if (no->esquerdo && no->direito) {                                                  \
+        /* Nó com dois filhos: recebe o predecessor, que sai da árvore no seu lugar */  \
+        caminho[topo++] = ligacao;                                                      \
+        ligacao = &no->esquerdo;                                                        \
+        while ((*ligacao)->direito) {                                                   \
+            caminho[topo++] = ligacao;                                                  \
+            ligacao = &(*ligacao)->direito;                                             \
+        }                                                                               \
+        P##No *predecessor = *ligacao;                                                  \
+        no->chave = predecessor->chave;                                                 \
+        no->valor = predecessor->valor;                                                 \
+        no = predecessor;                                                               \
+    }                                                                                   \
+                                                                                        \
+    *ligacao = no->esquerdo ? no->esquerdo : no->direito;                               \
+    P##Devolver(arvore, no);                                                            \
+    arvore->quantidade--;                                                               \
+    P##AjustarCaminho(caminho, topo);                                                   \
+}                                                                                       \
+                                                                                        \
+/** Libera todos os nós da árvore, que volta a ficar vazia. */                          \
+static inline void P##Destruir(P##Arvore *arvore) {                                     \
+    P##LiberarBlocos(arvore);                                                           \
+    arvore->raiz = NULL;                                                                \
+    arvore->quantidade = 0;                                                             \
+}
+
+/* ============================================================
+   RUBRO-NEGRA GENÉRICA
+   ============================================================ */
+
+/**
+ * Gera uma árvore rubro-negra com chaves TipoChave e valores TipoValor.
+ * Tipos gerados: P##No e P##Arvore (iniciada com {0}).
+ * Funções geradas: P##Pesquisar, P##Inserir, P##Remover e P##Destruir.
+ */
+#define DEFINIR_RN(P, TipoChave, TipoValor, COMPARAR)                                   \
+                                                                                        \
+typedef struct P##No {                                                                  \
+    TipoChave chave;                                                                    \
+    TipoValor valor;                                                                    \
+    struct P##No *esquerdo, *direito, *pai;                                             \
+    short vermelho;                                                                     \
+} P##No;                                                                                \
+                                                                                        \
+ARVORE_GENERICA_BLOCO(P)                                                                \
+                                                                                        \
+typedef struct {                                                                        \
+    P##No *raiz;                                                                        \
+    size_t quantidade;                                                                  \
+    ARVORE_GENERICA_CAMPOS_POOL(P)                                                      \
+} P##Arvore;                                                                            \
+                                                                                        \
+ARVORE_GENERICA_POOL(P)                                                                 \
+                                                                                        \
+static inline int P##Vermelho(const P##No *no) {                                        \
+    return no != NULL && no->vermelho;                                                  \
+}                                                                                       \
+                                                                                        \
+/* Coloca v no lugar de u, como filho do pai de u */                                    \
+static inline void P##Substituir(P##Arvore *arvore, P##No *u, P##No *v) {               \
+    if (u->pai == NULL) arvore->raiz = v;                                               \
+    else if (u == u->pai->esquerdo) u->pai->esquerdo = v;                               \
+    else u->pai->direito = v;                                                           \
+    if (v) v->pai = u->pai;                                                             \
+}                                                                                       \
+                                                                                        \
+static inline void P##RotacaoEsq(P##Arvore *arvore, P##No *p) {                         \
+    P##No *u = p->direito;                                                              \
+    p->direito = u->esquerdo;                                                           \
+    if (u->esquerdo) u->esquerdo->pai = p;                                              \
+    P##Substituir(arvore, p, u);                                                        \
+    u->esquerdo = p;                                                                    \
+    p->pai = u;                                                                         \
+}                                                                                       \
+                                                                                        \
+static inline void P##RotacaoDir(P##Arvore *arvore, P##No *p) {                         \
+    P##No *u = p->esquerdo;                                                             \
+    p->esquerdo = u->direito;                                                           \
+    if (u->direito) u->direito->pai = p;                                                \
+    P##Substituir(arvore, p, u);                                                        \
+    u->direito = p;                                                                     \
+    p->pai = u;                                                                         \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Busca uma chave na árvore.                                                           \
+ * @return Endereço do valor associado à chave (que pode ser alterado) ou NULL          \
+ */                                                                                     \
+static inline TipoValor *P##Pesquisar(const P##Arvore *arvore, TipoChave chave) {       \
+    P##No *no = arvore->raiz;                                                           \
+    while (no) {                                                                        \
+        const int c = COMPARAR(chave, no->chave);                                       \
+        if (c == 0) return &no->valor;                                                  \
+        no = c < 0 ? no->esquerdo : no->direito;                                        \
+    }                                                                                   \
+    return NULL;                                                                        \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Insere uma chave com o seu valor.                                                    \
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA               \
+ */                                                                                     \
+static inline void P##Inserir(P##Arvore *arvore, TipoChave chave,                       \
+                              TipoValor valor, Status *status) {                        \
+    P##No *pai = NULL, **ligacao = &arvore->raiz;                                       \
+    while (*ligacao) {                                                                  \
+        const int c = COMPARAR(chave, (*ligacao)->chave);                               \
+        if (c == 0) {                                                                   \
+            *status = STATUS_DUPLICADA;                                                 \
+            return;                                                                     \
+        }                                                                               \
+        pai = *ligacao;                                                                 \
+        ligacao = c < 0 ? &pai->esquerdo : &pai->direito;                               \
+    }                                                                                   \
+                                                                                        \
+    P##No *no = P##Alocar(arvore);                                                      \
+    if (no == NULL) {                                                                   \
+        *status = STATUS_SEM_MEMORIA;                                                   \
+        return;                                                                         \
+    }                                                                                   \
+    no->chave = chave;                                                                  \
+    no->valor = valor;                                                                  \
+    no->esquerdo = no->direito = NULL;                                                  \
+    no->pai = pai;                                                                      \
+    no->vermelho = 1;                                                                   \
+    *ligacao = no;                                                                      \
+    arvore->quantidade++;                                                               \
+    *status = STATUS_OK;                                                                \
+                                                                                        \
+    /* Ajuste: enquanto o pai for vermelho, recolore ou rotaciona */                    \
+    while (P##Vermelho(no->pai)) {                                                      \
+        pai = no->pai;                                                                  \
+        P##No *avo = pai->pai;                                                          \
+        P##No *tio = avo->esquerdo == pai ? avo->direito : avo->esquerdo;               \
+        if (P##Vermelho(tio)) {                                                         \
+            pai->vermelho = tio->vermelho = 0;                                          \
+            avo->vermelho = 1;                                                          \
+            no = avo;                                                                   \
+        } else if (avo->esquerdo == pai) {                                              \
+            if (pai->direito == no) {                                                   \
+                P##RotacaoEsq(arvore, pai);                                             \
+                pai = no;                                                               \
+            }                                                                           \
+            pai->vermelho = 0;                                                          \
+            avo->vermelho = 1;                                                          \
+            P##RotacaoDir(arvore, avo);                                                 \
+            break;                                                                      \
+        } else {                                                                        \
+            if (pai->esquerdo == no) {                                                  \
+                P##RotacaoDir(arvore, pai);                                             \
+                pai = no;                                                               \
+            }                                                                           \
+            pai->vermelho = 0;                                                          \
+            avo->vermelho = 1;                                                          \
+            P##RotacaoEsq(arvore, avo);                                                 \
+            break;                                                                      \
+        }                                                                               \
+    }                                                                                   \
+    arvore->raiz->vermelho = 0;                                                         \
+}                                                                                       \
+                                                                                        \
+/* Corrige a falta de um nó preto no caminho de x, filho de pai (x pode ser NULL) */    \
+static inline void P##AjustarRemocao(P##Arvore *arvore, P##No *x, P##No *pai) {         \
+    while (x != arvore->raiz && !P##Vermelho(x)) {                                      \
+        if (x == pai->esquerdo) {                                                       \
+            P##No *irmao = pai->direito;                                                \
+            if (irmao->vermelho) {                                                      \
+                irmao->vermelho = 0;                                                    \
+                pai->vermelho = 1;                                                      \
+                P##RotacaoEsq(arvore, pai);                                             \
+                irmao = pai->direito;                                                   \
+            }                                                                           \
+            if (!P##Vermelho(irmao->esquerdo) && !P##Vermelho(irmao->direito)) {        \
+                irmao->vermelho = 1;                                                    \
+                x = pai;                                                                \
+                pai = x->pai;                                                           \
+            } else {                                                                    \
+                if (!P##Vermelho(irmao->direito)) {                                     \
+                    irmao->esquerdo->vermelho = 0;                                      \
+                    irmao->vermelho = 1;                                                \
+                    P##RotacaoDir(arvore, irmao);                                       \
+                    irmao = pai->direito;                                               \
+                }                                                                       \
+                irmao->vermelho = pai->vermelho;                                        \
+                pai->vermelho = 0;                                                      \
+                irmao->direito->vermelho = 0;                                           \
+                P##RotacaoEsq(arvore, pai);                                             \
+                x = arvore->raiz;                                                       \
+            }                                                                           \
+        } else {                                                                        \
+            P##No *irmao = pai->esquerdo;                                               \
+            if (irmao->vermelho) {                                                      \
+                irmao->vermelho = 0;                                                    \
+                pai->vermelho = 1;                                                      \
+                P##RotacaoDir(arvore, pai);                                             \
+                irmao = pai->esquerdo;                                                  \
+            }                                                                           \
+            if (!P##Vermelho(irmao->esquerdo) && !P##Vermelho(irmao->direito)) {        \
+                irmao->vermelho = 1;                                                    \
+                x = pai;                                                                \
+                pai = x->pai;                                                           \
+            } else {                                                                    \
+                if (!P##Vermelho(irmao->esquerdo)) {                                    \
+                    irmao->direito->vermelho = 0;                                       \
+                    irmao->vermelho = 1;                                                \
+                    P##RotacaoEsq(arvore, irmao);                                       \
+                    irmao = pai->esquerdo;                                              \
+                }                                                                       \
+                irmao->vermelho = pai->vermelho;                                        \
+                pai->vermelho = 0;                                                      \
+                irmao->esquerdo->vermelho = 0;                                          \
+                P##RotacaoDir(arvore, pai);                                             \
+                x = arvore->raiz;                                                       \
+            }                                                                           \
+        }                                                                               \
+    }                                                                                   \
+    if (x) x->vermelho = 0;                                                             \
+}                                                                                       \
+                                                                                        \
+/**                                                                                     \
+ * Remove uma chave da árvore.                                                          \
+ * @param valor Recebe o valor que estava associado à chave (pode ser NULL)             \
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE                                     \
+ */                                                                                     \
+static inline void P##Remover(P##Arvore *arvore, TipoChave chave,                       \
+                              TipoValor *valor, Status *status) {                       \
+    P##No *z = arvore->raiz;                                                            \
+    while (z) {                                                                         \
+        const int c = COMPARAR(chave, z->chave);                                        \
+        if (c == 0) break;                                                              \
+        z = c < 0 ? z->esquerdo : z->direito;                                           \
+    }                                                                                   \
+    if (z == NULL) {                                                                    \
+        *status = STATUS_AUSENTE;                                                       \
+        return;                                                                         \
+    }                                                                                   \
+    *status = STATUS_OK;                                                                \
+    if (valor) *valor = z->valor;                                                       \
+                                                                                        \
+    P##No *x, *xPai = z->pai;                                                           \
+    int pretoRemovido = !z->vermelho;                                                   \
+    if (z->esquerdo == NULL) {                                                          \
+        x = z->direito;                                                                 \
+        P##Substituir(arvore, z, x);                                                    \
+    } else if (z->direito == NULL) {                                                    \
+        x = z->esquerdo;                                                                \
+        P##Substituir(arvore, z, x);                                                    \
+    } else {                                                                            \
+        /* Dois filhos: o sucessor y ocupa o lugar de z */                              \
+        P##No *y = z->direito;                                                          \
+        while (y->esquerdo) y = y->esquerdo;                                            \
+        pretoRemovido = !y->vermelho;                                                   \
+        x = y->direito;                                                                 \
+        if (y->pai == z) {                                                              \
+            xPai = y;                                                                   \
+        } else {                                                                        \
+            xPai = y->pai;                                                              \
+            P##Substituir(arvore, y, x);                                                \
+            y->direito = z->direito;                                                    \
+            y->direito->pai = y;                                                        \
+        }                                                                               \
+        P##Substituir(arvore, z, y);                                                    \
+        y->esquerdo = z->esquerdo;                                                      \
+        y->esquerdo->pai = y;                                                           \
+        y->vermelho = z->vermelho;                                                      \
+    }                                                                                   \
+                                                                                        \
+    P##Devolver(arvore, z);                                                             \
+    arvore->quantidade--;                                                               \
+    if (pretoRemovido) P##AjustarRemocao(arvore, x, xPai);                              \
+}                                                                                       \
+                                                                                        \
+/** Libera todos os nós da árvore, que volta a ficar vazia. */                          \
+static inline void P##Destruir(P##Arvore *arvore) {                                     \
+    P##LiberarBlocos(arvore);                                                           \
+    arvore->raiz = NULL;                                                                \
+    arvore->quantidade = 0;                                                             \
+}
+
+#endif
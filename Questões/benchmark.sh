@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+#
+# Compara as árvores AVL (questao01.c), Rubro-Negra (questao02.c), B+ (questao03.c),
+# AVL concorrente (questao04.c), esta executada por uma única thread, e WAVL
+# (questao05.c) sobre as mesmas sequências de chaves, gravando os resultados em CSV.
+#
+# Uso: ./benchmark.sh [arquivo.csv] [tamanhos...]
+#   arquivo.csv  destino dos resultados (padrão: benchmark.csv)
+#   tamanhos     quantidades de chaves (padrão: 1000 10000 100000 1000000 10000000 100000000)
+#
+# A pesquisa dentro dos nós da árvore B+ usa AVX2 quando compilada com suporte a ele
+# (por exemplo, CFLAGS="-O2 -DNDEBUG -march=native").
+#
+# Cada execução roda em um processo separado, para que o pico de memória (pico_rss_kb)
+# corresponda apenas àquela árvore e àquele tamanho.
+
+set -euo pipefail
+
+DIR="$(cd "$(dirname "$0")" && pwd)"
+SAIDA="${1:-benchmark.csv}"
+shift || true
+if [ $# -gt 0 ]; then
+    TAMANHOS=("$@")
+else
+    TAMANHOS=(1000 10000 100000 1000000 10000000 100000000)
+fi
+
+CC="${CC:-cc}"
+CFLAGS="${CFLAGS:--O2 -DNDEBUG}"
+BIN="$(mktemp -d)"
+trap 'rm -rf "$BIN"' EXIT
+
+# Identifica a versão compilada, para acompanhar regressões entre builds
+VERSAO="$(git -C "$DIR" rev-parse --short HEAD 2>/dev/null || echo desconhecida)"
+
+PROGRAMAS=(questao01 questao02 questao03 questao04 questao05)
+for programa in "${PROGRAMAS[@]}"; do
+    $CC $CFLAGS "$DIR/$programa.c" -o "$BIN/$programa" -lm -pthread
+done
+
+echo "versao,motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura" > "$SAIDA"
+
+for n in "${TAMANHOS[@]}"; do
+    for carga in aleatoria ordenada; do
+        for programa in "${PROGRAMAS[@]}"; do
+            for armazenamento in ponteiros compacta descendente; do
+                # As árvores B+, AVL concorrente e WAVL não têm armazenamento compacto,
+                # e só a Rubro-Negra tem o motor descendente
+                if [ "$programa" != questao01 ] && [ "$programa" != questao02 ] && [ "$armazenamento" = compacta ]; then
+                    continue
+                fi
+                if [ "$programa" != questao02 ] && [ "$armazenamento" = descendente ]; then
+                    continue
+                fi
+                echo "$programa: $n chaves ($carga, $armazenamento)" >&2
+                "$BIN/$programa" --bench "$n" "$carga" "$armazenamento" | sed "s/^/$VERSAO,/" >> "$SAIDA"
+            done
+        done
+    done
+done
+
+echo "Resultados gravados em $SAIDA" >&2
@@ -1,8 +1,29 @@
+// Expõe madvise, MADV_SEQUENTIAL e truncate mesmo quando compilado com -std=c11
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <locale.h>
 #include <wchar.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "arvore_generica.h"
 
 /*
 Alunos:
@@ -14,19 +35,249 @@ Nathielly Neves de Castro
    DEFINIÇÃO DA ESTRUTURA DO NÓ
    ============================================================ */
 
+/*
+ * Estatísticas de ordem opcionais. Com -DESTATISTICA_ORDEM=0 o campo tamanho
+ * deixa de existir, e as consultas posicao, selecionar e contarFaixa não são compiladas.
+ */
+#ifndef ESTATISTICA_ORDEM
+#define ESTATISTICA_ORDEM 1
+#endif
+
+/*
+ * Modo multiconjunto opcional. Com -DMULTICONJUNTO=1 cada nó guarda quantas
+ * vezes o seu valor foi inserido: inserir um valor existente só incrementa a
+ * contagem, e a remoção a decrementa, liberando o nó apenas na última ocorrência.
+ * O tamanho das subárvores passa a contar ocorrências, e não nós.
+ */
+#ifndef MULTICONJUNTO
+#define MULTICONJUNTO 0
+#endif
+
 /**
  * Estrutura que representa um nó da árvore AVL.
  * Cada nó armazena:
  * - um valor inteiro
  * - ponteiros para os filhos esquerdo e direito
  * - a altura do nó (necessária para o balanceamento AVL)
+ * - a quantidade de nós da subárvore (necessária para as estatísticas de ordem)
+ * - a quantidade de ocorrências do valor (no modo multiconjunto)
  */
 typedef struct no {
     int valor;
     struct no *esquerdo, *direito;
     int altura;
+#if ESTATISTICA_ORDEM
+    int tamanho;
+#endif
+#if MULTICONJUNTO
+    int contagem;
+#endif
 } No;
 
+/* ============================================================
+   CÓDIGOS DE RETORNO E RASTREAMENTO
+   ============================================================ */
+
+/**
+ * Resultado das operações da árvore. As operações não escrevem nada na tela:
+ * cabe a quem as chama decidir o que fazer com o resultado.
+ */
+typedef enum {
+    STATUS_OK = 0,         // operação realizada (ou chave encontrada)
+    STATUS_AUSENTE = 1,    // chave não encontrada
+    STATUS_DUPLICADA = 2,  // chave já existente, inserção ignorada
+    STATUS_INVALIDO = 3,   // operação desconhecida (usado no modo em lote)
+    STATUS_SEM_MEMORIA = 4 // não foi possível alocar um novo nó
+} Status;
+
+/*
+ * Rastreamento opcional das operações. Com -DRASTREAMENTO=0 as chamadas de
+ * RASTREAR desaparecem na compilação; caso contrário, custam apenas a verificação
+ * do ponteiro do rastreador, que por padrão é NULL.
+ */
+#ifndef RASTREAMENTO
+#define RASTREAMENTO 1
+#endif
+
+typedef enum {
+    EVENTO_VISITA // um nó foi visitado durante a pesquisa
+} Evento;
+
+typedef void (*Rastreador)(Evento evento, int valor);
+
+#if RASTREAMENTO
+static Rastreador rastreador = NULL;
+#define RASTREAR(evento, valor) do { if (rastreador) rastreador((evento), (valor)); } while (0)
+#else
+#define RASTREAR(evento, valor) ((void) 0)
+#endif
+
+/* ============================================================
+   CONTADORES DE INSTRUMENTAÇÃO
+   ============================================================ */
+
+/*
+ * Contadores das operações da árvore, para entender o custo de cada carga.
+ * São simples incrementos não atômicos, locais a cada thread (as operações de
+ * conjunto em paralelo não entram nos contadores exibidos pelo menu); com
+ * -DCONTADORES=0 as chamadas de CONTAR e CONTAR_PROFUNDIDADE desaparecem na compilação.
+ */
+#ifndef CONTADORES
+#define CONTADORES 1
+#endif
+
+#define PROFUNDIDADE_MAXIMA 64 // pesquisas mais profundas são contadas no último intervalo
+
+typedef struct {
+    unsigned long long comparacoes;     // comparações de chave em inserções, remoções e pesquisas
+    unsigned long long rotacoesDD;      // caso Direita-Direita (rotação simples à esquerda)
+    unsigned long long rotacoesEE;      // caso Esquerda-Esquerda (rotação simples à direita)
+    unsigned long long rotacoesED;      // caso Esquerda-Direita (rotação dupla)
+    unsigned long long rotacoesDE;      // caso Direita-Esquerda (rotação dupla)
+    unsigned long long balanceamentos;  // chamadas de balancear
+    unsigned long long profundidades[PROFUNDIDADE_MAXIMA]; // histograma da profundidade das pesquisas
+} Contadores;
+
+#if CONTADORES
+static _Thread_local Contadores contadores;
+#define CONTAR(campo) (contadores.campo++)
+#define CONTAR_PROFUNDIDADE(p) \
+    (contadores.profundidades[(p) < PROFUNDIDADE_MAXIMA ? (p) : PROFUNDIDADE_MAXIMA - 1]++)
+#else
+#define CONTAR(campo) ((void) 0)
+#define CONTAR_PROFUNDIDADE(p) ((void) (p))
+#endif
+
+/**
+ * Escreve uma linha em um fluxo de saída, respeitando a orientação do fluxo
+ * (caracteres largos no menu, bytes no modo em lote).
+ */
+void escreverLinha(FILE *saida, const char *linha) {
+    if (fwide(saida, 0) > 0) {
+        fwprintf(saida, L"%s", linha);
+    } else {
+        fputs(linha, saida);
+    }
+}
+
+/**
+ * Escreve os contadores acumulados até o momento, incluindo o histograma
+ * de profundidade das pesquisas (apenas as profundidades que ocorreram).
+ * @param saida Fluxo onde os contadores serão escritos
+ */
+void exibirContadores(FILE *saida) {
+#if CONTADORES
+    char linha[128];
+
+    snprintf(linha, sizeof(linha), "Comparações: %llu\n", contadores.comparacoes);
+    escreverLinha(saida, linha);
+    snprintf(linha, sizeof(linha), "Balanceamentos: %llu\n", contadores.balanceamentos);
+    escreverLinha(saida, linha);
+    snprintf(linha, sizeof(linha), "Rotações DD: %llu | EE: %llu | ED: %llu | DE: %llu\n",
+             contadores.rotacoesDD, contadores.rotacoesEE, contadores.rotacoesED, contadores.rotacoesDE);
+    escreverLinha(saida, linha);
+    escreverLinha(saida, "Profundidade das pesquisas (nós visitados):\n");
+    for (int p = 0; p < PROFUNDIDADE_MAXIMA; p++) {
+        if (contadores.profundidades[p]) {
+            snprintf(linha, sizeof(linha), "  profundidade %2d%s: %llu\n",
+                     p, p == PROFUNDIDADE_MAXIMA - 1 ? "+" : " ", contadores.profundidades[p]);
+            escreverLinha(saida, linha);
+        }
+    }
+#else
+    escreverLinha(saida, "Contadores desativados na compilação (-DCONTADORES=0).\n");
+#endif
+}
+
+/* ============================================================
+   ALOCADOR DE NÓS (POOL)
+   ============================================================ */
+
+#define POOL_BLOCO_INICIAL 1024     // capacidade do primeiro bloco (em nós)
+#define POOL_BLOCO_MAXIMO  1048576  // limite para o crescimento dos blocos
+
+/**
+ * Bloco contíguo de nós. Os blocos formam uma lista ligada para que possam
+ * ser liberados todos de uma vez ao destruir o pool.
+ */
+typedef struct bloco {
+    struct bloco *proximo;
+    size_t capacidade;
+    No nos[];
+} Bloco;
+
+/**
+ * Pool de nós: entrega nós a partir de blocos grandes e reaproveita os nós
+ * removidos através de uma lista de livres (encadeada pelo ponteiro esquerdo).
+ */
+typedef struct {
+    Bloco *blocos;  // bloco atual (início da lista de blocos)
+    size_t usados;  // quantidade de nós já entregues do bloco atual
+    No *livres;     // nós devolvidos, prontos para reutilização
+} Pool;
+
+/**
+ * Pool utilizado por todos os nós da árvore.
+ */
+static Pool poolNos = {NULL, 0, NULL};
+
+/**
+ * Obtém um nó do pool, priorizando os nós devolvidos.
+ * Quando o bloco atual se esgota, um novo bloco com o dobro da capacidade é alocado.
+ * @param pool Pool de onde o nó será retirado
+ * @return Nó não inicializado ou NULL, caso não haja memória
+ */
+No* poolAlocar(Pool *pool) {
+    // Reaproveita um nó da lista de livres
+    if (pool->livres) {
+        No *no = pool->livres;
+        pool->livres = no->esquerdo;
+        return no;
+    }
+
+    // Aloca um novo bloco quando o atual está cheio (ou ainda não existe)
+    if (pool->blocos == NULL || pool->usados == pool->blocos->capacidade) {
+        size_t capacidade = pool->blocos ? pool->blocos->capacidade * 2 : POOL_BLOCO_INICIAL;
+        if (capacidade > POOL_BLOCO_MAXIMO) capacidade = POOL_BLOCO_MAXIMO;
+
+        Bloco *bloco = malloc(sizeof(Bloco) + capacidade * sizeof(No));
+        if (bloco == NULL) return NULL;
+
+        bloco->proximo = pool->blocos;
+        bloco->capacidade = capacidade;
+        pool->blocos = bloco;
+        pool->usados = 0;
+    }
+
+    return &pool->blocos->nos[pool->usados++];
+}
+
+/**
+ * Devolve um nó ao pool, para que seja reutilizado em uma próxima alocação.
+ * @param pool Pool de onde o nó foi retirado
+ * @param no Nó que será devolvido
+ */
+void poolLiberar(Pool *pool, No *no) {
+    no->esquerdo = pool->livres;
+    pool->livres = no;
+}
+
+/**
+ * Libera todos os blocos do pool de uma só vez.
+ * Todos os nós entregues pelo pool (e, portanto, a árvore inteira) deixam de ser válidos.
+ * @param pool Pool que será destruído
+ */
+void poolDestruir(Pool *pool) {
+    while (pool->blocos) {
+        Bloco *proximo = pool->blocos->proximo;
+        free(pool->blocos);
+        pool->blocos = proximo;
+    }
+
+    pool->usados = 0;
+    pool->livres = NULL;
+}
+
 /* ============================================================
    FUNÇÕES AUXILIARES BÁSICAS
    ============================================================ */
@@ -34,18 +285,22 @@ typedef struct no {
 /**
  * Cria e inicializa um novo nó da árvore AVL.
  * @param num Valor a ser armazenado no nó
- * @return Ponteiro para o novo nó criado
+ * @return Ponteiro para o novo nó criado ou NULL, caso não haja memória
  */
 No* novoNo(int num) {
-    No *novo = malloc(sizeof(No));
+    No *novo = poolAlocar(&poolNos);
 
     if (novo) {
         novo->valor = num;
         novo->esquerdo = NULL;
         novo->direito = NULL;
         novo->altura = 0; // nó folha inicia com altura 0
-    } else {
-        wprintf(L"\nERRO ao alocar memória");
+#if ESTATISTICA_ORDEM
+        novo->tamanho = 1;
+#endif
+#if MULTICONJUNTO
+        novo->contagem = 1;
+#endif
     }
 
     return novo;
@@ -72,6 +327,42 @@ int alturaNo(const No *no) {
     }
 }
 
+/**
+ * Retorna a quantidade de nós de uma subárvore.
+ * @param no Raiz da subárvore
+ * @return Quantidade de nós ou 0 se for NULL
+ */
+int tamanhoNo(const No *no) {
+#if ESTATISTICA_ORDEM
+    return no ? no->tamanho : 0;
+#else
+    (void) no;
+    return 0;
+#endif
+}
+
+/**
+ * Retorna quantas vezes o valor de um nó foi inserido (sempre 1 fora do modo multiconjunto).
+ */
+int ocorrencias(const No *no) {
+#if MULTICONJUNTO
+    return no->contagem;
+#else
+    (void) no;
+    return 1;
+#endif
+}
+
+/**
+ * Recalcula a altura e o tamanho de um nó a partir dos seus filhos.
+ */
+void atualizaNo(No *no) {
+    no->altura = maior(alturaNo(no->esquerdo), alturaNo(no->direito)) + 1;
+#if ESTATISTICA_ORDEM
+    no->tamanho = tamanhoNo(no->esquerdo) + tamanhoNo(no->direito) + ocorrencias(no);
+#endif
+}
+
 /**
  * Calcula o fator de balanceamento de um nó AVL.
  * fator = altura(esquerda) - altura(direita)
@@ -100,9 +391,9 @@ No* rotacaoEsq(No *raiz) {
     u->esquerdo = raiz;
     raiz->direito = v;
 
-    // Atualização das alturas
-    raiz->altura = maior(alturaNo(raiz->esquerdo), alturaNo(raiz->direito)) + 1;
-    u->altura = maior(alturaNo(u->esquerdo), alturaNo(u->direito)) + 1;
+    // Atualização das alturas e dos tamanhos
+    atualizaNo(raiz);
+    atualizaNo(u);
 
     return u; // nova raiz da subárvore
 }
@@ -119,9 +410,9 @@ No* rotacaoDir(No *raiz) {
     u->direito = raiz;
     raiz->esquerdo = v;
 
-    // Atualização das alturas
-    raiz->altura = maior(alturaNo(raiz->esquerdo), alturaNo(raiz->direito)) + 1;
-    u->altura = maior(alturaNo(u->esquerdo), alturaNo(u->direito)) + 1;
+    // Atualização das alturas e dos tamanhos
+    atualizaNo(raiz);
+    atualizaNo(u);
 
     return u; // nova raiz da subárvore
 }
@@ -152,56 +443,121 @@ No* rotacaoDirEsq(No *raiz) {
 
 /**
  * Verifica o fator de balanceamento e aplica a rotação adequada.
+ * O fator do nó é calculado uma única vez, e o do filho só quando há rotação.
  */
 No* balancear(No *raiz) {
-    int fatorB = fatorBalanceamento(raiz);
+    const int fatorB = fatorBalanceamento(raiz);
+    CONTAR(balanceamentos);
 
-    // Caso Direita-Direita
-    if (fatorB < -1 && fatorBalanceamento(raiz->direito) <= 0) {
-        raiz = rotacaoEsq(raiz);
-    }
-    // Caso Esquerda-Esquerda
-    else if (fatorB > 1 && fatorBalanceamento(raiz->esquerdo) >= 0) {
-        raiz = rotacaoDir(raiz);
-    }
-    // Caso Esquerda-Direita
-    else if (fatorB > 1 && fatorBalanceamento(raiz->esquerdo) < 0) {
-        raiz = rotacaoEsqDir(raiz);
+    if (fatorB > 1) {
+        // Caso Esquerda-Esquerda
+        if (fatorBalanceamento(raiz->esquerdo) >= 0) {
+            CONTAR(rotacoesEE);
+            return rotacaoDir(raiz);
+        }
+        // Caso Esquerda-Direita
+        CONTAR(rotacoesED);
+        return rotacaoEsqDir(raiz);
     }
-    // Caso Direita-Esquerda
-    else if (fatorB < -1 && fatorBalanceamento(raiz->direito) > 0) {
-        raiz = rotacaoDirEsq(raiz);
+
+    if (fatorB < -1) {
+        // Caso Direita-Direita
+        if (fatorBalanceamento(raiz->direito) <= 0) {
+            CONTAR(rotacoesDD);
+            return rotacaoEsq(raiz);
+        }
+        // Caso Direita-Esquerda
+        CONTAR(rotacoesDE);
+        return rotacaoDirEsq(raiz);
     }
 
     return raiz;
 }
 
+/*
+ * A inserção e a remoção descem de forma iterativa, guardando em uma pilha o
+ * endereço de cada ligação do caminho (o ponteiro do pai, ou a própria raiz),
+ * para que a correção possa subir e religar as subárvores rotacionadas.
+ */
+#define AVL_CAMINHO 64 // maior que a altura de qualquer AVL com até 2^31 nós (no máximo 45)
+
+/**
+ * Corrige os nós de um caminho depois de uma inserção ou remoção, do mais
+ * profundo para a raiz. A correção para no primeiro nó cuja subárvore manteve
+ * a altura: daí para cima, nenhum fator de balanceamento mudou. Com as
+ * estatísticas de ordem, os nós restantes só têm o tamanho corrigido.
+ * @param caminho Endereço da ligação de cada nó do caminho, a partir da raiz
+ * @param topo Quantidade de nós no caminho
+ * @param variacao Variação do tamanho de cada subárvore do caminho (+1 ou -1)
+ */
+void ajustarCaminho(No **caminho[], int topo, const int variacao) {
+    while (topo > 0) {
+        No **ligacao = caminho[--topo];
+        No *no = *ligacao;
+        const int alturaAnterior = no->altura;
+
+        atualizaNo(no);
+        *ligacao = no = balancear(no);
+        if (no->altura == alturaAnterior) break;
+    }
+
+#if ESTATISTICA_ORDEM
+    while (topo > 0) {
+        (*caminho[--topo])->tamanho += variacao;
+    }
+#else
+    (void) variacao;
+#endif
+}
+
 /* ============================================================
    INSERÇÃO NA ÁRVORE AVL
    ============================================================ */
 
 /**
  * Insere um valor na árvore AVL.
- * Após a inserção, a árvore é balanceada.
+ * Após a inserção, os ancestrais são balanceados até o primeiro cuja altura
+ * não mudou. No modo multiconjunto, um valor existente só tem a sua contagem
+ * incrementada, sem alocação nem rotação.
+ * @param raiz Raiz da árvore
+ * @param num Valor a ser inserido
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA (fora do modo multiconjunto) ou STATUS_SEM_MEMORIA
+ * @return Nova raiz da árvore
  */
-No* insercao(No *raiz, int num) {
-    if (raiz == NULL) {
-        return novoNo(num);
+No* insercao(No *raiz, int num, Status *status) {
+    No **caminho[AVL_CAMINHO];
+    int topo = 0;
+    No **ligacao = &raiz;
+
+    while (*ligacao != NULL) {
+        No *no = *ligacao;
+        CONTAR(comparacoes);
+
+        if (num == no->valor) {
+#if MULTICONJUNTO
+            // A altura não muda: apenas os tamanhos do caminho são corrigidos
+            no->contagem++;
+            caminho[topo++] = ligacao;
+            ajustarCaminho(caminho, topo, 1);
+            *status = STATUS_OK;
+#else
+            *status = STATUS_DUPLICADA;
+#endif
+            return raiz;
+        }
+
+        caminho[topo++] = ligacao;
+        ligacao = num < no->valor ? &no->esquerdo : &no->direito;
     }
 
-    if (num < raiz->valor) {
-        raiz->esquerdo = insercao(raiz->esquerdo, num);
-    } else if (num > raiz->valor) {
-        raiz->direito = insercao(raiz->direito, num);
-    } else {
-        wprintf(L"A inserção não foi realizada, pois %d já existe\n", num);
+    *ligacao = novoNo(num);
+    if (*ligacao == NULL) {
+        *status = STATUS_SEM_MEMORIA;
         return raiz;
     }
+    *status = STATUS_OK;
 
-    // Atualiza altura e balanceia
-    raiz->altura = maior(alturaNo(raiz->esquerdo), alturaNo(raiz->direito)) + 1;
-    raiz = balancear(raiz);
-
+    ajustarCaminho(caminho, topo, 1);
     return raiz;
 }
 
@@ -211,307 +567,3922 @@ No* insercao(No *raiz, int num) {
 
 /**
  * Remove um valor da árvore AVL.
- * Após a remoção, a árvore é balanceada.
+ * Após a remoção, os ancestrais são balanceados até o primeiro cuja altura
+ * não mudou. No modo multiconjunto, remove uma única ocorrência: o nó só é
+ * liberado quando a contagem chega a zero.
+ * @param raiz Raiz da árvore
+ * @param chave Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Nova raiz da árvore
  */
-No* remover(No *raiz, int chave) {
-    if (raiz == NULL) {
-        wprintf(L"O valor não foi encontrado\n");
-        return NULL;
+No* remover(No *raiz, int chave, Status *status) {
+    No **caminho[AVL_CAMINHO];
+    int topo = 0;
+    No **ligacao = &raiz;
+
+    while (*ligacao != NULL && (*ligacao)->valor != chave) {
+        CONTAR(comparacoes);
+        caminho[topo++] = ligacao;
+        ligacao = chave < (*ligacao)->valor ? &(*ligacao)->esquerdo : &(*ligacao)->direito;
     }
 
-    if (chave < raiz->valor) {
-        raiz->esquerdo = remover(raiz->esquerdo, chave);
-    } else if (chave > raiz->valor) {
-        raiz->direito = remover(raiz->direito, chave);
-    } else {
-        // Nó encontrado
-        if (raiz->esquerdo == NULL && raiz->direito == NULL) {
-            free(raiz);
-            return NULL;
-        }
-        else if (raiz->esquerdo != NULL && raiz->direito != NULL) {
-            // Nó com dois filhos: troca pelo predecessor
-            No *aux = raiz->esquerdo;
-            while (aux->direito != NULL) {
-                aux = aux->direito;
-            }
-            raiz->valor = aux->valor;
-            raiz->esquerdo = remover(raiz->esquerdo, aux->valor);
+    if (*ligacao == NULL) {
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
+    CONTAR(comparacoes);
+    *status = STATUS_OK;
+
+    // Nó encontrado
+    No *no = *ligacao;
+#if MULTICONJUNTO
+    if (no->contagem > 1) {
+        no->contagem--;
+        caminho[topo++] = ligacao;
+        ajustarCaminho(caminho, topo, -1);
+        return raiz;
+    }
+#endif
+
+    if (no->esquerdo != NULL && no->direito != NULL) {
+        // Nó com dois filhos: recebe o valor do predecessor, que sai da árvore no seu lugar
+        caminho[topo++] = ligacao;
+#if MULTICONJUNTO && ESTATISTICA_ORDEM
+        const int encontrado = topo;
+#endif
+        ligacao = &no->esquerdo;
+        while ((*ligacao)->direito != NULL) {
+            caminho[topo++] = ligacao;
+            ligacao = &(*ligacao)->direito;
         }
-        else {
-            // Nó com apenas um filho
-            No *aux = (raiz->esquerdo) ? raiz->esquerdo : raiz->direito;
-            free(raiz);
-            return aux;
+
+        No *predecessor = *ligacao;
+        no->valor = predecessor->valor;
+#if MULTICONJUNTO
+        // O predecessor leva todas as ocorrências: abaixo do nó encontrado, o caminho perde todas elas
+#if ESTATISTICA_ORDEM
+        for (int i = encontrado; i < topo; i++) {
+            (*caminho[i])->tamanho -= predecessor->contagem - 1;
         }
+#endif
+        no->contagem = predecessor->contagem;
+#endif
+        no = predecessor;
     }
 
-    // Atualiza altura e balanceia
-    raiz->altura = maior(alturaNo(raiz->esquerdo), alturaNo(raiz->direito)) + 1;
-    raiz = balancear(raiz);
+    // O nó que sai tem no máximo um filho, que ocupa o seu lugar
+    *ligacao = no->esquerdo ? no->esquerdo : no->direito;
+    poolLiberar(&poolNos, no);
 
+    ajustarCaminho(caminho, topo, -1);
     return raiz;
 }
 
 /* ============================================================
-   FUNÇÕES DE PESQUISA
+   CONSTRUÇÃO EM LOTE
    ============================================================ */
 
 /**
- * Busca um nó com valor correspondente na árvore
- * @param raiz Nó inicial da busca
- * @param valor Valor que será buscado na árvore
- * @param exibirMensagem Indica se deve exibir mensagens durante a busca
- * @return O nó com o valor correspondente ou NULL, caso ele não esteja presente na árvore
+ * Compara dois inteiros, para a ordenação com qsort.
+ */
+int compararInteiros(const void *a, const void *b) {
+    const int x = *(const int *) a;
+    const int y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Constrói uma árvore perfeitamente balanceada a partir de um trecho de um vetor
+ * estritamente crescente, usando o elemento central como raiz de cada subárvore.
+ * @param valores Vetor ordenado
+ * @param contagens Ocorrências de cada valor no modo multiconjunto (NULL para uma de cada)
+ * @param ini Primeiro índice do trecho
+ * @param fim Último índice do trecho
+ * @param status Recebe STATUS_SEM_MEMORIA caso algum nó não possa ser alocado
+ * @return Raiz da subárvore construída
  */
-No* pesquisaNo(No *raiz, const int valor, const int exibirMensagem) {
-    // Caso base - valor não encontrado
-    if (raiz == NULL) return NULL;
+No* construirFaixa(const int *valores, const int *contagens, const int ini, const int fim, Status *status) {
+    if (ini > fim) return NULL;
 
-    if (exibirMensagem) {
-        wprintf(L"Verificando nó com valor %d...\n", raiz->valor);
+    const int meio = ini + (fim - ini) / 2;
+    No *raiz = novoNo(valores[meio]);
+    if (raiz == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
     }
 
-    // Caso base - valor encontrado
-    if (raiz->valor == valor) return raiz;
+#if MULTICONJUNTO
+    if (contagens) raiz->contagem = contagens[meio];
+#else
+    (void) contagens;
+#endif
+    raiz->esquerdo = construirFaixa(valores, contagens, ini, meio - 1, status);
+    raiz->direito = construirFaixa(valores, contagens, meio + 1, fim, status);
+    atualizaNo(raiz);
 
-    // Caso recursivo - continuar pesquisa para a direita ou esquerda, dependendo do valor do nó
-    return pesquisaNo(valor < raiz->valor ? raiz->esquerdo : raiz->direito, valor, exibirMensagem);
+    return raiz;
 }
 
-/* ============================================================
-   FUNÇÃO DE PERCURSO PRÉ-ORDEM
-   ============================================================ */
-
 /**
- * Realiza o percurso pré-ordem na árvore AVL.
- * @param raiz Ponteiro para a raiz da árvore
+ * Constrói uma árvore AVL a partir de um vetor de valores em tempo linear,
+ * sem nenhuma rotação. Caso o vetor não esteja estritamente crescente, uma cópia
+ * é ordenada e os valores repetidos são descartados, como na inserção (no modo
+ * multiconjunto, viram a contagem do nó).
+ * @param valores Vetor de valores
+ * @param n Quantidade de valores
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
+ * @return Raiz da nova árvore
  */
-void preOrdem(No *raiz){
-    wprintf(L"%d ", raiz->valor);
+No* construirArvore(const int *valores, const int n, Status *status) {
+    *status = STATUS_OK;
 
-    if(raiz->esquerdo != NULL){
-        preOrdem(raiz->esquerdo);
+    // Verifica se o vetor já está estritamente crescente
+    int ordenado = 1;
+    for (int i = 1; i < n && ordenado; i++) {
+        ordenado = valores[i - 1] < valores[i];
     }
-    if(raiz->direito != NULL){
-        preOrdem(raiz->direito);
+
+    if (ordenado) {
+        return construirFaixa(valores, NULL, 0, n - 1, status);
     }
+
+    // Ordena uma cópia e remove os valores repetidos
+    int *copia = malloc(sizeof(int) * n);
+    if (copia == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
+    }
+    memcpy(copia, valores, sizeof(int) * n);
+    qsort(copia, n, sizeof(int), compararInteiros);
+
+    int *contagens = NULL;
+#if MULTICONJUNTO
+    contagens = malloc(sizeof(int) * n);
+    if (contagens == NULL) {
+        free(copia);
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
+    }
+    contagens[0] = 1;
+#endif
+
+    int distintos = 1;
+    for (int i = 1; i < n; i++) {
+        if (copia[i] != copia[distintos - 1]) {
+            copia[distintos++] = copia[i];
+#if MULTICONJUNTO
+            contagens[distintos - 1] = 1;
+        } else {
+            contagens[distintos - 1]++;
+#endif
+        }
+    }
+
+    No *raiz = construirFaixa(copia, contagens, 0, distintos - 1, status);
+    free(contagens);
+    free(copia);
+
+    return raiz;
 }
 
 /* ============================================================
-   FUNÇÕES DE IMPRESSÃO
+   JUNÇÃO E DIVISÃO
    ============================================================ */
 
 /**
- * Calcula o comprimento (quantidade de caracteres) de um número inteiro.
- * É utilizado para alinhar corretamente os valores dos nós na impressão.
- * Considera números negativos e o valor zero.
+ * Junta duas árvores e um nó intermediário quando a árvore esquerda é a mais alta,
+ * descendo pela borda direita dela até encontrar uma subárvore de altura compatível.
+ * Todos os valores de esq devem ser menores que o do nó, e os de dir, maiores.
  */
-int comprimento(int numero) {
-    const int sinal = numero < 0; // Verifica se o número é negativo
-    int contador = 0;
-
-    // Caso especial: o número zero possui comprimento 1
-    if (numero == 0) {
-        contador = 1;
+No* juntarDireita(No *esq, No *meio, No *dir) {
+    if (alturaNo(esq->direito) <= alturaNo(dir) + 1) {
+        meio->esquerdo = esq->direito;
+        meio->direito = dir;
+        atualizaNo(meio);
+        esq->direito = meio;
     } else {
-        // Conta quantos dígitos o número possui
-        while (numero != 0) {
-            numero = numero / 10; // Remove o último dígito
-            contador++;           // Incrementa o contador de dígitos
-        }
+        esq->direito = juntarDireita(esq->direito, meio, dir);
     }
 
-    // Retorna o comprimento total (dígitos + possível sinal)
-    return sinal + contador;
+    // O desequilíbrio causado pela junção é de no máximo 2, corrigido por uma rotação
+    atualizaNo(esq);
+    return balancear(esq);
 }
 
 /**
- * Calcula o maior comprimento entre os valores armazenados nos nós da árvore.
- * Esse valor é utilizado para definir o espaçamento horizontal da impressão.
- * @param raiz Raiz da árvore
- * @return Maior quantidade de caracteres entre os valores dos nós
+ * Simétrica a juntarDireita, para quando a árvore direita é a mais alta.
  */
-int maiorComprimento(const No *raiz) {
-    // Caso base: árvore vazia
-    if (raiz == NULL) {
-        return 0;
+No* juntarEsquerda(No *esq, No *meio, No *dir) {
+    if (alturaNo(dir->esquerdo) <= alturaNo(esq) + 1) {
+        meio->esquerdo = esq;
+        meio->direito = dir->esquerdo;
+        atualizaNo(meio);
+        dir->esquerdo = meio;
+    } else {
+        dir->esquerdo = juntarEsquerda(esq, meio, dir->esquerdo);
     }
 
-    // Comprimento do valor armazenado no nó atual
-    const int compr = comprimento(raiz->valor);
+    atualizaNo(dir);
+    return balancear(dir);
+}
 
-    // Comprimento máximo das subárvores esquerda e direita
-    const int comprEsq = maiorComprimento(raiz->esquerdo);
-    const int comprDir = maiorComprimento(raiz->direito);
+/**
+ * Junta duas árvores AVL usando um nó já alocado como intermediário.
+ * O custo é proporcional à diferença de altura entre as árvores: O(log n).
+ * @param esq Árvore com os valores menores que o do nó
+ * @param meio Nó intermediário, fora de qualquer árvore
+ * @param dir Árvore com os valores maiores que o do nó
+ * @return Raiz da árvore resultante
+ */
+No* juntarNo(No *esq, No *meio, No *dir) {
+    if (alturaNo(esq) > alturaNo(dir) + 1) return juntarDireita(esq, meio, dir);
+    if (alturaNo(dir) > alturaNo(esq) + 1) return juntarEsquerda(esq, meio, dir);
 
-    // Retorna o maior valor entre os três
-    return (compr > comprEsq)
-        ? (compr > comprDir ? compr : comprDir)
-        : (comprEsq > comprDir ? comprEsq : comprDir);
+    meio->esquerdo = esq;
+    meio->direito = dir;
+    atualizaNo(meio);
+    return meio;
 }
 
 /**
- * Centraliza uma string em um espaço total definido.
- * Utiliza caracteres de preenchimento à esquerda e à direita.
- * É usada para alinhar valores e símbolos na impressão da árvore.
- *
- * @param str String a ser centralizada
- * @param tam Tamanho real da string
- * @param total Espaço total disponível
- * @param ajustarEsq Indica como o arredondamento do espaçamento será feito
- * @param fillEsq Caractere de preenchimento à esquerda
- * @param fillDir Caractere de preenchimento à direita
+ * Junta duas árvores AVL e um valor intermediário (join).
+ * Todos os valores de esq devem ser menores que chave, e todos os de dir, maiores;
+ * caso contrário, as árvores não são modificadas.
+ * @param esq Árvore com os valores menores
+ * @param chave Valor intermediário, que será inserido na árvore resultante
+ * @param dir Árvore com os valores maiores
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (ordem violada) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore resultante (ou esq, em caso de erro)
  */
-void center(const wchar_t *str, const int tam, const int total,
-            const int ajustarEsq, const wchar_t *fillEsq, const wchar_t *fillDir) {
+No* juntar(No *esq, const int chave, No *dir, Status *status) {
+    const No *maiorEsq = esq;
+    while (maiorEsq && maiorEsq->direito) maiorEsq = maiorEsq->direito;
+    const No *menorDir = dir;
+    while (menorDir && menorDir->esquerdo) menorDir = menorDir->esquerdo;
 
-    // Calcula o espaço restante para preenchimento
-    const double pad = (double) (total - tam) / 2.0;
+    if ((maiorEsq && maiorEsq->valor >= chave) || (menorDir && menorDir->valor <= chave)) {
+        *status = STATUS_INVALIDO;
+        return esq;
+    }
 
-    // Define quantos caracteres serão colocados à esquerda e à direita
-    const int padEsq = (int) (ajustarEsq ? floor(pad) : ceil(pad));
-    const int padDir = (int) (ajustarEsq ? ceil(pad) : floor(pad));
+    No *meio = novoNo(chave);
+    if (meio == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return esq;
+    }
 
-    // Preenchimento à esquerda
-    for (int p = 0; p < padEsq; p++) wprintf(L"%ls", fillEsq);
+    *status = STATUS_OK;
+    return juntarNo(esq, meio, dir);
+}
 
-    // Impressão da string centralizada
-    wprintf(L"%ls", str);
+/**
+ * Retira o nó com o maior valor de uma árvore, sem liberá-lo.
+ * @param raiz Raiz da árvore (não pode ser NULL)
+ * @param maximo Recebe o nó retirado
+ * @return Nova raiz da árvore
+ */
+No* retirarMaximo(No *raiz, No **maximo) {
+    if (raiz->direito == NULL) {
+        *maximo = raiz;
+        return raiz->esquerdo;
+    }
 
-    // Preenchimento à direita
-    for (int p = 0; p < padDir; p++) wprintf(L"%ls", fillDir);
+    raiz->direito = retirarMaximo(raiz->direito, maximo);
+    atualizaNo(raiz);
+    return balancear(raiz);
 }
 
 /**
- * Imprime um único nó da árvore, incluindo:
- * - o valor do nó
- * - os conectores gráficos (┌ ┐ ─)
- * A posição do nó é calculada com base na altura da árvore.
+ * Junta duas árvores AVL sem valor intermediário, usando o maior nó de esq como
+ * intermediário. Todos os valores de esq devem ser menores que os de dir.
+ * @return Raiz da árvore resultante
+ */
+No* juntarArvores(No *esq, No *dir) {
+    if (esq == NULL) return dir;
+
+    No *meio;
+    esq = retirarMaximo(esq, &meio);
+    return juntarNo(esq, meio, dir);
+}
+
+/**
+ * Divide uma árvore AVL em duas (split): uma com os valores menores que chave e
+ * outra com os valores maiores ou iguais a ela. Nenhum nó é alocado ou liberado,
+ * e o custo é O(log n), já que cada junção ao longo do caminho custa a diferença
+ * de altura entre as partes.
+ * @param raiz Raiz da árvore que será dividida
+ * @param chave Valor de corte
+ * @param direita Recebe a árvore com os valores maiores ou iguais a chave
+ * @return Raiz da árvore com os valores menores que chave
+ */
+No* dividir(No *raiz, const int chave, No **direita) {
+    if (raiz == NULL) {
+        *direita = NULL;
+        return NULL;
+    }
+
+    No *esq = raiz->esquerdo;
+    No *dir = raiz->direito;
+
+    CONTAR(comparacoes);
+    if (chave <= raiz->valor) {
+        // A raiz e a subárvore direita ficam na parte direita
+        No *meioDir;
+        No *menores = dividir(esq, chave, &meioDir);
+        *direita = juntarNo(meioDir, raiz, dir);
+        return menores;
+    }
+
+    // A raiz e a subárvore esquerda ficam na parte esquerda
+    No *meioEsq = dividir(dir, chave, direita);
+    return juntarNo(esq, raiz, meioEsq);
+}
+
+/**
+ * Divide uma árvore AVL em três partes: os valores menores que chave, o nó com
+ * a própria chave (quando existir) e os valores maiores que ela.
+ * @param raiz Raiz da árvore que será dividida
+ * @param chave Valor de corte
+ * @param direita Recebe a árvore com os valores maiores que chave
+ * @param igual Recebe o nó com o valor igual a chave, fora de qualquer árvore, ou NULL
+ * @return Raiz da árvore com os valores menores que chave
+ */
+No* separar(No *raiz, const int chave, No **direita, No **igual) {
+    if (raiz == NULL) {
+        *direita = NULL;
+        *igual = NULL;
+        return NULL;
+    }
+
+    No *esq = raiz->esquerdo;
+    No *dir = raiz->direito;
+
+    if (chave == raiz->valor) {
+        *direita = dir;
+        *igual = raiz;
+        return esq;
+    }
+
+    if (chave < raiz->valor) {
+        No *meioDir;
+        No *menores = separar(esq, chave, &meioDir, igual);
+        *direita = juntarNo(meioDir, raiz, dir);
+        return menores;
+    }
+
+    No *meioEsq = separar(dir, chave, direita, igual);
+    return juntarNo(esq, raiz, meioEsq);
+}
+
+/* ============================================================
+   OPERAÇÕES DE CONJUNTO EM PARALELO
+   ============================================================ */
+
+/*
+ * União, interseção e diferença por divisão e conquista: a raiz de uma árvore
+ * divide a outra (separar), as metades são resolvidas de forma independente e
+ * os resultados são juntados em O(log n). Enquanto a thread atual resolve as
+ * metades direitas, as esquerdas são entregues a um grupo de threads.
+ * Nenhum nó é alocado: as árvores de entrada são consumidas, e os nós que
+ * sobram são devolvidos ao pool sob uma trava.
+ */
+
+#define PARALELO_ALTURA_MINIMA 12 // subárvores mais baixas são resolvidas na própria thread
+#define THREADS_MAXIMO 64
+
+typedef enum {
+    CONJUNTO_UNIAO,
+    CONJUNTO_INTERSECAO,
+    CONJUNTO_DIFERENCA
+} OperacaoConjunto;
+
+/**
+ * Subproblema entregue ao grupo de threads. Fica na pilha de quem o criou,
+ * que sempre espera a sua conclusão antes de retornar.
+ */
+typedef struct tarefa {
+    OperacaoConjunto operacao;
+    No *a, *b;
+    No *resultado;
+    int concluida;
+    struct tarefa *proxima;
+} Tarefa;
+
+/**
+ * Grupo de threads com uma única pilha de tarefas, protegida por uma trava.
+ */
+typedef struct {
+    pthread_t threads[THREADS_MAXIMO];
+    int quantidade;          // threads auxiliares em execução (0 = execução sequencial)
+    int encerrar;
+    Tarefa *fila;            // tarefas aguardando uma thread
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;    // nova tarefa, tarefa concluída ou encerramento
+} GrupoThreads;
+
+static GrupoThreads grupo = {.trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER};
+
+/**
+ * Trava que protege o pool de nós enquanto as threads devolvem nós.
+ */
+static pthread_mutex_t travaPool = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Devolve ao pool todos os nós de uma subárvore.
+ */
+void liberarSubarvore(No *raiz) {
+    if (raiz == NULL) return;
+
+    liberarSubarvore(raiz->esquerdo);
+    liberarSubarvore(raiz->direito);
+    poolLiberar(&poolNos, raiz);
+}
+
+/**
+ * Devolve ao pool todos os nós de uma subárvore, podendo ser chamada por várias threads.
+ */
+void descartarSubarvore(No *raiz) {
+    if (raiz == NULL) return;
+
+    pthread_mutex_lock(&travaPool);
+    liberarSubarvore(raiz);
+    pthread_mutex_unlock(&travaPool);
+}
+
+/**
+ * Devolve um único nó ao pool (sem os filhos), podendo ser chamada por várias threads.
+ */
+void descartarNo(No *no) {
+    if (no == NULL) return;
+
+    pthread_mutex_lock(&travaPool);
+    poolLiberar(&poolNos, no);
+    pthread_mutex_unlock(&travaPool);
+}
+
+No* operacaoConjunto(OperacaoConjunto operacao, No *a, No *b);
+
+/**
+ * Resolve uma tarefa e avisa quem estiver esperando por ela.
+ */
+void executarTarefa(Tarefa *tarefa) {
+    No *resultado = operacaoConjunto(tarefa->operacao, tarefa->a, tarefa->b);
+
+    pthread_mutex_lock(&grupo.trava);
+    tarefa->resultado = resultado;
+    tarefa->concluida = 1;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Retira a tarefa mais recente da pilha. Deve ser chamada com a trava do grupo.
+ */
+Tarefa* retirarTarefa(void) {
+    Tarefa *tarefa = grupo.fila;
+    if (tarefa) grupo.fila = tarefa->proxima;
+    return tarefa;
+}
+
+/**
+ * Laço das threads auxiliares: resolve tarefas até o encerramento do grupo.
+ */
+void* trabalhador(void *argumento) {
+    (void) argumento;
+
+    pthread_mutex_lock(&grupo.trava);
+    while (!grupo.encerrar) {
+        Tarefa *tarefa = retirarTarefa();
+
+        if (tarefa == NULL) {
+            pthread_cond_wait(&grupo.sinal, &grupo.trava);
+            continue;
+        }
+
+        pthread_mutex_unlock(&grupo.trava);
+        executarTarefa(tarefa);
+        pthread_mutex_lock(&grupo.trava);
+    }
+    pthread_mutex_unlock(&grupo.trava);
+
+    return NULL;
+}
+
+/**
+ * Coloca uma tarefa na pilha, para que qualquer thread livre a resolva.
+ */
+void submeter(Tarefa *tarefa) {
+    pthread_mutex_lock(&grupo.trava);
+    tarefa->concluida = 0;
+    tarefa->proxima = grupo.fila;
+    grupo.fila = tarefa;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Espera a conclusão de uma tarefa. Enquanto espera, a thread resolve as
+ * tarefas pendentes (normalmente a própria tarefa, se ninguém a pegou ainda),
+ * o que evita que todas as threads fiquem bloqueadas esperando umas pelas outras.
+ */
+void aguardar(Tarefa *tarefa) {
+    pthread_mutex_lock(&grupo.trava);
+    while (!tarefa->concluida) {
+        Tarefa *pendente = retirarTarefa();
+
+        if (pendente) {
+            pthread_mutex_unlock(&grupo.trava);
+            executarTarefa(pendente);
+            pthread_mutex_lock(&grupo.trava);
+        } else {
+            pthread_cond_wait(&grupo.sinal, &grupo.trava);
+        }
+    }
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Inicia as threads auxiliares; a thread que chama também trabalha, portanto
+ * são criadas threads - 1 auxiliares.
+ * @param threads Quantidade total de threads
+ */
+void iniciarGrupo(int threads) {
+    if (threads > THREADS_MAXIMO + 1) threads = THREADS_MAXIMO + 1;
+
+    grupo.encerrar = 0;
+    grupo.quantidade = 0;
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&grupo.threads[grupo.quantidade], NULL, trabalhador, NULL) != 0) break;
+        grupo.quantidade++;
+    }
+}
+
+/**
+ * Encerra e aguarda todas as threads auxiliares.
+ */
+void encerrarGrupo(void) {
+    pthread_mutex_lock(&grupo.trava);
+    grupo.encerrar = 1;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+
+    for (int i = 0; i < grupo.quantidade; i++) {
+        pthread_join(grupo.threads[i], NULL);
+    }
+    grupo.quantidade = 0;
+}
+
+/**
+ * Calcula uma operação de conjunto entre duas árvores AVL, consumindo as duas.
+ * No modo multiconjunto, a união fica com a maior contagem de cada valor, a
+ * interseção com a menor, e a diferença com as ocorrências de a que excedem as de b.
+ * @param operacao União, interseção ou diferença (a - b)
+ * @param a Primeira árvore
+ * @param b Segunda árvore
+ * @return Raiz da árvore resultante
+ */
+No* operacaoConjunto(OperacaoConjunto operacao, No *a, No *b) {
+    if (a == NULL || b == NULL) {
+        switch (operacao) {
+            case CONJUNTO_UNIAO:
+                return a ? a : b;
+            case CONJUNTO_INTERSECAO:
+                descartarSubarvore(a ? a : b);
+                return NULL;
+            default:
+                descartarSubarvore(b);
+                return a;
+        }
+    }
+
+    // A raiz de b divide a árvore a
+    No *esqB = b->esquerdo;
+    No *dirB = b->direito;
+    No *dirA, *igual;
+    No *esqA = separar(a, b->valor, &dirA, &igual);
+
+    // As metades são independentes: a esquerda vai para o grupo quando é grande o bastante
+    No *esq, *dir;
+    if (grupo.quantidade > 0 && alturaNo(b) >= PARALELO_ALTURA_MINIMA) {
+        Tarefa tarefa = {operacao, esqA, esqB, NULL, 0, NULL};
+        submeter(&tarefa);
+        dir = operacaoConjunto(operacao, dirA, dirB);
+        aguardar(&tarefa);
+        esq = tarefa.resultado;
+    } else {
+        esq = operacaoConjunto(operacao, esqA, esqB);
+        dir = operacaoConjunto(operacao, dirA, dirB);
+    }
+
+    // A raiz de b entra no resultado conforme a operação e a presença do valor em a
+    switch (operacao) {
+        case CONJUNTO_UNIAO:
+#if MULTICONJUNTO
+            if (igual && igual->contagem > b->contagem) b->contagem = igual->contagem;
+#endif
+            descartarNo(igual);
+            return juntarNo(esq, b, dir);
+
+        case CONJUNTO_INTERSECAO:
+            if (igual) {
+#if MULTICONJUNTO
+                if (igual->contagem < b->contagem) b->contagem = igual->contagem;
+#endif
+                descartarNo(igual);
+                return juntarNo(esq, b, dir);
+            }
+            descartarNo(b);
+            return juntarArvores(esq, dir);
+
+        default:
+#if MULTICONJUNTO
+            if (igual && igual->contagem > b->contagem) {
+                igual->contagem -= b->contagem;
+                descartarNo(b);
+                return juntarNo(esq, igual, dir);
+            }
+#endif
+            descartarNo(igual);
+            descartarNo(b);
+            return juntarArvores(esq, dir);
+    }
+}
+
+/**
+ * Executa uma operação de conjunto usando várias threads.
+ * As árvores de entrada são consumidas e não devem mais ser usadas.
+ * @param operacao União, interseção ou diferença (a - b)
+ * @param a Primeira árvore
+ * @param b Segunda árvore
+ * @param threads Quantidade de threads (1 para execução sequencial)
+ * @return Raiz da árvore resultante
+ */
+No* conjuntoParalelo(OperacaoConjunto operacao, No *a, No *b, const int threads) {
+    iniciarGrupo(threads);
+    No *resultado = operacaoConjunto(operacao, a, b);
+    encerrarGrupo();
+
+    return resultado;
+}
+
+/**
+ * Retorna a quantidade de processadores disponíveis (1 quando indisponível).
+ */
+int processadores(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    const long quantidade = sysconf(_SC_NPROCESSORS_ONLN);
+    return quantidade > 0 ? (int) quantidade : 1;
+#else
+    return 1;
+#endif
+}
+
+/* ============================================================
+   VERSÕES PERSISTENTES (LEITURA SEM TRAVAS)
+   ============================================================ */
+
+/*
+ * Modo persistente: a inserção e a remoção nunca alteram um nó já publicado.
+ * Os nós do caminho (e os envolvidos nas rotações) são copiados, e a nova raiz
+ * é publicada com um único armazenamento atômico. Os leitores percorrem a versão
+ * que carregaram sem nenhuma trava, e só um escritor atua por vez.
  *
- * @param no Nó a ser impresso
- * @param altura Altura atual da camada
- * @param compr Largura padrão para cada nó
- * @param ajustarEsq Indica se o alinhamento deve ser ajustado
+ * Os nós substituídos são recuperados por épocas: cada leitor anuncia a época
+ * global ao começar uma leitura, e um nó aposentado na época e só volta ao pool
+ * quando nenhum leitor ativo anunciou uma época <= e.
+ */
+#define LEITORES_MAXIMO 64
+#define COPIAS_MAXIMO (3 * (PROFUNDIDADE_MAXIMA + 2)) // cópias de uma operação: caminho + rotações
+
+/**
+ * Época anunciada por um leitor (0 quando fora de uma leitura), uma por linha de
+ * cache para que os leitores não disputem a mesma linha.
+ */
+typedef struct {
+    _Alignas(64) atomic_ulong epoca;
+} Leitor;
+
+/**
+ * Nó substituído por uma cópia, aguardando que os leitores o abandonem.
+ */
+typedef struct {
+    No *no;
+    unsigned long epoca; // época em que o nó deixou de fazer parte da versão publicada
+} Aposentado;
+
+typedef struct {
+    _Atomic(No *) raiz;                 // versão publicada
+    atomic_ulong epoca;                 // época global, avançada a cada publicação
+    atomic_int quantidadeLeitores;      // leitores registrados
+    Leitor leitores[LEITORES_MAXIMO];
+    pthread_mutex_t escrita;            // serializa os escritores
+    No *reserva;                        // nós já alocados para as cópias, encadeados por esquerdo
+    int reservados;
+    Aposentado *aposentados;
+    size_t quantidade, capacidade;
+} ArvorePersistente;
+
+static ArvorePersistente persistente = {.epoca = 1, .escrita = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * Nós criados por uma operação de escrita. Enquanto a nova raiz não é publicada,
+ * eles são invisíveis aos leitores e podem ser alterados livremente.
+ */
+typedef struct {
+    No *frescos[COPIAS_MAXIMO];
+    int quantidade;
+} CopiaCaminho;
+
+/**
+ * Completa a reserva de nós para as cópias de uma operação, de forma que ela
+ * não precise tratar falta de memória no meio do caminho.
+ * @return 1 em caso de sucesso ou 0 se faltar memória
+ */
+int reservarCopias(const int quantidade) {
+    while (persistente.reservados < quantidade) {
+        No *no = poolAlocar(&poolNos);
+        if (no == NULL) return 0;
+
+        no->esquerdo = persistente.reserva;
+        persistente.reserva = no;
+        persistente.reservados++;
+    }
+    return 1;
+}
+
+/**
+ * Retira um nó da reserva e o preenche com o conteúdo de outro.
+ * @param no Nó a ser copiado (NULL para um nó novo, preenchido por quem chama)
+ * @param copia Nós criados pela operação
+ * @return A cópia, ainda não publicada
+ */
+No* copiarNo(const No *no, CopiaCaminho *copia) {
+    No *novo = persistente.reserva;
+    persistente.reserva = novo->esquerdo;
+    persistente.reservados--;
+
+    if (no) *novo = *no;
+    copia->frescos[copia->quantidade++] = novo;
+    return novo;
+}
+
+/**
+ * Aposenta um nó da versão publicada. Se não houver memória para registrá-lo,
+ * o nó só volta ao pool na destruição do pool.
+ */
+void aposentar(No *no) {
+    if (persistente.quantidade == persistente.capacidade) {
+        const size_t capacidade = persistente.capacidade ? persistente.capacidade * 2 : 256;
+        Aposentado *novo = realloc(persistente.aposentados, capacidade * sizeof(Aposentado));
+        if (novo == NULL) return;
+
+        persistente.aposentados = novo;
+        persistente.capacidade = capacidade;
+    }
+
+    persistente.aposentados[persistente.quantidade].no = no;
+    persistente.aposentados[persistente.quantidade].epoca =
+        atomic_load_explicit(&persistente.epoca, memory_order_relaxed);
+    persistente.quantidade++;
+}
+
+/**
+ * Retorna uma versão alterável de um nó: o próprio nó, se foi criado pela operação
+ * atual, ou uma cópia dele (aposentando o original).
+ */
+No* mutavel(No *no, CopiaCaminho *copia) {
+    for (int i = copia->quantidade - 1; i >= 0; i--) {
+        if (copia->frescos[i] == no) return no;
+    }
+
+    aposentar(no);
+    return copiarNo(no, copia);
+}
+
+/**
+ * Balanceia um nó recém-copiado. As rotações alteram também o filho (e, na
+ * rotação dupla, o neto) do lado mais alto, que são copiados antes se ainda
+ * pertencerem à versão publicada.
+ */
+No* balancearPersistente(No *raiz, CopiaCaminho *copia) {
+    const int fatorB = fatorBalanceamento(raiz);
+
+    if (fatorB < -1) {
+        raiz->direito = mutavel(raiz->direito, copia);
+        if (fatorBalanceamento(raiz->direito) > 0) {
+            raiz->direito->esquerdo = mutavel(raiz->direito->esquerdo, copia);
+        }
+    } else if (fatorB > 1) {
+        raiz->esquerdo = mutavel(raiz->esquerdo, copia);
+        if (fatorBalanceamento(raiz->esquerdo) < 0) {
+            raiz->esquerdo->direito = mutavel(raiz->esquerdo->direito, copia);
+        }
+    }
+
+    return balancear(raiz);
+}
+
+/**
+ * Insere um valor copiando o caminho da raiz até a nova folha.
+ * @param raiz Raiz da versão atual (não é alterada)
+ * @param num Valor a ser inserido
+ * @param status Recebe STATUS_OK ou STATUS_DUPLICADA
+ * @param copia Nós criados pela operação
+ * @return Raiz da nova versão (a própria raiz se nada mudou)
+ */
+No* insercaoCopiando(No *raiz, int num, Status *status, CopiaCaminho *copia) {
+    if (raiz == NULL) {
+        No *novo = copiarNo(NULL, copia);
+        novo->valor = num;
+        novo->esquerdo = NULL;
+        novo->direito = NULL;
+#if MULTICONJUNTO
+        novo->contagem = 1;
+#endif
+        atualizaNo(novo);
+        *status = STATUS_OK;
+        return novo;
+    }
+
+    CONTAR(comparacoes);
+    if (num == raiz->valor) {
+#if MULTICONJUNTO
+        // A contagem de um nó publicado não muda: a cópia recebe a nova contagem
+        aposentar(raiz);
+        raiz = copiarNo(raiz, copia);
+        raiz->contagem++;
+        atualizaNo(raiz);
+        *status = STATUS_OK;
+#else
+        *status = STATUS_DUPLICADA;
+#endif
+        return raiz;
+    }
+
+    No *filho = insercaoCopiando(num < raiz->valor ? raiz->esquerdo : raiz->direito, num, status, copia);
+    if (*status != STATUS_OK) return raiz;
+
+    aposentar(raiz);
+    raiz = copiarNo(raiz, copia);
+    if (num < raiz->valor) {
+        raiz->esquerdo = filho;
+    } else {
+        raiz->direito = filho;
+    }
+
+    atualizaNo(raiz);
+    return balancearPersistente(raiz, copia);
+}
+
+/**
+ * Retira o nó com o maior valor de uma subárvore, copiando o caminho até ele.
+ * O nó retirado é aposentado, mas continua legível até ser recolhido.
+ * @param raiz Raiz da subárvore (não pode ser NULL)
+ * @param copia Nós criados pela operação
+ * @return Raiz da nova versão da subárvore
+ */
+No* retirarMaximoCopiando(No *raiz, CopiaCaminho *copia) {
+    aposentar(raiz);
+    if (raiz->direito == NULL) return raiz->esquerdo;
+
+    No *direito = retirarMaximoCopiando(raiz->direito, copia);
+    raiz = copiarNo(raiz, copia);
+    raiz->direito = direito;
+    atualizaNo(raiz);
+    return balancearPersistente(raiz, copia);
+}
+
+/**
+ * Remove um valor copiando o caminho da raiz até o nó removido.
+ * @param raiz Raiz da versão atual (não é alterada)
+ * @param chave Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @param copia Nós criados pela operação
+ * @return Raiz da nova versão (a própria raiz se nada mudou)
+ */
+No* remocaoCopiando(No *raiz, int chave, Status *status, CopiaCaminho *copia) {
+    if (raiz == NULL) {
+        *status = STATUS_AUSENTE;
+        return NULL;
+    }
+
+    CONTAR(comparacoes);
+    if (chave != raiz->valor) {
+        No *filho = remocaoCopiando(chave < raiz->valor ? raiz->esquerdo : raiz->direito, chave, status, copia);
+        if (*status != STATUS_OK) return raiz;
+
+        aposentar(raiz);
+        raiz = copiarNo(raiz, copia);
+        if (chave < raiz->valor) {
+            raiz->esquerdo = filho;
+        } else {
+            raiz->direito = filho;
+        }
+#if MULTICONJUNTO
+    } else if (raiz->contagem > 1) {
+        // Ainda restam ocorrências: apenas a cópia do nó tem a contagem decrementada
+        aposentar(raiz);
+        raiz = copiarNo(raiz, copia);
+        raiz->contagem--;
+        *status = STATUS_OK;
+#endif
+    } else if (raiz->esquerdo != NULL && raiz->direito != NULL) {
+        // Nó com dois filhos: a cópia recebe o predecessor, removido da subárvore esquerda
+        No *aux = raiz->esquerdo;
+        while (aux->direito != NULL) {
+            aux = aux->direito;
+        }
+
+        aposentar(raiz);
+        raiz = copiarNo(raiz, copia);
+        raiz->valor = aux->valor;
+#if MULTICONJUNTO
+        raiz->contagem = aux->contagem;
+#endif
+        raiz->esquerdo = retirarMaximoCopiando(raiz->esquerdo, copia);
+        *status = STATUS_OK;
+    } else {
+        // Nó com no máximo um filho: o filho, inalterado, ocupa o seu lugar
+        *status = STATUS_OK;
+        aposentar(raiz);
+        return raiz->esquerdo ? raiz->esquerdo : raiz->direito;
+    }
+
+    atualizaNo(raiz);
+    return balancearPersistente(raiz, copia);
+}
+
+/**
+ * Devolve ao pool os nós aposentados que nenhum leitor ativo pode estar usando.
+ */
+void recolherAposentados(void) {
+    unsigned long minima = atomic_load(&persistente.epoca);
+    const int leitores = atomic_load(&persistente.quantidadeLeitores);
+
+    for (int i = 0; i < leitores && i < LEITORES_MAXIMO; i++) {
+        const unsigned long epoca = atomic_load(&persistente.leitores[i].epoca);
+        if (epoca != 0 && epoca < minima) minima = epoca;
+    }
+
+    size_t mantidos = 0;
+    for (size_t i = 0; i < persistente.quantidade; i++) {
+        if (persistente.aposentados[i].epoca < minima) {
+            poolLiberar(&poolNos, persistente.aposentados[i].no);
+        } else {
+            persistente.aposentados[mantidos++] = persistente.aposentados[i];
+        }
+    }
+    persistente.quantidade = mantidos;
+}
+
+/**
+ * Executa uma escrita no modo persistente: copia o caminho, publica a nova raiz,
+ * avança a época e recolhe o que os leitores já abandonaram.
+ * @param valor Valor a ser inserido ou removido
+ * @param inserir 1 para inserção, 0 para remoção
+ * @return Resultado da operação
+ */
+Status escreverPersistente(const int valor, const int inserir) {
+    pthread_mutex_lock(&persistente.escrita);
+
+    No *raiz = atomic_load_explicit(&persistente.raiz, memory_order_relaxed);
+    if (!reservarCopias(3 * (alturaNo(raiz) + 2))) {
+        pthread_mutex_unlock(&persistente.escrita);
+        return STATUS_SEM_MEMORIA;
+    }
+
+    Status status;
+    CopiaCaminho copia;
+    copia.quantidade = 0;
+    No *nova = inserir ? insercaoCopiando(raiz, valor, &status, &copia)
+                       : remocaoCopiando(raiz, valor, &status, &copia);
+
+    if (status == STATUS_OK) {
+        atomic_store(&persistente.raiz, nova);
+        atomic_fetch_add(&persistente.epoca, 1);
+        recolherAposentados();
+    }
+
+    pthread_mutex_unlock(&persistente.escrita);
+    return status;
+}
+
+/**
+ * Insere um valor no modo persistente (um escritor por vez).
+ */
+Status inserirPersistente(const int valor) {
+    return escreverPersistente(valor, 1);
+}
+
+/**
+ * Remove um valor no modo persistente (um escritor por vez).
+ */
+Status removerPersistente(const int valor) {
+    return escreverPersistente(valor, 0);
+}
+
+/**
+ * Registra um leitor, que deve ser usado por uma única thread.
+ * @return Identificador do leitor ou -1 se o limite foi atingido
+ */
+int registrarLeitor(void) {
+    const int leitor = atomic_fetch_add(&persistente.quantidadeLeitores, 1);
+    return leitor < LEITORES_MAXIMO ? leitor : -1;
+}
+
+/**
+ * Começa uma leitura: anuncia a época e carrega a versão publicada, que permanece
+ * válida e imutável até encerrarLeitura.
+ */
+const No* iniciarLeitura(const int leitor) {
+    atomic_store(&persistente.leitores[leitor].epoca, atomic_load(&persistente.epoca));
+    return atomic_load(&persistente.raiz);
+}
+
+/**
+ * Encerra uma leitura, liberando os nós da versão lida para a recuperação.
+ */
+void encerrarLeitura(const int leitor) {
+    atomic_store_explicit(&persistente.leitores[leitor].epoca, 0, memory_order_release);
+}
+
+/**
+ * Pesquisa um valor na versão publicada, sem travas.
+ * @param leitor Identificador retornado por registrarLeitor
+ * @param valor Valor a ser pesquisado
+ * @return 1 se o valor existir na versão lida, 0 caso contrário
+ */
+int pesquisaPersistente(const int leitor, const int valor) {
+    const No *no = iniciarLeitura(leitor);
+
+    while (no != NULL && no->valor != valor) {
+        no = valor < no->valor ? no->esquerdo : no->direito;
+    }
+
+    encerrarLeitura(leitor);
+    return no != NULL;
+}
+
+/**
+ * Descarta o modo persistente. Os nós pertencem ao pool e são liberados por
+ * poolDestruir; não pode haver leitores ativos.
+ */
+void destruirPersistente(void) {
+    free(persistente.aposentados);
+    persistente.aposentados = NULL;
+    persistente.quantidade = persistente.capacidade = 0;
+    persistente.reserva = NULL;
+    persistente.reservados = 0;
+    atomic_store(&persistente.raiz, NULL);
+    atomic_store(&persistente.quantidadeLeitores, 0);
+}
+
+/* ============================================================
+   FUNÇÕES DE PESQUISA
+   ============================================================ */
+
+/**
+ * Busca um nó com valor correspondente na árvore
+ * Cada nó visitado é informado ao rastreador (quando houver um), e a quantidade
+ * de nós visitados é registrada no histograma de profundidades.
+ * @param raiz Nó inicial da busca
+ * @param valor Valor que será buscado na árvore
+ * @return O nó com o valor correspondente ou NULL, caso ele não esteja presente na árvore
+ */
+No* pesquisaNo(No *raiz, const int valor) {
+    int profundidade = 0;
+
+    while (raiz != NULL) {
+        RASTREAR(EVENTO_VISITA, raiz->valor);
+        CONTAR(comparacoes);
+        profundidade++;
+
+        // Valor encontrado
+        if (raiz->valor == valor) break;
+
+        // Continua a pesquisa para a direita ou esquerda, dependendo do valor do nó
+        raiz = valor < raiz->valor ? raiz->esquerdo : raiz->direito;
+    }
+
+    CONTAR_PROFUNDIDADE(profundidade);
+    return raiz;
+}
+
+#if ESTATISTICA_ORDEM
+/* ============================================================
+   ESTATÍSTICAS DE ORDEM
+   ============================================================ */
+
+/**
+ * Conta os valores da árvore menores que um limite (ou menores ou iguais a ele),
+ * descendo um único caminho da raiz até uma folha.
+ * @param raiz Raiz da árvore
+ * @param limite Valor de referência
+ * @param incluirIgual Indica se os valores iguais ao limite também são contados
+ */
+int contarAte(const No *raiz, const int limite, const int incluirIgual) {
+    int total = 0;
+
+    while (raiz != NULL) {
+        if (limite < raiz->valor || (limite == raiz->valor && !incluirIgual)) {
+            raiz = raiz->esquerdo;
+        } else {
+            // O nó e toda a sua subárvore esquerda estão dentro do limite
+            total += tamanhoNo(raiz->esquerdo) + ocorrencias(raiz);
+            raiz = raiz->direito;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Calcula a posição (rank) de um valor: a quantidade de valores menores que ele.
+ * @param raiz Raiz da árvore
+ * @param valor Valor de referência, que não precisa estar presente na árvore
+ * @return Quantidade de valores da árvore menores que valor
+ */
+int posicao(const No *raiz, const int valor) {
+    return contarAte(raiz, valor, 0);
+}
+
+/**
+ * Busca o k-ésimo menor valor da árvore (select).
+ * @param raiz Raiz da árvore
+ * @param k Posição do valor em ordem crescente, a partir de 1
+ * @return O nó com o k-ésimo menor valor ou NULL, caso k esteja fora do intervalo [1, n]
+ */
+No* selecionar(No *raiz, int k) {
+    while (raiz != NULL) {
+        const int esquerda = tamanhoNo(raiz->esquerdo);
+
+        if (k <= esquerda) {
+            raiz = raiz->esquerdo;
+        } else if (k <= esquerda + ocorrencias(raiz)) {
+            return raiz;
+        } else {
+            k -= esquerda + ocorrencias(raiz);
+            raiz = raiz->direito;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Conta os valores da árvore dentro do intervalo fechado [inicio, fim].
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @return Quantidade de valores no intervalo (0 se inicio > fim)
+ */
+int contarFaixa(const No *raiz, const int inicio, const int fim) {
+    if (inicio > fim) return 0;
+    return contarAte(raiz, fim, 1) - contarAte(raiz, inicio, 0);
+}
+#endif
+
+/* ============================================================
+   CURSORES E CONSULTAS POR FAIXA
+   ============================================================ */
+
+/*
+ * Uma árvore AVL com n nós tem altura menor que 1,45 * log2(n + 2), portanto
+ * 64 posições bastam para o caminho até qualquer nó, mesmo com 2^31 valores.
+ */
+#define CURSOR_PILHA 64
+
+/**
+ * Cursor para o percurso em ordem da árvore, sem alocação e sem recursão.
+ * O caminho da raiz até o nó atual fica em uma pilha de tamanho fixo, o que
+ * permite avançar e recuar a partir de qualquer posição.
+ * O cursor deixa de ser válido quando a árvore é modificada.
+ */
+typedef struct {
+    No *caminho[CURSOR_PILHA]; // caminho[0] é a raiz; caminho[profundidade - 1] é o nó atual
+    int profundidade;          // 0 quando o cursor está fora da árvore
+} Cursor;
+
+/**
+ * Retorna o nó onde o cursor está posicionado.
+ * @return Nó atual ou NULL, caso o cursor tenha saído da árvore
+ */
+No* cursorAtual(const Cursor *cursor) {
+    return cursor->profundidade ? cursor->caminho[cursor->profundidade - 1] : NULL;
+}
+
+/**
+ * Empilha um nó e todos os seus descendentes mais à esquerda (ou mais à direita).
+ */
+void cursorDescer(Cursor *cursor, No *no, const int paraEsquerda) {
+    while (no != NULL) {
+        cursor->caminho[cursor->profundidade++] = no;
+        no = paraEsquerda ? no->esquerdo : no->direito;
+    }
+}
+
+/**
+ * Posiciona o cursor no primeiro valor maior ou igual ao informado (seek).
+ * @param cursor Cursor que será posicionado
+ * @param raiz Raiz da árvore
+ * @param valor Valor de referência
+ * @return O nó onde o cursor foi posicionado ou NULL, caso todos os valores sejam menores
+ */
+No* cursorPosicionar(Cursor *cursor, No *raiz, const int valor) {
+    int candidato = 0; // profundidade do menor nó >= valor encontrado até agora
+
+    cursor->profundidade = 0;
+    while (raiz != NULL) {
+        cursor->caminho[cursor->profundidade++] = raiz;
+
+        if (valor <= raiz->valor) {
+            candidato = cursor->profundidade;
+            if (valor == raiz->valor) break;
+            raiz = raiz->esquerdo;
+        } else {
+            raiz = raiz->direito;
+        }
+    }
+
+    // O caminho até o candidato é um prefixo do caminho percorrido
+    cursor->profundidade = candidato;
+    return cursorAtual(cursor);
+}
+
+/**
+ * Posiciona o cursor no menor valor da árvore.
+ * @return O nó com o menor valor ou NULL, caso a árvore esteja vazia
+ */
+No* cursorInicio(Cursor *cursor, No *raiz) {
+    cursor->profundidade = 0;
+    cursorDescer(cursor, raiz, 1);
+    return cursorAtual(cursor);
+}
+
+/**
+ * Posiciona o cursor no maior valor da árvore.
+ * @return O nó com o maior valor ou NULL, caso a árvore esteja vazia
+ */
+No* cursorFim(Cursor *cursor, No *raiz) {
+    cursor->profundidade = 0;
+    cursorDescer(cursor, raiz, 0);
+    return cursorAtual(cursor);
+}
+
+/**
+ * Avança o cursor para o próximo valor em ordem crescente.
+ * @return O novo nó atual ou NULL, caso o cursor tenha passado do maior valor
+ */
+No* cursorProximo(Cursor *cursor) {
+    const No *atual = cursorAtual(cursor);
+    if (atual == NULL) return NULL;
+
+    // O sucessor é o menor valor da subárvore direita, quando ela existe
+    if (atual->direito != NULL) {
+        cursorDescer(cursor, atual->direito, 1);
+        return cursorAtual(cursor);
+    }
+
+    // Senão, é o primeiro ancestral do qual o nó atual está à esquerda
+    No *filho;
+    do {
+        filho = cursor->caminho[--cursor->profundidade];
+    } while (cursor->profundidade > 0 && cursor->caminho[cursor->profundidade - 1]->direito == filho);
+
+    return cursorAtual(cursor);
+}
+
+/**
+ * Recua o cursor para o valor anterior em ordem crescente.
+ * @return O novo nó atual ou NULL, caso o cursor tenha passado do menor valor
+ */
+No* cursorAnterior(Cursor *cursor) {
+    const No *atual = cursorAtual(cursor);
+    if (atual == NULL) return NULL;
+
+    // O predecessor é o maior valor da subárvore esquerda, quando ela existe
+    if (atual->esquerdo != NULL) {
+        cursorDescer(cursor, atual->esquerdo, 0);
+        return cursorAtual(cursor);
+    }
+
+    // Senão, é o primeiro ancestral do qual o nó atual está à direita
+    No *filho;
+    do {
+        filho = cursor->caminho[--cursor->profundidade];
+    } while (cursor->profundidade > 0 && cursor->caminho[cursor->profundidade - 1]->esquerdo == filho);
+
+    return cursorAtual(cursor);
+}
+
+/**
+ * Busca o maior valor menor ou igual ao informado (floor).
+ * @return O nó encontrado ou NULL, caso todos os valores sejam maiores
+ */
+No* piso(No *raiz, const int valor) {
+    No *candidato = NULL;
+
+    while (raiz != NULL) {
+        if (raiz->valor == valor) return raiz;
+
+        if (raiz->valor < valor) {
+            candidato = raiz;
+            raiz = raiz->direito;
+        } else {
+            raiz = raiz->esquerdo;
+        }
+    }
+
+    return candidato;
+}
+
+/**
+ * Busca o menor valor maior ou igual ao informado (ceiling).
+ * @return O nó encontrado ou NULL, caso todos os valores sejam menores
+ */
+No* teto(No *raiz, const int valor) {
+    No *candidato = NULL;
+
+    while (raiz != NULL) {
+        if (raiz->valor == valor) return raiz;
+
+        if (raiz->valor > valor) {
+            candidato = raiz;
+            raiz = raiz->esquerdo;
+        } else {
+            raiz = raiz->direito;
+        }
+    }
+
+    return candidato;
+}
+
+/**
+ * Função chamada para cada valor de uma consulta por faixa.
+ * @param valor Valor visitado
+ * @param contexto Ponteiro repassado sem alteração pela consulta
+ * @return 0 para continuar a consulta ou qualquer outro valor para interrompê-la
+ */
+typedef int (*Visitante)(int valor, void *contexto);
+
+/**
+ * Visita, em ordem crescente, todos os valores do intervalo fechado [inicio, fim].
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @param visitante Função chamada para cada valor
+ * @param contexto Ponteiro repassado ao visitante
+ * @return Quantidade de valores visitados
+ */
+int visitarFaixa(No *raiz, const int inicio, const int fim, Visitante visitante, void *contexto) {
+    Cursor cursor;
+    int total = 0;
+
+    for (const No *no = cursorPosicionar(&cursor, raiz, inicio); no && no->valor <= fim; no = cursorProximo(&cursor)) {
+        // No modo multiconjunto, o valor é visitado uma vez para cada ocorrência
+        for (int c = 0; c < ocorrencias(no); c++) {
+            total++;
+            if (visitante(no->valor, contexto)) return total;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Copia, em ordem crescente, os valores do intervalo fechado [inicio, fim] para um vetor.
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @param destino Vetor que receberá os valores
+ * @param capacidade Quantidade máxima de valores copiados
+ * @return Quantidade de valores copiados
+ */
+int copiarFaixa(No *raiz, const int inicio, const int fim, int *destino, const int capacidade) {
+    Cursor cursor;
+    int total = 0;
+
+    for (const No *no = cursorPosicionar(&cursor, raiz, inicio); no && no->valor <= fim && total < capacidade; no = cursorProximo(&cursor)) {
+        for (int c = 0; c < ocorrencias(no) && total < capacidade; c++) destino[total++] = no->valor;
+    }
+
+    return total;
+}
+
+/* ============================================================
+   FUNÇÃO DE PERCURSO PRÉ-ORDEM
+   ============================================================ */
+
+/**
+ * Realiza o percurso pré-ordem na árvore AVL.
+ * @param raiz Ponteiro para a raiz da árvore
+ */
+void preOrdem(No *raiz){
+    if (raiz == NULL) return;
+
+    wprintf(L"%d ", raiz->valor);
+
+    if(raiz->esquerdo != NULL){
+        preOrdem(raiz->esquerdo);
+    }
+    if(raiz->direito != NULL){
+        preOrdem(raiz->direito);
+    }
+}
+
+/* ============================================================
+   FUNÇÕES DE IMPRESSÃO
+   ============================================================ */
+
+/**
+ * Calcula o comprimento (quantidade de caracteres) de um número inteiro.
+ * É utilizado para alinhar corretamente os valores dos nós na impressão.
+ * Considera números negativos e o valor zero.
+ */
+int comprimento(int numero) {
+    const int sinal = numero < 0; // Verifica se o número é negativo
+    int contador = 0;
+
+    // Caso especial: o número zero possui comprimento 1
+    if (numero == 0) {
+        contador = 1;
+    } else {
+        // Conta quantos dígitos o número possui
+        while (numero != 0) {
+            numero = numero / 10; // Remove o último dígito
+            contador++;           // Incrementa o contador de dígitos
+        }
+    }
+
+    // Retorna o comprimento total (dígitos + possível sinal)
+    return sinal + contador;
+}
+
+/**
+ * Calcula o maior comprimento entre os valores armazenados nos nós da árvore.
+ * Esse valor é utilizado para definir o espaçamento horizontal da impressão.
+ * O comprimento só cresce com o módulo do número, então o valor mais longo
+ * é o menor ou o maior da árvore: basta descer pelas duas bordas, sem
+ * percorrer todos os nós a cada impressão.
+ * @param raiz Raiz da árvore
+ * @return Maior quantidade de caracteres entre os valores dos nós
+ */
+int maiorComprimento(const No *raiz) {
+    // Caso base: árvore vazia
+    if (raiz == NULL) {
+        return 0;
+    }
+
+    const No *menor = raiz, *maior = raiz;
+    while (menor->esquerdo) menor = menor->esquerdo;
+    while (maior->direito) maior = maior->direito;
+
+    const int comprMenor = comprimento(menor->valor);
+    const int comprMaior = comprimento(maior->valor);
+    return comprMenor > comprMaior ? comprMenor : comprMaior;
+}
+
+#define IMPRESSAO_PROFUNDIDADE 7         // níveis exibidos pela opção "Imprimir"
+#define IMPRESSAO_PROFUNDIDADE_MAXIMA 12 // limita a largura da linha a compr * 2^13
+
+/*
+ * Cada linha da impressão é montada neste buffer e escrita com uma única
+ * chamada, em vez de um wprintf por caractere.
+ */
+typedef struct {
+    wchar_t *texto;
+    size_t tamanho;
+    size_t capacidade;
+    int falhou;
+} Linha;
+
+/**
+ * Acrescenta uma string repetida ao final da linha, aumentando o buffer quando necessário.
+ * @param linha Linha em construção
+ * @param str String a ser acrescentada
+ * @param vezes Quantidade de repetições
+ */
+void acrescentar(Linha *linha, const wchar_t *str, const size_t vezes) {
+    const size_t tam = wcslen(str);
+    if (linha->falhou || vezes == 0) return;
+
+    if (linha->tamanho + tam * vezes + 1 > linha->capacidade) {
+        size_t capacidade = linha->capacidade ? linha->capacidade : 256;
+        while (linha->tamanho + tam * vezes + 1 > capacidade) capacidade *= 2;
+
+        wchar_t *texto = realloc(linha->texto, capacidade * sizeof(wchar_t));
+        if (texto == NULL) {
+            linha->falhou = 1;
+            return;
+        }
+        linha->texto = texto;
+        linha->capacidade = capacidade;
+    }
+
+    // Espaços (o caso mais comum) são preenchidos de uma só vez
+    if (tam == 1) {
+        wmemset(linha->texto + linha->tamanho, str[0], vezes);
+    } else {
+        for (size_t v = 0; v < vezes; v++) wmemcpy(linha->texto + linha->tamanho + v * tam, str, tam);
+    }
+    linha->tamanho += tam * vezes;
+}
+
+/**
+ * Centraliza uma string em um espaço total definido.
+ * Utiliza caracteres de preenchimento à esquerda e à direita.
+ * É usada para alinhar valores e símbolos na impressão da árvore.
+ *
+ * @param linha Linha em construção
+ * @param str String a ser centralizada
+ * @param tam Tamanho real da string
+ * @param total Espaço total disponível
+ * @param ajustarEsq Indica como o arredondamento do espaçamento será feito
+ * @param fillEsq Caractere de preenchimento à esquerda
+ * @param fillDir Caractere de preenchimento à direita
+ */
+void center(Linha *linha, const wchar_t *str, const int tam, const int total,
+            const int ajustarEsq, const wchar_t *fillEsq, const wchar_t *fillDir) {
+
+    // Calcula o espaço restante para preenchimento
+    const int pad = total - tam;
+
+    // Define quantos caracteres serão colocados à esquerda e à direita
+    const int padEsq = ajustarEsq ? pad / 2 : (pad + 1) / 2;
+    const int padDir = pad - padEsq;
+
+    acrescentar(linha, fillEsq, padEsq);
+    acrescentar(linha, str, 1);
+    acrescentar(linha, fillDir, padDir);
+}
+
+/**
+ * Escreve um único nó da árvore na linha, incluindo:
+ * - o valor do nó
+ * - os conectores gráficos (┌ ┐ ─)
+ * A posição do nó é calculada com base na altura da árvore.
+ *
+ * @param linha Linha em construção
+ * @param no Nó a ser impresso
+ * @param altura Altura atual da camada
+ * @param compr Largura padrão para cada nó
+ * @param ajustarEsq Indica se o alinhamento deve ser ajustado
+ */
+void imprimeNo(Linha *linha, const No *no, const int altura, const int compr, const int ajustarEsq) {
+    // Espaçamento necessário entre os nós
+    const size_t halfPad = ((size_t) 1 << (altura - 1)) - 1;
+    const size_t trecho = halfPad * compr;
+
+    // Espaços iniciais, conector e linha horizontal para o filho esquerdo
+    acrescentar(linha, L" ", trecho);
+    center(linha, no->esquerdo ? L"┌" : L" ", 1, compr, 0, L" ", no->esquerdo ? L"─" : L" ");
+    acrescentar(linha, no->esquerdo ? L"─" : L" ", trecho);
+
+    // Converte o valor do nó para string wide e o centraliza
+    wchar_t wideBuffer[32];
+    swprintf(wideBuffer, sizeof(wideBuffer) / sizeof(wchar_t), L"%d", no->valor);
+    center(linha, wideBuffer, comprimento(no->valor), compr, ajustarEsq,
+           no->esquerdo ? L"─" : L" ",
+           no->direito ? L"─" : L" ");
+
+    // Linha horizontal, conector para o filho direito e espaços finais
+    acrescentar(linha, no->direito ? L"─" : L" ", trecho);
+    center(linha, no->direito ? L"┐" : L" ", 1, compr, 1, no->direito ? L"─" : L" ", L" ");
+    acrescentar(linha, L" ", trecho);
+
+    // Espaçamento entre os nós
+    acrescentar(linha, L" ", compr);
+}
+
+/**
+ * Escreve na linha os nós que estão a uma dada profundidade abaixo de no.
+ * Uma subárvore vazia vira um único trecho de espaços, do tamanho de todas
+ * as posições que ocuparia na camada, sem que suas posições sejam visitadas.
+ *
+ * @param linha Linha em construção
+ * @param no Raiz da subárvore
+ * @param profundidade Distância entre no e a camada impressa
+ * @param altura Altura da camada impressa
+ * @param compr Largura padrão dos nós
+ * @param ajustarEsq Indica se no é um filho direito
+ */
+void imprimeCamada(Linha *linha, const No *no, const int profundidade,
+                   const int altura, const int compr, const int ajustarEsq) {
+    if (no == NULL) {
+        // Cada posição da camada ocupa compr * 2^(altura + 1) caracteres
+        acrescentar(linha, L" ", ((size_t) compr << (altura + 1)) << profundidade);
+        return;
+    }
+
+    if (profundidade == 0) {
+        imprimeNo(linha, no, altura, compr, ajustarEsq);
+        return;
+    }
+
+    imprimeCamada(linha, no->esquerdo, profundidade - 1, altura, compr, 0);
+    imprimeCamada(linha, no->direito, profundidade - 1, altura, compr, 1);
+}
+
+/**
+ * Imprime graficamente uma subárvore, nível por nível, até uma profundidade
+ * máxima. Nós da última camada com filhos mantêm os conectores, indicando
+ * que há níveis omitidos abaixo deles.
+ *
+ * @param raiz Raiz da subárvore
+ * @param profundidade Quantidade máxima de níveis impressos
+ */
+void imprimeSubarvore(const No *raiz, int profundidade) {
+    // Altura total da subárvore
+    int altura = alturaNo(raiz) + 1;
+
+    // Caso a árvore esteja vazia
+    if (altura <= 0) {
+        wprintf(L"A árvore está vazia.\n");
+        return;
+    }
+
+    if (profundidade > IMPRESSAO_PROFUNDIDADE_MAXIMA) profundidade = IMPRESSAO_PROFUNDIDADE_MAXIMA;
+    if (profundidade < 1) profundidade = 1;
+    const int omitidos = altura > profundidade ? altura - profundidade : 0;
+    altura -= omitidos;
+
+    // Determina a largura necessária para impressão
+    const int compr = maiorComprimento(raiz);
+
+    Linha linha = {0};
+
+    // Imprime cada nível da árvore
+    for (int a = altura; a > 0 && !linha.falhou; a--) {
+        linha.tamanho = 0;
+        imprimeCamada(&linha, raiz, altura - a, a, compr, 0);
+        if (linha.falhou) break;
+
+        // Espaços no fim da linha não aparecem e não precisam ser escritos
+        while (linha.tamanho > 0 && linha.texto[linha.tamanho - 1] == L' ') linha.tamanho--;
+        linha.texto[linha.tamanho] = L'\0';
+        wprintf(L"%ls\n", linha.texto);
+    }
+
+    if (linha.falhou) {
+        wprintf(L"\nERRO ao alocar memória");
+    } else if (omitidos > 0) {
+        wprintf(L"(%d níveis abaixo não foram impressos)\n", omitidos);
+    }
+
+    free(linha.texto);
+}
+
+/**
+ * Imprime graficamente a árvore inteira, limitada a IMPRESSAO_PROFUNDIDADE níveis.
+ * Utiliza caracteres Unicode para representar a estrutura.
+ *
+ * @param raiz Raiz da árvore
+ */
+void imprimeArvore(No* raiz) {
+    imprimeSubarvore(raiz, IMPRESSAO_PROFUNDIDADE);
+}
+
+/* ============================================================
+   ARMAZENAMENTO COMPACTO (ÍNDICES DE 32 BITS)
+   ============================================================ */
+
+/*
+ * Modo alternativo de armazenamento: todos os nós ficam em um único vetor
+ * contíguo e os filhos são índices de 32 bits nesse vetor, sendo 0 (NULO) a
+ * ausência de filho. A altura do nó (6 bits) é guardada nos 3 bits mais altos
+ * de cada índice, de modo que cada nó ocupa 12 bytes, em vez dos 24 bytes de No.
+ */
+typedef struct {
+    int valor;
+    uint32_t esquerdo; // 3 bits mais altos: parte alta da altura
+    uint32_t direito;  // 3 bits mais altos: parte baixa da altura
+} NoCompacto;
+
+#define NULO 0u
+#define INDICE_BITS 29
+#define INDICE_MASCARA ((1u << INDICE_BITS) - 1)
+
+/**
+ * Vetor que armazena os nós compactos. A posição 0 é reservada para NULO e as
+ * posições devolvidas formam uma lista de livres, encadeada pelo filho esquerdo.
+ */
+typedef struct {
+    NoCompacto *nos;
+    uint32_t quantidade; // posições já utilizadas
+    uint32_t capacidade; // posições alocadas
+    uint32_t livres;     // primeira posição da lista de livres
+} VetorCompacto;
+
+static VetorCompacto compacto = {NULL, 0, 0, NULO};
+
+#define NC(i) (compacto.nos[(i)])
+
+uint32_t esquerdoC(const uint32_t i) {
+    return NC(i).esquerdo & INDICE_MASCARA;
+}
+
+uint32_t direitoC(const uint32_t i) {
+    return NC(i).direito & INDICE_MASCARA;
+}
+
+void defineEsquerdoC(const uint32_t i, const uint32_t filho) {
+    NC(i).esquerdo = (NC(i).esquerdo & ~INDICE_MASCARA) | filho;
+}
+
+void defineDireitoC(const uint32_t i, const uint32_t filho) {
+    NC(i).direito = (NC(i).direito & ~INDICE_MASCARA) | filho;
+}
+
+/**
+ * Retorna a altura de um nó compacto, ou -1 para NULO.
+ */
+int alturaC(const uint32_t i) {
+    if (i == NULO) return -1;
+    return (int) ((NC(i).esquerdo >> INDICE_BITS) << 3 | NC(i).direito >> INDICE_BITS);
+}
+
+/**
+ * Recalcula a altura de um nó compacto a partir das alturas dos filhos.
+ */
+void atualizaAlturaC(const uint32_t i) {
+    const uint32_t altura = (uint32_t) (maior(alturaC(esquerdoC(i)), alturaC(direitoC(i))) + 1);
+    NC(i).esquerdo = (NC(i).esquerdo & INDICE_MASCARA) | (altura >> 3) << INDICE_BITS;
+    NC(i).direito = (NC(i).direito & INDICE_MASCARA) | (altura & 7u) << INDICE_BITS;
+}
+
+/**
+ * Cria um novo nó compacto, reaproveitando uma posição livre ou ampliando o vetor.
+ * @param valor Valor a ser armazenado no nó
+ * @return Índice do novo nó ou NULO, caso não haja memória ou o limite de índices seja atingido
+ */
+uint32_t novoNoC(const int valor) {
+    uint32_t i;
+
+    if (compacto.livres != NULO) {
+        i = compacto.livres;
+        compacto.livres = esquerdoC(i);
+    } else {
+        if (compacto.quantidade == compacto.capacidade) {
+            if (compacto.capacidade > INDICE_MASCARA) return NULO;
+
+            uint32_t capacidade = compacto.capacidade ? compacto.capacidade * 2 : POOL_BLOCO_INICIAL;
+            if (capacidade > INDICE_MASCARA + 1u) capacidade = INDICE_MASCARA + 1u;
+
+            NoCompacto *nos = realloc(compacto.nos, sizeof(NoCompacto) * capacidade);
+            if (nos == NULL) return NULO;
+
+            compacto.nos = nos;
+            compacto.capacidade = capacidade;
+            if (compacto.quantidade == 0) compacto.quantidade = 1; // posição 0 reservada para NULO
+        }
+        i = compacto.quantidade++;
+    }
+
+    NC(i).valor = valor;
+    NC(i).esquerdo = NULO; // altura 0
+    NC(i).direito = NULO;
+
+    return i;
+}
+
+/**
+ * Devolve a posição de um nó compacto para a lista de livres.
+ */
+void liberarNoC(const uint32_t i) {
+    NC(i).esquerdo = compacto.livres;
+    compacto.livres = i;
+}
+
+/**
+ * Libera o vetor de nós compactos de uma só vez.
+ */
+void destruirCompacto(void) {
+    free(compacto.nos);
+    compacto.nos = NULL;
+    compacto.quantidade = 0;
+    compacto.capacidade = 0;
+    compacto.livres = NULO;
+}
+
+/**
+ * Rotação simples à esquerda sobre nós compactos.
+ */
+uint32_t rotacaoEsqC(const uint32_t raiz) {
+    const uint32_t u = direitoC(raiz);
+    const uint32_t v = esquerdoC(u);
+
+    defineEsquerdoC(u, raiz);
+    defineDireitoC(raiz, v);
+
+    atualizaAlturaC(raiz);
+    atualizaAlturaC(u);
+
+    return u;
+}
+
+/**
+ * Rotação simples à direita sobre nós compactos.
+ */
+uint32_t rotacaoDirC(const uint32_t raiz) {
+    const uint32_t u = esquerdoC(raiz);
+    const uint32_t v = direitoC(u);
+
+    defineDireitoC(u, raiz);
+    defineEsquerdoC(raiz, v);
+
+    atualizaAlturaC(raiz);
+    atualizaAlturaC(u);
+
+    return u;
+}
+
+/**
+ * Fator de balanceamento de um nó compacto.
+ */
+int fatorBalanceamentoC(const uint32_t i) {
+    return i == NULO ? 0 : alturaC(esquerdoC(i)) - alturaC(direitoC(i));
+}
+
+/**
+ * Verifica o fator de balanceamento de um nó compacto e aplica a rotação adequada.
+ */
+uint32_t balancearC(uint32_t raiz) {
+    const int fatorB = fatorBalanceamentoC(raiz);
+    CONTAR(balanceamentos);
+
+    // Caso Direita-Direita
+    if (fatorB < -1 && fatorBalanceamentoC(direitoC(raiz)) <= 0) {
+        CONTAR(rotacoesDD);
+        raiz = rotacaoEsqC(raiz);
+    }
+    // Caso Esquerda-Esquerda
+    else if (fatorB > 1 && fatorBalanceamentoC(esquerdoC(raiz)) >= 0) {
+        CONTAR(rotacoesEE);
+        raiz = rotacaoDirC(raiz);
+    }
+    // Caso Esquerda-Direita
+    else if (fatorB > 1) {
+        CONTAR(rotacoesED);
+        defineEsquerdoC(raiz, rotacaoEsqC(esquerdoC(raiz)));
+        raiz = rotacaoDirC(raiz);
+    }
+    // Caso Direita-Esquerda
+    else if (fatorB < -1) {
+        CONTAR(rotacoesDE);
+        defineDireitoC(raiz, rotacaoDirC(direitoC(raiz)));
+        raiz = rotacaoEsqC(raiz);
+    }
+
+    return raiz;
+}
+
+/**
+ * Insere um valor na árvore AVL compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param num Valor a ser inserido
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA
+ * @return Índice da nova raiz da árvore
+ */
+uint32_t insercaoC(uint32_t raiz, const int num, Status *status) {
+    if (raiz == NULO) {
+        const uint32_t novo = novoNoC(num);
+        *status = novo != NULO ? STATUS_OK : STATUS_SEM_MEMORIA;
+        return novo;
+    }
+
+    // O vetor pode ser realocado durante a recursão, por isso os nós são sempre acessados pelo índice
+    CONTAR(comparacoes);
+    if (num < NC(raiz).valor) {
+        defineEsquerdoC(raiz, insercaoC(esquerdoC(raiz), num, status));
+    } else if (num > NC(raiz).valor) {
+        defineDireitoC(raiz, insercaoC(direitoC(raiz), num, status));
+    } else {
+        *status = STATUS_DUPLICADA;
+        return raiz;
+    }
+
+    atualizaAlturaC(raiz);
+    return balancearC(raiz);
+}
+
+/**
+ * Remove um valor da árvore AVL compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param chave Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Índice da nova raiz da árvore
+ */
+uint32_t removerC(uint32_t raiz, const int chave, Status *status) {
+    if (raiz == NULO) {
+        *status = STATUS_AUSENTE;
+        return NULO;
+    }
+
+    CONTAR(comparacoes);
+    if (chave < NC(raiz).valor) {
+        defineEsquerdoC(raiz, removerC(esquerdoC(raiz), chave, status));
+    } else if (chave > NC(raiz).valor) {
+        defineDireitoC(raiz, removerC(direitoC(raiz), chave, status));
+    } else {
+        *status = STATUS_OK;
+
+        if (esquerdoC(raiz) != NULO && direitoC(raiz) != NULO) {
+            // Nó com dois filhos: troca pelo predecessor
+            uint32_t aux = esquerdoC(raiz);
+            while (direitoC(aux) != NULO) {
+                aux = direitoC(aux);
+            }
+            NC(raiz).valor = NC(aux).valor;
+            defineEsquerdoC(raiz, removerC(esquerdoC(raiz), NC(aux).valor, status));
+        } else {
+            // Nó com no máximo um filho
+            const uint32_t filho = esquerdoC(raiz) != NULO ? esquerdoC(raiz) : direitoC(raiz);
+            liberarNoC(raiz);
+            return filho;
+        }
+    }
+
+    atualizaAlturaC(raiz);
+    return balancearC(raiz);
+}
+
+/**
+ * Busca um valor na árvore AVL compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param valor Valor que será buscado
+ * @return Índice do nó com o valor ou NULO, caso ele não esteja presente
+ */
+uint32_t pesquisaNoC(uint32_t raiz, const int valor) {
+    int profundidade = 0;
+
+    while (raiz != NULO) {
+        RASTREAR(EVENTO_VISITA, NC(raiz).valor);
+        CONTAR(comparacoes);
+        profundidade++;
+
+        if (NC(raiz).valor == valor) break;
+
+        raiz = valor < NC(raiz).valor ? esquerdoC(raiz) : direitoC(raiz);
+    }
+
+    CONTAR_PROFUNDIDADE(profundidade);
+    return raiz;
+}
+
+/* ============================================================
+   INSTANTÂNEO CONGELADO (LAYOUT DE EYTZINGER)
+   ============================================================ */
+
+/*
+ * Cópia somente leitura da árvore, com as chaves dispostas em um vetor na ordem
+ * de uma busca em largura (layout de Eytzinger): os filhos da posição k ficam
+ * nas posições 2k e 2k + 1. A pesquisa não depende de desvios imprevisíveis e
+ * os próximos níveis podem ser antecipados para a cache.
+ * O instantâneo não acompanha as alterações da árvore: deve ser reconstruído
+ * (congelado novamente) após inserções e remoções.
+ */
+typedef struct {
+    int *chaves; // chaves a partir da posição 1
+    int n;       // quantidade de chaves
+} Congelada;
+
+static Congelada congelada = {NULL, 0};
+
+#ifdef __GNUC__
+#define ANTECIPAR(endereco) __builtin_prefetch(endereco)
+#else
+#define ANTECIPAR(endereco) ((void) 0)
+#endif
+
+/**
+ * Conta os bits 0 menos significativos de um número diferente de zero.
+ */
+int contarZerosFinais(size_t x) {
+#ifdef __GNUC__
+    return __builtin_ctzll((unsigned long long) x);
+#else
+    int zeros = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+/**
+ * Conta a quantidade de nós de uma árvore.
+ */
+int contarNos(const No *raiz) {
+    return raiz ? 1 + contarNos(raiz->esquerdo) + contarNos(raiz->direito) : 0;
+}
+
+/**
+ * Copia as chaves da árvore, em ordem crescente, para um vetor.
+ * @param raiz Raiz da árvore
+ * @param destino Vetor de destino
+ * @param i Próxima posição livre do vetor
+ */
+void coletarEmOrdem(const No *raiz, int *destino, int *i) {
+    if (raiz == NULL) return;
+
+    coletarEmOrdem(raiz->esquerdo, destino, i);
+    destino[(*i)++] = raiz->valor;
+    coletarEmOrdem(raiz->direito, destino, i);
+}
+
+/**
+ * Conta a quantidade de nós de uma árvore compacta.
+ */
+int contarNosC(const uint32_t raiz) {
+    return raiz != NULO ? 1 + contarNosC(esquerdoC(raiz)) + contarNosC(direitoC(raiz)) : 0;
+}
+
+/**
+ * Copia as chaves da árvore compacta, em ordem crescente, para um vetor.
+ */
+void coletarEmOrdemC(const uint32_t raiz, int *destino, int *i) {
+    if (raiz == NULO) return;
+
+    coletarEmOrdemC(esquerdoC(raiz), destino, i);
+    destino[(*i)++] = NC(raiz).valor;
+    coletarEmOrdemC(direitoC(raiz), destino, i);
+}
+
+/**
+ * Distribui as chaves ordenadas nas posições do layout de Eytzinger, percorrendo
+ * as posições em ordem simétrica (em ordem).
+ * @param ordenadas Chaves em ordem crescente
+ * @param i Próxima chave ordenada a ser distribuída
+ * @param k Posição atual do layout
+ */
+void distribuirEytzinger(const int *ordenadas, int *i, const size_t k) {
+    if (k > (size_t) congelada.n) return;
+
+    distribuirEytzinger(ordenadas, i, 2 * k);
+    congelada.chaves[k] = ordenadas[(*i)++];
+    distribuirEytzinger(ordenadas, i, 2 * k + 1);
+}
+
+/**
+ * Monta o instantâneo congelado a partir das chaves em ordem crescente,
+ * descartando o instantâneo anterior.
+ * @param ordenadas Chaves em ordem crescente
+ * @param n Quantidade de chaves
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelarOrdenadas(const int *ordenadas, const int n) {
+    free(congelada.chaves);
+    congelada.n = 0;
+
+    congelada.chaves = malloc(sizeof(int) * ((size_t) n + 1));
+    if (congelada.chaves == NULL) return STATUS_SEM_MEMORIA;
+
+    congelada.n = n;
+    int i = 0;
+    distribuirEytzinger(ordenadas, &i, 1);
+
+    return STATUS_OK;
+}
+
+/**
+ * Congela a árvore, (re)construindo o instantâneo a partir do seu estado atual.
+ * @param raiz Raiz da árvore
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelar(const No *raiz) {
+    const int n = contarNos(raiz);
+    int *ordenadas = malloc(sizeof(int) * ((size_t) n + 1));
+    if (ordenadas == NULL) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarEmOrdem(raiz, ordenadas, &i);
+
+    const Status status = congelarOrdenadas(ordenadas, n);
+    free(ordenadas);
+
+    return status;
+}
+
+/**
+ * Congela a árvore compacta, (re)construindo o instantâneo a partir do seu estado atual.
+ * @param raiz Índice da raiz da árvore compacta
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelarC(const uint32_t raiz) {
+    const int n = contarNosC(raiz);
+    int *ordenadas = malloc(sizeof(int) * ((size_t) n + 1));
+    if (ordenadas == NULL) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarEmOrdemC(raiz, ordenadas, &i);
+
+    const Status status = congelarOrdenadas(ordenadas, n);
+    free(ordenadas);
+
+    return status;
+}
+
+/**
+ * Busca um valor no instantâneo congelado, sem desvios dependentes das chaves:
+ * a descida apenas acumula o resultado das comparações no índice, e a posição
+ * do menor elemento maior ou igual ao valor é recuperada ao final.
+ * @param valor Valor que será buscado
+ * @return 1 se o valor estiver presente no instantâneo, 0 caso contrário
+ */
+int pesquisaCongelada(const int valor) {
+    const int *chaves = congelada.chaves;
+    const size_t n = (size_t) congelada.n;
+    size_t k = 1;
+
+    while (k <= n) {
+        // Antecipa o bloco com os descendentes 4 níveis abaixo (16 chaves = 64 bytes)
+        ANTECIPAR(chaves + 16 * k);
+        k = 2 * k + (chaves[k] < valor);
+    }
+
+    // Remove as descidas à direita finais (bits 1 menos significativos) e a última descida à esquerda
+    k >>= contarZerosFinais(~k) + 1;
+
+    return k != 0 && chaves[k] == valor;
+}
+
+/**
+ * Libera o instantâneo congelado.
+ */
+void destruirCongelada(void) {
+    free(congelada.chaves);
+    congelada.chaves = NULL;
+    congelada.n = 0;
+}
+
+/* ============================================================
+   INSTANTÂNEO EM ARQUIVO
+   ============================================================ */
+
+/*
+ * Formato binário do instantâneo, na ordem de bytes da máquina que o gravou:
+ * - cabeçalho (CabecalhoInstantaneo)
+ * - as n chaves em ordem crescente, como inteiros de 32 bits
+ * - no modo multiconjunto, as n contagens de ocorrências, como inteiros de 32 bits
+ *   sem sinal (o tipo inclui então INSTANTANEO_MULTICONJUNTO)
+ * - um byte por chave, na mesma ordem: a altura do nó (AVL) ou a sua posição
+ *   (Rubro-Negra), que junto com a ordem das chaves determina a forma da árvore
+ * A carga mapeia o arquivo na memória e reconstrói a mesma árvore em uma única
+ * passada, sem nenhuma rotação nem comparação entre as chaves além da conferência da ordem.
+ */
+#define INSTANTANEO_VERSAO 2
+#define INSTANTANEO_ORDEM  0x01020304u // detecta arquivos gravados com outra ordem de bytes
+#define INSTANTANEO_AVL    1
+#define INSTANTANEO_RN     2
+#define INSTANTANEO_MULTICONJUNTO 0x100u // combinado ao tipo quando há contagens
+#define INSTANTANEO_PILHA  128          // maior que a altura de qualquer árvore válida
+
+typedef struct {
+    char assinatura[4]; // "ARVI"
+    uint32_t versao;
+    uint32_t tipo;      // INSTANTANEO_AVL ou INSTANTANEO_RN, talvez com INSTANTANEO_MULTICONJUNTO
+    uint32_t ordem;     // INSTANTANEO_ORDEM
+    uint64_t n;         // quantidade de chaves
+    uint64_t geracao;   // última geração do diário incluída no instantâneo (0 sem diário)
+} CabecalhoInstantaneo;
+
+/**
+ * Força a gravação em disco de tudo o que foi escrito em um arquivo.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int sincronizarArquivo(FILE *arquivo) {
+    if (fflush(arquivo) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(arquivo)) == 0;
+#else
+    return fsync(fileno(arquivo)) == 0;
+#endif
+}
+
+/**
+ * Copia as chaves da árvore, em ordem crescente, a altura e a contagem de cada nó para vetores.
+ * @param contagens Recebe as contagens no modo multiconjunto (ignorado fora dele)
+ * @param i Próxima posição livre dos vetores
+ */
+void coletarInstantaneo(const No *raiz, int32_t *chaves, uint32_t *contagens, unsigned char *alturas, int *i) {
+    if (raiz == NULL) return;
+
+    coletarInstantaneo(raiz->esquerdo, chaves, contagens, alturas, i);
+    chaves[*i] = raiz->valor;
+#if MULTICONJUNTO
+    contagens[*i] = (uint32_t) raiz->contagem;
+#else
+    (void) contagens;
+#endif
+    alturas[(*i)++] = (unsigned char) raiz->altura;
+    coletarInstantaneo(raiz->direito, chaves, contagens, alturas, i);
+}
+
+/**
+ * Tamanho de um arquivo de instantâneo com n chaves.
+ * @param contagens Se o arquivo inclui as contagens de ocorrências
+ */
+size_t tamanhoInstantaneo(const uint64_t n, const int contagens) {
+    return sizeof(CabecalhoInstantaneo) + n * (sizeof(int32_t) + 1 + (contagens ? sizeof(uint32_t) : 0));
+}
+
+/**
+ * Aloca os vetores de um instantâneo de n chaves; o de contagens só no modo multiconjunto.
+ * @return 1 em caso de sucesso, 0 caso contrário (nada fica alocado)
+ */
+int alocarInstantaneo(const int n, int32_t **chaves, uint32_t **contagens, unsigned char **alturas) {
+    *chaves = malloc(sizeof(int32_t) * ((size_t) n + 1));
+    *contagens = MULTICONJUNTO ? malloc(sizeof(uint32_t) * ((size_t) n + 1)) : NULL;
+    *alturas = malloc((size_t) n + 1);
+    if (*chaves && *alturas && (*contagens || !MULTICONJUNTO)) return 1;
+
+    free(*chaves);
+    free(*contagens);
+    free(*alturas);
+    return 0;
+}
+
+/**
+ * Grava um arquivo de instantâneo a partir das chaves em ordem e de a altura de cada nó,
+ * esperando que os dados cheguem ao disco.
+ * @param contagens Contagem de cada chave ou NULL, fora do modo multiconjunto
+ * @param geracao Última geração do diário incluída no instantâneo (0 sem diário)
+ * @param caminho Caminho do arquivo, que é substituído caso já exista
+ * @return STATUS_OK ou STATUS_INVALIDO (o arquivo não pôde ser gravado)
+ */
+Status gravarInstantaneo(const int32_t *chaves, const uint32_t *contagens, const unsigned char *alturas,
+                         const int n, const uint64_t geracao, const char *caminho) {
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return STATUS_INVALIDO;
+
+    const CabecalhoInstantaneo cabecalho = {
+        {'A', 'R', 'V', 'I'}, INSTANTANEO_VERSAO, INSTANTANEO_AVL | (contagens ? INSTANTANEO_MULTICONJUNTO : 0),
+        INSTANTANEO_ORDEM, (uint64_t) n, geracao
+    };
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+             fwrite(chaves, sizeof(int32_t), (size_t) n, arquivo) == (size_t) n &&
+             (contagens == NULL || fwrite(contagens, sizeof(uint32_t), (size_t) n, arquivo) == (size_t) n) &&
+             fwrite(alturas, 1, (size_t) n, arquivo) == (size_t) n &&
+             sincronizarArquivo(arquivo);
+    if (fclose(arquivo) != 0) ok = 0;
+
+    return ok ? STATUS_OK : STATUS_INVALIDO;
+}
+
+/**
+ * Salva a árvore em um arquivo de instantâneo.
+ * @param raiz Raiz da árvore
+ * @param caminho Caminho do arquivo, que é substituído caso já exista
+ * @return STATUS_OK, STATUS_INVALIDO (o arquivo não pôde ser gravado) ou STATUS_SEM_MEMORIA
+ */
+Status salvarInstantaneo(const No *raiz, const char *caminho) {
+    const int n = contarNos(raiz);
+    int32_t *chaves;
+    uint32_t *contagens;
+    unsigned char *alturas;
+    if (!alocarInstantaneo(n, &chaves, &contagens, &alturas)) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarInstantaneo(raiz, chaves, contagens, alturas, &i);
+    const Status status = gravarInstantaneo(chaves, contagens, alturas, n, 0, caminho);
+
+    free(chaves);
+    free(contagens);
+    free(alturas);
+    return status;
+}
+
+/**
+ * Mapeia um arquivo inteiro na memória, somente para leitura. Sem mmap (Windows),
+ * o arquivo é lido para um bloco alocado.
+ * @param caminho Caminho do arquivo
+ * @param tamanho Recebe o tamanho do arquivo em bytes
+ * @return Conteúdo do arquivo ou NULL, caso não possa ser aberto ou esteja vazio
+ */
+const unsigned char* mapearArquivo(const char *caminho, size_t *tamanho) {
+#ifdef _WIN32
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return NULL;
+
+    unsigned char *dados = NULL;
+    if (fseek(arquivo, 0, SEEK_END) == 0) {
+        const long fim = ftell(arquivo);
+        if (fim > 0 && fseek(arquivo, 0, SEEK_SET) == 0 && (dados = malloc((size_t) fim)) != NULL) {
+            *tamanho = (size_t) fim;
+            if (fread(dados, 1, *tamanho, arquivo) != *tamanho) {
+                free(dados);
+                dados = NULL;
+            }
+        }
+    }
+    fclose(arquivo);
+
+    return dados;
+#else
+    const int arquivo = open(caminho, O_RDONLY);
+    if (arquivo < 0) return NULL;
+
+    struct stat info;
+    void *dados = MAP_FAILED;
+    if (fstat(arquivo, &info) == 0 && info.st_size > 0) {
+        *tamanho = (size_t) info.st_size;
+        dados = mmap(NULL, *tamanho, PROT_READ, MAP_PRIVATE, arquivo, 0);
+    }
+    // O mapeamento continua válido depois que o arquivo é fechado
+    close(arquivo);
+
+    if (dados == MAP_FAILED) return NULL;
+
+    // As chaves e as alturas são lidas uma única vez, em sequência
+    madvise(dados, *tamanho, MADV_SEQUENTIAL);
+    return dados;
+#endif
+}
+
+/**
+ * Desfaz o mapeamento feito por mapearArquivo.
+ */
+void desmapearArquivo(const unsigned char *dados, const size_t tamanho) {
+#ifdef _WIN32
+    (void) tamanho;
+    free((void *) dados);
+#else
+    munmap((void *) dados, tamanho);
+#endif
+}
+
+/**
+ * Confere um nó cuja subárvore acabou de ser completada na reconstrução.
+ * @return 1 se a altura gravada for a altura real e o nó estiver balanceado, 0 caso contrário
+ */
+int conferirReconstruido(No *no) {
+    const int gravada = no->altura;
+    atualizaNo(no);
+    return no->altura == gravada && abs(fatorBalanceamento(no)) <= 1;
+}
+
+/**
+ * Reconstrói a árvore a partir das chaves em ordem e das alturas, em uma única
+ * passada. Como a altura de um nó é maior que a de todos os seus descendentes,
+ * a árvore é a árvore cartesiana das alturas: uma pilha guarda a borda direita
+ * da árvore já construída, e cada novo nó adota como filho esquerdo os nós da
+ * borda mais baixos que ele. Um nó é conferido quando sai da pilha, pois a sua
+ * subárvore não muda mais.
+ * @param chaves Chaves em ordem estritamente crescente
+ * @param contagens Contagem de cada chave ou NULL (uma ocorrência de cada)
+ * @param alturas Altura de cada nó, na mesma ordem
+ * @param n Quantidade de chaves
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (os dados não formam uma AVL) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore reconstruída ou NULL em caso de erro
+ */
+No* reconstruirArvore(const int32_t *chaves, const uint32_t *contagens, const unsigned char *alturas,
+                      const int n, Status *status) {
+    No *pilha[INSTANTANEO_PILHA];
+    int topo = 0;
+    *status = STATUS_OK;
+
+    for (int i = 0; i <= n; i++) {
+        // Depois da última chave, a pilha inteira é esvaziada
+        const int altura = i < n ? alturas[i] : INT_MAX;
+        No *novo = NULL;
+
+        if (i < n) {
+            if ((i > 0 && chaves[i - 1] >= chaves[i]) || (contagens && (contagens[i] == 0 || contagens[i] > INT_MAX))) {
+                *status = STATUS_INVALIDO;
+            } else if ((novo = novoNo(chaves[i])) == NULL) {
+                *status = STATUS_SEM_MEMORIA;
+            } else {
+                novo->altura = altura;
+#if MULTICONJUNTO
+                if (contagens) novo->contagem = (int) contagens[i];
+#endif
+            }
+        }
+
+        No *ultimo = NULL;
+        while (*status == STATUS_OK && topo > 0 && pilha[topo - 1]->altura < altura) {
+            ultimo = pilha[--topo];
+            if (!conferirReconstruido(ultimo)) *status = STATUS_INVALIDO;
+        }
+
+        if (*status == STATUS_OK && topo == INSTANTANEO_PILHA) *status = STATUS_INVALIDO;
+
+        if (*status != STATUS_OK) {
+            // Todos os nós já criados continuam ligados à base da pilha ou ao último retirado
+            if (novo) poolLiberar(&poolNos, novo);
+            liberarSubarvore(topo > 0 ? pilha[0] : ultimo);
+            return NULL;
+        }
+
+        if (i == n) return ultimo;
+
+        novo->esquerdo = ultimo;
+        if (topo > 0) pilha[topo - 1]->direito = novo;
+        pilha[topo++] = novo;
+    }
+
+    return NULL;
+}
+
+/**
+ * Carrega uma árvore de um arquivo de instantâneo.
+ * @param caminho Caminho do arquivo
+ * @param geracao Recebe a última geração do diário incluída no instantâneo (pode ser NULL)
+ * @param status Recebe STATUS_OK, STATUS_AUSENTE (o arquivo não pôde ser aberto),
+ *               STATUS_INVALIDO (o arquivo não é um instantâneo AVL válido) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore carregada ou NULL em caso de erro
+ */
+No* carregarInstantaneo(const char *caminho, uint64_t *geracao, Status *status) {
+    size_t tamanho;
+    const unsigned char *dados = mapearArquivo(caminho, &tamanho);
+    if (dados == NULL) {
+        *status = STATUS_AUSENTE;
+        return NULL;
+    }
+
+    CabecalhoInstantaneo cabecalho;
+    No *raiz = NULL;
+    *status = STATUS_INVALIDO;
+
+    if (tamanho >= sizeof(cabecalho)) {
+        memcpy(&cabecalho, dados, sizeof(cabecalho));
+
+        // Um multiconjunto também carrega instantâneos sem contagens, com uma ocorrência de cada chave
+        const int multiconjunto = (cabecalho.tipo & INSTANTANEO_MULTICONJUNTO) != 0;
+        if (memcmp(cabecalho.assinatura, "ARVI", 4) == 0 && cabecalho.versao == INSTANTANEO_VERSAO &&
+            (cabecalho.tipo & ~INSTANTANEO_MULTICONJUNTO) == INSTANTANEO_AVL && (MULTICONJUNTO || !multiconjunto) &&
+            cabecalho.ordem == INSTANTANEO_ORDEM && cabecalho.n <= INT_MAX &&
+            tamanho == tamanhoInstantaneo(cabecalho.n, multiconjunto)) {
+            // O cabeçalho tem 32 bytes, então as chaves e as contagens mapeadas já estão alinhadas
+            const int32_t *chaves = (const int32_t *) (dados + sizeof(cabecalho));
+            const uint32_t *contagens = multiconjunto ? (const uint32_t *) (chaves + cabecalho.n) : NULL;
+            const unsigned char *alturas = (const unsigned char *) (chaves + cabecalho.n * (multiconjunto ? 2 : 1));
+            raiz = reconstruirArvore(chaves, contagens, alturas, (int) cabecalho.n, status);
+            if (geracao) *geracao = cabecalho.geracao;
+        }
+    }
+
+    desmapearArquivo(dados, tamanho);
+    return raiz;
+}
+
+/* ============================================================
+   EXPORTAÇÃO PARA GRAPHVIZ (DOT) E JSON
+   ============================================================ */
+
+/*
+ * A árvore é escrita em pós-ordem, de modo que os identificadores dos filhos
+ * já são conhecidos quando o nó é escrito. O percurso é iterativo, com uma
+ * entrada de pilha por nível, e a saída passa por um buffer de EXPORTACAO_BUFFER bytes.
+ * Os identificadores são a posição do nó na pós-ordem; a raiz é o último nó.
+ */
+#define EXPORTACAO_PILHA  128       // maior que a altura de qualquer árvore válida
+#define EXPORTACAO_BUFFER (1 << 20)
+
+typedef enum {
+    EXPORTAR_DOT = 1, // digraph do Graphviz
+    EXPORTAR_JSON     // um objeto JSON por linha (NDJSON)
+} FormatoExportacao;
+
+typedef struct {
+    const No *no;
+    int visitado; // 0: nenhum filho visitado, 1: visitando o esquerdo, 2: visitando o direito
+    long long esquerdo, direito; // identificadores dos filhos (-1 se ausentes)
+} QuadroExportacao;
+
+/**
+ * Escreve um nó no formato escolhido.
+ * @param arquivo Arquivo de saída
+ * @param formato Formato da exportação
+ * @param quadro Nó com os identificadores dos seus filhos
+ * @param id Identificador do nó
+ * @return Valor de retorno de fprintf (negativo em caso de erro)
+ */
+int exportarNo(FILE *arquivo, const FormatoExportacao formato, const QuadroExportacao *quadro, const long long id) {
+    const No *no = quadro->no;
+
+    if (formato == EXPORTAR_JSON) {
+        char esquerdo[24] = "null", direito[24] = "null";
+        if (quadro->esquerdo >= 0) snprintf(esquerdo, sizeof(esquerdo), "%lld", quadro->esquerdo);
+        if (quadro->direito >= 0) snprintf(direito, sizeof(direito), "%lld", quadro->direito);
+#if MULTICONJUNTO
+        return fprintf(arquivo, "{\"id\":%lld,\"valor\":%d,\"contagem\":%d,\"altura\":%d,\"esquerdo\":%s,\"direito\":%s}\n",
+                       id, no->valor, no->contagem, no->altura, esquerdo, direito);
+#else
+        return fprintf(arquivo, "{\"id\":%lld,\"valor\":%d,\"altura\":%d,\"esquerdo\":%s,\"direito\":%s}\n",
+                       id, no->valor, no->altura, esquerdo, direito);
+#endif
+    }
+
+#if MULTICONJUNTO
+    int escritos = fprintf(arquivo, "  n%lld [label=\"%d (x%d)\\nh=%d\"];\n", id, no->valor, no->contagem, no->altura);
+#else
+    int escritos = fprintf(arquivo, "  n%lld [label=\"%d\\nh=%d\"];\n", id, no->valor, no->altura);
+#endif
+    if (escritos >= 0 && quadro->esquerdo >= 0) escritos = fprintf(arquivo, "  n%lld -> n%lld [label=\"e\"];\n", id, quadro->esquerdo);
+    if (escritos >= 0 && quadro->direito >= 0) escritos = fprintf(arquivo, "  n%lld -> n%lld [label=\"d\"];\n", id, quadro->direito);
+    return escritos;
+}
+
+/**
+ * Exporta a estrutura da árvore para um arquivo, como DOT ou NDJSON.
+ * @param raiz Raiz da árvore
+ * @param caminho Arquivo de saída, substituído caso já exista
+ * @param formato Formato da exportação
+ * @param bytes Recebe a quantidade de bytes escritos (pode ser NULL)
+ * @return STATUS_OK, STATUS_SEM_MEMORIA ou STATUS_INVALIDO se o arquivo não
+ *         puder ser gravado ou a árvore for mais alta que EXPORTACAO_PILHA
+ */
+Status exportarArvore(const No *raiz, const char *caminho, const FormatoExportacao formato, long long *bytes) {
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return STATUS_INVALIDO;
+
+    char *buffer = malloc(EXPORTACAO_BUFFER);
+    if (buffer == NULL) {
+        fclose(arquivo);
+        return STATUS_SEM_MEMORIA;
+    }
+    setvbuf(arquivo, buffer, _IOFBF, EXPORTACAO_BUFFER);
+
+    int ok = formato == EXPORTAR_DOT ? fprintf(arquivo, "digraph avl {\n  node [shape=box];\n") >= 0 : 1;
+
+    QuadroExportacao pilha[EXPORTACAO_PILHA];
+    int topo = 0;
+    long long proximo = 0;
+    if (raiz) pilha[topo++] = (QuadroExportacao) {raiz, 0, -1, -1};
+
+    while (topo > 0 && ok) {
+        QuadroExportacao *quadro = &pilha[topo - 1];
+        const No *filho = NULL;
+
+        // Desce primeiro pelo filho esquerdo e depois pelo direito
+        if (quadro->visitado < 2) {
+            filho = quadro->visitado == 0 ? quadro->no->esquerdo : quadro->no->direito;
+            quadro->visitado++;
+            if (filho == NULL) continue;
+            if (topo == EXPORTACAO_PILHA) {
+                ok = 0;
+                break;
+            }
+            pilha[topo++] = (QuadroExportacao) {filho, 0, -1, -1};
+            continue;
+        }
+
+        // Os dois filhos já foram escritos: escreve o nó e avisa o pai
+        const long long id = proximo++;
+        ok = exportarNo(arquivo, formato, quadro, id) >= 0;
+        topo--;
+        if (topo > 0) {
+            QuadroExportacao *pai = &pilha[topo - 1];
+            if (pai->visitado == 1) pai->esquerdo = id;
+            else pai->direito = id;
+        }
+    }
+
+    if (ok && formato == EXPORTAR_DOT) ok = fprintf(arquivo, "}\n") >= 0;
+    if (bytes) *bytes = ftell(arquivo);
+    if (fclose(arquivo) != 0) ok = 0;
+    free(buffer);
+
+    return ok ? STATUS_OK : STATUS_INVALIDO;
+}
+
+/* ============================================================
+   MODO BENCHMARK
+   ============================================================ */
+
+#define BENCH_AMOSTRAS 1048576 // máximo de latências amostradas por operação
+
+#define BENCH_INSERIR   0
+#define BENCH_PESQUISAR 1
+#define BENCH_AUSENTE   2
+#define BENCH_CONGELADA 3 // pesquisa bem-sucedida no instantâneo congelado
+#define BENCH_REMOVER   4
+
+/**
+ * Embaralha um inteiro de 32 bits (finalizador do MurmurHash3).
+ * A função é bijetora, portanto índices distintos sempre geram chaves distintas.
+ */
+unsigned int embaralhar(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Gera a i-ésima chave da sequência do benchmark.
+ * A mesma sequência é gerada em todos os programas, para que as árvores sejam comparáveis.
+ * @param i Índice da chave
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ */
+int chaveBench(const unsigned int i, const int ordenada) {
+    return ordenada ? (int) i : (int) embaralhar(i);
+}
+
+/**
+ * Retorna o instante atual em nanossegundos.
+ */
+long long agoraNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Retorna o pico de memória residente do processo, em kilobytes (0 quando indisponível).
+ */
+long picoMemoriaKb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * Compara duas latências, para a ordenação com qsort.
+ */
+int compararLatencias(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Árvore utilizada no benchmark, em um dos dois modos de armazenamento.
+ */
+typedef struct {
+    int compacta; // indica se a árvore usa o armazenamento compacto
+    No *raiz;
+    uint32_t raizC;
+} ArvoreBench;
+
+/**
+ * Aplica a operação do benchmark correspondente ao índice i.
+ * @param arvore Árvore do benchmark
+ * @param operacao Operação a ser aplicada (BENCH_*)
+ * @param chave Chave da operação
+ * @param encontrados Contador de pesquisas bem-sucedidas (evita que a pesquisa seja descartada pelo compilador)
+ */
+void aplicarBench(ArvoreBench *arvore, const int operacao, const int chave, unsigned int *encontrados) {
+    Status status;
+
+    if (arvore->compacta) {
+        switch (operacao) {
+            case BENCH_INSERIR:
+                arvore->raizC = insercaoC(arvore->raizC, chave, &status);
+                break;
+            case BENCH_REMOVER:
+                arvore->raizC = removerC(arvore->raizC, chave, &status);
+                break;
+            case BENCH_CONGELADA:
+                *encontrados += pesquisaCongelada(chave);
+                break;
+            default:
+                *encontrados += pesquisaNoC(arvore->raizC, chave) != NULO;
+        }
+    } else {
+        switch (operacao) {
+            case BENCH_INSERIR:
+                arvore->raiz = insercao(arvore->raiz, chave, &status);
+                break;
+            case BENCH_REMOVER:
+                arvore->raiz = remover(arvore->raiz, chave, &status);
+                break;
+            case BENCH_CONGELADA:
+                *encontrados += pesquisaCongelada(chave);
+                break;
+            default:
+                *encontrados += pesquisaNo(arvore->raiz, chave) != NULL;
+        }
+    }
+}
+
+/**
+ * Gera a chave da i-ésima repetição de uma operação do benchmark.
+ * As pesquisas bem-sucedidas sorteiam chaves já inseridas, e as sem sucesso usam
+ * chaves que nunca foram inseridas.
+ */
+int chaveOperacao(const int operacao, const unsigned int i, const unsigned int n, const int ordenada) {
+    switch (operacao) {
+        case BENCH_PESQUISAR:
+        case BENCH_CONGELADA:
+            return chaveBench(embaralhar(i ^ 0x9e3779b9u) % n, ordenada);
+        case BENCH_AUSENTE:
+            return chaveBench(n + i, ordenada);
+        default:
+            return chaveBench(i, ordenada);
+    }
+}
+
+/**
+ * Executa n repetições de uma operação e escreve uma linha CSV com os resultados:
+ * motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura
+ * @param arvore Árvore do benchmark
+ * @param operacao Operação a ser medida (BENCH_*)
+ * @param n Quantidade de repetições
+ * @param ordenada Tipo de carga
+ */
+void medirBench(ArvoreBench *arvore, const int operacao, const unsigned int n, const int ordenada) {
+    static long long amostras[BENCH_AMOSTRAS];
+    const char *nomes[] = {"inserir", "pesquisar", "pesquisar_ausente", "pesquisar_congelada", "remover"};
+
+    // Apenas uma a cada "passo" operações tem a latência medida individualmente
+    const unsigned int passo = n / BENCH_AMOSTRAS + 1;
+    unsigned int encontrados = 0;
+    size_t qtd = 0;
+
+    const long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) {
+        const int chave = chaveOperacao(operacao, i, n, ordenada);
+
+        if (i % passo == 0) {
+            const long long t0 = agoraNs();
+            aplicarBench(arvore, operacao, chave, &encontrados);
+            amostras[qtd++] = agoraNs() - t0;
+        } else {
+            aplicarBench(arvore, operacao, chave, &encontrados);
+        }
+    }
+    const long long total = agoraNs() - inicio;
+
+    qsort(amostras, qtd, sizeof(long long), compararLatencias);
+
+    printf("%s,%s,%s,%u,%.0f,%.2f,%lld,%lld,%lld,%ld,%d\n",
+           arvore->compacta ? "avl_compacta" : "avl",
+           ordenada ? "ordenada" : "aleatoria", nomes[operacao], n,
+           n / (total / 1e9), (double) total / n,
+           amostras[qtd / 2], amostras[qtd * 99 / 100], amostras[qtd * 999 / 1000],
+           picoMemoriaKb(), (arvore->compacta ? alturaC(arvore->raizC) : alturaNo(arvore->raiz)) + 1);
+
+    if ((operacao == BENCH_PESQUISAR || operacao == BENCH_CONGELADA) && encontrados != n) {
+        fprintf(stderr, "ERRO: %u de %u chaves foram encontradas\n", encontrados, n);
+    }
+}
+
+/**
+ * Executa o benchmark completo (inserção, pesquisa, pesquisa sem sucesso, pesquisa
+ * no instantâneo congelado e remoção) sem interação.
+ * @param n Quantidade de chaves
+ * @param ordenada Tipo de carga
+ * @param compacta Indica se deve ser usado o armazenamento compacto
+ * @return Código de saída do programa
+ */
+int executarBenchmark(const unsigned int n, const int ordenada, const int compacta) {
+    ArvoreBench arvore = {compacta, NULL, NULO};
+
+    if (n == 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    for (int operacao = BENCH_INSERIR; operacao <= BENCH_REMOVER; operacao++) {
+        // O instantâneo é congelado logo antes de ser pesquisado
+        if (operacao == BENCH_CONGELADA) {
+            const Status status = compacta ? congelarC(arvore.raizC) : congelar(arvore.raiz);
+            if (status != STATUS_OK) {
+                fprintf(stderr, "ERRO: não foi possível congelar a árvore\n");
+                return 1;
+            }
+        }
+
+        medirBench(&arvore, operacao, n, ordenada);
+    }
+
+    destruirCongelada();
+    poolDestruir(&poolNos);
+    destruirCompacto();
+    return 0;
+}
+
+/**
+ * Mede as operações de conjunto em paralelo entre duas árvores de n chaves
+ * aleatórias, das quais metade é comum às duas, escrevendo uma linha CSV por operação:
+ * motor,operacao,n,threads,ms,tamanho
+ * @param n Quantidade de chaves de cada árvore
+ * @param threads Quantidade de threads
+ * @return Código de saída do programa
+ */
+int executarConjuntos(const unsigned int n, const int threads) {
+    const char *nomes[] = {"uniao", "intersecao", "diferenca"};
+
+    if (n == 0 || threads <= 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves e de threads deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    for (int operacao = CONJUNTO_UNIAO; operacao <= CONJUNTO_DIFERENCA; operacao++) {
+        Status statusA, statusB;
+
+        // As árvores são reconstruídas a cada operação, já que são consumidas por ela
+        for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+        No *a = construirArvore(valores, (int) n, &statusA);
+        for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(n / 2 + i, 0);
+        No *b = construirArvore(valores, (int) n, &statusB);
+
+        if (statusA != STATUS_OK || statusB != STATUS_OK) {
+            fprintf(stderr, "ERRO: não foi possível construir as árvores\n");
+            free(valores);
+            poolDestruir(&poolNos);
+            return 1;
+        }
+
+        const long long inicio = agoraNs();
+        No *resultado = conjuntoParalelo((OperacaoConjunto) operacao, a, b, threads);
+        const long long total = agoraNs() - inicio;
+
+        printf("avl,%s,%u,%d,%.3f,%d\n", nomes[operacao], n, threads, total / 1e6, contarNos(resultado));
+        poolDestruir(&poolNos);
+    }
+
+    free(valores);
+    return 0;
+}
+
+#define PERSISTENTE_DURACAO_MS 1000 // duração da medição de leitura concorrente
+
+/**
+ * Estado compartilhado pelos leitores do benchmark persistente.
+ */
+typedef struct {
+    unsigned int n;
+    atomic_int parar;
+    unsigned long long leituras[LEITORES_MAXIMO];
+} CargaPersistente;
+
+/**
+ * Laço de um leitor: pesquisa chaves aleatórias (metade delas presentes) até o
+ * sinal de parada, sem nenhuma trava.
+ */
+void* leitorPersistente(void *argumento) {
+    CargaPersistente *carga = argumento;
+    const int leitor = registrarLeitor();
+    const unsigned int semente = 0x9e3779b9u * (unsigned int) (leitor + 1);
+    unsigned long long leituras = 0;
+
+    if (leitor < 0) return NULL;
+
+    while (!atomic_load_explicit(&carga->parar, memory_order_relaxed)) {
+        const unsigned int i = embaralhar((unsigned int) leituras ^ semente);
+        pesquisaPersistente(leitor, chaveBench(i % (2 * carga->n), 0));
+        leituras++;
+    }
+
+    carga->leituras[leitor] = leituras;
+    return NULL;
+}
+
+/**
+ * Mede a vazão das leituras sem travas enquanto um escritor remove e reinsere
+ * chaves aleatórias, escrevendo uma linha CSV:
+ * motor,modo,n,leitores,leituras_por_s,escritas_por_s
+ * @param n Quantidade de chaves
+ * @param leitores Quantidade de threads leitoras
+ * @return Código de saída do programa
+ */
+int executarPersistente(const unsigned int n, int leitores) {
+    static CargaPersistente carga;
+    pthread_t threads[LEITORES_MAXIMO];
+
+    if (n == 0 || leitores <= 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves e de leitores deve ser positiva\n");
+        return 1;
+    }
+    if (leitores > LEITORES_MAXIMO) leitores = LEITORES_MAXIMO;
+
+    for (unsigned int i = 0; i < n; i++) {
+        if (inserirPersistente(chaveBench(i, 0)) == STATUS_SEM_MEMORIA) {
+            fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+            return 1;
+        }
+    }
+
+    carga.n = n;
+    int criados = 0;
+    for (; criados < leitores; criados++) {
+        if (pthread_create(&threads[criados], NULL, leitorPersistente, &carga) != 0) break;
+    }
+
+    // A thread principal é o escritor
+    unsigned long long escritas = 0;
+    const long long inicio = agoraNs();
+    long long decorrido;
+    do {
+        const int chave = chaveBench(embaralhar((unsigned int) escritas ^ 0x5bd1e995u) % n, 0);
+        removerPersistente(chave);
+        inserirPersistente(chave);
+        escritas += 2;
+        decorrido = agoraNs() - inicio;
+    } while (decorrido < PERSISTENTE_DURACAO_MS * 1000000LL);
+
+    atomic_store(&carga.parar, 1);
+    unsigned long long leituras = 0;
+    for (int i = 0; i < criados; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < criados; i++) {
+        leituras += carga.leituras[i];
+    }
+
+    printf("avl,persistente,%u,%d,%.0f,%.0f\n", n, criados,
+           leituras / (decorrido / 1e9), escritas / (decorrido / 1e9));
+
+    destruirPersistente();
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+/**
+ * Compara as formas de recuperar uma árvore de n chaves aleatórias guardada em
+ * arquivo, escrevendo uma linha CSV:
+ * motor,modo,n,bytes,salvar_ms,carregar_ms,reinserir_ms
+ * A última coluna é o tempo de reconstruir a mesma árvore inserindo as chaves uma a uma.
+ * @param n Quantidade de chaves
+ * @param caminho Arquivo de instantâneo, substituído caso já exista
+ * @return Código de saída do programa
+ */
+int executarInstantaneo(const unsigned int n, const char *caminho) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    Status status;
+    for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+    No *raiz = construirArvore(valores, (int) n, &status);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível construir a árvore\n");
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+
+    long long inicio = agoraNs();
+    status = salvarInstantaneo(raiz, caminho);
+    const long long salvar = agoraNs() - inicio;
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar %s\n", caminho);
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+    poolDestruir(&poolNos);
+
+    inicio = agoraNs();
+    raiz = carregarInstantaneo(caminho, NULL, &status);
+    const long long carregar = agoraNs() - inicio;
+    if (status != STATUS_OK || contarNos(raiz) != (int) n) {
+        fprintf(stderr, "ERRO: não foi possível carregar %s\n", caminho);
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+    poolDestruir(&poolNos);
+
+    // A alternativa sem instantâneo: inserir as chaves uma a uma
+    raiz = NULL;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) raiz = insercao(raiz, valores[i], &status);
+    const long long reinserir = agoraNs() - inicio;
+
+    printf("avl,instantaneo,%u,%llu,%.3f,%.3f,%.3f\n", n,
+           (unsigned long long) tamanhoInstantaneo((uint64_t) n, MULTICONJUNTO),
+           salvar / 1e6, carregar / 1e6, reinserir / 1e6);
+
+    free(valores);
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+/**
+ * Mede a exportação de uma árvore de n chaves aleatórias, escrevendo uma linha CSV:
+ * motor,modo,n,formato,bytes,ms
+ * @param n Quantidade de chaves
+ * @param caminho Arquivo de saída, substituído caso já exista
+ * @param formato Formato da exportação
+ * @return Código de saída do programa
+ */
+int executarExportacao(const unsigned int n, const char *caminho, const FormatoExportacao formato) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    Status status;
+    for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+    No *raiz = construirArvore(valores, (int) n, &status);
+    free(valores);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível construir a árvore\n");
+        poolDestruir(&poolNos);
+        return 1;
+    }
+
+    long long bytes = 0;
+    const long long inicio = agoraNs();
+    status = exportarArvore(raiz, caminho, formato, &bytes);
+    const long long exportar = agoraNs() - inicio;
+    poolDestruir(&poolNos);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar %s\n", caminho);
+        return 1;
+    }
+
+    printf("avl,exportar,%u,%s,%lld,%.3f\n", n, formato == EXPORTAR_DOT ? "dot" : "json", bytes, exportar / 1e6);
+    return 0;
+}
+
+/*
+ * Instâncias das árvores genéricas (arvore_generica.h) medidas por --generica:
+ * a mesma chave int da árvore do programa e chaves de 64 bits.
+ */
+DEFINIR_AVL(avlInt, int, int, COMPARAR_NUMEROS)
+DEFINIR_AVL(avl64, int64_t, int64_t, COMPARAR_NUMEROS)
+
+/**
+ * Gera a i-ésima chave de 64 bits, espalhando as chaves de chaveBench além do alcance de int.
+ */
+int64_t chaveBench64(const unsigned int i) {
+    return (int64_t) chaveBench(i, 0) * 1048576;
+}
+
+/**
+ * Compara a árvore do programa com as versões genéricas, escrevendo uma linha CSV por variante:
+ * motor,modo,n,variante,inserir_ms,pesquisar_ms,remover_ms
+ * @param n Quantidade de chaves aleatórias
+ * @return Código de saída do programa
+ */
+int executarGenerica(const unsigned int n) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    Status status = STATUS_OK;
+    int falhou = 0;
+    long long encontrados = 0, inicio, inserir, pesquisar;
+
+    // Árvore do programa
+    No *raiz = NULL;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) raiz = insercao(raiz, chaveBench(i, 0), &status);
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += pesquisaNo(raiz, chaveBench(i, 0)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) raiz = remover(raiz, chaveBench(i, 0), &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("avl,generica,%u,programa,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    poolDestruir(&poolNos);
+
+    // Versão genérica com chaves int
+    avlIntArvore arvoreInt = {0};
+    encontrados = 0;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) avlIntInserir(&arvoreInt, chaveBench(i, 0), (int) i, &status);
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += avlIntPesquisar(&arvoreInt, chaveBench(i, 0)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) avlIntRemover(&arvoreInt, chaveBench(i, 0), NULL, &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("avl,generica,%u,int,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    avlIntDestruir(&arvoreInt);
+
+    // Versão genérica com chaves de 64 bits, fora do alcance de int
+    avl64Arvore arvore64 = {0};
+    encontrados = 0;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) {
+        avl64Inserir(&arvore64, chaveBench64(i), (int64_t) i, &status);
+    }
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += avl64Pesquisar(&arvore64, chaveBench64(i)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) avl64Remover(&arvore64, chaveBench64(i), NULL, &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("avl,generica,%u,int64,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    avl64Destruir(&arvore64);
+
+    if (falhou) {
+        fprintf(stderr, "ERRO: a árvore não contém todas as chaves inseridas\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================
+   MODO EM LOTE (FLUXO BINÁRIO)
+   ============================================================ */
+
+/*
+ * Formato dos registros (inteiros em little-endian):
+ * - requisição: 1 byte de operação + 4 bytes de chave
+ * - resposta:   1 byte de status + 4 bytes de valor
+ */
+#define LOTE_REGISTRO 5     // tamanho, em bytes, de uma requisição ou resposta
+#define LOTE_BUFFER   4096  // quantidade de registros lidos/escritos por chamada
+
+#define OP_INSERIR   1
+#define OP_REMOVER   2
+#define OP_PESQUISAR 3
+#define OP_CONTADORES 4 // escreve os contadores na saída de erro, em texto
+#define OP_CONGELAR   5 // (re)constrói o instantâneo congelado
+#define OP_PESQUISAR_CONGELADA 6
+#define OP_POSICAO    7 // responde a quantidade de valores menores que a chave
+#define OP_SELECIONAR 8 // a chave é a posição k; responde o k-ésimo menor valor
+
+/* O status de cada resposta é o próprio Status retornado pela operação */
+
+/**
+ * Lê um inteiro de 32 bits em little-endian.
+ */
+int lerInt32(const unsigned char *p) {
+    return (int) ((unsigned int) p[0] | (unsigned int) p[1] << 8 |
+                  (unsigned int) p[2] << 16 | (unsigned int) p[3] << 24);
+}
+
+/**
+ * Escreve um inteiro de 32 bits em little-endian.
+ */
+void escreverInt32(unsigned char *p, const int valor) {
+    const unsigned int v = (unsigned int) valor;
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+    p[2] = (unsigned char) (v >> 16);
+    p[3] = (unsigned char) (v >> 24);
+}
+
+/**
+ * Aplica uma requisição do fluxo binário na árvore.
+ * @param raiz Raiz da árvore
+ * @param requisicao Registro de requisição (operação + chave)
+ * @param resposta Registro onde a resposta (status + valor) será escrita
+ * @return Nova raiz da árvore
+ */
+No* processarRegistro(No *raiz, const unsigned char *requisicao, unsigned char *resposta) {
+    const int chave = lerInt32(requisicao + 1);
+    int valor = chave;
+    Status status = STATUS_OK;
+
+    switch (requisicao[0]) {
+        case OP_INSERIR:
+            raiz = insercao(raiz, chave, &status);
+            break;
+
+        case OP_REMOVER:
+            raiz = remover(raiz, chave, &status);
+            break;
+
+        case OP_PESQUISAR:
+            if (!pesquisaNo(raiz, chave)) status = STATUS_AUSENTE;
+            break;
+
+        case OP_CONTADORES:
+            exibirContadores(stderr);
+            break;
+
+        case OP_CONGELAR:
+            status = congelar(raiz);
+            break;
+
+        case OP_PESQUISAR_CONGELADA:
+            if (!pesquisaCongelada(chave)) status = STATUS_AUSENTE;
+            break;
+
+#if ESTATISTICA_ORDEM
+        case OP_POSICAO:
+            valor = posicao(raiz, chave);
+            break;
+
+        case OP_SELECIONAR: {
+            const No *no = selecionar(raiz, chave);
+            if (no) {
+                valor = no->valor;
+            } else {
+                status = STATUS_AUSENTE;
+            }
+            break;
+        }
+#endif
+
+        default:
+            status = STATUS_INVALIDO;
+    }
+
+    resposta[0] = (unsigned char) status;
+    escreverInt32(resposta + 1, valor);
+
+    return raiz;
+}
+
+/**
+ * Processa um fluxo binário de requisições, sem nenhuma interação com o usuário,
+ * escrevendo uma resposta para cada requisição recebida.
+ * @param entrada Fluxo de requisições
+ * @param saida Fluxo de respostas
+ * @return Código de saída do programa
+ */
+int executarLote(FILE *entrada, FILE *saida) {
+    static unsigned char requisicoes[LOTE_BUFFER * LOTE_REGISTRO];
+    static unsigned char respostas[LOTE_BUFFER * LOTE_REGISTRO];
+    No *raiz = NULL;
+    size_t lidos;
+
+    while ((lidos = fread(requisicoes, LOTE_REGISTRO, LOTE_BUFFER, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            raiz = processarRegistro(raiz, requisicoes + i * LOTE_REGISTRO, respostas + i * LOTE_REGISTRO);
+        }
+
+        if (fwrite(respostas, LOTE_REGISTRO, lidos, saida) != lidos) {
+            fprintf(stderr, "ERRO: falha ao escrever as respostas\n");
+            poolDestruir(&poolNos);
+            return 1;
+        }
+    }
+
+    fflush(saida);
+    destruirCongelada();
+    poolDestruir(&poolNos);
+    return ferror(entrada) ? 1 : 0;
+}
+
+/* ============================================================
+   DIÁRIO DE OPERAÇÕES (WRITE-AHEAD LOG)
+   ============================================================ */
+
+/*
+ * Persistência da árvore do menu em arquivos com o mesmo prefixo:
+ * - <base>.avl:       instantâneo com o estado até uma geração do diário
+ * - <base>.diario.<g>: diários, um por geração; só o de maior geração recebe operações
+ * Cada diário tem um cabeçalho com a sua geração, seguido de registros de
+ * DIARIO_REGISTRO bytes: a operação (OP_INSERIR ou OP_REMOVER), a chave em
+ * little-endian e um byte de verificação, que identifica um registro incompleto
+ * no final do arquivo depois de uma queda.
+ * A compactação troca o diário por um da geração seguinte e grava o instantâneo
+ * em segundo plano; só depois que ele está no disco os diários que ele inclui
+ * são apagados, de modo que uma queda em qualquer ponto não perde operações.
+ * Uma operação só é confirmada depois de registrada. A sincronização com o disco
+ * é feita em grupo, uma vez a cada `lote` operações, e os registros ainda não
+ * sincronizados são os únicos que podem ser perdidos. Com várias threads, a que
+ * completa o lote sincroniza os registros de todas, e as demais apenas esperam.
+ */
+#define DIARIO_REGISTRO 6
+#define DIARIO_CAMINHO  1024
+#define DIARIO_BASE     (DIARIO_CAMINHO - 32) // sobra espaço para as extensões
+
+typedef struct {
+    char assinatura[4]; // "ARVD"
+    uint32_t versao;
+    uint32_t tipo;      // INSTANTANEO_AVL ou INSTANTANEO_RN
+    uint32_t ordem;     // INSTANTANEO_ORDEM
+    uint64_t geracao;
+} CabecalhoDiario;
+
+/**
+ * Instantâneo copiado da árvore, gravado em segundo plano pela compactação.
+ */
+typedef struct {
+    int32_t *chaves;
+    uint32_t *contagens; // só no modo multiconjunto
+    unsigned char *alturas;
+    int n;
+    uint64_t geracao;
+    Status status;
+} Compactacao;
+
+typedef struct {
+    FILE *arquivo;                      // NULL quando não há diário aberto
+    uint64_t geracao;                   // geração do diário atual
+    int lote;                           // operações por sincronização
+    unsigned long long registrados;     // registros escritos no diário atual
+    unsigned long long sincronizados;   // registros já gravados no disco
+    int sincronizando;                  // há uma thread sincronizando o arquivo
+    int falhou;                         // houve erro de escrita no diário atual
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    pthread_t thread;
+    int compactando;                    // há um instantâneo sendo gravado em segundo plano
+    Compactacao compactacao;
+    char base[DIARIO_BASE];
+} Diario;
+
+static Diario diario = {.trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER};
+
+/**
+ * Monta o caminho do diário de uma geração.
+ */
+void caminhoDiario(char *caminho, const uint64_t geracao) {
+    snprintf(caminho, DIARIO_CAMINHO, "%s.diario.%llu", diario.base, (unsigned long long) geracao);
+}
+
+/**
+ * Monta o caminho do instantâneo (com um sufixo opcional, para o arquivo temporário).
+ */
+void caminhoInstantaneo(char *caminho, const char *sufixo) {
+    snprintf(caminho, DIARIO_CAMINHO, "%s.avl%s", diario.base, sufixo);
+}
+
+/**
+ * Calcula o byte de verificação de um registro do diário.
+ */
+unsigned char verificacaoDiario(const unsigned char *registro) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < DIARIO_REGISTRO - 1; i++) {
+        h = (h ^ registro[i]) * 16777619u;
+    }
+    return (unsigned char) (h ^ h >> 8 ^ h >> 16 ^ h >> 24);
+}
+
+/**
+ * Reduz um arquivo ao tamanho informado, descartando o final.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int truncarArquivo(const char *caminho, const size_t tamanho) {
+#ifdef _WIN32
+    const int arquivo = _open(caminho, _O_RDWR | _O_BINARY);
+    if (arquivo < 0) return 0;
+    const int ok = _chsize_s(arquivo, (long long) tamanho) == 0;
+    _close(arquivo);
+    return ok;
+#else
+    return truncate(caminho, (off_t) tamanho) == 0;
+#endif
+}
+
+/**
+ * Substitui um arquivo por outro, mesmo que o destino já exista.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int substituirArquivo(const char *origem, const char *destino) {
+#ifdef _WIN32
+    remove(destino);
+#endif
+    return rename(origem, destino) == 0;
+}
+
+/**
+ * Indica se um arquivo existe e pode ser lido.
+ */
+int arquivoExiste(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return 0;
+    fclose(arquivo);
+    return 1;
+}
+
+/**
+ * Apaga os diários de uma geração e das anteriores a ela. Os diários são apagados
+ * do mais antigo para o mais novo: se o processo for interrompido no meio, os que
+ * sobram ainda formam uma sequência terminada na geração, que a próxima chamada
+ * encontra descendo a partir dela até a primeira geração sem diário.
  */
-void imprimeNo(const No *no, const int altura, const int compr, const int ajustarEsq) {
-    // Espaçamento necessário entre os nós
-    const int halfPad = (1 << (altura - 1)) - 1;
+void apagarDiarios(const uint64_t geracao) {
+    char caminho[DIARIO_CAMINHO];
+    uint64_t primeira = geracao + 1;
+
+    while (primeira > 1) {
+        caminhoDiario(caminho, primeira - 1);
+        if (!arquivoExiste(caminho)) break;
+        primeira--;
+    }
 
-    // Espaços iniciais antes do conector esquerdo
-    for (int p = 0; p < halfPad * compr; p++) wprintf(L" ");
+    for (; primeira <= geracao; primeira++) {
+        caminhoDiario(caminho, primeira);
+        remove(caminho);
+    }
+}
+
+/**
+ * Aplica na árvore os registros do diário de uma geração. Um registro incompleto
+ * ou inválido marca o fim do diário: ele e tudo o que vem depois são descartados do arquivo.
+ * @param raiz Raiz da árvore
+ * @param geracao Geração do diário
+ * @param status Recebe STATUS_OK, STATUS_AUSENTE (o diário não existe), STATUS_INVALIDO
+ *               (o arquivo não é um diário desta árvore) ou STATUS_SEM_MEMORIA
+ * @return Nova raiz da árvore
+ */
+No* reaplicarDiario(No *raiz, const uint64_t geracao, Status *status) {
+    char caminho[DIARIO_CAMINHO];
+    caminhoDiario(caminho, geracao);
 
-    // Conector para o filho esquerdo
-    center(no && no->esquerdo ? L"┌" : L" ", 1, compr, 0, L" ", L"─");
+    size_t tamanho;
+    const unsigned char *dados = mapearArquivo(caminho, &tamanho);
+    if (dados == NULL) {
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
 
-    // Linha horizontal entre o nó e o conector
-    for (int p = 0; p < halfPad * compr; p++)
-        wprintf(no && no->esquerdo ? L"─" : L" ");
+    // Um diário sem o cabeçalho completo foi interrompido antes de receber registros
+    CabecalhoDiario cabecalho;
+    if (tamanho < sizeof(cabecalho)) {
+        desmapearArquivo(dados, tamanho);
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
 
-    if (no) {
-        // Converte o valor do nó para string wide
-        wchar_t wideBuffer[32];
-        swprintf(wideBuffer, sizeof(wideBuffer) / sizeof(wchar_t), L"%d", no->valor);
-
-        // Centraliza o valor do nó
-        const int tam = comprimento(no->valor);
-        center(wideBuffer, tam, compr, ajustarEsq,
-               no->esquerdo ? L"─" : L" ",
-               no->direito ? L"─" : L" ");
+    memcpy(&cabecalho, dados, sizeof(cabecalho));
+    if (memcmp(cabecalho.assinatura, "ARVD", 4) != 0 || cabecalho.versao != INSTANTANEO_VERSAO ||
+        cabecalho.tipo != INSTANTANEO_AVL || cabecalho.ordem != INSTANTANEO_ORDEM || cabecalho.geracao != geracao) {
+        desmapearArquivo(dados, tamanho);
+        *status = STATUS_INVALIDO;
+        return raiz;
+    }
+
+    *status = STATUS_OK;
+    size_t fim = sizeof(cabecalho);
+    while (fim + DIARIO_REGISTRO <= tamanho) {
+        const unsigned char *registro = dados + fim;
+        if (registro[DIARIO_REGISTRO - 1] != verificacaoDiario(registro)) break;
+
+        Status aplicado = STATUS_OK;
+        if (registro[0] == OP_INSERIR) {
+            raiz = insercao(raiz, lerInt32(registro + 1), &aplicado);
+        } else if (registro[0] == OP_REMOVER) {
+            raiz = remover(raiz, lerInt32(registro + 1), &aplicado);
+        } else {
+            break;
+        }
+
+        if (aplicado == STATUS_SEM_MEMORIA) {
+            *status = STATUS_SEM_MEMORIA;
+            break;
+        }
+        fim += DIARIO_REGISTRO;
+    }
+    desmapearArquivo(dados, tamanho);
+
+    // Descarta o registro incompleto, para que os próximos sejam acrescentados depois do último válido
+    if (*status == STATUS_OK && fim < tamanho && !truncarArquivo(caminho, fim)) *status = STATUS_INVALIDO;
+
+    return raiz;
+}
+
+/**
+ * Cria o diário de uma geração, vazio e já sincronizado com o disco.
+ * @return Arquivo aberto para acréscimos ou NULL em caso de erro
+ */
+FILE* criarDiario(const uint64_t geracao) {
+    char caminho[DIARIO_CAMINHO];
+    caminhoDiario(caminho, geracao);
+
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return NULL;
+
+    const CabecalhoDiario cabecalho = {
+        {'A', 'R', 'V', 'D'}, INSTANTANEO_VERSAO, INSTANTANEO_AVL, INSTANTANEO_ORDEM, geracao
+    };
+    if (fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 || !sincronizarArquivo(arquivo)) {
+        fclose(arquivo);
+        return NULL;
+    }
+
+    return arquivo;
+}
+
+/**
+ * Recupera a árvore a partir dos arquivos de um prefixo (o instantâneo e os
+ * diários posteriores a ele) e abre o diário para as próximas operações.
+ * @param base Prefixo dos arquivos
+ * @param lote Quantidade de operações por sincronização com o disco
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (prefixo longo demais, arquivos corrompidos
+ *               ou de outra árvore, ou o diário não pôde ser aberto) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore recuperada
+ */
+No* abrirDiario(const char *base, const int lote, Status *status) {
+    char caminho[DIARIO_CAMINHO];
+    if (strlen(base) >= DIARIO_BASE) {
+        *status = STATUS_INVALIDO;
+        return NULL;
+    }
+    strcpy(diario.base, base);
+    caminhoInstantaneo(caminho, "");
+
+    uint64_t geracao = 0;
+    No *raiz = carregarInstantaneo(caminho, &geracao, status);
+    if (*status == STATUS_AUSENTE) *status = STATUS_OK; // ainda não houve compactação
+    if (*status != STATUS_OK) return NULL;
+
+    // Diários já incluídos no instantâneo sobram quando a compactação é interrompida antes de apagá-los
+    apagarDiarios(geracao);
+
+    // Os diários posteriores ao instantâneo são reaplicados em ordem
+    int reaplicados = 0;
+    while (1) {
+        Status reaplicado;
+        raiz = reaplicarDiario(raiz, geracao + 1, &reaplicado);
+        if (reaplicado == STATUS_AUSENTE) break;
+        if (reaplicado != STATUS_OK) {
+            *status = reaplicado;
+            return raiz;
+        }
+        geracao++;
+        reaplicados++;
+    }
+
+    if (reaplicados > 0) {
+        // O último diário continua recebendo as operações
+        caminhoDiario(caminho, geracao);
+        diario.arquivo = fopen(caminho, "ab");
+        diario.geracao = geracao;
     } else {
-        // Espaço vazio caso o nó não exista
-        for (int p = 0; p < compr; p++) wprintf(L" ");
+        diario.geracao = geracao + 1;
+        diario.arquivo = criarDiario(diario.geracao);
     }
 
-    // Linha horizontal para o filho direito
-    for (int p = 0; p < halfPad * compr; p++)
-        wprintf(no && no->direito ? L"─" : L" ");
+    diario.lote = lote > 0 ? lote : 1;
+    diario.registrados = diario.sincronizados = 0;
+    diario.sincronizando = diario.falhou = 0;
+    if (diario.arquivo == NULL) *status = STATUS_INVALIDO;
+
+    return raiz;
+}
+
+/**
+ * Sincroniza com o disco os registros já escritos no diário, compartilhando a
+ * sincronização com as threads que chegarem enquanto ela acontece. Deve ser
+ * chamada com a trava do diário.
+ * @param alvo Quantidade de registros que precisam estar no disco
+ */
+void sincronizarAte(const unsigned long long alvo) {
+    while (diario.sincronizados < alvo && !diario.falhou) {
+        if (diario.sincronizando) {
+            // Outra thread já está sincronizando: espera por ela e confere de novo
+            pthread_cond_wait(&diario.sinal, &diario.trava);
+            continue;
+        }
+
+        // Esta thread sincroniza tudo o que foi registrado até agora, fora da trava
+        const unsigned long long registrados = diario.registrados;
+        diario.sincronizando = 1;
+        const int ok = fflush(diario.arquivo) == 0;
+        pthread_mutex_unlock(&diario.trava);
 
-    // Conector para o filho direito
-    center(no && no->direito ? L"┐" : L" ", 1, compr, 1, L"─", L" ");
+#ifdef _WIN32
+        const int sincronizado = ok && _commit(_fileno(diario.arquivo)) == 0;
+#else
+        const int sincronizado = ok && fsync(fileno(diario.arquivo)) == 0;
+#endif
 
-    // Espaços finais
-    for (int p = 0; p < halfPad * compr; p++) wprintf(L" ");
+        pthread_mutex_lock(&diario.trava);
+        diario.sincronizando = 0;
+        if (sincronizado) {
+            if (registrados > diario.sincronizados) diario.sincronizados = registrados;
+        } else {
+            diario.falhou = 1;
+        }
+        pthread_cond_broadcast(&diario.sinal);
+    }
 }
 
 /**
- * Imprime uma camada (nível) inteira da árvore AVL.
- * Também prepara a próxima camada com os filhos dos nós atuais.
- *
- * @param camada Vetor de nós da camada atual
- * @param n Quantidade de nós na camada
- * @param altura Altura atual da árvore
- * @param compr Largura padrão dos nós
- * @return Vetor contendo a próxima camada
+ * Registra uma operação já aplicada na árvore, podendo ser chamada por várias threads.
+ * Retorna depois que o registro foi escrito e, se ele completou um lote, depois
+ * que o lote chegou ao disco.
+ * @param operacao OP_INSERIR ou OP_REMOVER
+ * @param chave Chave da operação
+ * @return STATUS_OK ou STATUS_INVALIDO (não há diário aberto ou houve erro de escrita)
  */
-No** imprimeCamada(No **camada, const int n, const int altura, const int compr) {
-    if (!camada) {
-        wprintf(L"Erro, camada não alocada\n");
-        return camada;
+Status registrarOperacao(const int operacao, const int chave) {
+    unsigned char registro[DIARIO_REGISTRO];
+    registro[0] = (unsigned char) operacao;
+    escreverInt32(registro + 1, chave);
+    registro[DIARIO_REGISTRO - 1] = verificacaoDiario(registro);
+
+    pthread_mutex_lock(&diario.trava);
+    if (diario.arquivo == NULL || diario.falhou || fwrite(registro, DIARIO_REGISTRO, 1, diario.arquivo) != 1) {
+        pthread_mutex_unlock(&diario.trava);
+        return STATUS_INVALIDO;
     }
 
-    // Aloca espaço para a próxima camada (dobro de nós)
-    No** prox_camada = malloc(sizeof(No*) * n * 2);
+    const unsigned long long numero = ++diario.registrados;
+    if (numero - diario.sincronizados >= (unsigned long long) diario.lote) sincronizarAte(numero);
+    const int falhou = diario.falhou;
+    pthread_mutex_unlock(&diario.trava);
+
+    return falhou ? STATUS_INVALIDO : STATUS_OK;
+}
 
-    for (int i = 0; i < n; i++) {
-        const No* no = camada[i];
+/**
+ * Grava no disco todos os registros do diário, mesmo com o lote incompleto.
+ * @return STATUS_OK ou STATUS_INVALIDO (não há diário aberto ou houve erro de escrita)
+ */
+Status sincronizarDiario(void) {
+    pthread_mutex_lock(&diario.trava);
+    if (diario.arquivo) sincronizarAte(diario.registrados);
+    const Status status = diario.arquivo && !diario.falhou ? STATUS_OK : STATUS_INVALIDO;
+    pthread_mutex_unlock(&diario.trava);
 
-        // Imprime o nó atual
-        imprimeNo(no, altura, compr, i % 2);
+    return status;
+}
 
-        // Espaçamento entre os nós
-        for (int p = 0; p < compr; p++) wprintf(L" ");
+/**
+ * Grava o instantâneo copiado pela compactação e, depois que ele está no disco,
+ * apaga os diários que ele inclui.
+ */
+void* gravarCompactacao(void *argumento) {
+    Compactacao *compactacao = argumento;
+    char temporario[DIARIO_CAMINHO], caminho[DIARIO_CAMINHO];
+    caminhoInstantaneo(temporario, ".tmp");
+    caminhoInstantaneo(caminho, "");
 
-        // Preenche a próxima camada com os filhos
-        prox_camada[i * 2]     = no ? no->esquerdo : NULL;
-        prox_camada[i * 2 + 1] = no ? no->direito  : NULL;
+    // O instantâneo anterior só é substituído quando o novo está completo
+    compactacao->status = gravarInstantaneo(compactacao->chaves, compactacao->contagens, compactacao->alturas,
+                                            compactacao->n, compactacao->geracao, temporario);
+    if (compactacao->status == STATUS_OK && !substituirArquivo(temporario, caminho)) {
+        compactacao->status = STATUS_INVALIDO;
     }
+    if (compactacao->status == STATUS_OK) apagarDiarios(compactacao->geracao);
 
-    // Quebra de linha ao final da camada
-    wprintf(L"\n");
+    free(compactacao->chaves);
+    free(compactacao->contagens);
+    free(compactacao->alturas);
+    return NULL;
+}
 
-    // Libera a camada atual
-    free(camada);
+/**
+ * Espera o fim da compactação em segundo plano, se houver uma.
+ * @return Resultado da última compactação (STATUS_OK se não houve nenhuma)
+ */
+Status aguardarCompactacao(void) {
+    if (!diario.compactando) return STATUS_OK;
 
-    return prox_camada;
+    pthread_join(diario.thread, NULL);
+    diario.compactando = 0;
+    return diario.compactacao.status;
 }
 
 /**
- * Imprime graficamente toda a árvore AVL, nível por nível.
- * Utiliza caracteres Unicode para representar a estrutura.
- *
- * @param raiz Raiz da árvore
+ * Compacta o diário em um novo instantâneo. A árvore é copiada para dois vetores
+ * e o diário passa para a geração seguinte; a gravação do instantâneo, que é a
+ * parte demorada, continua em segundo plano enquanto novas operações são registradas.
+ * A árvore não pode ser alterada durante a chamada.
+ * @param raiz Raiz da árvore, com todas as operações já registradas
+ * @return STATUS_OK, STATUS_INVALIDO (não há diário aberto, ou um arquivo não pôde
+ *         ser gravado) ou STATUS_SEM_MEMORIA
  */
-void imprimeArvore(No* raiz) {
-    // Altura total da árvore
-    const int altura = alturaNo(raiz) + 1;
+Status compactarDiario(const No *raiz) {
+    if (diario.arquivo == NULL) return STATUS_INVALIDO;
 
-    // Caso a árvore esteja vazia
-    if (altura <= 0) {
-        wprintf(L"A árvore está vazia.\n");
-        return;
+    // Uma compactação por vez: a anterior precisa terminar antes
+    Status status = aguardarCompactacao();
+    if (status != STATUS_OK) return status;
+
+    const int n = contarNos(raiz);
+    Compactacao *compactacao = &diario.compactacao;
+    if (!alocarInstantaneo(n, &compactacao->chaves, &compactacao->contagens, &compactacao->alturas)) {
+        return STATUS_SEM_MEMORIA;
     }
 
-    // Determina a largura necessária para impressão
-    const int compr = maiorComprimento(raiz);
+    int i = 0;
+    coletarInstantaneo(raiz, compactacao->chaves, compactacao->contagens, compactacao->alturas, &i);
+    compactacao->n = n;
+
+    // Troca o diário: os registros do atual precisam estar no disco antes de ele ser fechado
+    pthread_mutex_lock(&diario.trava);
+    sincronizarAte(diario.registrados);
+    FILE *proximo = diario.falhou ? NULL : criarDiario(diario.geracao + 1);
+    if (proximo) {
+        fclose(diario.arquivo);
+        diario.arquivo = proximo;
+        compactacao->geracao = diario.geracao++;
+        diario.registrados = diario.sincronizados = 0;
+    }
+    pthread_mutex_unlock(&diario.trava);
 
-    // Inicializa a primeira camada com a raiz
-    No** camada = malloc(sizeof(No*));
-    camada[0] = raiz;
+    if (proximo == NULL || pthread_create(&diario.thread, NULL, gravarCompactacao, compactacao) != 0) {
+        free(compactacao->chaves);
+        free(compactacao->contagens);
+        free(compactacao->alturas);
+        return STATUS_INVALIDO;
+    }
 
-    int n = 1;
+    diario.compactando = 1;
+    return STATUS_OK;
+}
 
-    // Imprime cada nível da árvore
-    for (int a = altura; a > 0; a--) {
-        camada = imprimeCamada(camada, n, a, compr);
-        n *= 2;
+/**
+ * Sincroniza e fecha o diário, esperando a compactação em andamento.
+ * @return STATUS_OK ou STATUS_INVALIDO (houve erro de escrita)
+ */
+Status fecharDiario(void) {
+    if (diario.arquivo == NULL) return STATUS_OK;
+
+    Status status = sincronizarDiario();
+    if (aguardarCompactacao() != STATUS_OK) status = STATUS_INVALIDO;
+    if (fclose(diario.arquivo) != 0) status = STATUS_INVALIDO;
+    diario.arquivo = NULL;
+
+    return status;
+}
+
+/**
+ * Mede o custo do diário: insere n chaves aleatórias registrando cada uma,
+ * compacta o diário enquanto remove metade das chaves e, por fim, recupera a
+ * árvore dos arquivos. Escreve uma linha CSV:
+ * motor,modo,n,lote,ops_por_s,compactar_ms,recuperar_ms
+ * A coluna compactar_ms é o tempo em que as operações ficam bloqueadas pela compactação.
+ * @param n Quantidade de chaves
+ * @param base Prefixo dos arquivos, que ainda não deve ter dados
+ * @param lote Quantidade de operações por sincronização com o disco
+ * @return Código de saída do programa
+ */
+int executarDuravel(const unsigned int n, const char *base, const int lote) {
+    Status status;
+
+    if (n == 0 || lote <= 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves e o lote devem ser positivos\n");
+        return 1;
+    }
+
+    No *raiz = abrirDiario(base, lote, &status);
+    if (status != STATUS_OK || raiz != NULL) {
+        fprintf(stderr, "ERRO: não foi possível criar um diário vazio em %s\n", base);
+        fecharDiario();
+        poolDestruir(&poolNos);
+        return 1;
+    }
+
+    long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) {
+        raiz = insercao(raiz, chaveBench(i, 0), &status);
+        if (status == STATUS_OK) status = registrarOperacao(OP_INSERIR, chaveBench(i, 0));
+        if (status == STATUS_DUPLICADA) status = STATUS_OK;
+    }
+    if (status == STATUS_OK) status = sincronizarDiario();
+    const long long inserir = agoraNs() - inicio;
+
+    inicio = agoraNs();
+    if (status == STATUS_OK) status = compactarDiario(raiz);
+    const long long compactar = agoraNs() - inicio;
+
+    // As remoções são registradas enquanto o instantâneo é gravado
+    for (unsigned int i = 0; i < n / 2 && status == STATUS_OK; i++) {
+        raiz = remover(raiz, chaveBench(i, 0), &status);
+        if (status == STATUS_OK) status = registrarOperacao(OP_REMOVER, chaveBench(i, 0));
+        if (status == STATUS_AUSENTE) status = STATUS_OK;
+    }
+    if (fecharDiario() != STATUS_OK) status = STATUS_INVALIDO;
+
+    const int esperados = contarNos(raiz);
+    poolDestruir(&poolNos);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar o diário em %s\n", base);
+        return 1;
+    }
+
+    inicio = agoraNs();
+    raiz = abrirDiario(base, lote, &status);
+    const long long recuperar = agoraNs() - inicio;
+    fecharDiario();
+
+    if (status != STATUS_OK || contarNos(raiz) != esperados) {
+        fprintf(stderr, "ERRO: a árvore recuperada de %s não confere\n", base);
+        poolDestruir(&poolNos);
+        return 1;
     }
 
-    // Libera a última camada
-    free(camada);
+    printf("avl,diario,%u,%d,%.0f,%.3f,%.3f\n", n, lote, n / (inserir / 1e9), compactar / 1e6, recuperar / 1e6);
+
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+/**
+ * Rastreador utilizado pelo menu, exibindo cada nó visitado durante a pesquisa.
+ */
+void exibirVisita(Evento evento, int valor) {
+    if (evento == EVENTO_VISITA) {
+        wprintf(L"Verificando nó com valor %d...\n", valor);
+    }
+}
+
+/**
+ * Visitante utilizado pelo menu, exibindo cada valor de uma consulta por faixa.
+ */
+int exibirValor(int valor, void *contexto) {
+    (void) contexto;
+    wprintf(L"%d ", valor);
+    return 0;
+}
+
+/**
+ * Lê do menu o caminho de um arquivo, convertido para a codificação do sistema.
+ * @return 1 se o caminho foi lido, 0 caso contrário
+ */
+int lerCaminho(char *arquivo, const size_t tamanho) {
+    wchar_t caminho[1024];
+
+    wprintf(L"\nInforme o caminho do arquivo:");
+    if (wscanf(L"%1023ls", caminho) != 1) return 0;
+
+    const size_t convertidos = wcstombs(arquivo, caminho, tamanho);
+    return convertidos != (size_t) -1 && convertidos < tamanho;
 }
 
-int main(){
+int main(int argc, char *argv[]){
+    // Modo benchmark: questao01 --bench <n> [aleatoria|ordenada] [compacta]
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        const int ordenada = argc >= 4 && strcmp(argv[3], "ordenada") == 0;
+        const int compacta = argc >= 5 && strcmp(argv[4], "compacta") == 0;
+        return executarBenchmark((unsigned int) strtoul(argv[2], NULL, 10), ordenada, compacta);
+    }
+
+    // Operações de conjunto: questao01 --conjuntos <n> [threads]
+    if (argc >= 3 && strcmp(argv[1], "--conjuntos") == 0) {
+        const int threads = argc >= 4 ? atoi(argv[3]) : processadores();
+        return executarConjuntos((unsigned int) strtoul(argv[2], NULL, 10), threads);
+    }
+
+    // Leitura sem travas: questao01 --persistente <n> [leitores]
+    if (argc >= 3 && strcmp(argv[1], "--persistente") == 0) {
+        const int leitores = argc >= 4 ? atoi(argv[3]) : processadores();
+        return executarPersistente((unsigned int) strtoul(argv[2], NULL, 10), leitores);
+    }
+
+    // Instantâneo em arquivo: questao01 --instantaneo <n> [arquivo]
+    if (argc >= 3 && strcmp(argv[1], "--instantaneo") == 0) {
+        return executarInstantaneo((unsigned int) strtoul(argv[2], NULL, 10), argc >= 4 ? argv[3] : "instantaneo.avl");
+    }
+
+    // Exportação: questao01 --exportar <n> <arquivo> [dot|json]
+    if (argc >= 4 && strcmp(argv[1], "--exportar") == 0) {
+        const FormatoExportacao formato = argc >= 5 && strcmp(argv[4], "json") == 0 ? EXPORTAR_JSON : EXPORTAR_DOT;
+        return executarExportacao((unsigned int) strtoul(argv[2], NULL, 10), argv[3], formato);
+    }
+
+    // Árvores genéricas: questao01 --generica <n>
+    if (argc >= 3 && strcmp(argv[1], "--generica") == 0) {
+        return executarGenerica((unsigned int) strtoul(argv[2], NULL, 10));
+    }
+
+    // Diário com sincronização em grupo: questao01 --duravel <n> <base> [lote]
+    if (argc >= 4 && strcmp(argv[1], "--duravel") == 0) {
+        const int lote = argc >= 5 ? atoi(argv[4]) : 1;
+        return executarDuravel((unsigned int) strtoul(argv[2], NULL, 10), argv[3], lote);
+    }
+
+    // Modo em lote: questao01 --lote [arquivo], lendo da entrada padrão quando o arquivo é omitido
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) {
+        FILE *entrada = argc >= 3 ? fopen(argv[2], "rb") : stdin;
+        if (entrada == NULL) {
+            fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+            return 1;
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        const int resultado = executarLote(entrada, stdout);
+        if (entrada != stdin) fclose(entrada);
+        return resultado;
+    }
+
+    // Menu com diário: questao01 --diario <base> [lote], recuperando a árvore dos arquivos do prefixo
+    const char *base = NULL;
+    int lote = 1;
+    if (argc >= 3 && strcmp(argv[1], "--diario") == 0) {
+        base = argv[2];
+        lote = argc >= 4 ? atoi(argv[3]) : 1;
+    }
+
     // Set locale to support wide characters
     setlocale(LC_ALL, "");
 
@@ -525,10 +4496,21 @@ int main(){
 #endif
 
     int escolha, valor; 
+    Status status;
     No *raiz = NULL; 
 
+    if (base) {
+        raiz = abrirDiario(base, lote, &status);
+        if (status != STATUS_OK) {
+            wprintf(L"\nERRO ao recuperar a árvore de %s", base);
+            fecharDiario();
+            poolDestruir(&poolNos);
+            return 1;
+        }
+    }
+
     do{
-        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n");
+        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n6 - Construir a partir de uma lista\n7 - Contadores\n8 - Congelar\n9 - Pesquisar no instantâneo congelado\n10 - Posição de um valor\n11 - K-ésimo menor valor\n12 - Contar valores em um intervalo\n13 - Listar valores em um intervalo\n14 - Piso e teto de um valor\n15 - Dividir em um valor\n16 - União, interseção ou diferença com uma lista\n17 - Salvar em arquivo\n18 - Carregar de arquivo\n19 - Compactar o diário\n20 - Imprimir uma subárvore\n21 - Exportar para DOT ou JSON\n");
         wscanf(L"%d", &escolha);
 
         switch (escolha){
@@ -539,22 +4521,44 @@ int main(){
         case 1:
             wprintf(L"\nInforme o valor que deseja inserir:");
             wscanf(L"%d", &valor);
-            raiz = insercao(raiz, valor);
+            raiz = insercao(raiz, valor, &status);
+            if (status == STATUS_DUPLICADA) {
+                wprintf(L"A inserção não foi realizada, pois %d já existe\n", valor);
+            } else if (status == STATUS_SEM_MEMORIA) {
+                wprintf(L"\nERRO ao alocar memória");
+            } else if (diario.arquivo && registrarOperacao(OP_INSERIR, valor) != STATUS_OK) {
+                wprintf(L"\nERRO ao gravar o diário");
+            }
             break;
         
         case 2:
             wprintf(L"\nInforme o valor que deseja remover:");
             wscanf(L"%d", &valor);
-            raiz = remover(raiz, valor);
+            raiz = remover(raiz, valor, &status);
+            if (status == STATUS_AUSENTE) {
+                wprintf(L"O valor não foi encontrado\n");
+            } else if (diario.arquivo && registrarOperacao(OP_REMOVER, valor) != STATUS_OK) {
+                wprintf(L"\nERRO ao gravar o diário");
+            }
             break;
 
         case 3:
             wprintf(L"\nInforme o valor que deseja pesquisar:");
             wscanf(L"%d", &valor);
 
-            const No* resultado = pesquisaNo(raiz, valor, 1);
+#if RASTREAMENTO
+            rastreador = exibirVisita;
+#endif
+            const No* resultado = pesquisaNo(raiz, valor);
+#if RASTREAMENTO
+            rastreador = NULL;
+#endif
             if (resultado) {
-                wprintf(L"Valor %d encontrado na árvore.\n", valor);
+                wprintf(L"Valor %d encontrado na árvore", valor);
+#if MULTICONJUNTO
+                wprintf(L" (%d ocorrência(s))", resultado->contagem);
+#endif
+                wprintf(L".\n");
             } else {
                 wprintf(L"Valor %d não encontrado na árvore.\n", valor);
             }
@@ -568,12 +4572,270 @@ int main(){
         case 5:
             preOrdem(raiz); 
             break;
+
+        case 6:
+            wprintf(L"\nInforme a quantidade de valores:");
+            wscanf(L"%d", &valor);
+            if (valor <= 0) {
+                wprintf(L"Quantidade inválida\n");
+                break;
+            }
+
+            int *valores = malloc(sizeof(int) * valor);
+            if (valores == NULL) {
+                wprintf(L"\nERRO ao alocar memória");
+                break;
+            }
+
+            wprintf(L"\nInforme os valores:");
+            for (int i = 0; i < valor; i++) {
+                wscanf(L"%d", &valores[i]);
+            }
+
+            // A árvore atual é descartada e a nova é construída de uma só vez
+            poolDestruir(&poolNos);
+            raiz = construirArvore(valores, valor, &status);
+            free(valores);
+
+            if (status == STATUS_SEM_MEMORIA) {
+                wprintf(L"\nERRO ao alocar memória");
+            }
+            break;
+
+        case 7:
+            exibirContadores(stdout);
+            break;
+
+        case 8:
+            if (congelar(raiz) == STATUS_OK) {
+                wprintf(L"Instantâneo congelado com %d valores.\n", congelada.n);
+            } else {
+                wprintf(L"\nERRO ao alocar memória");
+            }
+            break;
+
+        case 9:
+            wprintf(L"\nInforme o valor que deseja pesquisar:");
+            wscanf(L"%d", &valor);
+            if (pesquisaCongelada(valor)) {
+                wprintf(L"Valor %d encontrado no instantâneo.\n", valor);
+            } else {
+                wprintf(L"Valor %d não encontrado no instantâneo.\n", valor);
+            }
+            break;
+
+#if ESTATISTICA_ORDEM
+        case 10:
+            wprintf(L"\nInforme o valor:");
+            wscanf(L"%d", &valor);
+            wprintf(L"Há %d valores menores que %d na árvore.\n", posicao(raiz, valor), valor);
+            break;
+
+        case 11:
+            wprintf(L"\nInforme a posição k:");
+            wscanf(L"%d", &valor);
+            const No *kesimo = selecionar(raiz, valor);
+            if (kesimo) {
+                wprintf(L"O %dº menor valor é %d.\n", valor, kesimo->valor);
+            } else {
+                wprintf(L"A árvore não tem uma posição %d.\n", valor);
+            }
+            break;
+
+        case 12: {
+            int fim;
+            wprintf(L"\nInforme o início e o fim do intervalo:");
+            wscanf(L"%d %d", &valor, &fim);
+            wprintf(L"Há %d valores em [%d, %d].\n", contarFaixa(raiz, valor, fim), valor, fim);
+            break;
+        }
+#endif
+
+        case 13: {
+            int fim;
+            wprintf(L"\nInforme o início e o fim do intervalo:");
+            wscanf(L"%d %d", &valor, &fim);
+            visitarFaixa(raiz, valor, fim, exibirValor, NULL);
+            wprintf(L"\n");
+            break;
+        }
+
+        case 14: {
+            wprintf(L"\nInforme o valor:");
+            wscanf(L"%d", &valor);
+            const No *menorIgual = piso(raiz, valor);
+            const No *maiorIgual = teto(raiz, valor);
+            if (menorIgual) {
+                wprintf(L"Piso: %d\n", menorIgual->valor);
+            } else {
+                wprintf(L"Não há valores menores ou iguais a %d.\n", valor);
+            }
+            if (maiorIgual) {
+                wprintf(L"Teto: %d\n", maiorIgual->valor);
+            } else {
+                wprintf(L"Não há valores maiores ou iguais a %d.\n", valor);
+            }
+            break;
+        }
+
+        case 15: {
+            wprintf(L"\nInforme o valor de corte:");
+            wscanf(L"%d", &valor);
+
+            // Exibe as duas partes e as junta novamente
+            No *maiores;
+            No *menores = dividir(raiz, valor, &maiores);
+            wprintf(L"\nValores menores que %d:\n", valor);
+            imprimeArvore(menores);
+            wprintf(L"\nValores maiores ou iguais a %d:\n", valor);
+            imprimeArvore(maiores);
+            raiz = juntarArvores(menores, maiores);
+            break;
+        }
+
+        case 16: {
+            int operacao;
+            wprintf(L"\n1 - União\n2 - Interseção\n3 - Diferença (árvore - lista)\nEscolha a operação:");
+            wscanf(L"%d", &operacao);
+            if (operacao < 1 || operacao > 3) {
+                wprintf(L"\nOpcao invalida!!!!");
+                break;
+            }
+
+            wprintf(L"\nInforme a quantidade de valores:");
+            wscanf(L"%d", &valor);
+            if (valor <= 0) {
+                wprintf(L"Quantidade inválida\n");
+                break;
+            }
+
+            int *lista = malloc(sizeof(int) * valor);
+            if (lista == NULL) {
+                wprintf(L"\nERRO ao alocar memória");
+                break;
+            }
+
+            wprintf(L"\nInforme os valores:");
+            for (int i = 0; i < valor; i++) {
+                wscanf(L"%d", &lista[i]);
+            }
+
+            No *outra = construirArvore(lista, valor, &status);
+            free(lista);
+            if (status == STATUS_SEM_MEMORIA) {
+                wprintf(L"\nERRO ao alocar memória");
+                break;
+            }
+
+            raiz = conjuntoParalelo((OperacaoConjunto) (operacao - 1), raiz, outra, processadores());
+            break;
+        }
+
+        case 17:
+        case 18: {
+            char arquivo[1024];
+            if (!lerCaminho(arquivo, sizeof(arquivo))) {
+                wprintf(L"\nCaminho inválido");
+                break;
+            }
+
+            if (escolha == 17) {
+                status = salvarInstantaneo(raiz, arquivo);
+                if (status == STATUS_OK) {
+                    wprintf(L"Árvore salva.\n");
+                } else if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"\nERRO ao alocar memória");
+                } else {
+                    wprintf(L"\nERRO ao gravar o arquivo");
+                }
+                break;
+            }
+
+            // A árvore atual é descartada e a nova é reconstruída de uma só vez
+            poolDestruir(&poolNos);
+            raiz = carregarInstantaneo(arquivo, NULL, &status);
+            if (status == STATUS_OK) {
+                wprintf(L"Árvore carregada com %d valores.\n", contarNos(raiz));
+            } else if (status == STATUS_AUSENTE) {
+                wprintf(L"\nERRO ao abrir o arquivo");
+            } else if (status == STATUS_INVALIDO) {
+                wprintf(L"\nO arquivo não é um instantâneo AVL válido");
+            } else {
+                wprintf(L"\nERRO ao alocar memória");
+            }
+            break;
+        }
+
+        case 19:
+            if (diario.arquivo == NULL) {
+                wprintf(L"\nO programa não foi iniciado com --diario");
+            } else if (compactarDiario(raiz) == STATUS_OK) {
+                wprintf(L"Compactação iniciada.\n");
+            } else {
+                wprintf(L"\nERRO ao compactar o diário");
+            }
+            break;
         
+        case 20: {
+            int niveis;
+            wprintf(L"\nInforme o valor da raiz da subárvore:");
+            wscanf(L"%d", &valor);
+            wprintf(L"\nInforme a quantidade de níveis:");
+            wscanf(L"%d", &niveis);
+
+            const No *subarvore = pesquisaNo(raiz, valor);
+            if (subarvore == NULL) {
+                wprintf(L"O valor %d não foi encontrado\n", valor);
+            } else {
+                imprimeSubarvore(subarvore, niveis);
+            }
+            break;
+        }
+
+        case 21: {
+            int formato;
+            wprintf(L"\nInforme o formato (1 - DOT, 2 - JSON):");
+            wscanf(L"%d", &formato);
+            if (formato != EXPORTAR_DOT && formato != EXPORTAR_JSON) {
+                wprintf(L"\nFormato inválido");
+                break;
+            }
+
+            char arquivo[1024];
+            if (!lerCaminho(arquivo, sizeof(arquivo))) {
+                wprintf(L"\nCaminho inválido");
+                break;
+            }
+
+            long long bytes;
+            status = exportarArvore(raiz, arquivo, (FormatoExportacao) formato, &bytes);
+            if (status == STATUS_OK) {
+                wprintf(L"Árvore exportada (%lld bytes).\n", bytes);
+            } else if (status == STATUS_SEM_MEMORIA) {
+                wprintf(L"\nERRO ao alocar memória");
+            } else {
+                wprintf(L"\nERRO ao gravar o arquivo");
+            }
+            break;
+        }
+
         default:
             wprintf(L"\nOpcao invalida!!!!");
         }
 
+        // As operações em bloco não passam pelo diário: a árvore inteira vai para um novo instantâneo
+        if (diario.arquivo && (escolha == 6 || escolha == 16 || escolha == 18) && compactarDiario(raiz) != STATUS_OK) {
+            wprintf(L"\nERRO ao compactar o diário");
+        }
+
     }while (escolha != 0); 
-    
+
+    if (fecharDiario() != STATUS_OK) {
+        wprintf(L"\nERRO ao gravar o diário");
+    }
+
+    // Libera todos os nós da árvore de uma só vez
+    destruirCongelada();
+    poolDestruir(&poolNos);
     return 0; 
 }
\ No newline at end of file
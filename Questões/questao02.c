@@ -1,13 +1,30 @@
+// Expõe madvise, MADV_SEQUENTIAL e truncate mesmo quando compilado com -std=c11
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <locale.h>
 #include <wchar.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <limits.h>
 #ifdef _WIN32
 #include <io.h>
 #include <fcntl.h>
+#else
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
+#include "arvore_generica.h"
+
 #define TEXT_RED L"\033[0;31m"
 #define TEXT_RESET L"\033[0m"
 
@@ -18,6 +35,25 @@
 Murilo Henrique Conde da Luz
 Nathielly Neves de Castro */
 
+/*
+ * Estatísticas de ordem opcionais. Com -DESTATISTICA_ORDEM=0 o campo tamanho
+ * deixa de existir, e as consultas posicao, selecionar e contarFaixa não são compiladas.
+ */
+#ifndef ESTATISTICA_ORDEM
+#define ESTATISTICA_ORDEM 1
+#endif
+
+/*
+ * Modo multiconjunto opcional. Sem ele, valores repetidos viram nós separados
+ * na subárvore direita; com -DMULTICONJUNTO=1 cada valor ocupa um único nó com
+ * a quantidade de ocorrências: inserir um valor existente só incrementa a
+ * contagem, sem alocação nem ajuste, e a remoção a decrementa, liberando o nó
+ * apenas na última ocorrência. O tamanho das subárvores continua contando ocorrências.
+ */
+#ifndef MULTICONJUNTO
+#define MULTICONJUNTO 0
+#endif
+
 /**
  * Estrutura que representa um nó da árvore.
  */
@@ -25,15 +61,237 @@ typedef struct no {
     int valor;
     struct no *esquerdo, *direito, *pai;
     short cor; // 1 para vermelho e 0 para preto
+#if ESTATISTICA_ORDEM
+    int tamanho; // quantidade de valores da subárvore
+#endif
+#if MULTICONJUNTO
+    int contagem; // ocorrências do valor
+#endif
 } No;
 
+/* ============================================================
+   CÓDIGOS DE RETORNO E RASTREAMENTO
+   ============================================================ */
+
+/**
+ * Resultado das operações da árvore. As operações não escrevem nada na tela:
+ * cabe a quem as chama decidir o que fazer com o resultado.
+ */
+typedef enum {
+    STATUS_OK = 0,         // operação realizada (ou chave encontrada)
+    STATUS_AUSENTE = 1,    // chave não encontrada
+    STATUS_DUPLICADA = 2,  // chave já existente, inserção ignorada
+    STATUS_INVALIDO = 3,   // operação desconhecida (usado no modo em lote)
+    STATUS_SEM_MEMORIA = 4 // não foi possível alocar um novo nó
+} Status;
+
+/*
+ * Rastreamento opcional das operações. Com -DRASTREAMENTO=0 as chamadas de
+ * RASTREAR desaparecem na compilação; caso contrário, custam apenas a verificação
+ * do ponteiro do rastreador, que por padrão é NULL.
+ */
+#ifndef RASTREAMENTO
+#define RASTREAMENTO 1
+#endif
+
+typedef enum {
+    EVENTO_VISITA // um nó foi visitado durante a pesquisa
+} Evento;
+
+typedef void (*Rastreador)(Evento evento, int valor);
+
+#if RASTREAMENTO
+static Rastreador rastreador = NULL;
+#define RASTREAR(evento, valor) do { if (rastreador) rastreador((evento), (valor)); } while (0)
+#else
+#define RASTREAR(evento, valor) ((void) 0)
+#endif
+
+/* ============================================================
+   CONTADORES DE INSTRUMENTAÇÃO
+   ============================================================ */
+
+/*
+ * Contadores das operações da árvore, para entender o custo de cada carga.
+ * São simples incrementos não atômicos, locais a cada thread (as operações de
+ * conjunto em paralelo não entram nos contadores exibidos pelo menu); com
+ * -DCONTADORES=0 as chamadas de CONTAR e CONTAR_PROFUNDIDADE desaparecem na compilação.
+ */
+#ifndef CONTADORES
+#define CONTADORES 1
+#endif
+
+#define PROFUNDIDADE_MAXIMA 64 // pesquisas mais profundas são contadas no último intervalo
+
+typedef struct {
+    unsigned long long comparacoes;          // comparações de chave em inserções e pesquisas
+    unsigned long long rotacoesEsquerda;     // rotações simples à esquerda (as duplas contam duas rotações)
+    unsigned long long rotacoesDireita;      // rotações simples à direita
+    unsigned long long iteracoesInsercao;    // níveis visitados por insercaoAjuste
+    unsigned long long recoloracoesInsercao; // casos de tio vermelho, resolvidos com recoloração
+    unsigned long long rotacoesInsercao;     // casos de tio preto, resolvidos com rotação
+    unsigned long long iteracoesRemocao;     // iterações do laço de remocaoAjuste
+    unsigned long long recoloracoesRemocao;  // casos de irmão com filhos pretos, resolvidos com recoloração
+    unsigned long long profundidades[PROFUNDIDADE_MAXIMA]; // histograma da profundidade das pesquisas
+} Contadores;
+
+#if CONTADORES
+static _Thread_local Contadores contadores;
+#define CONTAR(campo) (contadores.campo++)
+#define CONTAR_PROFUNDIDADE(p) \
+    (contadores.profundidades[(p) < PROFUNDIDADE_MAXIMA ? (p) : PROFUNDIDADE_MAXIMA - 1]++)
+#else
+#define CONTAR(campo) ((void) 0)
+#define CONTAR_PROFUNDIDADE(p) ((void) (p))
+#endif
+
+/**
+ * Escreve uma linha em um fluxo de saída, respeitando a orientação do fluxo
+ * (caracteres largos no menu, bytes no modo em lote).
+ */
+void escreverLinha(FILE *saida, const char *linha) {
+    if (fwide(saida, 0) > 0) {
+        fwprintf(saida, L"%s", linha);
+    } else {
+        fputs(linha, saida);
+    }
+}
+
+/**
+ * Escreve os contadores acumulados até o momento, incluindo o histograma
+ * de profundidade das pesquisas (apenas as profundidades que ocorreram).
+ * @param saida Fluxo onde os contadores serão escritos
+ */
+void exibirContadores(FILE *saida) {
+#if CONTADORES
+    char linha[128];
+
+    snprintf(linha, sizeof(linha), "Comparações: %llu\n", contadores.comparacoes);
+    escreverLinha(saida, linha);
+    snprintf(linha, sizeof(linha), "Rotações à esquerda: %llu | à direita: %llu\n",
+             contadores.rotacoesEsquerda, contadores.rotacoesDireita);
+    escreverLinha(saida, linha);
+    snprintf(linha, sizeof(linha), "Ajuste da inserção: %llu iterações, %llu recolorações, %llu rotações\n",
+             contadores.iteracoesInsercao, contadores.recoloracoesInsercao, contadores.rotacoesInsercao);
+    escreverLinha(saida, linha);
+    snprintf(linha, sizeof(linha), "Ajuste da remoção: %llu iterações, %llu recolorações\n",
+             contadores.iteracoesRemocao, contadores.recoloracoesRemocao);
+    escreverLinha(saida, linha);
+    escreverLinha(saida, "Profundidade das pesquisas (nós visitados):\n");
+    for (int p = 0; p < PROFUNDIDADE_MAXIMA; p++) {
+        if (contadores.profundidades[p]) {
+            snprintf(linha, sizeof(linha), "  profundidade %2d%s: %llu\n",
+                     p, p == PROFUNDIDADE_MAXIMA - 1 ? "+" : " ", contadores.profundidades[p]);
+            escreverLinha(saida, linha);
+        }
+    }
+#else
+    escreverLinha(saida, "Contadores desativados na compilação (-DCONTADORES=0).\n");
+#endif
+}
+
+/* ============================================================
+   ALOCADOR DE NÓS (POOL)
+   ============================================================ */
+
+#define POOL_BLOCO_INICIAL 1024     // capacidade do primeiro bloco (em nós)
+#define POOL_BLOCO_MAXIMO  1048576  // limite para o crescimento dos blocos
+
+/**
+ * Bloco contíguo de nós. Os blocos formam uma lista ligada para que possam
+ * ser liberados todos de uma vez ao destruir o pool.
+ */
+typedef struct bloco {
+    struct bloco *proximo;
+    size_t capacidade;
+    No nos[];
+} Bloco;
+
+/**
+ * Pool de nós: entrega nós a partir de blocos grandes e reaproveita os nós
+ * removidos através de uma lista de livres (encadeada pelo ponteiro esquerdo).
+ */
+typedef struct {
+    Bloco *blocos;  // bloco atual (início da lista de blocos)
+    size_t usados;  // quantidade de nós já entregues do bloco atual
+    No *livres;     // nós devolvidos, prontos para reutilização
+} Pool;
+
+/**
+ * Pool utilizado por todos os nós da árvore.
+ */
+static Pool poolNos = {NULL, 0, NULL};
+
+/**
+ * Pool de onde a thread atual aloca e para onde devolve os nós. As fatias da
+ * árvore particionada trocam-no pelo seu próprio pool enquanto estão travadas.
+ */
+static _Thread_local Pool *poolAtual = &poolNos;
+
+/**
+ * Obtém um nó do pool, priorizando os nós devolvidos.
+ * Quando o bloco atual se esgota, um novo bloco com o dobro da capacidade é alocado.
+ * @param pool Pool de onde o nó será retirado
+ * @return Nó não inicializado ou NULL, caso não haja memória
+ */
+No* poolAlocar(Pool *pool) {
+    // Reaproveita um nó da lista de livres
+    if (pool->livres) {
+        No *no = pool->livres;
+        pool->livres = no->esquerdo;
+        return no;
+    }
+
+    // Aloca um novo bloco quando o atual está cheio (ou ainda não existe)
+    if (pool->blocos == NULL || pool->usados == pool->blocos->capacidade) {
+        size_t capacidade = pool->blocos ? pool->blocos->capacidade * 2 : POOL_BLOCO_INICIAL;
+        if (capacidade > POOL_BLOCO_MAXIMO) capacidade = POOL_BLOCO_MAXIMO;
+
+        Bloco *bloco = malloc(sizeof(Bloco) + capacidade * sizeof(No));
+        if (bloco == NULL) return NULL;
+
+        bloco->proximo = pool->blocos;
+        bloco->capacidade = capacidade;
+        pool->blocos = bloco;
+        pool->usados = 0;
+    }
+
+    return &pool->blocos->nos[pool->usados++];
+}
+
+/**
+ * Devolve um nó ao pool, para que seja reutilizado em uma próxima alocação.
+ * @param pool Pool de onde o nó foi retirado
+ * @param no Nó que será devolvido
+ */
+void poolLiberar(Pool *pool, No *no) {
+    no->esquerdo = pool->livres;
+    pool->livres = no;
+}
+
+/**
+ * Libera todos os blocos do pool de uma só vez.
+ * Todos os nós entregues pelo pool (e, portanto, a árvore inteira) deixam de ser válidos.
+ * @param pool Pool que será destruído
+ */
+void poolDestruir(Pool *pool) {
+    while (pool->blocos) {
+        Bloco *proximo = pool->blocos->proximo;
+        free(pool->blocos);
+        pool->blocos = proximo;
+    }
+
+    pool->usados = 0;
+    pool->livres = NULL;
+}
+
 /**
  * Cria uma nova instância da estrutura nó
  * @param valor Valor a ser armazenado no nó
- * @return Nó alocado e inicializado com o valor passado
+ * @return Nó alocado e inicializado com o valor passado ou NULL, caso não haja memória
  */
 No* novoNo(const int valor) {
-    No* no = malloc(sizeof(No));
+    No* no = poolAlocar(poolAtual);
 
     if (no) {
         no->valor = valor;
@@ -41,24 +299,67 @@ No* novoNo(const int valor) {
         no->direito = NULL;
         no->pai = NULL;
         no->cor = VERMELHO; // Todos os nós criados são inicialmente vermelhos
-    } else {
-        wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+#if ESTATISTICA_ORDEM
+        no->tamanho = 1;
+#endif
+#if MULTICONJUNTO
+        no->contagem = 1;
+#endif
     }
 
     return no;
 }
 
+/**
+ * Retorna a quantidade de nós de uma subárvore
+ * @param no Raiz da subárvore
+ * @return Quantidade de nós ou 0, caso a subárvore seja vazia
+ */
+int tamanhoNo(const No *no) {
+#if ESTATISTICA_ORDEM
+    return no ? no->tamanho : 0;
+#else
+    (void) no;
+    return 0;
+#endif
+}
+
+/**
+ * Retorna quantas vezes o valor de um nó foi inserido (sempre 1 fora do modo multiconjunto)
+ */
+int ocorrencias(const No *no) {
+#if MULTICONJUNTO
+    return no->contagem;
+#else
+    (void) no;
+    return 1;
+#endif
+}
+
+/**
+ * Recalcula o tamanho de um nó a partir dos seus filhos
+ * @param no Nó que será atualizado
+ */
+void atualizaTamanho(No *no) {
+#if ESTATISTICA_ORDEM
+    no->tamanho = tamanhoNo(no->esquerdo) + tamanhoNo(no->direito) + ocorrencias(no);
+#else
+    (void) no;
+#endif
+}
+
 /**
  * Realiza a rotação à esquerda de uma árvore
  * @param p Pivô da rotação, deve ter um filho à direita para realizar a rotação
- * @return Nova raiz, após realizada a rotação
+ * @return Nova raiz, após realizada a rotação (o próprio pivô, caso a rotação não seja possível)
  */
 No* rotacaoEsquerda(No *p) {
     if (p == NULL || p->direito == NULL) {
-        wprintf(L"ERRO: A árvore não cumpre os requisitos de uma rotação à esquerda.");
-        return NULL;
+        return p;
     }
 
+    CONTAR(rotacoesEsquerda);
+
     // Seleção do nó direito ao pivô
     No *u = p->direito;
 
@@ -74,6 +375,12 @@ No* rotacaoEsquerda(No *p) {
     u->esquerdo = p;
     p->pai = u;
 
+    // u assume a subárvore inteira, e p perde u e a subárvore direita de u
+#if ESTATISTICA_ORDEM
+    u->tamanho = p->tamanho;
+#endif
+    atualizaTamanho(p);
+
     // Retornando nova raiz
     return u;
 }
@@ -81,14 +388,15 @@ No* rotacaoEsquerda(No *p) {
 /**
  * Realiza a rotação à direita de uma árvore
  * @param p Pivô da rotação, deve ter um filho à esquerda para realizar a rotação
- * @return Nova raiz, após realizada a rotação
+ * @return Nova raiz, após realizada a rotação (o próprio pivô, caso a rotação não seja possível)
  */
 No* rotacaoDireita(No *p) {
     if (p == NULL || p->esquerdo == NULL) {
-        wprintf(L"ERRO: A árvore não cumpre os requisitos de uma rotação à direita.");
-        return NULL;
+        return p;
     }
 
+    CONTAR(rotacoesDireita);
+
     // Seleção do nó direito ao pivô
     No *u = p->esquerdo;
 
@@ -105,6 +413,12 @@ No* rotacaoDireita(No *p) {
     u->direito = p;
     p->pai = u;
 
+    // u assume a subárvore inteira, e p perde u e a subárvore esquerda de u
+#if ESTATISTICA_ORDEM
+    u->tamanho = p->tamanho;
+#endif
+    atualizaTamanho(p);
+
     // Retornando nova raiz
     return u;
 }
@@ -142,19 +456,18 @@ No* rotacaoDuplaDireita(No *p) {
  * @return Nova raiz da árvore
  */
 No* inserirNo(No* raiz, No* novoNo) {
-    // Caso o nó não esteja inicializado corretamente, ele não é inserido na árvore
-    if (novoNo == NULL) {
-        printf("ERRO: Novo nó inválido");
-    }
-
     // Caso a árvore esteja vazia (raiz == NULL), o nó será a nova raiz;
-    else if (raiz == NULL) {
+    if (raiz == NULL) {
         raiz = novoNo;
     }
 
     // Caso a árvore não esteja vazia, será procurado um nó com espaço para armazenar o nó inserido, seguindo as regras das árvores binárias
     else {
         novoNo->pai = raiz;
+        CONTAR(comparacoes);
+#if ESTATISTICA_ORDEM
+        raiz->tamanho++; // o novo nó sempre entra na subárvore de raiz
+#endif
 
         // A inserção do nó é realizada de forma recursiva
         if (novoNo->valor < raiz->valor) {
@@ -175,12 +488,10 @@ No* inserirNo(No* raiz, No* novoNo) {
  * @return Raiz da árvore ajustada seguindo as regras de inserção de árvores rubro-negra
  */
 No* insercaoAjuste(No *raiz, No *no) {
-    // Caso o nó não exista, mostra um erro e retorna a árvore
-    if (!no) {
-        wprintf(L"ERRO: nó não definido.\n");
-    }
+    CONTAR(iteracoesInsercao);
+
     // Caso o nó inserido seja a raiz, transforme o nó de vermelho para preto
-    else if (!no->pai) {
+    if (!no->pai) {
         no->cor = PRETO;
     }
     // Casos onde o pai é vermelho
@@ -192,6 +503,7 @@ No* insercaoAjuste(No *raiz, No *no) {
 
         // Caso o pai e o tio forem vermelhos, troca a cor do pai, tio e avô, e verifica se o avô precisa de ajuste
         if (tio != NULL && tio->cor == VERMELHO) {
+            CONTAR(recoloracoesInsercao);
             pai->cor = PRETO;
             avo->cor = VERMELHO;
             tio->cor = PRETO;
@@ -201,6 +513,7 @@ No* insercaoAjuste(No *raiz, No *no) {
 
         // Caso o pai seja vermelho, e o tio seja preto, aplicamos uma das rotações e mudamos a cor no novo avô e do irmão do nó inserido
         else {
+            CONTAR(rotacoesInsercao);
             No *novoAvo = NULL;
             if (avo->esquerdo == pai && pai->esquerdo == no) {
                 novoAvo = rotacaoDireita(avo);
@@ -230,15 +543,73 @@ No* insercaoAjuste(No *raiz, No *no) {
     return raiz;
 }
 
+#if MULTICONJUNTO
+/**
+ * Insere um valor no modo multiconjunto. Uma única descida encontra o nó do valor,
+ * que só tem a sua contagem incrementada, ou o ponto onde o novo nó é ligado.
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore com o valor inserido
+ */
+No* inserirOcorrencia(No *raiz, const int valor, Status *status) {
+    No *pai = NULL;
+    No *no = raiz;
+
+    while (no != NULL && no->valor != valor) {
+        CONTAR(comparacoes);
+        pai = no;
+        no = valor < no->valor ? no->esquerdo : no->direito;
+    }
+
+    No *novo = NULL;
+    if (no != NULL) {
+        no->contagem++;
+    } else {
+        if ((novo = novoNo(valor)) == NULL) {
+            *status = STATUS_SEM_MEMORIA;
+            return raiz;
+        }
+
+        novo->pai = pai;
+        if (pai == NULL) {
+            raiz = novo;
+        } else if (valor < pai->valor) {
+            pai->esquerdo = novo;
+        } else {
+            pai->direito = novo;
+        }
+    }
+    *status = STATUS_OK;
+
+    // A nova ocorrência entra na subárvore de todos os ancestrais (e do próprio nó, se ele já existia)
+#if ESTATISTICA_ORDEM
+    for (No *ancestral = no ? no : pai; ancestral != NULL; ancestral = ancestral->pai) {
+        ancestral->tamanho++;
+    }
+#endif
+
+    return novo ? insercaoAjuste(raiz, novo) : raiz;
+}
+#endif
+
 /**
  * Insere um valor na árvore Rubro-Negra
  * @param raiz A raiz da árvore onde será inserido o valor
  * @param valor Valor que será inserido na árvore
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
  * @return Raiz da árvore com o valor inserido
  */
-No* inserirNoRN(No *raiz, const int valor) {
+No* inserirNoRN(No *raiz, const int valor, Status *status) {
+#if MULTICONJUNTO
+    // Valores repetidos não criam novos nós
+    return inserirOcorrencia(raiz, valor, status);
+#else
     // Para inserir o valor, criamos um nó vermelho
     No* no = novoNo(valor);
+    if (no == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return raiz;
+    }
+    *status = STATUS_OK;
 
     // O inserimos na árvore utilizando os critérios de uma árvore binária de busca
     raiz = inserirNo(raiz, no);
@@ -247,28 +618,34 @@ No* inserirNoRN(No *raiz, const int valor) {
     raiz = insercaoAjuste(raiz, no);
 
     return raiz;
+#endif
 }
 
 /**
  * Busca um nó com valor correspondente na árvore
+ * Cada nó visitado é informado ao rastreador (quando houver um), e a quantidade
+ * de nós visitados é registrada no histograma de profundidades.
  * @param raiz Nó inicial da busca
  * @param valor Valor que será buscado na árvore
- * @param exibirMensagem Indica se deve exibir mensagens durante a busca
  * @return O nó com o valor correspondente ou NULL, caso ele não esteja presente na árvore
  */
-No* pesquisaNo(No *raiz, const int valor, const int exibirMensagem) {
-    // Caso base - valor não encontrado
-    if (raiz == NULL) return NULL;
+No* pesquisaNo(No *raiz, const int valor) {
+    int profundidade = 0;
 
-    if (exibirMensagem) {
-        wprintf(L"Verificando nó com valor %d...\n", raiz->valor);
-    }
+    while (raiz != NULL) {
+        RASTREAR(EVENTO_VISITA, raiz->valor);
+        CONTAR(comparacoes);
+        profundidade++;
 
-    // Caso base - valor encontrado
-    if (raiz->valor == valor) return raiz;
+        // Valor encontrado
+        if (raiz->valor == valor) break;
+
+        // Continua a pesquisa para a direita ou esquerda, dependendo do valor do nó
+        raiz = valor < raiz->valor ? raiz->esquerdo : raiz->direito;
+    }
 
-    // Caso recursivo - continuar pesquisa para a direita ou esquerda, dependendo do valor do nó
-    return pesquisaNo(valor < raiz->valor ? raiz->esquerdo : raiz->direito, valor, exibirMensagem);
+    CONTAR_PROFUNDIDADE(profundidade);
+    return raiz;
 }
 
 /**
@@ -283,6 +660,18 @@ No* minimo(No *no) {
     return no;
 }
 
+/**
+ * Retorna o maior nó de uma subárvore
+ * @param no Raiz da subárvore
+ * @return Nó com o maior valor
+ */
+No* maximo(No *no) {
+    while (no && no->direito) {
+        no = no->direito;
+    }
+    return no;
+}
+
 /**
  * Substitui um nó por outro na árvore
  * @param raiz Raiz da árvore
@@ -306,70 +695,94 @@ No* transplantar(No *raiz, No *u, No *v) {
     return raiz;
 }
 
+/**
+ * Liga a nova raiz de uma subárvore rotacionada ao pai da antiga raiz
+ * @param raiz Raiz da árvore
+ * @param antiga Raiz da subárvore antes da rotação
+ * @param nova Raiz da subárvore após a rotação (já com o ponteiro pai atualizado)
+ * @return Raiz da árvore, que muda caso a subárvore rotacionada fosse a árvore inteira
+ */
+No* religar(No *raiz, No *antiga, No *nova) {
+    if (nova->pai == NULL) {
+        raiz = nova;
+    } else if (nova->pai->esquerdo == antiga) {
+        nova->pai->esquerdo = nova;
+    } else {
+        nova->pai->direito = nova;
+    }
+
+    return raiz;
+}
+
 /**
  * Ajusta a árvore rubro-negra após remoção
  * @param raiz Raiz da árvore
- * @param x Nó que pode violar as propriedades rubro-negras
+ * @param x Nó que pode violar as propriedades rubro-negras (pode ser NULL)
+ * @param pai Pai de x, necessário quando x é NULL
  * @return Raiz ajustada
  */
-No* remocaoAjuste(No *raiz, No *x) {
+No* remocaoAjuste(No *raiz, No *x, No *pai) {
     while (x != raiz && (x == NULL || x->cor == PRETO)) {
-        No *pai = x ? x->pai : NULL;
+        CONTAR(iteracoesRemocao);
 
         if (x == pai->esquerdo) {
             No *irmao = pai->direito;
 
-            if (irmao && irmao->cor == VERMELHO) {
+            if (irmao->cor == VERMELHO) {
                 irmao->cor = PRETO;
                 pai->cor = VERMELHO;
-                raiz = rotacaoEsquerda(pai);
+                raiz = religar(raiz, pai, rotacaoEsquerda(pai));
                 irmao = pai->direito;
             }
 
             if ((!irmao->esquerdo || irmao->esquerdo->cor == PRETO) &&
                 (!irmao->direito || irmao->direito->cor == PRETO)) {
+                CONTAR(recoloracoesRemocao);
                 irmao->cor = VERMELHO;
                 x = pai;
+                pai = x->pai;
             } else {
                 if (!irmao->direito || irmao->direito->cor == PRETO) {
-                    if (irmao->esquerdo) irmao->esquerdo->cor = PRETO;
+                    irmao->esquerdo->cor = PRETO;
                     irmao->cor = VERMELHO;
-                    raiz = rotacaoDireita(irmao);
+                    raiz = religar(raiz, irmao, rotacaoDireita(irmao));
                     irmao = pai->direito;
                 }
 
                 irmao->cor = pai->cor;
                 pai->cor = PRETO;
                 if (irmao->direito) irmao->direito->cor = PRETO;
-                raiz = rotacaoEsquerda(pai);
+                raiz = religar(raiz, pai, rotacaoEsquerda(pai));
                 x = raiz;
             }
         } else {
             No *irmao = pai->esquerdo;
 
-            if (irmao && irmao->cor == VERMELHO) {
+            if (irmao->cor == VERMELHO) {
                 irmao->cor = PRETO;
                 pai->cor = VERMELHO;
-                raiz = rotacaoDireita(pai);
+                raiz = religar(raiz, pai, rotacaoDireita(pai));
                 irmao = pai->esquerdo;
             }
 
             if ((!irmao->direito || irmao->direito->cor == PRETO) &&
                 (!irmao->esquerdo || irmao->esquerdo->cor == PRETO)) {
+                CONTAR(recoloracoesRemocao);
                 irmao->cor = VERMELHO;
                 x = pai;
+                pai = x->pai;
             } else {
                 if (!irmao->esquerdo || irmao->esquerdo->cor == PRETO) {
-                    if (irmao->direito) irmao->direito->cor = PRETO;
+                    irmao->direito->cor = PRETO;
                     irmao->cor = VERMELHO;
-                    raiz = rotacaoEsquerda(irmao);
+                    raiz = religar(raiz, irmao, rotacaoEsquerda(irmao));
                     irmao = pai->esquerdo;
                 }
 
                 irmao->cor = pai->cor;
                 pai->cor = PRETO;
                 if (irmao->esquerdo) irmao->esquerdo->cor = PRETO;
-                raiz = rotacaoDireita(pai);
+                raiz = religar(raiz, pai, rotacaoDireita(pai));
                 x = raiz;
             }
         }
@@ -383,18 +796,32 @@ No* remocaoAjuste(No *raiz, No *x) {
  * Remove um nó da árvore Rubro-Negra
  * @param raiz Raiz da árvore
  * @param valor Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
  * @return Nova raiz da árvore
  */
-No* removeNoRN(No *raiz, const int valor) {
-    No *z = pesquisaNo(raiz, valor, 0);
+No* removeNoRN(No *raiz, const int valor, Status *status) {
+    No *z = pesquisaNo(raiz, valor);
 
     if (z == NULL) {
-        wprintf(L"Valor não encontrado na árvore.\n");
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
+    *status = STATUS_OK;
+
+#if MULTICONJUNTO
+    // Ainda restam ocorrências: nenhum nó sai da árvore
+    if (z->contagem > 1) {
+        z->contagem--;
+#if ESTATISTICA_ORDEM
+        for (No *no = z; no != NULL; no = no->pai) no->tamanho--;
+#endif
         return raiz;
     }
+#endif
 
     No *y = z;
     No *x = NULL;
+    No *xPai = z->pai; // pai de x após a remoção, já que x pode ser NULL
     short corOriginal = y->cor;
 
     if (z->esquerdo == NULL) {
@@ -409,8 +836,10 @@ No* removeNoRN(No *raiz, const int valor) {
         x = y->direito;
 
         if (y->pai == z) {
+            xPai = y;
             if (x) x->pai = y;
         } else {
+            xPai = y->pai;
             raiz = transplantar(raiz, y, y->direito);
             y->direito = z->direito;
             y->direito->pai = y;
@@ -422,27 +851,150 @@ No* removeNoRN(No *raiz, const int valor) {
         y->cor = z->cor;
     }
 
-    free(z);
+    // Os tamanhos mudam apenas no caminho entre o ponto de remoção e a raiz
+#if ESTATISTICA_ORDEM
+    for (No *no = xPai; no != NULL; no = no->pai) {
+        atualizaTamanho(no);
+    }
+#endif
+
+    poolLiberar(poolAtual, z);
 
     if (corOriginal == PRETO) {
-        raiz = remocaoAjuste(raiz, x);
+        raiz = remocaoAjuste(raiz, x, xPai);
     }
 
     return raiz;
 }
 
 
+/* ============================================================
+   CONSTRUÇÃO EM LOTE
+   ============================================================ */
+
 /**
- * Libera os recursos de uma árvore binária
- * @param raiz Raiz da árvore que terá os seus nós liberados
+ * Compara dois inteiros, para a ordenação com qsort.
  */
-void freeArvore(No *raiz) {
-    // Para a liberação a árvore é percorrida de forma recusiva em pós-ordem, liberando as subarvores da esquerda e da direita antes de liberar o nó atual
-    if (raiz == NULL) return;
+int compararInteiros(const void *a, const void *b) {
+    const int x = *(const int *) a;
+    const int y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Constrói uma árvore perfeitamente balanceada a partir de um trecho de um vetor
+ * ordenado, usando o elemento central como raiz de cada subárvore.
+ * Como as folhas ficam todas nos dois últimos níveis, basta pintar de vermelho
+ * os nós do nível mais profundo para que todos os caminhos tenham a mesma
+ * quantidade de nós pretos.
+ * @param valores Vetor ordenado
+ * @param ini Primeiro índice do trecho
+ * @param fim Último índice do trecho
+ * @param pai Pai da subárvore construída
+ * @param profundidade Profundidade da raiz da subárvore
+ * @param profundidadeVermelha Profundidade do nível mais profundo da árvore
+ * @param status Recebe STATUS_SEM_MEMORIA caso algum nó não possa ser alocado
+ * @return Raiz da subárvore construída
+ */
+No* construirFaixa(const int *valores, const int *contagens, const int ini, const int fim, No *pai,
+                   const int profundidade, const int profundidadeVermelha, Status *status) {
+    if (ini > fim) return NULL;
+
+    const int meio = ini + (fim - ini) / 2;
+    No *raiz = novoNo(valores[meio]);
+    if (raiz == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
+    }
+
+#if MULTICONJUNTO
+    if (contagens) raiz->contagem = contagens[meio];
+#else
+    (void) contagens;
+#endif
+    raiz->pai = pai;
+    raiz->cor = (profundidade == profundidadeVermelha && profundidade > 0) ? VERMELHO : PRETO;
+    raiz->esquerdo = construirFaixa(valores, contagens, ini, meio - 1, raiz, profundidade + 1, profundidadeVermelha, status);
+    raiz->direito = construirFaixa(valores, contagens, meio + 1, fim, raiz, profundidade + 1, profundidadeVermelha, status);
+    atualizaTamanho(raiz);
 
-    freeArvore(raiz->esquerdo);
-    freeArvore(raiz->direito);
-    free(raiz);
+    return raiz;
+}
+
+/**
+ * Constrói a árvore perfeitamente balanceada de um vetor ordenado inteiro.
+ * @param contagens Ocorrências de cada valor no modo multiconjunto (NULL para uma de cada)
+ */
+No* construirOrdenada(const int *valores, const int *contagens, const int n, Status *status) {
+    // O nível mais profundo de uma árvore perfeitamente balanceada com n nós é floor(log2(n))
+    int profundidadeVermelha = 0;
+    while ((2 << profundidadeVermelha) <= n) {
+        profundidadeVermelha++;
+    }
+
+    return construirFaixa(valores, contagens, 0, n - 1, NULL, 0, profundidadeVermelha, status);
+}
+
+/**
+ * Constrói uma árvore rubro-negra a partir de um vetor de valores em tempo linear,
+ * sem nenhuma rotação ou recoloração. Caso o vetor não esteja ordenado, uma cópia
+ * é ordenada antes da construção (valores repetidos são mantidos, como na inserção;
+ * no modo multiconjunto, viram a contagem do nó).
+ * @param valores Vetor de valores
+ * @param n Quantidade de valores
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
+ * @return Raiz da nova árvore
+ */
+No* construirArvore(const int *valores, const int n, Status *status) {
+    *status = STATUS_OK;
+
+    // Verifica se o vetor já está ordenado (sem repetições, no modo multiconjunto)
+    int ordenado = 1;
+    for (int i = 1; i < n && ordenado; i++) {
+        ordenado = MULTICONJUNTO ? valores[i - 1] < valores[i] : valores[i - 1] <= valores[i];
+    }
+
+    if (ordenado) {
+        return construirOrdenada(valores, NULL, n, status);
+    }
+
+    // Ordena uma cópia do vetor
+    int *copia = malloc(sizeof(int) * n);
+    if (copia == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
+    }
+    memcpy(copia, valores, sizeof(int) * n);
+    qsort(copia, n, sizeof(int), compararInteiros);
+
+#if MULTICONJUNTO
+    // Os valores repetidos são agrupados em um único nó
+    int *contagens = malloc(sizeof(int) * n);
+    if (contagens == NULL) {
+        free(copia);
+        *status = STATUS_SEM_MEMORIA;
+        return NULL;
+    }
+
+    int distintos = 1;
+    contagens[0] = 1;
+    for (int i = 1; i < n; i++) {
+        if (copia[i] != copia[distintos - 1]) {
+            copia[distintos] = copia[i];
+            contagens[distintos++] = 1;
+        } else {
+            contagens[distintos - 1]++;
+        }
+    }
+
+    No *raiz = construirOrdenada(copia, contagens, distintos, status);
+    free(contagens);
+#else
+    No *raiz = construirOrdenada(copia, NULL, n, status);
+#endif
+    free(copia);
+
+    return raiz;
 }
 
 /**
@@ -467,63 +1019,1410 @@ int alturaNo(const No *raiz) {
 }
 
 /* ============================================================
-   FUNÇÕES DE IMPRESSÃO
+   JUNÇÃO E DIVISÃO
    ============================================================ */
 
 /**
- * Calcula o comprimento (quantidade de caracteres) de um número inteiro.
- * É utilizado para alinhar corretamente os valores dos nós na impressão.
- * Considera números negativos e o valor zero.
+ * Calcula a altura negra de uma árvore (quantidade de nós pretos em qualquer
+ * caminho da raiz até uma folha), descendo pelo caminho mais à esquerda
+ * @param raiz Raiz da árvore
+ * @return Altura negra da árvore (0 para a árvore vazia)
  */
-int comprimento(int numero) {
-    const int sinal = numero < 0; // Verifica se o número é negativo
-    int contador = 0;
+int alturaNegra(const No *raiz) {
+    int altura = 0;
 
-    // Caso especial: o número zero possui comprimento 1
-    if (numero == 0) {
-        contador = 1;
-    } else {
-        // Conta quantos dígitos o número possui
-        while (numero != 0) {
-            numero = numero / 10; // Remove o último dígito
-            contador++;           // Incrementa o contador de dígitos
-        }
+    for (; raiz != NULL; raiz = raiz->esquerdo) {
+        if (raiz->cor == PRETO) altura++;
     }
 
-    // Retorna o comprimento total (dígitos + possível sinal)
-    return sinal + contador;
+    return altura;
 }
 
 /**
- * Calcula o maior comprimento entre os valores armazenados nos nós da árvore.
- * Esse valor é utilizado para definir o espaçamento horizontal da impressão.
- * @param raiz Raiz da árvore
- * @return Maior quantidade de caracteres entre os valores dos nós
+ * Junta duas árvores rubro-negras de alturas negras conhecidas usando um nó já
+ * alocado como intermediário. O nó vermelho é pendurado na borda da árvore mais
+ * alta, no primeiro nó preto com a altura negra da outra árvore, e o único
+ * conflito possível (pai vermelho) é corrigido pelo mesmo ajuste da inserção.
+ * Como as alturas já são conhecidas, o custo é O(|alturaEsq - alturaDir| + 1).
+ * Todos os valores de esq devem ser menores ou iguais ao do nó, e os de dir, maiores ou iguais.
+ * @param esq Árvore com os valores menores
+ * @param alturaEsq Altura negra de esq
+ * @param meio Nó intermediário, fora de qualquer árvore
+ * @param dir Árvore com os valores maiores
+ * @param alturaDir Altura negra de dir
+ * @param altura Recebe a altura negra da árvore resultante
+ * @return Raiz da árvore resultante
  */
-int maiorComprimento(const No *raiz) {
-    // Caso base: árvore vazia
-    if (raiz == NULL) {
-        return 0;
+No* juntarAlturas(No *esq, int alturaEsq, No *meio, No *dir, int alturaDir, int *altura) {
+    // Pintar as raízes de preto nunca viola as propriedades da árvore
+    if (esq) {
+        esq->pai = NULL;
+        if (esq->cor == VERMELHO) {
+            esq->cor = PRETO;
+            alturaEsq++;
+        }
+    }
+    if (dir) {
+        dir->pai = NULL;
+        if (dir->cor == VERMELHO) {
+            dir->cor = PRETO;
+            alturaDir++;
+        }
     }
 
-    // Comprimento do valor armazenado no nó atual
-    const int compr = comprimento(raiz->valor);
+    if (alturaEsq == alturaDir) {
+        meio->esquerdo = esq;
+        meio->direito = dir;
+        meio->pai = NULL;
+        meio->cor = PRETO;
+        if (esq) esq->pai = meio;
+        if (dir) dir->pai = meio;
+        atualizaTamanho(meio);
+        *altura = alturaEsq + 1;
+        return meio;
+    }
 
-    // Comprimento máximo das subárvores esquerda e direita
-    const int comprEsq = maiorComprimento(raiz->esquerdo);
-    const int comprDir = maiorComprimento(raiz->direito);
+    // Desce pela borda da árvore mais alta até um nó preto (ou NULL) com a altura negra da outra
+    const int paraDireita = alturaEsq > alturaDir;
+    No *raiz = paraDireita ? esq : dir;
+    No *outra = paraDireita ? dir : esq;
+    const int alturaOutra = paraDireita ? alturaDir : alturaEsq;
+    const int alturaRaiz = paraDireita ? alturaEsq : alturaDir;
+    int nivel = alturaRaiz;
+    No *pai = NULL;
+    No *c = raiz;
 
-    // Retorna o maior valor entre os três
-    return (compr > comprEsq)
-        ? (compr > comprDir ? compr : comprDir)
-        : (comprEsq > comprDir ? comprEsq : comprDir);
-}
+    while (!((c == NULL || c->cor == PRETO) && nivel == alturaOutra)) {
+        if (c->cor == PRETO) nivel--;
+        pai = c;
+        c = paraDireita ? c->direito : c->esquerdo;
+    }
 
-/**
+    // O nó intermediário, vermelho, ocupa o lugar de c
+    meio->cor = VERMELHO;
+    meio->pai = pai;
+    if (paraDireita) {
+        meio->esquerdo = c;
+        meio->direito = outra;
+        pai->direito = meio;
+    } else {
+        meio->esquerdo = outra;
+        meio->direito = c;
+        pai->esquerdo = meio;
+    }
+    if (c) c->pai = meio;
+    if (outra) outra->pai = meio;
+
+    // Os tamanhos mudam apenas no caminho entre o nó intermediário e a raiz
+    for (No *no = meio; no != NULL; no = no->pai) {
+        atualizaTamanho(no);
+    }
+
+    // Um pai sentinela preto impede que o ajuste pinte a raiz de preto por conta própria:
+    // assim, uma raiz vermelha no final indica que a altura negra cresceu
+    No sentinela = {.cor = PRETO};
+    sentinela.esquerdo = raiz;
+    raiz->pai = &sentinela;
+    insercaoAjuste(raiz, meio);
+    raiz = sentinela.esquerdo;
+    raiz->pai = NULL;
+
+    *altura = alturaRaiz;
+    if (raiz->cor == VERMELHO) {
+        raiz->cor = PRETO;
+        (*altura)++;
+    }
+
+    return raiz;
+}
+
+/**
+ * Junta duas árvores rubro-negras usando um nó já alocado como intermediário.
+ * As alturas negras são calculadas uma única vez, e o custo é O(log n).
+ * Todos os valores de esq devem ser menores ou iguais ao do nó, e os de dir, maiores ou iguais.
+ * @param esq Árvore com os valores menores
+ * @param meio Nó intermediário, fora de qualquer árvore
+ * @param dir Árvore com os valores maiores
+ * @return Raiz da árvore resultante
+ */
+No* juntarNo(No *esq, No *meio, No *dir) {
+    int altura;
+    return juntarAlturas(esq, alturaNegra(esq), meio, dir, alturaNegra(dir), &altura);
+}
+
+/**
+ * Junta duas árvores rubro-negras e um valor intermediário (join).
+ * Todos os valores de esq devem ser menores ou iguais a chave, e todos os de dir,
+ * maiores ou iguais; caso contrário, as árvores não são modificadas.
+ * @param esq Árvore com os valores menores
+ * @param chave Valor intermediário, que será inserido na árvore resultante
+ * @param dir Árvore com os valores maiores
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (ordem violada) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore resultante (ou esq, em caso de erro)
+ */
+No* juntar(No *esq, const int chave, No *dir, Status *status) {
+    const No *maiorEsq = maximo(esq);
+    const No *menorDir = minimo(dir);
+
+    if ((maiorEsq && maiorEsq->valor > chave) || (menorDir && menorDir->valor < chave)) {
+        *status = STATUS_INVALIDO;
+        return esq;
+    }
+
+    No *meio = novoNo(chave);
+    if (meio == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return esq;
+    }
+
+    *status = STATUS_OK;
+    return juntarNo(esq, meio, dir);
+}
+
+/**
+ * Separa os filhos de um nó, que passam a ser raízes de árvores independentes
+ */
+void soltarFilhos(No *no) {
+    if (no->esquerdo) no->esquerdo->pai = NULL;
+    if (no->direito) no->direito->pai = NULL;
+}
+
+/**
+ * Retira o nó com o maior valor de uma árvore, sem liberá-lo. Cada nível da borda
+ * direita é juntado de volta com alturas de diferença constante, e o custo total é O(log n).
+ * @param raiz Raiz da árvore (não pode ser NULL)
+ * @param altura Altura negra da árvore
+ * @param maior Recebe o nó retirado
+ * @param alturaResto Recebe a altura negra da árvore restante
+ * @return Nova raiz da árvore
+ */
+No* retirarMaximo(No *raiz, const int altura, No **maior, int *alturaResto) {
+    No *esq = raiz->esquerdo;
+    No *dir = raiz->direito;
+    const int alturaFilhos = altura - (raiz->cor == PRETO);
+    soltarFilhos(raiz);
+
+    if (dir == NULL) {
+        *maior = raiz;
+        *alturaResto = alturaFilhos;
+        if (esq && esq->cor == VERMELHO) {
+            esq->cor = PRETO;
+            (*alturaResto)++;
+        }
+        return esq;
+    }
+
+    int alturaDir;
+    No *resto = retirarMaximo(dir, alturaFilhos, maior, &alturaDir);
+    return juntarAlturas(esq, alturaFilhos, raiz, resto, alturaDir, alturaResto);
+}
+
+/**
+ * Junta duas árvores rubro-negras de alturas negras conhecidas sem valor
+ * intermediário, usando o maior nó de esq como intermediário.
+ * Todos os valores de esq devem ser menores ou iguais aos de dir.
+ * @param altura Recebe a altura negra da árvore resultante
+ * @return Raiz da árvore resultante
+ */
+No* juntarArvoresAlturas(No *esq, const int alturaEsq, No *dir, const int alturaDir, int *altura) {
+    if (esq == NULL) {
+        *altura = alturaDir;
+        if (dir) {
+            dir->pai = NULL;
+            if (dir->cor == VERMELHO) {
+                dir->cor = PRETO;
+                (*altura)++;
+            }
+        }
+        return dir;
+    }
+
+    No *meio;
+    int alturaResto;
+    esq = retirarMaximo(esq, alturaEsq, &meio, &alturaResto);
+    return juntarAlturas(esq, alturaResto, meio, dir, alturaDir, altura);
+}
+
+/**
+ * Junta duas árvores rubro-negras sem valor intermediário, em O(log n).
+ * Todos os valores de esq devem ser menores ou iguais aos de dir.
+ * @return Raiz da árvore resultante
+ */
+No* juntarArvores(No *esq, No *dir) {
+    int altura;
+    return juntarArvoresAlturas(esq, alturaNegra(esq), dir, alturaNegra(dir), &altura);
+}
+
+/**
+ * Divide uma árvore rubro-negra de altura negra conhecida. As alturas das partes
+ * são devolvidas junto com elas, de modo que cada junção custa apenas a diferença
+ * entre as alturas, e a soma dessas diferenças ao longo da descida é O(log n).
+ * @param altura Altura negra de raiz
+ * @param alturaMenores Recebe a altura negra da árvore com os valores menores
+ * @param alturaDireita Recebe a altura negra da árvore com os valores maiores ou iguais
+ */
+No* dividirAlturas(No *raiz, const int altura, const int chave, No **direita, int *alturaMenores, int *alturaDireita) {
+    if (raiz == NULL) {
+        *direita = NULL;
+        *alturaMenores = *alturaDireita = 0;
+        return NULL;
+    }
+
+    No *esq = raiz->esquerdo;
+    No *dir = raiz->direito;
+    const int alturaFilhos = altura - (raiz->cor == PRETO);
+    soltarFilhos(raiz);
+
+    CONTAR(comparacoes);
+    if (chave <= raiz->valor) {
+        // A raiz e a subárvore direita ficam na parte direita
+        No *meioDir;
+        int alturaMeio;
+        No *menores = dividirAlturas(esq, alturaFilhos, chave, &meioDir, alturaMenores, &alturaMeio);
+        *direita = juntarAlturas(meioDir, alturaMeio, raiz, dir, alturaFilhos, alturaDireita);
+        return menores;
+    }
+
+    // A raiz e a subárvore esquerda ficam na parte esquerda
+    int alturaMeio;
+    No *meioEsq = dividirAlturas(dir, alturaFilhos, chave, direita, &alturaMeio, alturaDireita);
+    return juntarAlturas(esq, alturaFilhos, raiz, meioEsq, alturaMeio, alturaMenores);
+}
+
+/**
+ * Divide uma árvore rubro-negra em duas (split): uma com os valores menores que
+ * chave e outra com os valores maiores ou iguais a ela, em O(log n).
+ * Nenhum nó é alocado ou liberado.
+ * @param raiz Raiz da árvore que será dividida
+ * @param chave Valor de corte
+ * @param direita Recebe a árvore com os valores maiores ou iguais a chave
+ * @return Raiz da árvore com os valores menores que chave
+ */
+No* dividir(No *raiz, const int chave, No **direita) {
+    int alturaMenores, alturaDireita;
+    return dividirAlturas(raiz, alturaNegra(raiz), chave, direita, &alturaMenores, &alturaDireita);
+}
+
+/* ============================================================
+   OPERAÇÕES DE CONJUNTO EM PARALELO
+   ============================================================ */
+
+/*
+ * União, interseção e diferença por divisão e conquista: a raiz de uma árvore
+ * divide a outra (separar), as metades são resolvidas de forma independente e
+ * os resultados são juntados novamente. Enquanto a thread atual resolve as
+ * metades direitas, as esquerdas são entregues a um grupo de threads.
+ * Nenhum nó é alocado: as árvores de entrada são consumidas, e os nós que
+ * sobram são devolvidos ao pool sob uma trava.
+ * As árvores são tratadas como conjuntos: cópias de um valor presente nas
+ * duas árvores são descartadas.
+ */
+
+#define PARALELO_ALTURA_MINIMA 7 // altura negra abaixo da qual a subárvore é resolvida na própria thread
+#define THREADS_MAXIMO 64
+
+typedef enum {
+    CONJUNTO_UNIAO,
+    CONJUNTO_INTERSECAO,
+    CONJUNTO_DIFERENCA
+} OperacaoConjunto;
+
+/**
+ * Subproblema entregue ao grupo de threads. Fica na pilha de quem o criou,
+ * que sempre espera a sua conclusão antes de retornar.
+ */
+typedef struct tarefa {
+    OperacaoConjunto operacao;
+    No *a, *b;
+    int alturaA, alturaB;    // alturas negras de a e b
+    No *resultado;
+    int alturaResultado;
+    int concluida;
+    struct tarefa *proxima;
+} Tarefa;
+
+/**
+ * Grupo de threads com uma única pilha de tarefas, protegida por uma trava.
+ */
+typedef struct {
+    pthread_t threads[THREADS_MAXIMO];
+    int quantidade;          // threads auxiliares em execução (0 = execução sequencial)
+    int encerrar;
+    Tarefa *fila;            // tarefas aguardando uma thread
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;    // nova tarefa, tarefa concluída ou encerramento
+} GrupoThreads;
+
+static GrupoThreads grupo = {.trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER};
+
+/**
+ * Trava que protege o pool de nós enquanto as threads devolvem nós.
+ */
+static pthread_mutex_t travaPool = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Devolve ao pool todos os nós de uma subárvore
+ */
+void liberarSubarvore(No *raiz) {
+    if (raiz == NULL) return;
+
+    liberarSubarvore(raiz->esquerdo);
+    liberarSubarvore(raiz->direito);
+    poolLiberar(&poolNos, raiz);
+}
+
+/**
+ * Devolve ao pool todos os nós de uma subárvore, podendo ser chamada por várias threads
+ */
+void descartarSubarvore(No *raiz) {
+    if (raiz == NULL) return;
+
+    pthread_mutex_lock(&travaPool);
+    liberarSubarvore(raiz);
+    pthread_mutex_unlock(&travaPool);
+}
+
+/**
+ * Devolve um único nó ao pool (sem os filhos), podendo ser chamada por várias threads
+ */
+void descartarNo(No *no) {
+    if (no == NULL) return;
+
+    pthread_mutex_lock(&travaPool);
+    poolLiberar(&poolNos, no);
+    pthread_mutex_unlock(&travaPool);
+}
+
+/**
+ * Divide uma árvore rubro-negra em três partes: os valores menores que chave,
+ * um nó com a própria chave (quando existir) e os valores maiores que ela.
+ * As demais cópias da chave são devolvidas ao pool. Como em dividirAlturas, as
+ * alturas negras acompanham as partes, e o custo é O(log n).
+ * @param raiz Raiz da árvore que será dividida
+ * @param altura Altura negra de raiz
+ * @param chave Valor de corte
+ * @param direita Recebe a árvore com os valores maiores que chave
+ * @param igual Recebe um nó com o valor igual a chave, fora de qualquer árvore, ou NULL
+ * @param alturaMenores Recebe a altura negra da árvore com os valores menores
+ * @param alturaDireita Recebe a altura negra de direita
+ * @return Raiz da árvore com os valores menores que chave
+ */
+No* separar(No *raiz, const int altura, const int chave, No **direita, No **igual, int *alturaMenores, int *alturaDireita) {
+    if (raiz == NULL) {
+        *direita = NULL;
+        *igual = NULL;
+        *alturaMenores = *alturaDireita = 0;
+        return NULL;
+    }
+
+    No *esq = raiz->esquerdo;
+    No *dir = raiz->direito;
+    const int alturaFilhos = altura - (raiz->cor == PRETO);
+    soltarFilhos(raiz);
+
+    if (chave == raiz->valor) {
+        // Com valores repetidos, outras cópias podem estar em qualquer uma das subárvores
+        No *copiaEsq, *copiaDir, *nenhum;
+        int alturaNenhum, alturaIgnorada;
+        No *menores = separar(esq, alturaFilhos, chave, &nenhum, &copiaEsq, alturaMenores, &alturaNenhum);
+        separar(dir, alturaFilhos, chave, direita, &copiaDir, &alturaIgnorada, alturaDireita);
+        descartarNo(copiaEsq);
+        descartarNo(copiaDir);
+
+        *igual = raiz;
+        return menores;
+    }
+
+    int alturaMeio;
+    if (chave < raiz->valor) {
+        No *meioDir;
+        No *menores = separar(esq, alturaFilhos, chave, &meioDir, igual, alturaMenores, &alturaMeio);
+        *direita = juntarAlturas(meioDir, alturaMeio, raiz, dir, alturaFilhos, alturaDireita);
+        return menores;
+    }
+
+    No *meioEsq = separar(dir, alturaFilhos, chave, direita, igual, &alturaMeio, alturaDireita);
+    return juntarAlturas(esq, alturaFilhos, raiz, meioEsq, alturaMeio, alturaMenores);
+}
+
+No* operacaoConjunto(OperacaoConjunto operacao, No *a, int alturaA, No *b, int alturaB, int *altura);
+
+/**
+ * Resolve uma tarefa e avisa quem estiver esperando por ela
+ */
+void executarTarefa(Tarefa *tarefa) {
+    int altura;
+    No *resultado = operacaoConjunto(tarefa->operacao, tarefa->a, tarefa->alturaA, tarefa->b, tarefa->alturaB, &altura);
+
+    pthread_mutex_lock(&grupo.trava);
+    tarefa->resultado = resultado;
+    tarefa->alturaResultado = altura;
+    tarefa->concluida = 1;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Retira a tarefa mais recente da pilha. Deve ser chamada com a trava do grupo
+ */
+Tarefa* retirarTarefa(void) {
+    Tarefa *tarefa = grupo.fila;
+    if (tarefa) grupo.fila = tarefa->proxima;
+    return tarefa;
+}
+
+/**
+ * Laço das threads auxiliares: resolve tarefas até o encerramento do grupo
+ */
+void* trabalhador(void *argumento) {
+    (void) argumento;
+
+    pthread_mutex_lock(&grupo.trava);
+    while (!grupo.encerrar) {
+        Tarefa *tarefa = retirarTarefa();
+
+        if (tarefa == NULL) {
+            pthread_cond_wait(&grupo.sinal, &grupo.trava);
+            continue;
+        }
+
+        pthread_mutex_unlock(&grupo.trava);
+        executarTarefa(tarefa);
+        pthread_mutex_lock(&grupo.trava);
+    }
+    pthread_mutex_unlock(&grupo.trava);
+
+    return NULL;
+}
+
+/**
+ * Coloca uma tarefa na pilha, para que qualquer thread livre a resolva
+ */
+void submeter(Tarefa *tarefa) {
+    pthread_mutex_lock(&grupo.trava);
+    tarefa->concluida = 0;
+    tarefa->proxima = grupo.fila;
+    grupo.fila = tarefa;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Espera a conclusão de uma tarefa. Enquanto espera, a thread resolve as
+ * tarefas pendentes (normalmente a própria tarefa, se ninguém a pegou ainda),
+ * o que evita que todas as threads fiquem bloqueadas esperando umas pelas outras
+ */
+void aguardar(Tarefa *tarefa) {
+    pthread_mutex_lock(&grupo.trava);
+    while (!tarefa->concluida) {
+        Tarefa *pendente = retirarTarefa();
+
+        if (pendente) {
+            pthread_mutex_unlock(&grupo.trava);
+            executarTarefa(pendente);
+            pthread_mutex_lock(&grupo.trava);
+        } else {
+            pthread_cond_wait(&grupo.sinal, &grupo.trava);
+        }
+    }
+    pthread_mutex_unlock(&grupo.trava);
+}
+
+/**
+ * Inicia as threads auxiliares; a thread que chama também trabalha, portanto
+ * são criadas threads - 1 auxiliares
+ * @param threads Quantidade total de threads
+ */
+void iniciarGrupo(int threads) {
+    if (threads > THREADS_MAXIMO + 1) threads = THREADS_MAXIMO + 1;
+
+    grupo.encerrar = 0;
+    grupo.quantidade = 0;
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&grupo.threads[grupo.quantidade], NULL, trabalhador, NULL) != 0) break;
+        grupo.quantidade++;
+    }
+}
+
+/**
+ * Encerra e aguarda todas as threads auxiliares
+ */
+void encerrarGrupo(void) {
+    pthread_mutex_lock(&grupo.trava);
+    grupo.encerrar = 1;
+    pthread_cond_broadcast(&grupo.sinal);
+    pthread_mutex_unlock(&grupo.trava);
+
+    for (int i = 0; i < grupo.quantidade; i++) {
+        pthread_join(grupo.threads[i], NULL);
+    }
+    grupo.quantidade = 0;
+}
+
+/**
+ * Calcula uma operação de conjunto entre duas árvores rubro-negras, consumindo as duas
+ * No modo multiconjunto, a união fica com a maior contagem de cada valor, a
+ * interseção com a menor, e a diferença com as ocorrências de a que excedem as de b.
+ * As alturas negras acompanham as árvores durante toda a recursão, de modo que
+ * nenhuma junção ou divisão precisa recalculá-las. Com m <= n valores nas duas
+ * árvores, o trabalho total é O(m log(n/m + 1)).
+ * @param operacao União, interseção ou diferença (a - b)
+ * @param a Primeira árvore
+ * @param alturaA Altura negra de a
+ * @param b Segunda árvore
+ * @param alturaB Altura negra de b
+ * @param altura Recebe a altura negra da árvore resultante
+ * @return Raiz da árvore resultante
+ */
+No* operacaoConjunto(OperacaoConjunto operacao, No *a, int alturaA, No *b, int alturaB, int *altura) {
+    if (a == NULL || b == NULL) {
+        switch (operacao) {
+            case CONJUNTO_UNIAO:
+                *altura = a ? alturaA : alturaB;
+                return a ? a : b;
+            case CONJUNTO_INTERSECAO:
+                descartarSubarvore(a ? a : b);
+                *altura = 0;
+                return NULL;
+            default:
+                descartarSubarvore(b);
+                *altura = alturaA;
+                return a;
+        }
+    }
+
+    // A raiz de b divide a árvore a
+    No *esqB = b->esquerdo;
+    No *dirB = b->direito;
+    const int alturaFilhosB = alturaB - (b->cor == PRETO);
+    soltarFilhos(b);
+    No *dirA, *igual;
+    int alturaEsqA, alturaDirA;
+    No *esqA = separar(a, alturaA, b->valor, &dirA, &igual, &alturaEsqA, &alturaDirA);
+
+    // As metades são independentes: a esquerda vai para o grupo quando é grande o bastante
+    No *esq, *dir;
+    int alturaEsq, alturaDir;
+    if (grupo.quantidade > 0 && alturaB >= PARALELO_ALTURA_MINIMA) {
+        Tarefa tarefa = {operacao, esqA, esqB, alturaEsqA, alturaFilhosB, NULL, 0, 0, NULL};
+        submeter(&tarefa);
+        dir = operacaoConjunto(operacao, dirA, alturaDirA, dirB, alturaFilhosB, &alturaDir);
+        aguardar(&tarefa);
+        esq = tarefa.resultado;
+        alturaEsq = tarefa.alturaResultado;
+    } else {
+        esq = operacaoConjunto(operacao, esqA, alturaEsqA, esqB, alturaFilhosB, &alturaEsq);
+        dir = operacaoConjunto(operacao, dirA, alturaDirA, dirB, alturaFilhosB, &alturaDir);
+    }
+
+    // A raiz de b entra no resultado conforme a operação e a presença do valor em a
+    switch (operacao) {
+        case CONJUNTO_UNIAO:
+#if MULTICONJUNTO
+            if (igual && igual->contagem > b->contagem) b->contagem = igual->contagem;
+#endif
+            descartarNo(igual);
+            return juntarAlturas(esq, alturaEsq, b, dir, alturaDir, altura);
+
+        case CONJUNTO_INTERSECAO:
+            if (igual) {
+#if MULTICONJUNTO
+                if (igual->contagem < b->contagem) b->contagem = igual->contagem;
+#endif
+                descartarNo(igual);
+                return juntarAlturas(esq, alturaEsq, b, dir, alturaDir, altura);
+            }
+            descartarNo(b);
+            return juntarArvoresAlturas(esq, alturaEsq, dir, alturaDir, altura);
+
+        default:
+#if MULTICONJUNTO
+            if (igual && igual->contagem > b->contagem) {
+                igual->contagem -= b->contagem;
+                descartarNo(b);
+                return juntarAlturas(esq, alturaEsq, igual, dir, alturaDir, altura);
+            }
+#endif
+            descartarNo(igual);
+            descartarNo(b);
+            return juntarArvoresAlturas(esq, alturaEsq, dir, alturaDir, altura);
+    }
+}
+
+/**
+ * Executa uma operação de conjunto usando várias threads.
+ * As árvores de entrada são consumidas e não devem mais ser usadas
+ * @param operacao União, interseção ou diferença (a - b)
+ * @param a Primeira árvore
+ * @param b Segunda árvore
+ * @param threads Quantidade de threads (1 para execução sequencial)
+ * @return Raiz da árvore resultante
+ */
+No* conjuntoParalelo(OperacaoConjunto operacao, No *a, No *b, const int threads) {
+    int altura;
+    iniciarGrupo(threads);
+    No *resultado = operacaoConjunto(operacao, a, alturaNegra(a), b, alturaNegra(b), &altura);
+    encerrarGrupo();
+
+    // Subárvores devolvidas sem junção podem ter a raiz vermelha
+    if (resultado) {
+        resultado->pai = NULL;
+        resultado->cor = PRETO;
+    }
+
+    return resultado;
+}
+
+/**
+ * Retorna a quantidade de processadores disponíveis (1 quando indisponível)
+ */
+int processadores(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    const long quantidade = sysconf(_SC_NPROCESSORS_ONLN);
+    return quantidade > 0 ? (int) quantidade : 1;
+#else
+    return 1;
+#endif
+}
+
+#if ESTATISTICA_ORDEM
+/* ============================================================
+   ESTATÍSTICAS DE ORDEM
+   ============================================================ */
+
+/**
+ * Conta os valores da árvore menores que um limite (ou menores ou iguais a ele),
+ * descendo um único caminho da raiz até uma folha. Valores repetidos são todos contados.
+ * @param raiz Raiz da árvore
+ * @param limite Valor de referência
+ * @param incluirIgual Indica se os valores iguais ao limite também são contados
+ * @return Quantidade de valores dentro do limite
+ */
+int contarAte(const No *raiz, const int limite, const int incluirIgual) {
+    int total = 0;
+
+    while (raiz != NULL) {
+        if (limite < raiz->valor || (limite == raiz->valor && !incluirIgual)) {
+            raiz = raiz->esquerdo;
+        } else {
+            // O nó e toda a sua subárvore esquerda estão dentro do limite
+            total += tamanhoNo(raiz->esquerdo) + ocorrencias(raiz);
+            raiz = raiz->direito;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Calcula a posição (rank) de um valor: a quantidade de valores menores que ele
+ * @param raiz Raiz da árvore
+ * @param valor Valor de referência, que não precisa estar presente na árvore
+ * @return Quantidade de valores da árvore menores que valor
+ */
+int posicao(const No *raiz, const int valor) {
+    return contarAte(raiz, valor, 0);
+}
+
+/**
+ * Busca o k-ésimo menor valor da árvore (select)
+ * @param raiz Raiz da árvore
+ * @param k Posição do valor em ordem crescente, a partir de 1
+ * @return O nó com o k-ésimo menor valor ou NULL, caso k esteja fora do intervalo [1, n]
+ */
+No* selecionar(No *raiz, int k) {
+    while (raiz != NULL) {
+        const int esquerda = tamanhoNo(raiz->esquerdo);
+
+        if (k <= esquerda) {
+            raiz = raiz->esquerdo;
+        } else if (k <= esquerda + ocorrencias(raiz)) {
+            return raiz;
+        } else {
+            k -= esquerda + ocorrencias(raiz);
+            raiz = raiz->direito;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Conta os valores da árvore dentro do intervalo fechado [inicio, fim]
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @return Quantidade de valores no intervalo (0 se inicio > fim)
+ */
+int contarFaixa(const No *raiz, const int inicio, const int fim) {
+    if (inicio > fim) return 0;
+    return contarAte(raiz, fim, 1) - contarAte(raiz, inicio, 0);
+}
+#endif
+
+/* ============================================================
+   CURSORES E CONSULTAS POR FAIXA
+   ============================================================ */
+
+/**
+ * Retorna o nó seguinte em ordem crescente, subindo pelos ponteiros pai quando necessário
+ * @param no Nó de referência
+ * @return Sucessor do nó ou NULL, caso ele seja o maior da árvore
+ */
+No* sucessor(No *no) {
+    if (no->direito) {
+        return minimo(no->direito);
+    }
+
+    // Sobe até chegar a um ancestral pela sua subárvore esquerda
+    while (no->pai && no->pai->direito == no) {
+        no = no->pai;
+    }
+    return no->pai;
+}
+
+/**
+ * Retorna o nó anterior em ordem crescente, subindo pelos ponteiros pai quando necessário
+ * @param no Nó de referência
+ * @return Predecessor do nó ou NULL, caso ele seja o menor da árvore
+ */
+No* predecessor(No *no) {
+    if (no->esquerdo) {
+        return maximo(no->esquerdo);
+    }
+
+    // Sobe até chegar a um ancestral pela sua subárvore direita
+    while (no->pai && no->pai->esquerdo == no) {
+        no = no->pai;
+    }
+    return no->pai;
+}
+
+/**
+ * Cursor para o percurso em ordem da árvore, sem alocação e sem recursão.
+ * Como cada nó conhece o seu pai, basta guardar o nó atual.
+ * O cursor deixa de ser válido quando a árvore é modificada.
+ */
+typedef struct {
+    No *atual; // NULL quando o cursor está fora da árvore
+} Cursor;
+
+/**
+ * Retorna o nó onde o cursor está posicionado
+ * @return Nó atual ou NULL, caso o cursor tenha saído da árvore
+ */
+No* cursorAtual(const Cursor *cursor) {
+    return cursor->atual;
+}
+
+/**
+ * Posiciona o cursor no primeiro valor maior ou igual ao informado (seek).
+ * Havendo valores repetidos, o cursor fica no primeiro deles.
+ * @param cursor Cursor que será posicionado
+ * @param raiz Raiz da árvore
+ * @param valor Valor de referência
+ * @return O nó onde o cursor foi posicionado ou NULL, caso todos os valores sejam menores
+ */
+No* cursorPosicionar(Cursor *cursor, No *raiz, const int valor) {
+    cursor->atual = NULL;
+
+    while (raiz != NULL) {
+        if (valor <= raiz->valor) {
+            cursor->atual = raiz;
+            raiz = raiz->esquerdo;
+        } else {
+            raiz = raiz->direito;
+        }
+    }
+
+    return cursor->atual;
+}
+
+/**
+ * Posiciona o cursor no menor valor da árvore
+ * @return O nó com o menor valor ou NULL, caso a árvore esteja vazia
+ */
+No* cursorInicio(Cursor *cursor, No *raiz) {
+    cursor->atual = minimo(raiz);
+    return cursor->atual;
+}
+
+/**
+ * Posiciona o cursor no maior valor da árvore
+ * @return O nó com o maior valor ou NULL, caso a árvore esteja vazia
+ */
+No* cursorFim(Cursor *cursor, No *raiz) {
+    cursor->atual = maximo(raiz);
+    return cursor->atual;
+}
+
+/**
+ * Avança o cursor para o próximo valor em ordem crescente
+ * @return O novo nó atual ou NULL, caso o cursor tenha passado do maior valor
+ */
+No* cursorProximo(Cursor *cursor) {
+    if (cursor->atual) cursor->atual = sucessor(cursor->atual);
+    return cursor->atual;
+}
+
+/**
+ * Recua o cursor para o valor anterior em ordem crescente
+ * @return O novo nó atual ou NULL, caso o cursor tenha passado do menor valor
+ */
+No* cursorAnterior(Cursor *cursor) {
+    if (cursor->atual) cursor->atual = predecessor(cursor->atual);
+    return cursor->atual;
+}
+
+/**
+ * Busca o maior valor menor ou igual ao informado (floor)
+ * @return O nó encontrado ou NULL, caso todos os valores sejam maiores
+ */
+No* piso(No *raiz, const int valor) {
+    No *candidato = NULL;
+
+    while (raiz != NULL) {
+        if (raiz->valor <= valor) {
+            candidato = raiz;
+            raiz = raiz->direito;
+        } else {
+            raiz = raiz->esquerdo;
+        }
+    }
+
+    return candidato;
+}
+
+/**
+ * Busca o menor valor maior ou igual ao informado (ceiling)
+ * @return O nó encontrado ou NULL, caso todos os valores sejam menores
+ */
+No* teto(No *raiz, const int valor) {
+    Cursor cursor;
+    return cursorPosicionar(&cursor, raiz, valor);
+}
+
+/**
+ * Função chamada para cada valor de uma consulta por faixa
+ * @param valor Valor visitado
+ * @param contexto Ponteiro repassado sem alteração pela consulta
+ * @return 0 para continuar a consulta ou qualquer outro valor para interrompê-la
+ */
+typedef int (*Visitante)(int valor, void *contexto);
+
+/**
+ * Visita, em ordem crescente, todos os valores do intervalo fechado [inicio, fim]
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @param visitante Função chamada para cada valor
+ * @param contexto Ponteiro repassado ao visitante
+ * @return Quantidade de valores visitados
+ */
+int visitarFaixa(No *raiz, const int inicio, const int fim, Visitante visitante, void *contexto) {
+    Cursor cursor;
+    int total = 0;
+
+    for (const No *no = cursorPosicionar(&cursor, raiz, inicio); no && no->valor <= fim; no = cursorProximo(&cursor)) {
+        // No modo multiconjunto, o valor é visitado uma vez para cada ocorrência
+        for (int c = 0; c < ocorrencias(no); c++) {
+            total++;
+            if (visitante(no->valor, contexto)) return total;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Copia, em ordem crescente, os valores do intervalo fechado [inicio, fim] para um vetor
+ * @param raiz Raiz da árvore
+ * @param inicio Início do intervalo
+ * @param fim Fim do intervalo
+ * @param destino Vetor que receberá os valores
+ * @param capacidade Quantidade máxima de valores copiados
+ * @return Quantidade de valores copiados
+ */
+int copiarFaixa(No *raiz, const int inicio, const int fim, int *destino, const int capacidade) {
+    Cursor cursor;
+    int total = 0;
+
+    for (const No *no = cursorPosicionar(&cursor, raiz, inicio); no && no->valor <= fim && total < capacidade; no = cursorProximo(&cursor)) {
+        for (int c = 0; c < ocorrencias(no) && total < capacidade; c++) destino[total++] = no->valor;
+    }
+
+    return total;
+}
+
+/* ============================================================
+   ÁRVORE PARTICIONADA POR FAIXAS DE CHAVES
+   ============================================================ */
+
+/*
+ * Contêiner para várias threads escritoras: o espaço das chaves é dividido em
+ * faixas contíguas (fatias), cada uma com a sua árvore rubro-negra, a sua trava
+ * e o seu pool de nós, de modo que escritas em fatias diferentes não disputam nada.
+ * O início de uma fatia só muda com as travas dela e da fatia anterior, quando
+ * uma fatia fica muito maior que a média e os valores são redistribuídos.
+ */
+#define FATIAS_MAXIMO     64
+#define FATIA_MINIMA      1024 // fatias menores que isso nunca são redistribuídas
+#define FATIA_FATOR       2    // uma fatia é redistribuída ao passar de FATIA_FATOR vezes a média das outras
+#define FATIA_VERIFICACAO 64   // a média só é conferida a cada FATIA_VERIFICACAO inserções na fatia
+
+/**
+ * Uma faixa de chaves [inicio, inicio da próxima fatia), com a sua própria árvore.
+ * Cada fatia começa em uma nova linha de cache, para que as travas não a compartilhem.
+ */
+typedef struct {
+    _Alignas(64) pthread_mutex_t trava;
+    No *raiz;
+    atomic_int quantidade; // lida sem trava apenas como estimativa
+    Pool pool;
+    atomic_int inicio;     // lido sem trava para localizar a fatia, alterado com as travas
+} Fatia;
+
+typedef struct {
+    Fatia fatias[FATIAS_MAXIMO];
+    int quantidade; // fatias em uso
+} ArvoreParticionada;
+
+static ArvoreParticionada particionada;
+
+/**
+ * Divide o espaço das chaves em fatias de mesma largura
+ * @param fatias Quantidade de fatias (entre 1 e FATIAS_MAXIMO)
+ */
+void iniciarParticionada(int fatias) {
+    if (fatias < 1) fatias = 1;
+    if (fatias > FATIAS_MAXIMO) fatias = FATIAS_MAXIMO;
+
+    particionada.quantidade = fatias;
+    for (int i = 0; i < fatias; i++) {
+        Fatia *fatia = &particionada.fatias[i];
+        pthread_mutex_init(&fatia->trava, NULL);
+        fatia->raiz = NULL;
+        atomic_init(&fatia->quantidade, 0);
+        fatia->pool = (Pool) {NULL, 0, NULL};
+        atomic_init(&fatia->inicio, (int) (INT_MIN + (long long) i * ((long long) UINT32_MAX + 1) / fatias));
+    }
+}
+
+/**
+ * Localiza, sem travas, a última fatia que começa antes de um valor
+ * @return Índice da fatia
+ */
+int localizarFatia(const int valor) {
+    int esq = 0, dir = particionada.quantidade - 1;
+
+    while (esq < dir) {
+        const int meio = (esq + dir + 1) / 2;
+        if (atomic_load_explicit(&particionada.fatias[meio].inicio, memory_order_relaxed) <= valor) {
+            esq = meio;
+        } else {
+            dir = meio - 1;
+        }
+    }
+
+    return esq;
+}
+
+/**
+ * Indica se um valor pertence a uma fatia. Com a trava da fatia, o resultado
+ * não muda, pois os dois limites só mudam com essa trava.
+ */
+int pertenceFatia(const int i, const int valor) {
+    return atomic_load(&particionada.fatias[i].inicio) <= valor &&
+           (i + 1 == particionada.quantidade || valor < atomic_load(&particionada.fatias[i + 1].inicio));
+}
+
+/**
+ * Trava a fatia de um valor. Se os limites mudarem entre a localização e a
+ * trava, a fatia é localizada de novo.
+ * @return Índice da fatia travada
+ */
+int travarFatia(const int valor) {
+    while (1) {
+        const int i = localizarFatia(valor);
+        pthread_mutex_lock(&particionada.fatias[i].trava);
+        if (pertenceFatia(i, valor)) return i;
+        pthread_mutex_unlock(&particionada.fatias[i].trava);
+    }
+}
+
+/**
+ * Soma os tamanhos de todas as fatias. Sem as travas, o total é apenas uma estimativa.
+ */
+long long totalFatias(void) {
+    long long total = 0;
+
+    for (int i = 0; i < particionada.quantidade; i++) {
+        total += atomic_load_explicit(&particionada.fatias[i].quantidade, memory_order_relaxed);
+    }
+
+    return total;
+}
+
+/**
+ * Indica se uma fatia ficou muito maior que a média das outras fatias e deve ser redistribuída
+ */
+int fatiaGrande(const int i) {
+    const int quantidade = particionada.fatias[i].quantidade;
+    return particionada.quantidade > 1 && quantidade > FATIA_MINIMA &&
+           (long long) quantidade * (particionada.quantidade - 1) > FATIA_FATOR * (totalFatias() - quantidade);
+}
+
+/**
+ * Busca os valores que dividem uma árvore em partes de mesmo tamanho (em tempo
+ * linear quando compilada sem as estatísticas de ordem)
+ * @param raiz Raiz da árvore
+ * @param total Quantidade de valores da árvore
+ * @param partes Quantidade de partes
+ * @param limites Recebe, para cada parte j > 0, o menor valor da parte
+ * @param menores Recebe, para cada parte j > 0, a quantidade de valores menores que limites[j]
+ */
+void quantisFatias(No *raiz, const int total, const int partes, int *limites, int *menores) {
+#if ESTATISTICA_ORDEM
+    for (int j = 1; j < partes; j++) {
+        limites[j] = selecionar(raiz, (int) ((long long) total * j / partes) + 1)->valor;
+        menores[j] = posicao(raiz, limites[j]);
+    }
+#else
+    // Com valores repetidos, os menores são os que vêm antes da primeira cópia do limite
+    Cursor cursor;
+    No *no = cursorInicio(&cursor, raiz);
+    int antes = 0, menoresNo = 0;
+    for (int j = 1; j < partes; j++) {
+        const int k = (int) ((long long) total * j / partes) + 1;
+        while (antes + ocorrencias(no) < k) {
+            antes += ocorrencias(no);
+            No *proximo = cursorProximo(&cursor);
+            if (proximo->valor != no->valor) menoresNo = antes;
+            no = proximo;
+        }
+        limites[j] = no->valor;
+        menores[j] = menoresNo;
+    }
+#endif
+}
+
+/**
+ * Escolhe as fatias que dividirão os valores de uma fatia grande: a faixa cresce
+ * a partir dela, sempre pela vizinha com menos valores, até que a sua média não
+ * passe da média de todas as fatias. Sem as travas, os tamanhos são apenas estimativas.
+ * @param i Índice da fatia grande
+ * @param primeira Recebe o índice da primeira fatia da faixa
+ * @param ultima Recebe o índice da última fatia da faixa
+ */
+void faixaRedistribuicao(const int i, int *primeira, int *ultima) {
+    const long long total = totalFatias();
+    const int fatias = particionada.quantidade;
+    int p = i, q = i;
+    long long soma = particionada.fatias[i].quantidade;
+
+    while (q - p + 1 < fatias && soma * fatias > total * (q - p + 1)) {
+        if (q + 1 == fatias || (p > 0 && particionada.fatias[p - 1].quantidade < particionada.fatias[q + 1].quantidade)) {
+            soma += particionada.fatias[--p].quantidade;
+        } else {
+            soma += particionada.fatias[++q].quantidade;
+        }
+    }
+
+    *primeira = p;
+    *ultima = q;
+}
+
+/**
+ * Redistribui os valores de uma fatia grande com as fatias vizinhas: as árvores
+ * da faixa escolhida são juntadas e divididas em partes de mesmo tamanho, cujos
+ * menores valores passam a ser os novos limites. Com k fatias na faixa, como
+ * juntar e dividir custam O(log n), a redistribuição custa O(k log n) com as
+ * estatísticas de ordem.
+ * @param i Índice da fatia (sem trava)
+ */
+void redistribuirFatia(const int i) {
+    int primeira, ultima;
+    faixaRedistribuicao(i, &primeira, &ultima);
+
+    // As travas são obtidas sempre na ordem das fatias
+    for (int j = primeira; j <= ultima; j++) {
+        pthread_mutex_lock(&particionada.fatias[j].trava);
+    }
+
+    // Com as travas, os tamanhos da faixa são exatos e a decisão é conferida
+    if (fatiaGrande(i)) {
+        const int partes = ultima - primeira + 1;
+        Fatia *fatias = &particionada.fatias[primeira];
+        No *juntas = NULL;
+        int total = 0;
+        for (int j = 0; j < partes; j++) {
+            juntas = juntarArvores(juntas, fatias[j].raiz);
+            total += fatias[j].quantidade;
+        }
+
+        int limites[FATIAS_MAXIMO], menores[FATIAS_MAXIMO + 1];
+        quantisFatias(juntas, total, partes, limites, menores);
+        menores[0] = 0;
+        menores[partes] = total;
+
+        // As partes são retiradas da direita para a esquerda, cada uma com os valores a partir do seu limite
+        for (int j = partes - 1; j > 0; j--) {
+            juntas = dividir(juntas, limites[j], &fatias[j].raiz);
+            fatias[j].quantidade = menores[j + 1] - menores[j];
+            atomic_store(&fatias[j].inicio, limites[j]);
+        }
+        fatias[0].raiz = juntas;
+        fatias[0].quantidade = menores[1];
+    }
+
+    for (int j = ultima; j >= primeira; j--) {
+        pthread_mutex_unlock(&particionada.fatias[j].trava);
+    }
+}
+
+/**
+ * Insere um valor na árvore particionada, podendo ser chamada por várias threads
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status inserirParticionada(const int valor) {
+    Status status;
+    const int i = travarFatia(valor);
+    Fatia *fatia = &particionada.fatias[i];
+
+    // Os nós vêm do pool da fatia, protegido pela mesma trava
+    poolAtual = &fatia->pool;
+    fatia->raiz = inserirNoRN(fatia->raiz, valor, &status);
+    poolAtual = &poolNos;
+
+    if (status == STATUS_OK) fatia->quantidade++;
+    const int redistribuir = fatia->quantidade % FATIA_VERIFICACAO == 0 && fatiaGrande(i);
+    pthread_mutex_unlock(&fatia->trava);
+
+    if (redistribuir) redistribuirFatia(i);
+    return status;
+}
+
+/**
+ * Remove um valor da árvore particionada, podendo ser chamada por várias threads
+ * @return STATUS_OK ou STATUS_AUSENTE
+ */
+Status removerParticionada(const int valor) {
+    Status status;
+    const int i = travarFatia(valor);
+    Fatia *fatia = &particionada.fatias[i];
+
+    poolAtual = &fatia->pool;
+    fatia->raiz = removeNoRN(fatia->raiz, valor, &status);
+    poolAtual = &poolNos;
+
+    if (status == STATUS_OK) fatia->quantidade--;
+    pthread_mutex_unlock(&fatia->trava);
+
+    return status;
+}
+
+/**
+ * Pesquisa um valor na árvore particionada, podendo ser chamada por várias threads
+ * @return 1 se o valor estiver presente, 0 caso contrário
+ */
+int pesquisarParticionada(const int valor) {
+    const int i = travarFatia(valor);
+    const int encontrado = pesquisaNo(particionada.fatias[i].raiz, valor) != NULL;
+    pthread_mutex_unlock(&particionada.fatias[i].trava);
+
+    return encontrado;
+}
+
+/**
+ * Visitante original de uma consulta que atravessa várias fatias
+ */
+typedef struct {
+    Visitante visitante;
+    void *contexto;
+    int interrompida;
+} VisitaFatias;
+
+/**
+ * Repassa um valor ao visitante original, registrando se ele pediu a interrupção
+ */
+int visitarEmFatia(int valor, void *contexto) {
+    VisitaFatias *visita = contexto;
+    visita->interrompida = visita->visitante(valor, visita->contexto);
+    return visita->interrompida;
+}
+
+/**
+ * Visita, em ordem crescente, todos os valores do intervalo fechado [inicio, fim].
+ * Como as fatias são faixas contíguas, a ordem global é a concatenação das
+ * fatias em ordem; todas as fatias do intervalo ficam travadas durante a
+ * consulta, que enxerga portanto um estado consistente.
+ * @return Quantidade de valores visitados
+ */
+int visitarParticionada(const int inicio, const int fim, Visitante visitante, void *contexto) {
+    if (inicio > fim) return 0;
+
+    int primeira, ultima;
+    while (1) {
+        primeira = localizarFatia(inicio);
+        ultima = localizarFatia(fim);
+        for (int i = primeira; i <= ultima; i++) {
+            pthread_mutex_lock(&particionada.fatias[i].trava);
+        }
+
+        // Com as travas, os limites externos da faixa de fatias não mudam mais
+        if (pertenceFatia(primeira, inicio) && pertenceFatia(ultima, fim)) break;
+
+        for (int i = ultima; i >= primeira; i--) {
+            pthread_mutex_unlock(&particionada.fatias[i].trava);
+        }
+    }
+
+    VisitaFatias visita = {visitante, contexto, 0};
+    int total = 0;
+    for (int i = primeira; i <= ultima && !visita.interrompida; i++) {
+        total += visitarFaixa(particionada.fatias[i].raiz, inicio, fim, visitarEmFatia, &visita);
+    }
+
+    for (int i = ultima; i >= primeira; i--) {
+        pthread_mutex_unlock(&particionada.fatias[i].trava);
+    }
+
+    return total;
+}
+
+/**
+ * Libera todas as fatias. Os nós podem ter mudado de fatia nas redistribuições,
+ * por isso todos os pools são destruídos juntos, sem threads em execução.
+ */
+void destruirParticionada(void) {
+    for (int i = 0; i < particionada.quantidade; i++) {
+        poolDestruir(&particionada.fatias[i].pool);
+        pthread_mutex_destroy(&particionada.fatias[i].trava);
+        particionada.fatias[i].raiz = NULL;
+    }
+    particionada.quantidade = 0;
+}
+
+/* ============================================================
+   FUNÇÕES DE IMPRESSÃO
+   ============================================================ */
+
+/**
+ * Calcula o comprimento (quantidade de caracteres) de um número inteiro.
+ * É utilizado para alinhar corretamente os valores dos nós na impressão.
+ * Considera números negativos e o valor zero.
+ */
+int comprimento(int numero) {
+    const int sinal = numero < 0; // Verifica se o número é negativo
+    int contador = 0;
+
+    // Caso especial: o número zero possui comprimento 1
+    if (numero == 0) {
+        contador = 1;
+    } else {
+        // Conta quantos dígitos o número possui
+        while (numero != 0) {
+            numero = numero / 10; // Remove o último dígito
+            contador++;           // Incrementa o contador de dígitos
+        }
+    }
+
+    // Retorna o comprimento total (dígitos + possível sinal)
+    return sinal + contador;
+}
+
+/**
+ * Calcula o maior comprimento entre os valores armazenados nos nós da árvore.
+ * Esse valor é utilizado para definir o espaçamento horizontal da impressão.
+ * O comprimento só cresce com o módulo do número, então o valor mais longo
+ * é o menor ou o maior da árvore: basta descer pelas duas bordas, sem
+ * percorrer todos os nós a cada impressão.
+ * @param raiz Raiz da árvore
+ * @return Maior quantidade de caracteres entre os valores dos nós
+ */
+int maiorComprimento(const No *raiz) {
+    // Caso base: árvore vazia
+    if (raiz == NULL) {
+        return 0;
+    }
+
+    const No *menor = raiz, *maior = raiz;
+    while (menor->esquerdo) menor = menor->esquerdo;
+    while (maior->direito) maior = maior->direito;
+
+    const int comprMenor = comprimento(menor->valor);
+    const int comprMaior = comprimento(maior->valor);
+    return comprMenor > comprMaior ? comprMenor : comprMaior;
+}
+
+/**
+ * Calcula a altura de uma subárvore, sem descer além de um limite.
+ * @param raiz Raiz da subárvore
+ * @param limite Altura máxima de interesse
+ * @return Altura da subárvore, ou limite se ela for mais alta
+ */
+int alturaAte(const No *raiz, const int limite) {
+    if (raiz == NULL || limite == 0) return 0;
+
+    const int alturaEsquerdo = alturaAte(raiz->esquerdo, limite - 1);
+    if (alturaEsquerdo == limite - 1) return limite;
+
+    const int alturaDireita = alturaAte(raiz->direito, limite - 1);
+    return (alturaDireita > alturaEsquerdo ? alturaDireita : alturaEsquerdo) + 1;
+}
+
+#define IMPRESSAO_PROFUNDIDADE 7         // níveis exibidos pela opção "Imprimir"
+#define IMPRESSAO_PROFUNDIDADE_MAXIMA 12 // limita a largura da linha a compr * 2^13
+
+/*
+ * Cada linha da impressão é montada neste buffer e escrita com uma única
+ * chamada, em vez de um wprintf por caractere.
+ */
+typedef struct {
+    wchar_t *texto;
+    size_t tamanho;
+    size_t capacidade;
+    int falhou;
+} Linha;
+
+/**
+ * Acrescenta uma string repetida ao final da linha, aumentando o buffer quando necessário.
+ * @param linha Linha em construção
+ * @param str String a ser acrescentada
+ * @param vezes Quantidade de repetições
+ */
+void acrescentar(Linha *linha, const wchar_t *str, const size_t vezes) {
+    const size_t tam = wcslen(str);
+    if (linha->falhou || vezes == 0) return;
+
+    if (linha->tamanho + tam * vezes + 1 > linha->capacidade) {
+        size_t capacidade = linha->capacidade ? linha->capacidade : 256;
+        while (linha->tamanho + tam * vezes + 1 > capacidade) capacidade *= 2;
+
+        wchar_t *texto = realloc(linha->texto, capacidade * sizeof(wchar_t));
+        if (texto == NULL) {
+            linha->falhou = 1;
+            return;
+        }
+        linha->texto = texto;
+        linha->capacidade = capacidade;
+    }
+
+    // Espaços (o caso mais comum) são preenchidos de uma só vez
+    if (tam == 1) {
+        wmemset(linha->texto + linha->tamanho, str[0], vezes);
+    } else {
+        for (size_t v = 0; v < vezes; v++) wmemcpy(linha->texto + linha->tamanho + v * tam, str, tam);
+    }
+    linha->tamanho += tam * vezes;
+}
+
+/**
  * Centraliza uma string em um espaço total definido.
  * Utiliza caracteres de preenchimento à esquerda e à direita.
  * É usada para alinhar valores e símbolos na impressão da árvore.
  *
+ * @param linha Linha em construção
  * @param str String a ser centralizada
  * @param tam Tamanho real da string
  * @param total Espaço total disponível
@@ -531,166 +2430,2948 @@ int maiorComprimento(const No *raiz) {
  * @param fillEsq Caractere de preenchimento à esquerda
  * @param fillDir Caractere de preenchimento à direita
  */
-void center(const wchar_t *str, const int tam, const int total,
-            const int ajustarEsq, const wchar_t *fillEsq, const wchar_t *fillDir) {
+void center(Linha *linha, const wchar_t *str, const int tam, const int total,
+            const int ajustarEsq, const wchar_t *fillEsq, const wchar_t *fillDir) {
+
+    // Calcula o espaço restante para preenchimento
+    const int pad = total - tam;
+
+    // Define quantos caracteres serão colocados à esquerda e à direita
+    const int padEsq = ajustarEsq ? pad / 2 : (pad + 1) / 2;
+    const int padDir = pad - padEsq;
+
+    acrescentar(linha, fillEsq, padEsq);
+    acrescentar(linha, str, 1);
+    acrescentar(linha, fillDir, padDir);
+}
+
+/**
+ * Escreve um único nó da árvore na linha, incluindo:
+ * - o valor do nó
+ * - os conectores gráficos (┌ ┐ ─)
+ * A posição do nó é calculada com base na altura da árvore.
+ *
+ * @param linha Linha em construção
+ * @param no Nó a ser impresso
+ * @param altura Altura atual da camada
+ * @param compr Largura padrão para cada nó
+ * @param ajustarEsq Indica se o alinhamento deve ser ajustado
+ */
+void imprimeNo(Linha *linha, const No *no, const int altura, const int compr, const int ajustarEsq) {
+    // Espaçamento necessário entre os nós
+    const size_t halfPad = ((size_t) 1 << (altura - 1)) - 1;
+    const size_t trecho = halfPad * compr;
+
+    // Espaços iniciais, conector e linha horizontal para o filho esquerdo
+    acrescentar(linha, L" ", trecho);
+    center(linha, no->esquerdo ? L"┌" : L" ", 1, compr, 0, L" ", no->esquerdo ? L"─" : L" ");
+    acrescentar(linha, no->esquerdo ? L"─" : L" ", trecho);
+
+    // Converte o valor do nó para string wide e o centraliza
+    wchar_t wideBuffer[32];
+    swprintf(wideBuffer, sizeof(wideBuffer) / sizeof(wchar_t), no->cor == VERMELHO ? TEXT_RED L"%d" TEXT_RESET : L"%d", no->valor);
+    center(linha, wideBuffer, comprimento(no->valor), compr, ajustarEsq,
+           no->esquerdo ? L"─" : L" ",
+           no->direito ? L"─" : L" ");
+
+    // Linha horizontal, conector para o filho direito e espaços finais
+    acrescentar(linha, no->direito ? L"─" : L" ", trecho);
+    center(linha, no->direito ? L"┐" : L" ", 1, compr, 1, no->direito ? L"─" : L" ", L" ");
+    acrescentar(linha, L" ", trecho);
+
+    // Espaçamento entre os nós
+    acrescentar(linha, L" ", compr);
+}
+
+/**
+ * Escreve na linha os nós que estão a uma dada profundidade abaixo de no.
+ * Uma subárvore vazia vira um único trecho de espaços, do tamanho de todas
+ * as posições que ocuparia na camada, sem que suas posições sejam visitadas.
+ *
+ * @param linha Linha em construção
+ * @param no Raiz da subárvore
+ * @param profundidade Distância entre no e a camada impressa
+ * @param altura Altura da camada impressa
+ * @param compr Largura padrão dos nós
+ * @param ajustarEsq Indica se no é um filho direito
+ */
+void imprimeCamada(Linha *linha, const No *no, const int profundidade,
+                   const int altura, const int compr, const int ajustarEsq) {
+    if (no == NULL) {
+        // Cada posição da camada ocupa compr * 2^(altura + 1) caracteres
+        acrescentar(linha, L" ", ((size_t) compr << (altura + 1)) << profundidade);
+        return;
+    }
+
+    if (profundidade == 0) {
+        imprimeNo(linha, no, altura, compr, ajustarEsq);
+        return;
+    }
+
+    imprimeCamada(linha, no->esquerdo, profundidade - 1, altura, compr, 0);
+    imprimeCamada(linha, no->direito, profundidade - 1, altura, compr, 1);
+}
+
+/**
+ * Imprime graficamente uma subárvore, nível por nível, até uma profundidade
+ * máxima. Nós da última camada com filhos mantêm os conectores, indicando
+ * que há níveis omitidos abaixo deles.
+ *
+ * @param raiz Raiz da subárvore
+ * @param profundidade Quantidade máxima de níveis impressos
+ */
+void imprimeSubarvore(const No *raiz, int profundidade) {
+    if (profundidade > IMPRESSAO_PROFUNDIDADE_MAXIMA) profundidade = IMPRESSAO_PROFUNDIDADE_MAXIMA;
+    if (profundidade < 1) profundidade = 1;
+
+    // Só é preciso saber se a subárvore passa do limite, não a sua altura total
+    int altura = alturaAte(raiz, profundidade + 1);
+
+    // Caso a árvore esteja vazia
+    if (altura <= 0) {
+        wprintf(L"A árvore está vazia.\n");
+        return;
+    }
+
+    const int omitidos = altura > profundidade;
+    altura -= omitidos;
+
+    // Determina a largura necessária para impressão
+    const int compr = maiorComprimento(raiz);
+
+    Linha linha = {0};
+
+    // Imprime cada nível da árvore
+    for (int a = altura; a > 0 && !linha.falhou; a--) {
+        linha.tamanho = 0;
+        imprimeCamada(&linha, raiz, altura - a, a, compr, 0);
+        if (linha.falhou) break;
+
+        // Espaços no fim da linha não aparecem e não precisam ser escritos
+        while (linha.tamanho > 0 && linha.texto[linha.tamanho - 1] == L' ') linha.tamanho--;
+        linha.texto[linha.tamanho] = L'\0';
+        wprintf(L"%ls\n", linha.texto);
+    }
+
+    if (linha.falhou) {
+        wprintf(L"\nERRO ao alocar memória");
+    } else if (omitidos) {
+        wprintf(L"(os níveis abaixo não foram impressos)\n");
+    }
+
+    free(linha.texto);
+}
+
+/**
+ * Imprime graficamente a árvore inteira, limitada a IMPRESSAO_PROFUNDIDADE níveis.
+ * Utiliza caracteres Unicode para representar a estrutura.
+ *
+ * @param raiz Raiz da árvore
+ */
+void imprimeArvore(No* raiz) {
+    imprimeSubarvore(raiz, IMPRESSAO_PROFUNDIDADE);
+}
+
+void preOrdem(const No *raiz){
+    if (raiz == NULL) return;
+
+    wprintf(L"%d ", raiz->valor);
+
+    if(raiz->esquerdo != NULL){
+        preOrdem(raiz->esquerdo);
+    }
+    if(raiz->direito != NULL){
+        preOrdem(raiz->direito);
+    }
+}
+
+/* ============================================================
+   ARMAZENAMENTO COMPACTO (ÍNDICES DE 32 BITS)
+   ============================================================ */
+
+/*
+ * Modo alternativo de armazenamento: todos os nós ficam em um único vetor
+ * contíguo e os ponteiros são índices de 32 bits nesse vetor. A cor é guardada
+ * no bit mais alto do índice do pai, de modo que cada nó ocupa 16 bytes, em vez
+ * dos 40 bytes de No. A posição 0 (NULO) é um sentinela preto que faz o papel
+ * das folhas, o que dispensa os testes de NULL nos ajustes.
+ */
+typedef struct {
+    int valor;
+    uint32_t esquerdo, direito;
+    uint32_t pai; // bit mais alto: cor (1 para vermelho e 0 para preto)
+} NoCompacto;
+
+#define NULO 0u
+#define INDICE_MASCARA 0x7fffffffu
+#define COR_BIT 31
+
+/**
+ * Vetor que armazena os nós compactos. As posições devolvidas formam uma lista
+ * de livres, encadeada pelo filho esquerdo.
+ */
+typedef struct {
+    NoCompacto *nos;
+    uint32_t quantidade; // posições já utilizadas (incluindo o sentinela)
+    uint32_t capacidade; // posições alocadas
+    uint32_t livres;     // primeira posição da lista de livres
+} VetorCompacto;
+
+static VetorCompacto compacto = {NULL, 0, 0, NULO};
+
+#define NC(i) (compacto.nos[(i)])
+
+uint32_t paiC(const uint32_t i) {
+    return NC(i).pai & INDICE_MASCARA;
+}
+
+short corC(const uint32_t i) {
+    return (short) (NC(i).pai >> COR_BIT);
+}
+
+void definePaiC(const uint32_t i, const uint32_t pai) {
+    NC(i).pai = (NC(i).pai & ~INDICE_MASCARA) | pai;
+}
+
+void defineCorC(const uint32_t i, const short cor) {
+    NC(i).pai = (NC(i).pai & INDICE_MASCARA) | (uint32_t) cor << COR_BIT;
+}
+
+/**
+ * Cria um novo nó compacto vermelho, reaproveitando uma posição livre ou ampliando o vetor.
+ * @param valor Valor a ser armazenado no nó
+ * @return Índice do novo nó ou NULO, caso não haja memória ou o limite de índices seja atingido
+ */
+uint32_t novoNoC(const int valor) {
+    uint32_t i;
+
+    if (compacto.livres != NULO) {
+        i = compacto.livres;
+        compacto.livres = NC(i).esquerdo;
+    } else {
+        if (compacto.quantidade == compacto.capacidade) {
+            if (compacto.capacidade > INDICE_MASCARA) return NULO;
+
+            uint32_t capacidade = compacto.capacidade ? compacto.capacidade * 2 : POOL_BLOCO_INICIAL;
+            if (capacidade > INDICE_MASCARA + 1u) capacidade = INDICE_MASCARA + 1u;
+
+            NoCompacto *nos = realloc(compacto.nos, sizeof(NoCompacto) * capacidade);
+            if (nos == NULL) return NULO;
+
+            compacto.nos = nos;
+            compacto.capacidade = capacidade;
+
+            // A posição 0 é o sentinela preto
+            if (compacto.quantidade == 0) {
+                NC(NULO).valor = 0;
+                NC(NULO).esquerdo = NC(NULO).direito = NC(NULO).pai = NULO;
+                compacto.quantidade = 1;
+            }
+        }
+        i = compacto.quantidade++;
+    }
+
+    NC(i).valor = valor;
+    NC(i).esquerdo = NULO;
+    NC(i).direito = NULO;
+    NC(i).pai = (uint32_t) VERMELHO << COR_BIT;
+
+    return i;
+}
+
+/**
+ * Devolve a posição de um nó compacto para a lista de livres.
+ */
+void liberarNoC(const uint32_t i) {
+    NC(i).esquerdo = compacto.livres;
+    compacto.livres = i;
+}
+
+/**
+ * Libera o vetor de nós compactos de uma só vez.
+ */
+void destruirCompacto(void) {
+    free(compacto.nos);
+    compacto.nos = NULL;
+    compacto.quantidade = 0;
+    compacto.capacidade = 0;
+    compacto.livres = NULO;
+}
+
+/**
+ * Rotação à esquerda sobre nós compactos, já ligando a nova raiz ao pai do pivô.
+ * @param raiz Índice da raiz da árvore
+ * @param p Pivô da rotação
+ * @return Índice da raiz da árvore após a rotação
+ */
+uint32_t rotacaoEsquerdaC(uint32_t raiz, const uint32_t p) {
+    CONTAR(rotacoesEsquerda);
+    const uint32_t u = NC(p).direito;
+
+    NC(p).direito = NC(u).esquerdo;
+    if (NC(u).esquerdo != NULO) definePaiC(NC(u).esquerdo, p);
+
+    definePaiC(u, paiC(p));
+    if (paiC(p) == NULO) {
+        raiz = u;
+    } else if (NC(paiC(p)).esquerdo == p) {
+        NC(paiC(p)).esquerdo = u;
+    } else {
+        NC(paiC(p)).direito = u;
+    }
+
+    NC(u).esquerdo = p;
+    definePaiC(p, u);
+
+    return raiz;
+}
+
+/**
+ * Rotação à direita sobre nós compactos, já ligando a nova raiz ao pai do pivô.
+ * @param raiz Índice da raiz da árvore
+ * @param p Pivô da rotação
+ * @return Índice da raiz da árvore após a rotação
+ */
+uint32_t rotacaoDireitaC(uint32_t raiz, const uint32_t p) {
+    CONTAR(rotacoesDireita);
+    const uint32_t u = NC(p).esquerdo;
+
+    NC(p).esquerdo = NC(u).direito;
+    if (NC(u).direito != NULO) definePaiC(NC(u).direito, p);
+
+    definePaiC(u, paiC(p));
+    if (paiC(p) == NULO) {
+        raiz = u;
+    } else if (NC(paiC(p)).direito == p) {
+        NC(paiC(p)).direito = u;
+    } else {
+        NC(paiC(p)).esquerdo = u;
+    }
+
+    NC(u).direito = p;
+    definePaiC(p, u);
+
+    return raiz;
+}
+
+/**
+ * Ajusta a árvore rubro-negra compacta após a inserção de um nó vermelho.
+ * @param raiz Índice da raiz da árvore
+ * @param no Nó inserido
+ * @return Índice da raiz ajustada
+ */
+uint32_t insercaoAjusteC(uint32_t raiz, uint32_t no) {
+    while (corC(paiC(no)) == VERMELHO) {
+        CONTAR(iteracoesInsercao);
+        uint32_t pai = paiC(no);
+        const uint32_t avo = paiC(pai);
+
+        if (pai == NC(avo).esquerdo) {
+            const uint32_t tio = NC(avo).direito;
+
+            if (corC(tio) == VERMELHO) {
+                // Pai e tio vermelhos: recolore e continua a partir do avô
+                CONTAR(recoloracoesInsercao);
+                defineCorC(pai, PRETO);
+                defineCorC(tio, PRETO);
+                defineCorC(avo, VERMELHO);
+                no = avo;
+            } else {
+                // Tio preto: uma rotação (ou duas, no caso em zigue-zague)
+                CONTAR(rotacoesInsercao);
+                if (no == NC(pai).direito) {
+                    no = pai;
+                    raiz = rotacaoEsquerdaC(raiz, no);
+                    pai = paiC(no);
+                }
+                defineCorC(pai, PRETO);
+                defineCorC(avo, VERMELHO);
+                raiz = rotacaoDireitaC(raiz, avo);
+            }
+        } else {
+            const uint32_t tio = NC(avo).esquerdo;
+
+            if (corC(tio) == VERMELHO) {
+                CONTAR(recoloracoesInsercao);
+                defineCorC(pai, PRETO);
+                defineCorC(tio, PRETO);
+                defineCorC(avo, VERMELHO);
+                no = avo;
+            } else {
+                CONTAR(rotacoesInsercao);
+                if (no == NC(pai).esquerdo) {
+                    no = pai;
+                    raiz = rotacaoDireitaC(raiz, no);
+                    pai = paiC(no);
+                }
+                defineCorC(pai, PRETO);
+                defineCorC(avo, VERMELHO);
+                raiz = rotacaoEsquerdaC(raiz, avo);
+            }
+        }
+    }
+
+    defineCorC(raiz, PRETO);
+    return raiz;
+}
+
+/**
+ * Insere um valor na árvore rubro-negra compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param valor Valor que será inserido
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
+ * @return Índice da raiz da árvore com o valor inserido
+ */
+uint32_t inserirNoRNC(uint32_t raiz, const int valor, Status *status) {
+    // O nó é criado antes da descida, pois o vetor pode ser realocado
+    const uint32_t no = novoNoC(valor);
+    if (no == NULO) {
+        *status = STATUS_SEM_MEMORIA;
+        return raiz;
+    }
+    *status = STATUS_OK;
+
+    // Descida iterativa até a posição de inserção
+    uint32_t pai = NULO;
+    uint32_t atual = raiz;
+    while (atual != NULO) {
+        CONTAR(comparacoes);
+        pai = atual;
+        atual = valor < NC(atual).valor ? NC(atual).esquerdo : NC(atual).direito;
+    }
+
+    definePaiC(no, pai);
+    if (pai == NULO) {
+        raiz = no;
+    } else if (valor < NC(pai).valor) {
+        NC(pai).esquerdo = no;
+    } else {
+        NC(pai).direito = no;
+    }
+
+    return insercaoAjusteC(raiz, no);
+}
+
+/**
+ * Busca um valor na árvore rubro-negra compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param valor Valor que será buscado
+ * @return Índice do nó com o valor ou NULO, caso ele não esteja presente
+ */
+uint32_t pesquisaNoC(uint32_t raiz, const int valor) {
+    int profundidade = 0;
+
+    while (raiz != NULO) {
+        RASTREAR(EVENTO_VISITA, NC(raiz).valor);
+        CONTAR(comparacoes);
+        profundidade++;
+
+        if (NC(raiz).valor == valor) break;
+
+        raiz = valor < NC(raiz).valor ? NC(raiz).esquerdo : NC(raiz).direito;
+    }
+
+    CONTAR_PROFUNDIDADE(profundidade);
+    return raiz;
+}
+
+/**
+ * Substitui a subárvore u pela subárvore v. O pai do sentinela também é
+ * atualizado, pois o ajuste da remoção precisa dele quando v é NULO.
+ * @return Índice da raiz da árvore
+ */
+uint32_t transplantarC(uint32_t raiz, const uint32_t u, const uint32_t v) {
+    if (paiC(u) == NULO) {
+        raiz = v;
+    } else if (u == NC(paiC(u)).esquerdo) {
+        NC(paiC(u)).esquerdo = v;
+    } else {
+        NC(paiC(u)).direito = v;
+    }
+
+    definePaiC(v, paiC(u));
+    return raiz;
+}
+
+/**
+ * Ajusta a árvore rubro-negra compacta após a remoção de um nó preto.
+ * @param raiz Índice da raiz da árvore
+ * @param x Nó que pode violar as propriedades rubro-negras (pode ser o sentinela)
+ * @return Índice da raiz ajustada
+ */
+uint32_t remocaoAjusteC(uint32_t raiz, uint32_t x) {
+    while (x != raiz && corC(x) == PRETO) {
+        CONTAR(iteracoesRemocao);
+        const uint32_t pai = paiC(x);
+
+        if (x == NC(pai).esquerdo) {
+            uint32_t irmao = NC(pai).direito;
+
+            if (corC(irmao) == VERMELHO) {
+                defineCorC(irmao, PRETO);
+                defineCorC(pai, VERMELHO);
+                raiz = rotacaoEsquerdaC(raiz, pai);
+                irmao = NC(pai).direito;
+            }
+
+            if (corC(NC(irmao).esquerdo) == PRETO && corC(NC(irmao).direito) == PRETO) {
+                CONTAR(recoloracoesRemocao);
+                defineCorC(irmao, VERMELHO);
+                x = pai;
+            } else {
+                if (corC(NC(irmao).direito) == PRETO) {
+                    defineCorC(NC(irmao).esquerdo, PRETO);
+                    defineCorC(irmao, VERMELHO);
+                    raiz = rotacaoDireitaC(raiz, irmao);
+                    irmao = NC(pai).direito;
+                }
+
+                defineCorC(irmao, corC(pai));
+                defineCorC(pai, PRETO);
+                defineCorC(NC(irmao).direito, PRETO);
+                raiz = rotacaoEsquerdaC(raiz, pai);
+                x = raiz;
+            }
+        } else {
+            uint32_t irmao = NC(pai).esquerdo;
+
+            if (corC(irmao) == VERMELHO) {
+                defineCorC(irmao, PRETO);
+                defineCorC(pai, VERMELHO);
+                raiz = rotacaoDireitaC(raiz, pai);
+                irmao = NC(pai).esquerdo;
+            }
+
+            if (corC(NC(irmao).direito) == PRETO && corC(NC(irmao).esquerdo) == PRETO) {
+                CONTAR(recoloracoesRemocao);
+                defineCorC(irmao, VERMELHO);
+                x = pai;
+            } else {
+                if (corC(NC(irmao).esquerdo) == PRETO) {
+                    defineCorC(NC(irmao).direito, PRETO);
+                    defineCorC(irmao, VERMELHO);
+                    raiz = rotacaoEsquerdaC(raiz, irmao);
+                    irmao = NC(pai).esquerdo;
+                }
+
+                defineCorC(irmao, corC(pai));
+                defineCorC(pai, PRETO);
+                defineCorC(NC(irmao).esquerdo, PRETO);
+                raiz = rotacaoDireitaC(raiz, pai);
+                x = raiz;
+            }
+        }
+    }
+
+    defineCorC(x, PRETO);
+    return raiz;
+}
+
+/**
+ * Remove um valor da árvore rubro-negra compacta.
+ * @param raiz Índice da raiz da árvore
+ * @param valor Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Índice da nova raiz da árvore
+ */
+uint32_t removeNoRNC(uint32_t raiz, const int valor, Status *status) {
+    const uint32_t z = pesquisaNoC(raiz, valor);
+
+    if (z == NULO) {
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
+    *status = STATUS_OK;
+
+    uint32_t y = z;
+    uint32_t x;
+    short corOriginal = corC(y);
+
+    if (NC(z).esquerdo == NULO) {
+        x = NC(z).direito;
+        raiz = transplantarC(raiz, z, x);
+    } else if (NC(z).direito == NULO) {
+        x = NC(z).esquerdo;
+        raiz = transplantarC(raiz, z, x);
+    } else {
+        // Sucessor: menor nó da subárvore direita
+        y = NC(z).direito;
+        while (NC(y).esquerdo != NULO) {
+            y = NC(y).esquerdo;
+        }
+        corOriginal = corC(y);
+        x = NC(y).direito;
+
+        if (paiC(y) == z) {
+            definePaiC(x, y);
+        } else {
+            raiz = transplantarC(raiz, y, x);
+            NC(y).direito = NC(z).direito;
+            definePaiC(NC(y).direito, y);
+        }
+
+        raiz = transplantarC(raiz, z, y);
+        NC(y).esquerdo = NC(z).esquerdo;
+        definePaiC(NC(y).esquerdo, y);
+        defineCorC(y, corC(z));
+    }
+
+    liberarNoC(z);
+
+    if (corOriginal == PRETO) {
+        raiz = remocaoAjusteC(raiz, x);
+    }
+
+    return raiz;
+}
+
+/**
+ * Calcula a altura da árvore compacta.
+ */
+int alturaC(const uint32_t raiz) {
+    if (raiz == NULO) return 0;
+
+    const int alturaEsquerda = alturaC(NC(raiz).esquerdo);
+    const int alturaDireita = alturaC(NC(raiz).direito);
+
+    return (alturaDireita > alturaEsquerda ? alturaDireita : alturaEsquerda) + 1;
+}
+
+/* ============================================================
+   RUBRO-NEGRA DESCENDENTE (SEM PONTEIRO PARA O PAI)
+   ============================================================ */
+
+/*
+ * Motor alternativo em que a inserção e a remoção fazem as recolorações e as
+ * rotações durante a própria descida, em uma única passada da raiz até o ponto
+ * de alteração. Como nenhuma correção sobe pela árvore, o nó não precisa do
+ * ponteiro para o pai (nem do tamanho da subárvore) e ocupa 24 bytes, em vez
+ * dos 40 bytes de No. Valores repetidos são mantidos, como na árvore principal.
+ * - inserção: um nó preto com dois filhos vermelhos troca de cor com eles, e o
+ *   par de vermelhos que isso pode criar é desfeito por uma rotação no avô;
+ *   o novo nó é ligado à folha já com o caminho ajustado
+ * - remoção: a descida nunca entra em um nó preto sem filho vermelho no lado
+ *   seguido, "empurrando" um vermelho para baixo por rotação ou recoloração;
+ *   ao fim, o nó a remover recebe o valor do seu antecessor, que a descida
+ *   deixou vermelho e por isso sai da árvore sem nenhum ajuste
+ */
+typedef struct noDescendente {
+    int valor;
+    short cor;
+    struct noDescendente *filho[2]; // 0 para o esquerdo e 1 para o direito
+} NoDescendente;
+
+/**
+ * Bloco contíguo de nós descendentes, com a mesma política de crescimento do Pool.
+ */
+typedef struct blocoDescendente {
+    struct blocoDescendente *proximo;
+    size_t capacidade;
+    NoDescendente nos[];
+} BlocoDescendente;
+
+/**
+ * Pool dos nós descendentes. Os nós devolvidos formam uma lista de livres,
+ * encadeada pelo filho esquerdo.
+ */
+static struct {
+    BlocoDescendente *blocos;
+    size_t usados;
+    NoDescendente *livres;
+} descendente = {NULL, 0, NULL};
+
+/**
+ * Cria um novo nó descendente vermelho, reaproveitando um nó devolvido ou ampliando o pool.
+ * @param valor Valor a ser armazenado no nó
+ * @return Nó alocado ou NULL, caso não haja memória
+ */
+NoDescendente* novoNoD(const int valor) {
+    NoDescendente *no = descendente.livres;
+
+    if (no) {
+        descendente.livres = no->filho[0];
+    } else {
+        if (descendente.blocos == NULL || descendente.usados == descendente.blocos->capacidade) {
+            size_t capacidade = descendente.blocos ? descendente.blocos->capacidade * 2 : POOL_BLOCO_INICIAL;
+            if (capacidade > POOL_BLOCO_MAXIMO) capacidade = POOL_BLOCO_MAXIMO;
+
+            BlocoDescendente *bloco = malloc(sizeof(BlocoDescendente) + capacidade * sizeof(NoDescendente));
+            if (bloco == NULL) return NULL;
+
+            bloco->proximo = descendente.blocos;
+            bloco->capacidade = capacidade;
+            descendente.blocos = bloco;
+            descendente.usados = 0;
+        }
+        no = &descendente.blocos->nos[descendente.usados++];
+    }
+
+    no->valor = valor;
+    no->cor = VERMELHO;
+    no->filho[0] = no->filho[1] = NULL;
+
+    return no;
+}
+
+/**
+ * Devolve um nó descendente ao pool.
+ */
+void liberarNoD(NoDescendente *no) {
+    no->filho[0] = descendente.livres;
+    descendente.livres = no;
+}
+
+/**
+ * Libera todos os nós descendentes de uma só vez.
+ */
+void destruirDescendente(void) {
+    while (descendente.blocos) {
+        BlocoDescendente *proximo = descendente.blocos->proximo;
+        free(descendente.blocos);
+        descendente.blocos = proximo;
+    }
+    descendente.usados = 0;
+    descendente.livres = NULL;
+}
+
+/**
+ * Indica se um nó descendente é vermelho (as folhas vazias são pretas).
+ */
+int vermelhoD(const NoDescendente *no) {
+    return no != NULL && no->cor == VERMELHO;
+}
+
+/**
+ * Rotação simples da descida: o filho do lado oposto a "lado" sobe e fica preto,
+ * e a antiga raiz desce para "lado" e fica vermelha.
+ * @param raiz Raiz da subárvore
+ * @param lado Lado para onde a raiz desce (0 para a esquerda e 1 para a direita)
+ * @return Nova raiz da subárvore
+ */
+NoDescendente* rotacaoD(NoDescendente *raiz, const int lado) {
+    NoDescendente *filho = raiz->filho[!lado];
+
+    raiz->filho[!lado] = filho->filho[lado];
+    filho->filho[lado] = raiz;
+    raiz->cor = VERMELHO;
+    filho->cor = PRETO;
+
+    if (lado) {
+        CONTAR(rotacoesDireita);
+    } else {
+        CONTAR(rotacoesEsquerda);
+    }
+    return filho;
+}
+
+/**
+ * Rotação dupla da descida: primeiro no filho do lado oposto a "lado", depois na raiz.
+ */
+NoDescendente* rotacaoDuplaD(NoDescendente *raiz, const int lado) {
+    raiz->filho[!lado] = rotacaoD(raiz->filho[!lado], !lado);
+    return rotacaoD(raiz, lado);
+}
+
+/**
+ * Insere um valor na árvore descendente, em uma única passada.
+ * @param raiz Raiz da árvore
+ * @param valor Valor que será inserido
+ * @param status Recebe STATUS_OK ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore com o valor inserido
+ */
+NoDescendente* inserirNoRND(NoDescendente *raiz, const int valor, Status *status) {
+    NoDescendente *novo = novoNoD(valor);
+    if (novo == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return raiz;
+    }
+    *status = STATUS_OK;
+
+    if (raiz == NULL) {
+        novo->cor = PRETO;
+        return novo;
+    }
+
+    // A falsa raiz faz da raiz verdadeira um filho comum, que pode ser rotacionado
+    NoDescendente cabeca = {0, PRETO, {NULL, raiz}};
+    NoDescendente *bisavo = &cabeca, *avo = NULL, *pai = NULL, *atual = raiz;
+    int lado = 0, ultimo = 0;
+
+    for (;;) {
+        CONTAR(iteracoesInsercao);
+
+        if (atual == NULL) {
+            pai->filho[lado] = atual = novo;
+        } else if (vermelhoD(atual->filho[0]) && vermelhoD(atual->filho[1])) {
+            // Nó preto com dois filhos vermelhos: troca de cor com eles
+            CONTAR(recoloracoesInsercao);
+            atual->cor = VERMELHO;
+            atual->filho[0]->cor = PRETO;
+            atual->filho[1]->cor = PRETO;
+        }
+
+        // Dois vermelhos seguidos: o tio é preto, então uma rotação no avô resolve
+        if (vermelhoD(atual) && vermelhoD(pai)) {
+            CONTAR(rotacoesInsercao);
+            const int ladoAvo = bisavo->filho[1] == avo;
+            bisavo->filho[ladoAvo] = atual == pai->filho[ultimo] ? rotacaoD(avo, !ultimo) : rotacaoDuplaD(avo, !ultimo);
+        }
+
+        if (atual == novo) break;
+
+        // Valores iguais seguem para a direita, como em inserirNo
+        CONTAR(comparacoes);
+        ultimo = lado;
+        lado = !(valor < atual->valor);
+        if (avo != NULL) bisavo = avo;
+        avo = pai;
+        pai = atual;
+        atual = atual->filho[lado];
+    }
+
+    raiz = cabeca.filho[1];
+    raiz->cor = PRETO;
+    return raiz;
+}
+
+/**
+ * Remove uma ocorrência de um valor da árvore descendente, em uma única passada.
+ * @param raiz Raiz da árvore
+ * @param valor Valor que será removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Nova raiz da árvore
+ */
+NoDescendente* removeNoRND(NoDescendente *raiz, const int valor, Status *status) {
+    *status = STATUS_AUSENTE;
+    if (raiz == NULL) return NULL;
+
+    NoDescendente cabeca = {0, PRETO, {NULL, raiz}};
+    NoDescendente *avo = NULL, *pai = NULL, *atual = &cabeca, *encontrado = NULL;
+    int lado = 1;
+
+    // A descida segue até o antecessor do último nó com o valor (ou até uma folha)
+    while (atual->filho[lado] != NULL) {
+        CONTAR(iteracoesRemocao);
+        const int ultimo = lado;
+        avo = pai;
+        pai = atual;
+        atual = atual->filho[lado];
+
+        CONTAR(comparacoes);
+        lado = atual->valor < valor;
+        if (atual->valor == valor) encontrado = atual;
+
+        // O próximo passo não pode entrar em um nó preto sem filho vermelho naquele lado
+        if (vermelhoD(atual) || vermelhoD(atual->filho[lado])) continue;
+
+        if (vermelhoD(atual->filho[!lado])) {
+            // O filho vermelho do outro lado sobe, e atual desce como vermelho
+            pai = pai->filho[ultimo] = rotacaoD(atual, lado);
+        } else {
+            NoDescendente *irmao = pai->filho[!ultimo];
+            if (irmao == NULL) continue;
+
+            if (!vermelhoD(irmao->filho[0]) && !vermelhoD(irmao->filho[1])) {
+                // Irmão sem filhos vermelhos: o pai (vermelho) empresta a cor aos dois
+                CONTAR(recoloracoesRemocao);
+                pai->cor = PRETO;
+                irmao->cor = VERMELHO;
+                atual->cor = VERMELHO;
+            } else {
+                // Irmão com um filho vermelho: uma rotação (ou duas) no pai traz o vermelho para o caminho
+                const int ladoAvo = avo->filho[1] == pai;
+                avo->filho[ladoAvo] = vermelhoD(irmao->filho[ultimo]) ? rotacaoDuplaD(pai, ultimo) : rotacaoD(pai, ultimo);
+
+                NoDescendente *topo = avo->filho[ladoAvo];
+                atual->cor = VERMELHO;
+                topo->cor = VERMELHO;
+                topo->filho[0]->cor = PRETO;
+                topo->filho[1]->cor = PRETO;
+            }
+        }
+    }
+
+    if (encontrado != NULL) {
+        // atual tem no máximo um filho e, vermelho (ou raiz), sai sem mudar a altura negra
+        encontrado->valor = atual->valor;
+        pai->filho[pai->filho[1] == atual] = atual->filho[atual->filho[0] == NULL];
+        liberarNoD(atual);
+        *status = STATUS_OK;
+    }
+
+    raiz = cabeca.filho[1];
+    if (raiz) raiz->cor = PRETO;
+    return raiz;
+}
+
+/**
+ * Busca um valor na árvore descendente.
+ * @param raiz Raiz da árvore
+ * @param valor Valor que será buscado
+ * @return O nó com o valor ou NULL, caso ele não esteja presente
+ */
+NoDescendente* pesquisaNoD(NoDescendente *raiz, const int valor) {
+    int profundidade = 0;
+
+    while (raiz != NULL) {
+        RASTREAR(EVENTO_VISITA, raiz->valor);
+        CONTAR(comparacoes);
+        profundidade++;
+
+        if (raiz->valor == valor) break;
+
+        raiz = raiz->filho[!(valor < raiz->valor)];
+    }
+
+    CONTAR_PROFUNDIDADE(profundidade);
+    return raiz;
+}
+
+/**
+ * Calcula a altura da árvore descendente.
+ */
+int alturaD(const NoDescendente *raiz) {
+    if (raiz == NULL) return 0;
+
+    const int alturaEsquerda = alturaD(raiz->filho[0]);
+    const int alturaDireita = alturaD(raiz->filho[1]);
+
+    return (alturaDireita > alturaEsquerda ? alturaDireita : alturaEsquerda) + 1;
+}
+
+/* ============================================================
+   INSTANTÂNEO CONGELADO (LAYOUT DE EYTZINGER)
+   ============================================================ */
+
+/*
+ * Cópia somente leitura da árvore, com as chaves dispostas em um vetor na ordem
+ * de uma busca em largura (layout de Eytzinger): os filhos da posição k ficam
+ * nas posições 2k e 2k + 1. A pesquisa não depende de desvios imprevisíveis e
+ * os próximos níveis podem ser antecipados para a cache.
+ * O instantâneo não acompanha as alterações da árvore: deve ser reconstruído
+ * (congelado novamente) após inserções e remoções.
+ */
+typedef struct {
+    int *chaves; // chaves a partir da posição 1
+    int n;       // quantidade de chaves
+} Congelada;
+
+static Congelada congelada = {NULL, 0};
+
+#ifdef __GNUC__
+#define ANTECIPAR(endereco) __builtin_prefetch(endereco)
+#else
+#define ANTECIPAR(endereco) ((void) 0)
+#endif
+
+/**
+ * Conta os bits 0 menos significativos de um número diferente de zero.
+ */
+int contarZerosFinais(size_t x) {
+#ifdef __GNUC__
+    return __builtin_ctzll((unsigned long long) x);
+#else
+    int zeros = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+/**
+ * Conta a quantidade de nós de uma árvore.
+ */
+int contarNos(const No *raiz) {
+    return raiz ? 1 + contarNos(raiz->esquerdo) + contarNos(raiz->direito) : 0;
+}
+
+/**
+ * Copia as chaves da árvore, em ordem crescente, para um vetor.
+ * @param raiz Raiz da árvore
+ * @param destino Vetor de destino
+ * @param i Próxima posição livre do vetor
+ */
+void coletarEmOrdem(const No *raiz, int *destino, int *i) {
+    if (raiz == NULL) return;
+
+    coletarEmOrdem(raiz->esquerdo, destino, i);
+    destino[(*i)++] = raiz->valor;
+    coletarEmOrdem(raiz->direito, destino, i);
+}
+
+/**
+ * Conta a quantidade de nós de uma árvore compacta.
+ */
+int contarNosC(const uint32_t raiz) {
+    return raiz != NULO ? 1 + contarNosC(NC(raiz).esquerdo) + contarNosC(NC(raiz).direito) : 0;
+}
+
+/**
+ * Copia as chaves da árvore compacta, em ordem crescente, para um vetor.
+ */
+void coletarEmOrdemC(const uint32_t raiz, int *destino, int *i) {
+    if (raiz == NULO) return;
+
+    coletarEmOrdemC(NC(raiz).esquerdo, destino, i);
+    destino[(*i)++] = NC(raiz).valor;
+    coletarEmOrdemC(NC(raiz).direito, destino, i);
+}
+
+/**
+ * Distribui as chaves ordenadas nas posições do layout de Eytzinger, percorrendo
+ * as posições em ordem simétrica (em ordem).
+ * @param ordenadas Chaves em ordem crescente
+ * @param i Próxima chave ordenada a ser distribuída
+ * @param k Posição atual do layout
+ */
+void distribuirEytzinger(const int *ordenadas, int *i, const size_t k) {
+    if (k > (size_t) congelada.n) return;
+
+    distribuirEytzinger(ordenadas, i, 2 * k);
+    congelada.chaves[k] = ordenadas[(*i)++];
+    distribuirEytzinger(ordenadas, i, 2 * k + 1);
+}
+
+/**
+ * Monta o instantâneo congelado a partir das chaves em ordem crescente,
+ * descartando o instantâneo anterior.
+ * @param ordenadas Chaves em ordem crescente
+ * @param n Quantidade de chaves
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelarOrdenadas(const int *ordenadas, const int n) {
+    free(congelada.chaves);
+    congelada.n = 0;
+
+    congelada.chaves = malloc(sizeof(int) * ((size_t) n + 1));
+    if (congelada.chaves == NULL) return STATUS_SEM_MEMORIA;
+
+    congelada.n = n;
+    int i = 0;
+    distribuirEytzinger(ordenadas, &i, 1);
+
+    return STATUS_OK;
+}
+
+/**
+ * Congela a árvore, (re)construindo o instantâneo a partir do seu estado atual.
+ * @param raiz Raiz da árvore
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelar(const No *raiz) {
+    const int n = contarNos(raiz);
+    int *ordenadas = malloc(sizeof(int) * ((size_t) n + 1));
+    if (ordenadas == NULL) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarEmOrdem(raiz, ordenadas, &i);
+
+    const Status status = congelarOrdenadas(ordenadas, n);
+    free(ordenadas);
+
+    return status;
+}
+
+/**
+ * Congela a árvore compacta, (re)construindo o instantâneo a partir do seu estado atual.
+ * @param raiz Índice da raiz da árvore compacta
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelarC(const uint32_t raiz) {
+    const int n = contarNosC(raiz);
+    int *ordenadas = malloc(sizeof(int) * ((size_t) n + 1));
+    if (ordenadas == NULL) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarEmOrdemC(raiz, ordenadas, &i);
+
+    const Status status = congelarOrdenadas(ordenadas, n);
+    free(ordenadas);
+
+    return status;
+}
+
+/**
+ * Conta a quantidade de nós de uma árvore descendente.
+ */
+int contarNosD(const NoDescendente *raiz) {
+    return raiz ? 1 + contarNosD(raiz->filho[0]) + contarNosD(raiz->filho[1]) : 0;
+}
+
+/**
+ * Copia as chaves da árvore descendente, em ordem crescente, para um vetor.
+ */
+void coletarEmOrdemD(const NoDescendente *raiz, int *destino, int *i) {
+    if (raiz == NULL) return;
+
+    coletarEmOrdemD(raiz->filho[0], destino, i);
+    destino[(*i)++] = raiz->valor;
+    coletarEmOrdemD(raiz->filho[1], destino, i);
+}
+
+/**
+ * Congela a árvore descendente, (re)construindo o instantâneo a partir do seu estado atual.
+ * @param raiz Raiz da árvore descendente
+ * @return STATUS_OK ou STATUS_SEM_MEMORIA
+ */
+Status congelarD(const NoDescendente *raiz) {
+    const int n = contarNosD(raiz);
+    int *ordenadas = malloc(sizeof(int) * ((size_t) n + 1));
+    if (ordenadas == NULL) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarEmOrdemD(raiz, ordenadas, &i);
+
+    const Status status = congelarOrdenadas(ordenadas, n);
+    free(ordenadas);
+
+    return status;
+}
+
+/**
+ * Busca um valor no instantâneo congelado, sem desvios dependentes das chaves:
+ * a descida apenas acumula o resultado das comparações no índice, e a posição
+ * do menor elemento maior ou igual ao valor é recuperada ao final.
+ * @param valor Valor que será buscado
+ * @return 1 se o valor estiver presente no instantâneo, 0 caso contrário
+ */
+int pesquisaCongelada(const int valor) {
+    const int *chaves = congelada.chaves;
+    const size_t n = (size_t) congelada.n;
+    size_t k = 1;
+
+    while (k <= n) {
+        // Antecipa o bloco com os descendentes 4 níveis abaixo (16 chaves = 64 bytes)
+        ANTECIPAR(chaves + 16 * k);
+        k = 2 * k + (chaves[k] < valor);
+    }
+
+    // Remove as descidas à direita finais (bits 1 menos significativos) e a última descida à esquerda
+    k >>= contarZerosFinais(~k) + 1;
+
+    return k != 0 && chaves[k] == valor;
+}
+
+/**
+ * Libera o instantâneo congelado.
+ */
+void destruirCongelada(void) {
+    free(congelada.chaves);
+    congelada.chaves = NULL;
+    congelada.n = 0;
+}
+
+/* ============================================================
+   INSTANTÂNEO EM ARQUIVO
+   ============================================================ */
+
+/*
+ * Formato binário do instantâneo, na ordem de bytes da máquina que o gravou:
+ * - cabeçalho (CabecalhoInstantaneo)
+ * - as n chaves em ordem crescente, como inteiros de 32 bits
+ * - no modo multiconjunto, as n contagens de ocorrências, como inteiros de 32 bits
+ *   sem sinal (o tipo inclui então INSTANTANEO_MULTICONJUNTO)
+ * - um byte por chave, na mesma ordem: a altura do nó (AVL) ou a sua posição
+ *   (Rubro-Negra), que junto com a ordem das chaves determina a forma da árvore
+ * A carga mapeia o arquivo na memória e reconstrói a mesma árvore em uma única
+ * passada, sem nenhuma rotação nem comparação entre as chaves além da conferência da ordem.
+ */
+#define INSTANTANEO_VERSAO 2
+#define INSTANTANEO_ORDEM  0x01020304u // detecta arquivos gravados com outra ordem de bytes
+#define INSTANTANEO_AVL    1
+#define INSTANTANEO_RN     2
+#define INSTANTANEO_MULTICONJUNTO 0x100u // combinado ao tipo quando há contagens
+#define INSTANTANEO_PILHA  128          // maior que a altura de qualquer árvore válida
+
+typedef struct {
+    char assinatura[4]; // "ARVI"
+    uint32_t versao;
+    uint32_t tipo;      // INSTANTANEO_AVL ou INSTANTANEO_RN, talvez com INSTANTANEO_MULTICONJUNTO
+    uint32_t ordem;     // INSTANTANEO_ORDEM
+    uint64_t n;         // quantidade de chaves
+    uint64_t geracao;   // última geração do diário incluída no instantâneo (0 sem diário)
+} CabecalhoInstantaneo;
+
+/**
+ * Força a gravação em disco de tudo o que foi escrito em um arquivo.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int sincronizarArquivo(FILE *arquivo) {
+    if (fflush(arquivo) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(arquivo)) == 0;
+#else
+    return fsync(fileno(arquivo)) == 0;
+#endif
+}
+
+/**
+ * Copia as chaves da árvore, em ordem crescente, a contagem e a posição de cada nó
+ * para vetores. A posição é o dobro da altura negra do nó (os nós pretos de um caminho
+ * até uma folha, incluindo o próprio nó) somado a 1 nos nós vermelhos, e é sempre
+ * maior que a dos filhos.
+ * @param negros Altura negra do nó
+ * @param contagens Recebe as contagens no modo multiconjunto (ignorado fora dele)
+ * @param i Próxima posição livre dos vetores
+ */
+void coletarInstantaneo(const No *raiz, const int negros, int32_t *chaves, uint32_t *contagens,
+                        unsigned char *posicoes, int *i) {
+    if (raiz == NULL) return;
+
+    const int alturaFilhos = negros - (raiz->cor == PRETO);
+    coletarInstantaneo(raiz->esquerdo, alturaFilhos, chaves, contagens, posicoes, i);
+    chaves[*i] = raiz->valor;
+#if MULTICONJUNTO
+    contagens[*i] = (uint32_t) raiz->contagem;
+#else
+    (void) contagens;
+#endif
+    posicoes[(*i)++] = (unsigned char) (2 * negros + (raiz->cor == VERMELHO));
+    coletarInstantaneo(raiz->direito, alturaFilhos, chaves, contagens, posicoes, i);
+}
+
+/**
+ * Tamanho de um arquivo de instantâneo com n chaves.
+ * @param contagens Se o arquivo inclui as contagens de ocorrências
+ */
+size_t tamanhoInstantaneo(const uint64_t n, const int contagens) {
+    return sizeof(CabecalhoInstantaneo) + n * (sizeof(int32_t) + 1 + (contagens ? sizeof(uint32_t) : 0));
+}
+
+/**
+ * Aloca os vetores de um instantâneo de n chaves; o de contagens só no modo multiconjunto.
+ * @return 1 em caso de sucesso, 0 caso contrário (nada fica alocado)
+ */
+int alocarInstantaneo(const int n, int32_t **chaves, uint32_t **contagens, unsigned char **posicoes) {
+    *chaves = malloc(sizeof(int32_t) * ((size_t) n + 1));
+    *contagens = MULTICONJUNTO ? malloc(sizeof(uint32_t) * ((size_t) n + 1)) : NULL;
+    *posicoes = malloc((size_t) n + 1);
+    if (*chaves && *posicoes && (*contagens || !MULTICONJUNTO)) return 1;
+
+    free(*chaves);
+    free(*contagens);
+    free(*posicoes);
+    return 0;
+}
+
+/**
+ * Grava um arquivo de instantâneo a partir das chaves em ordem e de a posição de cada nó,
+ * esperando que os dados cheguem ao disco.
+ * @param contagens Contagem de cada chave ou NULL, fora do modo multiconjunto
+ * @param geracao Última geração do diário incluída no instantâneo (0 sem diário)
+ * @param caminho Caminho do arquivo, que é substituído caso já exista
+ * @return STATUS_OK ou STATUS_INVALIDO (o arquivo não pôde ser gravado)
+ */
+Status gravarInstantaneo(const int32_t *chaves, const uint32_t *contagens, const unsigned char *posicoes,
+                         const int n, const uint64_t geracao, const char *caminho) {
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return STATUS_INVALIDO;
+
+    const CabecalhoInstantaneo cabecalho = {
+        {'A', 'R', 'V', 'I'}, INSTANTANEO_VERSAO, INSTANTANEO_RN | (contagens ? INSTANTANEO_MULTICONJUNTO : 0),
+        INSTANTANEO_ORDEM, (uint64_t) n, geracao
+    };
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+             fwrite(chaves, sizeof(int32_t), (size_t) n, arquivo) == (size_t) n &&
+             (contagens == NULL || fwrite(contagens, sizeof(uint32_t), (size_t) n, arquivo) == (size_t) n) &&
+             fwrite(posicoes, 1, (size_t) n, arquivo) == (size_t) n &&
+             sincronizarArquivo(arquivo);
+    if (fclose(arquivo) != 0) ok = 0;
+
+    return ok ? STATUS_OK : STATUS_INVALIDO;
+}
+
+/**
+ * Salva a árvore em um arquivo de instantâneo.
+ * @param raiz Raiz da árvore
+ * @param caminho Caminho do arquivo, que é substituído caso já exista
+ * @return STATUS_OK, STATUS_INVALIDO (o arquivo não pôde ser gravado) ou STATUS_SEM_MEMORIA
+ */
+Status salvarInstantaneo(const No *raiz, const char *caminho) {
+    const int n = contarNos(raiz);
+    int32_t *chaves;
+    uint32_t *contagens;
+    unsigned char *posicoes;
+    if (!alocarInstantaneo(n, &chaves, &contagens, &posicoes)) return STATUS_SEM_MEMORIA;
+
+    int i = 0;
+    coletarInstantaneo(raiz, alturaNegra(raiz), chaves, contagens, posicoes, &i);
+    const Status status = gravarInstantaneo(chaves, contagens, posicoes, n, 0, caminho);
+
+    free(chaves);
+    free(contagens);
+    free(posicoes);
+    return status;
+}
+
+/**
+ * Mapeia um arquivo inteiro na memória, somente para leitura. Sem mmap (Windows),
+ * o arquivo é lido para um bloco alocado.
+ * @param caminho Caminho do arquivo
+ * @param tamanho Recebe o tamanho do arquivo em bytes
+ * @return Conteúdo do arquivo ou NULL, caso não possa ser aberto ou esteja vazio
+ */
+const unsigned char* mapearArquivo(const char *caminho, size_t *tamanho) {
+#ifdef _WIN32
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return NULL;
+
+    unsigned char *dados = NULL;
+    if (fseek(arquivo, 0, SEEK_END) == 0) {
+        const long fim = ftell(arquivo);
+        if (fim > 0 && fseek(arquivo, 0, SEEK_SET) == 0 && (dados = malloc((size_t) fim)) != NULL) {
+            *tamanho = (size_t) fim;
+            if (fread(dados, 1, *tamanho, arquivo) != *tamanho) {
+                free(dados);
+                dados = NULL;
+            }
+        }
+    }
+    fclose(arquivo);
+
+    return dados;
+#else
+    const int arquivo = open(caminho, O_RDONLY);
+    if (arquivo < 0) return NULL;
+
+    struct stat info;
+    void *dados = MAP_FAILED;
+    if (fstat(arquivo, &info) == 0 && info.st_size > 0) {
+        *tamanho = (size_t) info.st_size;
+        dados = mmap(NULL, *tamanho, PROT_READ, MAP_PRIVATE, arquivo, 0);
+    }
+    // O mapeamento continua válido depois que o arquivo é fechado
+    close(arquivo);
+
+    if (dados == MAP_FAILED) return NULL;
+
+    // As chaves e as posições são lidas uma única vez, em sequência
+    madvise(dados, *tamanho, MADV_SEQUENTIAL);
+    return dados;
+#endif
+}
+
+/**
+ * Desfaz o mapeamento feito por mapearArquivo.
+ */
+void desmapearArquivo(const unsigned char *dados, const size_t tamanho) {
+#ifdef _WIN32
+    (void) tamanho;
+    free((void *) dados);
+#else
+    munmap((void *) dados, tamanho);
+#endif
+}
+
+/**
+ * Confere um nó cuja subárvore acabou de ser completada na reconstrução.
+ * @param posicao Posição gravada do nó
+ * @return 1 se a altura negra dos dois filhos corresponder à posição e um nó
+ *         vermelho não tiver filho vermelho, 0 caso contrário
+ */
+int conferirReconstruido(No *no, const int posicao) {
+    const int alturaFilhos = posicao / 2 - (no->cor == PRETO);
+    atualizaTamanho(no);
+
+    if (no->cor == VERMELHO && ((no->esquerdo && no->esquerdo->cor == VERMELHO) ||
+                                (no->direito && no->direito->cor == VERMELHO))) {
+        return 0;
+    }
+    return alturaFilhos >= 0 && alturaNegra(no->esquerdo) == alturaFilhos && alturaNegra(no->direito) == alturaFilhos;
+}
+
+/**
+ * Reconstrói a árvore a partir das chaves em ordem e das posições, em uma única
+ * passada. Como a posição de um nó é maior que a de todos os seus descendentes,
+ * a árvore é a árvore cartesiana das posições: uma pilha guarda a borda direita
+ * da árvore já construída, e cada novo nó adota como filho esquerdo os nós da
+ * borda com posição menor que a sua. Um nó é conferido quando sai da pilha, pois
+ * a sua subárvore não muda mais; como as subárvores dos filhos já foram
+ * conferidas, basta descer pela borda esquerda para obter as alturas negras.
+ * @param chaves Chaves em ordem crescente (podem se repetir, exceto no modo multiconjunto)
+ * @param contagens Contagem de cada chave ou NULL (uma ocorrência de cada)
+ * @param posicoes Posição de cada nó, na mesma ordem
+ * @param n Quantidade de chaves
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (os dados não formam uma rubro-negra) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore reconstruída ou NULL em caso de erro
+ */
+No* reconstruirArvore(const int32_t *chaves, const uint32_t *contagens, const unsigned char *posicoes,
+                      const int n, Status *status) {
+    No *pilha[INSTANTANEO_PILHA];
+    int posicaoPilha[INSTANTANEO_PILHA];
+    int topo = 0;
+    *status = STATUS_OK;
+
+    for (int i = 0; i <= n; i++) {
+        // Depois da última chave, a pilha inteira é esvaziada
+        const int posicao = i < n ? posicoes[i] : INT_MAX;
+        No *novo = NULL;
+
+        if (i < n) {
+            if ((i > 0 && (MULTICONJUNTO ? chaves[i - 1] >= chaves[i] : chaves[i - 1] > chaves[i])) ||
+                (contagens && (contagens[i] == 0 || contagens[i] > INT_MAX))) {
+                *status = STATUS_INVALIDO;
+            } else if ((novo = novoNo(chaves[i])) == NULL) {
+                *status = STATUS_SEM_MEMORIA;
+            } else {
+                novo->cor = posicao % 2 ? VERMELHO : PRETO;
+#if MULTICONJUNTO
+                if (contagens) novo->contagem = (int) contagens[i];
+#endif
+            }
+        }
+
+        No *ultimo = NULL;
+        while (*status == STATUS_OK && topo > 0 && posicaoPilha[topo - 1] < posicao) {
+            topo--;
+            ultimo = pilha[topo];
+            if (!conferirReconstruido(ultimo, posicaoPilha[topo])) *status = STATUS_INVALIDO;
+        }
+
+        if (*status == STATUS_OK && topo == INSTANTANEO_PILHA) *status = STATUS_INVALIDO;
+        // A raiz é sempre preta
+        if (*status == STATUS_OK && i == n && ultimo && ultimo->cor == VERMELHO) *status = STATUS_INVALIDO;
+
+        if (*status != STATUS_OK) {
+            // Todos os nós já criados continuam ligados à base da pilha ou ao último retirado
+            if (novo) poolLiberar(poolAtual, novo);
+            liberarSubarvore(topo > 0 ? pilha[0] : ultimo);
+            return NULL;
+        }
+
+        if (i == n) return ultimo;
+
+        novo->esquerdo = ultimo;
+        if (ultimo) ultimo->pai = novo;
+        if (topo > 0) {
+            pilha[topo - 1]->direito = novo;
+            novo->pai = pilha[topo - 1];
+        }
+        pilha[topo] = novo;
+        posicaoPilha[topo++] = posicao;
+    }
+
+    return NULL;
+}
+
+/**
+ * Carrega uma árvore de um arquivo de instantâneo.
+ * @param caminho Caminho do arquivo
+ * @param geracao Recebe a última geração do diário incluída no instantâneo (pode ser NULL)
+ * @param status Recebe STATUS_OK, STATUS_AUSENTE (o arquivo não pôde ser aberto),
+ *               STATUS_INVALIDO (o arquivo não é um instantâneo rubro-negro válido) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore carregada ou NULL em caso de erro
+ */
+No* carregarInstantaneo(const char *caminho, uint64_t *geracao, Status *status) {
+    size_t tamanho;
+    const unsigned char *dados = mapearArquivo(caminho, &tamanho);
+    if (dados == NULL) {
+        *status = STATUS_AUSENTE;
+        return NULL;
+    }
+
+    CabecalhoInstantaneo cabecalho;
+    No *raiz = NULL;
+    *status = STATUS_INVALIDO;
+
+    if (tamanho >= sizeof(cabecalho)) {
+        memcpy(&cabecalho, dados, sizeof(cabecalho));
+
+        // Um multiconjunto também carrega instantâneos sem contagens, desde que não haja chaves repetidas
+        const int multiconjunto = (cabecalho.tipo & INSTANTANEO_MULTICONJUNTO) != 0;
+        if (memcmp(cabecalho.assinatura, "ARVI", 4) == 0 && cabecalho.versao == INSTANTANEO_VERSAO &&
+            (cabecalho.tipo & ~INSTANTANEO_MULTICONJUNTO) == INSTANTANEO_RN && (MULTICONJUNTO || !multiconjunto) &&
+            cabecalho.ordem == INSTANTANEO_ORDEM && cabecalho.n <= INT_MAX &&
+            tamanho == tamanhoInstantaneo(cabecalho.n, multiconjunto)) {
+            // O cabeçalho tem 32 bytes, então as chaves e as contagens mapeadas já estão alinhadas
+            const int32_t *chaves = (const int32_t *) (dados + sizeof(cabecalho));
+            const uint32_t *contagens = multiconjunto ? (const uint32_t *) (chaves + cabecalho.n) : NULL;
+            const unsigned char *posicoes = (const unsigned char *) (chaves + cabecalho.n * (multiconjunto ? 2 : 1));
+            raiz = reconstruirArvore(chaves, contagens, posicoes, (int) cabecalho.n, status);
+            if (geracao) *geracao = cabecalho.geracao;
+        }
+    }
+
+    desmapearArquivo(dados, tamanho);
+    return raiz;
+}
+
+/* ============================================================
+   EXPORTAÇÃO PARA GRAPHVIZ (DOT) E JSON
+   ============================================================ */
+
+/*
+ * A árvore é escrita em pós-ordem, de modo que os identificadores dos filhos
+ * já são conhecidos quando o nó é escrito. O percurso é iterativo, com uma
+ * entrada de pilha por nível, e a saída passa por um buffer de EXPORTACAO_BUFFER bytes.
+ * Os identificadores são a posição do nó na pós-ordem; a raiz é o último nó.
+ */
+#define EXPORTACAO_PILHA  128       // maior que a altura de qualquer árvore válida
+#define EXPORTACAO_BUFFER (1 << 20)
+
+typedef enum {
+    EXPORTAR_DOT = 1, // digraph do Graphviz
+    EXPORTAR_JSON     // um objeto JSON por linha (NDJSON)
+} FormatoExportacao;
+
+typedef struct {
+    const No *no;
+    int visitado; // 0: nenhum filho visitado, 1: visitando o esquerdo, 2: visitando o direito
+    long long esquerdo, direito; // identificadores dos filhos (-1 se ausentes)
+} QuadroExportacao;
+
+/**
+ * Escreve um nó no formato escolhido.
+ * @param arquivo Arquivo de saída
+ * @param formato Formato da exportação
+ * @param quadro Nó com os identificadores dos seus filhos
+ * @param id Identificador do nó
+ * @return Valor de retorno de fprintf (negativo em caso de erro)
+ */
+int exportarNo(FILE *arquivo, const FormatoExportacao formato, const QuadroExportacao *quadro, const long long id) {
+    const No *no = quadro->no;
+
+    if (formato == EXPORTAR_JSON) {
+        char esquerdo[24] = "null", direito[24] = "null";
+        if (quadro->esquerdo >= 0) snprintf(esquerdo, sizeof(esquerdo), "%lld", quadro->esquerdo);
+        if (quadro->direito >= 0) snprintf(direito, sizeof(direito), "%lld", quadro->direito);
+#if MULTICONJUNTO
+        return fprintf(arquivo, "{\"id\":%lld,\"valor\":%d,\"contagem\":%d,\"cor\":\"%s\",\"esquerdo\":%s,\"direito\":%s}\n",
+                       id, no->valor, no->contagem, no->cor == VERMELHO ? "vermelho" : "preto", esquerdo, direito);
+#else
+        return fprintf(arquivo, "{\"id\":%lld,\"valor\":%d,\"cor\":\"%s\",\"esquerdo\":%s,\"direito\":%s}\n",
+                       id, no->valor, no->cor == VERMELHO ? "vermelho" : "preto", esquerdo, direito);
+#endif
+    }
+
+#if MULTICONJUNTO
+    int escritos = fprintf(arquivo, "  n%lld [label=\"%d (x%d)\", color=\"%s\"];\n", id, no->valor, no->contagem,
+                           no->cor == VERMELHO ? "red" : "black");
+#else
+    int escritos = fprintf(arquivo, "  n%lld [label=\"%d\", color=\"%s\"];\n", id, no->valor, no->cor == VERMELHO ? "red" : "black");
+#endif
+    if (escritos >= 0 && quadro->esquerdo >= 0) escritos = fprintf(arquivo, "  n%lld -> n%lld [label=\"e\"];\n", id, quadro->esquerdo);
+    if (escritos >= 0 && quadro->direito >= 0) escritos = fprintf(arquivo, "  n%lld -> n%lld [label=\"d\"];\n", id, quadro->direito);
+    return escritos;
+}
+
+/**
+ * Exporta a estrutura da árvore para um arquivo, como DOT ou NDJSON.
+ * @param raiz Raiz da árvore
+ * @param caminho Arquivo de saída, substituído caso já exista
+ * @param formato Formato da exportação
+ * @param bytes Recebe a quantidade de bytes escritos (pode ser NULL)
+ * @return STATUS_OK, STATUS_SEM_MEMORIA ou STATUS_INVALIDO se o arquivo não
+ *         puder ser gravado ou a árvore for mais alta que EXPORTACAO_PILHA
+ */
+Status exportarArvore(const No *raiz, const char *caminho, const FormatoExportacao formato, long long *bytes) {
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return STATUS_INVALIDO;
+
+    char *buffer = malloc(EXPORTACAO_BUFFER);
+    if (buffer == NULL) {
+        fclose(arquivo);
+        return STATUS_SEM_MEMORIA;
+    }
+    setvbuf(arquivo, buffer, _IOFBF, EXPORTACAO_BUFFER);
+
+    int ok = formato == EXPORTAR_DOT ? fprintf(arquivo, "digraph rn {\n  node [shape=box];\n") >= 0 : 1;
+
+    QuadroExportacao pilha[EXPORTACAO_PILHA];
+    int topo = 0;
+    long long proximo = 0;
+    if (raiz) pilha[topo++] = (QuadroExportacao) {raiz, 0, -1, -1};
+
+    while (topo > 0 && ok) {
+        QuadroExportacao *quadro = &pilha[topo - 1];
+        const No *filho = NULL;
+
+        // Desce primeiro pelo filho esquerdo e depois pelo direito
+        if (quadro->visitado < 2) {
+            filho = quadro->visitado == 0 ? quadro->no->esquerdo : quadro->no->direito;
+            quadro->visitado++;
+            if (filho == NULL) continue;
+            if (topo == EXPORTACAO_PILHA) {
+                ok = 0;
+                break;
+            }
+            pilha[topo++] = (QuadroExportacao) {filho, 0, -1, -1};
+            continue;
+        }
+
+        // Os dois filhos já foram escritos: escreve o nó e avisa o pai
+        const long long id = proximo++;
+        ok = exportarNo(arquivo, formato, quadro, id) >= 0;
+        topo--;
+        if (topo > 0) {
+            QuadroExportacao *pai = &pilha[topo - 1];
+            if (pai->visitado == 1) pai->esquerdo = id;
+            else pai->direito = id;
+        }
+    }
+
+    if (ok && formato == EXPORTAR_DOT) ok = fprintf(arquivo, "}\n") >= 0;
+    if (bytes) *bytes = ftell(arquivo);
+    if (fclose(arquivo) != 0) ok = 0;
+    free(buffer);
+
+    return ok ? STATUS_OK : STATUS_INVALIDO;
+}
+
+/* ============================================================
+   MODO BENCHMARK
+   ============================================================ */
+
+#define BENCH_AMOSTRAS 1048576 // máximo de latências amostradas por operação
+
+#define BENCH_INSERIR   0
+#define BENCH_PESQUISAR 1
+#define BENCH_AUSENTE   2
+#define BENCH_CONGELADA 3 // pesquisa bem-sucedida no instantâneo congelado
+#define BENCH_REMOVER   4
+
+/**
+ * Embaralha um inteiro de 32 bits (finalizador do MurmurHash3).
+ * A função é bijetora, portanto índices distintos sempre geram chaves distintas.
+ */
+unsigned int embaralhar(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Gera a i-ésima chave da sequência do benchmark.
+ * A mesma sequência é gerada em todos os programas, para que as árvores sejam comparáveis.
+ * @param i Índice da chave
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ */
+int chaveBench(const unsigned int i, const int ordenada) {
+    return ordenada ? (int) i : (int) embaralhar(i);
+}
+
+/**
+ * Retorna o instante atual em nanossegundos.
+ */
+long long agoraNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Retorna o pico de memória residente do processo, em kilobytes (0 quando indisponível).
+ */
+long picoMemoriaKb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * Compara duas latências, para a ordenação com qsort.
+ */
+int compararLatencias(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Motores da Rubro-Negra que podem ser medidos pelo benchmark.
+ */
+typedef enum {
+    MOTOR_PONTEIROS,  // nós com ponteiro para o pai e ajuste de baixo para cima
+    MOTOR_COMPACTA,   // armazenamento compacto (índices de 32 bits)
+    MOTOR_DESCENDENTE // ajuste de cima para baixo, sem ponteiro para o pai
+} Motor;
+
+/**
+ * Árvore utilizada no benchmark, em um dos motores.
+ */
+typedef struct {
+    Motor motor;
+    No *raiz;
+    uint32_t raizC;
+    NoDescendente *raizD;
+} ArvoreBench;
+
+/**
+ * Aplica a operação do benchmark correspondente ao índice i.
+ * @param arvore Árvore do benchmark
+ * @param operacao Operação a ser aplicada (BENCH_*)
+ * @param chave Chave da operação
+ * @param encontrados Contador de pesquisas bem-sucedidas (evita que a pesquisa seja descartada pelo compilador)
+ */
+void aplicarBench(ArvoreBench *arvore, const int operacao, const int chave, unsigned int *encontrados) {
+    Status status;
+
+    if (arvore->motor == MOTOR_DESCENDENTE) {
+        switch (operacao) {
+            case BENCH_INSERIR:
+                arvore->raizD = inserirNoRND(arvore->raizD, chave, &status);
+                break;
+            case BENCH_REMOVER:
+                arvore->raizD = removeNoRND(arvore->raizD, chave, &status);
+                break;
+            case BENCH_CONGELADA:
+                *encontrados += pesquisaCongelada(chave);
+                break;
+            default:
+                *encontrados += pesquisaNoD(arvore->raizD, chave) != NULL;
+        }
+    } else if (arvore->motor == MOTOR_COMPACTA) {
+        switch (operacao) {
+            case BENCH_INSERIR:
+                arvore->raizC = inserirNoRNC(arvore->raizC, chave, &status);
+                break;
+            case BENCH_REMOVER:
+                arvore->raizC = removeNoRNC(arvore->raizC, chave, &status);
+                break;
+            case BENCH_CONGELADA:
+                *encontrados += pesquisaCongelada(chave);
+                break;
+            default:
+                *encontrados += pesquisaNoC(arvore->raizC, chave) != NULO;
+        }
+    } else {
+        switch (operacao) {
+            case BENCH_INSERIR:
+                arvore->raiz = inserirNoRN(arvore->raiz, chave, &status);
+                break;
+            case BENCH_REMOVER:
+                arvore->raiz = removeNoRN(arvore->raiz, chave, &status);
+                break;
+            case BENCH_CONGELADA:
+                *encontrados += pesquisaCongelada(chave);
+                break;
+            default:
+                *encontrados += pesquisaNo(arvore->raiz, chave) != NULL;
+        }
+    }
+}
+
+/**
+ * Gera a chave da i-ésima repetição de uma operação do benchmark.
+ * As pesquisas bem-sucedidas sorteiam chaves já inseridas, e as sem sucesso usam
+ * chaves que nunca foram inseridas.
+ */
+int chaveOperacao(const int operacao, const unsigned int i, const unsigned int n, const int ordenada) {
+    switch (operacao) {
+        case BENCH_PESQUISAR:
+        case BENCH_CONGELADA:
+            return chaveBench(embaralhar(i ^ 0x9e3779b9u) % n, ordenada);
+        case BENCH_AUSENTE:
+            return chaveBench(n + i, ordenada);
+        default:
+            return chaveBench(i, ordenada);
+    }
+}
+
+/**
+ * Executa n repetições de uma operação e escreve uma linha CSV com os resultados:
+ * motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura
+ * @param arvore Árvore do benchmark
+ * @param operacao Operação a ser medida (BENCH_*)
+ * @param n Quantidade de repetições
+ * @param ordenada Tipo de carga
+ */
+void medirBench(ArvoreBench *arvore, const int operacao, const unsigned int n, const int ordenada) {
+    static long long amostras[BENCH_AMOSTRAS];
+    const char *nomes[] = {"inserir", "pesquisar", "pesquisar_ausente", "pesquisar_congelada", "remover"};
+
+    // Apenas uma a cada "passo" operações tem a latência medida individualmente
+    const unsigned int passo = n / BENCH_AMOSTRAS + 1;
+    unsigned int encontrados = 0;
+    size_t qtd = 0;
+
+    const long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) {
+        const int chave = chaveOperacao(operacao, i, n, ordenada);
+
+        if (i % passo == 0) {
+            const long long t0 = agoraNs();
+            aplicarBench(arvore, operacao, chave, &encontrados);
+            amostras[qtd++] = agoraNs() - t0;
+        } else {
+            aplicarBench(arvore, operacao, chave, &encontrados);
+        }
+    }
+    const long long total = agoraNs() - inicio;
+
+    qsort(amostras, qtd, sizeof(long long), compararLatencias);
+
+    const char *motores[] = {"rn", "rn_compacta", "rn_descendente"};
+    const int altura = arvore->motor == MOTOR_DESCENDENTE ? alturaD(arvore->raizD)
+                     : arvore->motor == MOTOR_COMPACTA ? alturaC(arvore->raizC) : alturaNo(arvore->raiz);
+
+    printf("%s,%s,%s,%u,%.0f,%.2f,%lld,%lld,%lld,%ld,%d\n",
+           motores[arvore->motor],
+           ordenada ? "ordenada" : "aleatoria", nomes[operacao], n,
+           n / (total / 1e9), (double) total / n,
+           amostras[qtd / 2], amostras[qtd * 99 / 100], amostras[qtd * 999 / 1000],
+           picoMemoriaKb(), altura);
+
+    if ((operacao == BENCH_PESQUISAR || operacao == BENCH_CONGELADA) && encontrados != n) {
+        fprintf(stderr, "ERRO: %u de %u chaves foram encontradas\n", encontrados, n);
+    }
+}
+
+/**
+ * Executa o benchmark completo (inserção, pesquisa, pesquisa sem sucesso, pesquisa
+ * no instantâneo congelado e remoção) sem interação.
+ * @param n Quantidade de chaves
+ * @param ordenada Tipo de carga
+ * @param motor Motor da árvore (ponteiros, compacta ou descendente)
+ * @return Código de saída do programa
+ */
+int executarBenchmark(const unsigned int n, const int ordenada, const Motor motor) {
+    ArvoreBench arvore = {motor, NULL, NULO, NULL};
+
+    if (n == 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    for (int operacao = BENCH_INSERIR; operacao <= BENCH_REMOVER; operacao++) {
+        // O instantâneo é congelado logo antes de ser pesquisado
+        if (operacao == BENCH_CONGELADA) {
+            const Status status = motor == MOTOR_DESCENDENTE ? congelarD(arvore.raizD)
+                                : motor == MOTOR_COMPACTA ? congelarC(arvore.raizC) : congelar(arvore.raiz);
+            if (status != STATUS_OK) {
+                fprintf(stderr, "ERRO: não foi possível congelar a árvore\n");
+                return 1;
+            }
+        }
+
+        medirBench(&arvore, operacao, n, ordenada);
+    }
+
+    destruirCongelada();
+    poolDestruir(&poolNos);
+    destruirCompacto();
+    destruirDescendente();
+    return 0;
+}
+
+/**
+ * Mede as operações de conjunto em paralelo entre duas árvores de n chaves
+ * aleatórias, das quais metade é comum às duas, escrevendo uma linha CSV por operação:
+ * motor,operacao,n,threads,ms,tamanho
+ * @param n Quantidade de chaves de cada árvore
+ * @param threads Quantidade de threads
+ * @return Código de saída do programa
+ */
+int executarConjuntos(const unsigned int n, const int threads) {
+    const char *nomes[] = {"uniao", "intersecao", "diferenca"};
+
+    if (n == 0 || threads <= 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves e de threads deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    for (int operacao = CONJUNTO_UNIAO; operacao <= CONJUNTO_DIFERENCA; operacao++) {
+        Status statusA, statusB;
+
+        // As árvores são reconstruídas a cada operação, já que são consumidas por ela
+        for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+        No *a = construirArvore(valores, (int) n, &statusA);
+        for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(n / 2 + i, 0);
+        No *b = construirArvore(valores, (int) n, &statusB);
+
+        if (statusA != STATUS_OK || statusB != STATUS_OK) {
+            fprintf(stderr, "ERRO: não foi possível construir as árvores\n");
+            free(valores);
+            poolDestruir(&poolNos);
+            return 1;
+        }
+
+        const long long inicio = agoraNs();
+        No *resultado = conjuntoParalelo((OperacaoConjunto) operacao, a, b, threads);
+        const long long total = agoraNs() - inicio;
+
+        printf("rn,%s,%u,%d,%.3f,%d\n", nomes[operacao], n, threads, total / 1e6, contarNos(resultado));
+        poolDestruir(&poolNos);
+    }
+
+    free(valores);
+    return 0;
+}
+
+/**
+ * Trabalho de uma thread no benchmark da árvore particionada: as chaves de
+ * índice i com i % threads == indice, para que as threads não se repitam
+ */
+typedef struct {
+    int operacao;
+    unsigned int n;
+    int threads;
+    int indice;
+    int ordenada;
+} CargaParticionada;
+
+void* executarCargaParticionada(void *argumento) {
+    const CargaParticionada *carga = argumento;
+
+    for (unsigned int i = (unsigned int) carga->indice; i < carga->n; i += (unsigned int) carga->threads) {
+        const int chave = chaveBench(i, carga->ordenada);
+        if (carga->operacao == BENCH_INSERIR) {
+            inserirParticionada(chave);
+        } else if (carga->operacao == BENCH_PESQUISAR) {
+            pesquisarParticionada(chave);
+        } else {
+            removerParticionada(chave);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Mede a inserção, a pesquisa e a remoção de n chaves na árvore particionada,
+ * com as chaves divididas entre as threads, escrevendo uma linha CSV por operação:
+ * motor,operacao,n,threads,fatias,ms
+ * @param n Quantidade de chaves
+ * @param threads Quantidade de threads
+ * @param fatias Quantidade de fatias
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ * @return Código de saída do programa
+ */
+int executarParticionada(const unsigned int n, const int threads, const int fatias, const int ordenada) {
+    const int operacoes[] = {BENCH_INSERIR, BENCH_PESQUISAR, BENCH_REMOVER};
+    const char *nomes[] = {"inserir", "pesquisar", "remover"};
+
+    if (n == 0 || threads <= 0 || threads > FATIAS_MAXIMO || fatias <= 0 || fatias > FATIAS_MAXIMO) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva e as de threads e fatias, entre 1 e %d\n", FATIAS_MAXIMO);
+        return 1;
+    }
+
+    iniciarParticionada(fatias);
+
+    for (int o = 0; o < 3; o++) {
+        pthread_t ids[FATIAS_MAXIMO];
+        CargaParticionada cargas[FATIAS_MAXIMO];
+        int criadas = 0;
+
+        const long long inicio = agoraNs();
+        for (int t = 0; t < threads; t++) {
+            cargas[t] = (CargaParticionada) {operacoes[o], n, threads, t, ordenada};
+            if (pthread_create(&ids[t], NULL, executarCargaParticionada, &cargas[t]) != 0) break;
+            criadas++;
+        }
+        for (int t = 0; t < criadas; t++) pthread_join(ids[t], NULL);
+        const long long total = agoraNs() - inicio;
+
+        if (criadas < threads) {
+            fprintf(stderr, "ERRO: não foi possível criar as threads\n");
+            destruirParticionada();
+            return 1;
+        }
+
+        printf("rn,%s,%u,%d,%d,%.3f\n", nomes[o], n, threads, fatias, total / 1e6);
+    }
+
+    destruirParticionada();
+    return 0;
+}
+
+/**
+ * Compara as formas de recuperar uma árvore de n chaves aleatórias guardada em
+ * arquivo, escrevendo uma linha CSV:
+ * motor,modo,n,bytes,salvar_ms,carregar_ms,reinserir_ms
+ * A última coluna é o tempo de reconstruir a mesma árvore inserindo as chaves uma a uma.
+ * @param n Quantidade de chaves
+ * @param caminho Arquivo de instantâneo, substituído caso já exista
+ * @return Código de saída do programa
+ */
+int executarInstantaneo(const unsigned int n, const char *caminho) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    Status status;
+    for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+    No *raiz = construirArvore(valores, (int) n, &status);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível construir a árvore\n");
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+
+    long long inicio = agoraNs();
+    status = salvarInstantaneo(raiz, caminho);
+    const long long salvar = agoraNs() - inicio;
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar %s\n", caminho);
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+    poolDestruir(&poolNos);
+
+    inicio = agoraNs();
+    raiz = carregarInstantaneo(caminho, NULL, &status);
+    const long long carregar = agoraNs() - inicio;
+    if (status != STATUS_OK || contarNos(raiz) != (int) n) {
+        fprintf(stderr, "ERRO: não foi possível carregar %s\n", caminho);
+        free(valores);
+        poolDestruir(&poolNos);
+        return 1;
+    }
+    poolDestruir(&poolNos);
+
+    // A alternativa sem instantâneo: inserir as chaves uma a uma
+    raiz = NULL;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) raiz = inserirNoRN(raiz, valores[i], &status);
+    const long long reinserir = agoraNs() - inicio;
+
+    printf("rn,instantaneo,%u,%llu,%.3f,%.3f,%.3f\n", n,
+           (unsigned long long) tamanhoInstantaneo((uint64_t) n, MULTICONJUNTO),
+           salvar / 1e6, carregar / 1e6, reinserir / 1e6);
+
+    free(valores);
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+/**
+ * Mede a exportação de uma árvore de n chaves aleatórias, escrevendo uma linha CSV:
+ * motor,modo,n,formato,bytes,ms
+ * @param n Quantidade de chaves
+ * @param caminho Arquivo de saída, substituído caso já exista
+ * @param formato Formato da exportação
+ * @return Código de saída do programa
+ */
+int executarExportacao(const unsigned int n, const char *caminho, const FormatoExportacao formato) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    int *valores = malloc(sizeof(int) * n);
+    if (valores == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    Status status;
+    for (unsigned int i = 0; i < n; i++) valores[i] = chaveBench(i, 0);
+    No *raiz = construirArvore(valores, (int) n, &status);
+    free(valores);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível construir a árvore\n");
+        poolDestruir(&poolNos);
+        return 1;
+    }
+
+    long long bytes = 0;
+    const long long inicio = agoraNs();
+    status = exportarArvore(raiz, caminho, formato, &bytes);
+    const long long exportar = agoraNs() - inicio;
+    poolDestruir(&poolNos);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar %s\n", caminho);
+        return 1;
+    }
+
+    printf("rn,exportar,%u,%s,%lld,%.3f\n", n, formato == EXPORTAR_DOT ? "dot" : "json", bytes, exportar / 1e6);
+    return 0;
+}
+
+/*
+ * Instâncias das árvores genéricas (arvore_generica.h) medidas por --generica:
+ * a mesma chave int da árvore do programa e chaves de 64 bits.
+ */
+DEFINIR_RN(rnInt, int, int, COMPARAR_NUMEROS)
+DEFINIR_RN(rn64, int64_t, int64_t, COMPARAR_NUMEROS)
+
+/**
+ * Gera a i-ésima chave de 64 bits, espalhando as chaves de chaveBench além do alcance de int.
+ */
+int64_t chaveBench64(const unsigned int i) {
+    return (int64_t) chaveBench(i, 0) * 1048576;
+}
+
+/**
+ * Compara a árvore do programa com as versões genéricas, escrevendo uma linha CSV por variante:
+ * motor,modo,n,variante,inserir_ms,pesquisar_ms,remover_ms
+ * @param n Quantidade de chaves aleatórias
+ * @return Código de saída do programa
+ */
+int executarGenerica(const unsigned int n) {
+    if (n == 0 || n > INT_MAX) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    Status status = STATUS_OK;
+    int falhou = 0;
+    long long encontrados = 0, inicio, inserir, pesquisar;
+
+    // Árvore do programa
+    No *raiz = NULL;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) raiz = inserirNoRN(raiz, chaveBench(i, 0), &status);
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += pesquisaNo(raiz, chaveBench(i, 0)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) raiz = removeNoRN(raiz, chaveBench(i, 0), &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("rn,generica,%u,programa,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    poolDestruir(&poolNos);
+
+    // Versão genérica com chaves int
+    rnIntArvore arvoreInt = {0};
+    encontrados = 0;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) rnIntInserir(&arvoreInt, chaveBench(i, 0), (int) i, &status);
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += rnIntPesquisar(&arvoreInt, chaveBench(i, 0)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) rnIntRemover(&arvoreInt, chaveBench(i, 0), NULL, &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("rn,generica,%u,int,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    rnIntDestruir(&arvoreInt);
+
+    // Versão genérica com chaves de 64 bits, fora do alcance de int
+    rn64Arvore arvore64 = {0};
+    encontrados = 0;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) {
+        rn64Inserir(&arvore64, chaveBench64(i), (int64_t) i, &status);
+    }
+    inserir = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) encontrados += rn64Pesquisar(&arvore64, chaveBench64(i)) != NULL;
+    pesquisar = agoraNs() - inicio;
+    inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) rn64Remover(&arvore64, chaveBench64(i), NULL, &status);
+    if (status != STATUS_OK || encontrados != n) {
+        falhou = 1;
+    } else {
+        printf("rn,generica,%u,int64,%.3f,%.3f,%.3f\n", n, inserir / 1e6, pesquisar / 1e6, (agoraNs() - inicio) / 1e6);
+    }
+    rn64Destruir(&arvore64);
+
+    if (falhou) {
+        fprintf(stderr, "ERRO: a árvore não contém todas as chaves inseridas\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================
+   MODO EM LOTE (FLUXO BINÁRIO)
+   ============================================================ */
+
+/*
+ * Formato dos registros (inteiros em little-endian):
+ * - requisição: 1 byte de operação + 4 bytes de chave
+ * - resposta:   1 byte de status + 4 bytes de valor
+ */
+#define LOTE_REGISTRO 5     // tamanho, em bytes, de uma requisição ou resposta
+#define LOTE_BUFFER   4096  // quantidade de registros lidos/escritos por chamada
+
+#define OP_INSERIR   1
+#define OP_REMOVER   2
+#define OP_PESQUISAR 3
+#define OP_CONTADORES 4 // escreve os contadores na saída de erro, em texto
+#define OP_CONGELAR   5 // (re)constrói o instantâneo congelado
+#define OP_PESQUISAR_CONGELADA 6
+#define OP_POSICAO    7 // responde a quantidade de valores menores que a chave
+#define OP_SELECIONAR 8 // a chave é a posição k; responde o k-ésimo menor valor
+
+/* O status de cada resposta é o próprio Status retornado pela operação */
+
+/**
+ * Lê um inteiro de 32 bits em little-endian.
+ */
+int lerInt32(const unsigned char *p) {
+    return (int) ((unsigned int) p[0] | (unsigned int) p[1] << 8 |
+                  (unsigned int) p[2] << 16 | (unsigned int) p[3] << 24);
+}
+
+/**
+ * Escreve um inteiro de 32 bits em little-endian.
+ */
+void escreverInt32(unsigned char *p, const int valor) {
+    const unsigned int v = (unsigned int) valor;
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+    p[2] = (unsigned char) (v >> 16);
+    p[3] = (unsigned char) (v >> 24);
+}
+
+/**
+ * Aplica uma requisição do fluxo binário na árvore.
+ * @param raiz Raiz da árvore
+ * @param requisicao Registro de requisição (operação + chave)
+ * @param resposta Registro onde a resposta (status + valor) será escrita
+ * @return Nova raiz da árvore
+ */
+No* processarRegistro(No *raiz, const unsigned char *requisicao, unsigned char *resposta) {
+    const int chave = lerInt32(requisicao + 1);
+    int valor = chave;
+    Status status = STATUS_OK;
+
+    switch (requisicao[0]) {
+        case OP_INSERIR:
+            raiz = inserirNoRN(raiz, chave, &status);
+            break;
+
+        case OP_REMOVER:
+            raiz = removeNoRN(raiz, chave, &status);
+            break;
+
+        case OP_PESQUISAR:
+            if (!pesquisaNo(raiz, chave)) status = STATUS_AUSENTE;
+            break;
+
+        case OP_CONTADORES:
+            exibirContadores(stderr);
+            break;
+
+        case OP_CONGELAR:
+            status = congelar(raiz);
+            break;
+
+        case OP_PESQUISAR_CONGELADA:
+            if (!pesquisaCongelada(chave)) status = STATUS_AUSENTE;
+            break;
+
+#if ESTATISTICA_ORDEM
+        case OP_POSICAO:
+            valor = posicao(raiz, chave);
+            break;
+
+        case OP_SELECIONAR: {
+            const No *no = selecionar(raiz, chave);
+            if (no) {
+                valor = no->valor;
+            } else {
+                status = STATUS_AUSENTE;
+            }
+            break;
+        }
+#endif
+
+        default:
+            status = STATUS_INVALIDO;
+    }
+
+    resposta[0] = (unsigned char) status;
+    escreverInt32(resposta + 1, valor);
+
+    return raiz;
+}
+
+/**
+ * Processa um fluxo binário de requisições, sem nenhuma interação com o usuário,
+ * escrevendo uma resposta para cada requisição recebida.
+ * @param entrada Fluxo de requisições
+ * @param saida Fluxo de respostas
+ * @return Código de saída do programa
+ */
+int executarLote(FILE *entrada, FILE *saida) {
+    static unsigned char requisicoes[LOTE_BUFFER * LOTE_REGISTRO];
+    static unsigned char respostas[LOTE_BUFFER * LOTE_REGISTRO];
+    No *raiz = NULL;
+    size_t lidos;
+
+    while ((lidos = fread(requisicoes, LOTE_REGISTRO, LOTE_BUFFER, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            raiz = processarRegistro(raiz, requisicoes + i * LOTE_REGISTRO, respostas + i * LOTE_REGISTRO);
+        }
+
+        if (fwrite(respostas, LOTE_REGISTRO, lidos, saida) != lidos) {
+            fprintf(stderr, "ERRO: falha ao escrever as respostas\n");
+            poolDestruir(&poolNos);
+            return 1;
+        }
+    }
+
+    fflush(saida);
+    destruirCongelada();
+    poolDestruir(&poolNos);
+    return ferror(entrada) ? 1 : 0;
+}
+
+/* ============================================================
+   DIÁRIO DE OPERAÇÕES (WRITE-AHEAD LOG)
+   ============================================================ */
+
+/*
+ * Persistência da árvore do menu em arquivos com o mesmo prefixo:
+ * - <base>.rn:        instantâneo com o estado até uma geração do diário
+ * - <base>.diario.<g>: diários, um por geração; só o de maior geração recebe operações
+ * Cada diário tem um cabeçalho com a sua geração, seguido de registros de
+ * DIARIO_REGISTRO bytes: a operação (OP_INSERIR ou OP_REMOVER), a chave em
+ * little-endian e um byte de verificação, que identifica um registro incompleto
+ * no final do arquivo depois de uma queda.
+ * A compactação troca o diário por um da geração seguinte e grava o instantâneo
+ * em segundo plano; só depois que ele está no disco os diários que ele inclui
+ * são apagados, de modo que uma queda em qualquer ponto não perde operações.
+ * Uma operação só é confirmada depois de registrada. A sincronização com o disco
+ * é feita em grupo, uma vez a cada `lote` operações, e os registros ainda não
+ * sincronizados são os únicos que podem ser perdidos. Com várias threads, a que
+ * completa o lote sincroniza os registros de todas, e as demais apenas esperam.
+ */
+#define DIARIO_REGISTRO 6
+#define DIARIO_CAMINHO  1024
+#define DIARIO_BASE     (DIARIO_CAMINHO - 32) // sobra espaço para as extensões
+
+typedef struct {
+    char assinatura[4]; // "ARVD"
+    uint32_t versao;
+    uint32_t tipo;      // INSTANTANEO_RN ou INSTANTANEO_RN
+    uint32_t ordem;     // INSTANTANEO_ORDEM
+    uint64_t geracao;
+} CabecalhoDiario;
+
+/**
+ * Instantâneo copiado da árvore, gravado em segundo plano pela compactação.
+ */
+typedef struct {
+    int32_t *chaves;
+    uint32_t *contagens; // só no modo multiconjunto
+    unsigned char *posicoes;
+    int n;
+    uint64_t geracao;
+    Status status;
+} Compactacao;
+
+typedef struct {
+    FILE *arquivo;                      // NULL quando não há diário aberto
+    uint64_t geracao;                   // geração do diário atual
+    int lote;                           // operações por sincronização
+    unsigned long long registrados;     // registros escritos no diário atual
+    unsigned long long sincronizados;   // registros já gravados no disco
+    int sincronizando;                  // há uma thread sincronizando o arquivo
+    int falhou;                         // houve erro de escrita no diário atual
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    pthread_t thread;
+    int compactando;                    // há um instantâneo sendo gravado em segundo plano
+    Compactacao compactacao;
+    char base[DIARIO_BASE];
+} Diario;
+
+static Diario diario = {.trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER};
+
+/**
+ * Monta o caminho do diário de uma geração.
+ */
+void caminhoDiario(char *caminho, const uint64_t geracao) {
+    snprintf(caminho, DIARIO_CAMINHO, "%s.diario.%llu", diario.base, (unsigned long long) geracao);
+}
+
+/**
+ * Monta o caminho do instantâneo (com um sufixo opcional, para o arquivo temporário).
+ */
+void caminhoInstantaneo(char *caminho, const char *sufixo) {
+    snprintf(caminho, DIARIO_CAMINHO, "%s.rn%s", diario.base, sufixo);
+}
+
+/**
+ * Calcula o byte de verificação de um registro do diário.
+ */
+unsigned char verificacaoDiario(const unsigned char *registro) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < DIARIO_REGISTRO - 1; i++) {
+        h = (h ^ registro[i]) * 16777619u;
+    }
+    return (unsigned char) (h ^ h >> 8 ^ h >> 16 ^ h >> 24);
+}
+
+/**
+ * Reduz um arquivo ao tamanho informado, descartando o final.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int truncarArquivo(const char *caminho, const size_t tamanho) {
+#ifdef _WIN32
+    const int arquivo = _open(caminho, _O_RDWR | _O_BINARY);
+    if (arquivo < 0) return 0;
+    const int ok = _chsize_s(arquivo, (long long) tamanho) == 0;
+    _close(arquivo);
+    return ok;
+#else
+    return truncate(caminho, (off_t) tamanho) == 0;
+#endif
+}
+
+/**
+ * Substitui um arquivo por outro, mesmo que o destino já exista.
+ * @return 1 em caso de sucesso, 0 caso contrário
+ */
+int substituirArquivo(const char *origem, const char *destino) {
+#ifdef _WIN32
+    remove(destino);
+#endif
+    return rename(origem, destino) == 0;
+}
+
+/**
+ * Indica se um arquivo existe e pode ser lido.
+ */
+int arquivoExiste(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return 0;
+    fclose(arquivo);
+    return 1;
+}
+
+/**
+ * Apaga os diários de uma geração e das anteriores a ela. Os diários são apagados
+ * do mais antigo para o mais novo: se o processo for interrompido no meio, os que
+ * sobram ainda formam uma sequência terminada na geração, que a próxima chamada
+ * encontra descendo a partir dela até a primeira geração sem diário.
+ */
+void apagarDiarios(const uint64_t geracao) {
+    char caminho[DIARIO_CAMINHO];
+    uint64_t primeira = geracao + 1;
+
+    while (primeira > 1) {
+        caminhoDiario(caminho, primeira - 1);
+        if (!arquivoExiste(caminho)) break;
+        primeira--;
+    }
+
+    for (; primeira <= geracao; primeira++) {
+        caminhoDiario(caminho, primeira);
+        remove(caminho);
+    }
+}
+
+/**
+ * Aplica na árvore os registros do diário de uma geração. Um registro incompleto
+ * ou inválido marca o fim do diário: ele e tudo o que vem depois são descartados do arquivo.
+ * @param raiz Raiz da árvore
+ * @param geracao Geração do diário
+ * @param status Recebe STATUS_OK, STATUS_AUSENTE (o diário não existe), STATUS_INVALIDO
+ *               (o arquivo não é um diário desta árvore) ou STATUS_SEM_MEMORIA
+ * @return Nova raiz da árvore
+ */
+No* reaplicarDiario(No *raiz, const uint64_t geracao, Status *status) {
+    char caminho[DIARIO_CAMINHO];
+    caminhoDiario(caminho, geracao);
 
-    // Calcula o espaço restante para preenchimento
-    const double pad = (double) (total - tam) / 2.0;
+    size_t tamanho;
+    const unsigned char *dados = mapearArquivo(caminho, &tamanho);
+    if (dados == NULL) {
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
 
-    // Define quantos caracteres serão colocados à esquerda e à direita
-    const int padEsq = (int) (ajustarEsq ? floor(pad) : ceil(pad));
-    const int padDir = (int) (ajustarEsq ? ceil(pad) : floor(pad));
+    // Um diário sem o cabeçalho completo foi interrompido antes de receber registros
+    CabecalhoDiario cabecalho;
+    if (tamanho < sizeof(cabecalho)) {
+        desmapearArquivo(dados, tamanho);
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
+
+    memcpy(&cabecalho, dados, sizeof(cabecalho));
+    if (memcmp(cabecalho.assinatura, "ARVD", 4) != 0 || cabecalho.versao != INSTANTANEO_VERSAO ||
+        cabecalho.tipo != INSTANTANEO_RN || cabecalho.ordem != INSTANTANEO_ORDEM || cabecalho.geracao != geracao) {
+        desmapearArquivo(dados, tamanho);
+        *status = STATUS_INVALIDO;
+        return raiz;
+    }
+
+    *status = STATUS_OK;
+    size_t fim = sizeof(cabecalho);
+    while (fim + DIARIO_REGISTRO <= tamanho) {
+        const unsigned char *registro = dados + fim;
+        if (registro[DIARIO_REGISTRO - 1] != verificacaoDiario(registro)) break;
+
+        Status aplicado = STATUS_OK;
+        if (registro[0] == OP_INSERIR) {
+            raiz = inserirNoRN(raiz, lerInt32(registro + 1), &aplicado);
+        } else if (registro[0] == OP_REMOVER) {
+            raiz = removeNoRN(raiz, lerInt32(registro + 1), &aplicado);
+        } else {
+            break;
+        }
 
-    // Preenchimento à esquerda
-    for (int p = 0; p < padEsq; p++) wprintf(L"%ls", fillEsq);
+        if (aplicado == STATUS_SEM_MEMORIA) {
+            *status = STATUS_SEM_MEMORIA;
+            break;
+        }
+        fim += DIARIO_REGISTRO;
+    }
+    desmapearArquivo(dados, tamanho);
 
-    // Impressão da string centralizada
-    wprintf(L"%ls", str);
+    // Descarta o registro incompleto, para que os próximos sejam acrescentados depois do último válido
+    if (*status == STATUS_OK && fim < tamanho && !truncarArquivo(caminho, fim)) *status = STATUS_INVALIDO;
 
-    // Preenchimento à direita
-    for (int p = 0; p < padDir; p++) wprintf(L"%ls", fillDir);
+    return raiz;
 }
 
 /**
- * Imprime um único nó da árvore, incluindo:
- * - o valor do nó
- * - os conectores gráficos (┌ ┐ ─)
- * A posição do nó é calculada com base na altura da árvore.
- *
- * @param no Nó a ser impresso
- * @param altura Altura atual da camada
- * @param compr Largura padrão para cada nó
- * @param ajustarEsq Indica se o alinhamento deve ser ajustado
+ * Cria o diário de uma geração, vazio e já sincronizado com o disco.
+ * @return Arquivo aberto para acréscimos ou NULL em caso de erro
  */
-void imprimeNo(const No *no, const int altura, const int compr, const int ajustarEsq) {
-    // Espaçamento necessário entre os nós
-    const int halfPad = (1 << (altura - 1)) - 1;
+FILE* criarDiario(const uint64_t geracao) {
+    char caminho[DIARIO_CAMINHO];
+    caminhoDiario(caminho, geracao);
+
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) return NULL;
+
+    const CabecalhoDiario cabecalho = {
+        {'A', 'R', 'V', 'D'}, INSTANTANEO_VERSAO, INSTANTANEO_RN, INSTANTANEO_ORDEM, geracao
+    };
+    if (fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 || !sincronizarArquivo(arquivo)) {
+        fclose(arquivo);
+        return NULL;
+    }
+
+    return arquivo;
+}
 
-    // Espaços iniciais antes do conector esquerdo
-    for (int p = 0; p < halfPad * compr; p++) wprintf(L" ");
+/**
+ * Recupera a árvore a partir dos arquivos de um prefixo (o instantâneo e os
+ * diários posteriores a ele) e abre o diário para as próximas operações.
+ * @param base Prefixo dos arquivos
+ * @param lote Quantidade de operações por sincronização com o disco
+ * @param status Recebe STATUS_OK, STATUS_INVALIDO (prefixo longo demais, arquivos corrompidos
+ *               ou de outra árvore, ou o diário não pôde ser aberto) ou STATUS_SEM_MEMORIA
+ * @return Raiz da árvore recuperada
+ */
+No* abrirDiario(const char *base, const int lote, Status *status) {
+    char caminho[DIARIO_CAMINHO];
+    if (strlen(base) >= DIARIO_BASE) {
+        *status = STATUS_INVALIDO;
+        return NULL;
+    }
+    strcpy(diario.base, base);
+    caminhoInstantaneo(caminho, "");
 
-    // Conector para o filho esquerdo
-    center(no && no->esquerdo ? L"┌" : L" ", 1, compr, 0, L" ", L"─");
+    uint64_t geracao = 0;
+    No *raiz = carregarInstantaneo(caminho, &geracao, status);
+    if (*status == STATUS_AUSENTE) *status = STATUS_OK; // ainda não houve compactação
+    if (*status != STATUS_OK) return NULL;
 
-    // Linha horizontal entre o nó e o conector
-    for (int p = 0; p < halfPad * compr; p++)
-        wprintf(no && no->esquerdo ? L"─" : L" ");
+    // Diários já incluídos no instantâneo sobram quando a compactação é interrompida antes de apagá-los
+    apagarDiarios(geracao);
 
-    if (no) {
-        // Converte o valor do nó para string wide
-        wchar_t wideBuffer[32];
-        swprintf(wideBuffer, sizeof(wideBuffer) / sizeof(wchar_t), no->cor == VERMELHO ? TEXT_RED L"%d" TEXT_RESET : L"%d", no->valor);
-
-        // Centraliza o valor do nó
-        const int tam = comprimento(no->valor);
-        center(wideBuffer, tam, compr, ajustarEsq,
-               no->esquerdo ? L"─" : L" ",
-               no->direito ? L"─" : L" ");
+    // Os diários posteriores ao instantâneo são reaplicados em ordem
+    int reaplicados = 0;
+    while (1) {
+        Status reaplicado;
+        raiz = reaplicarDiario(raiz, geracao + 1, &reaplicado);
+        if (reaplicado == STATUS_AUSENTE) break;
+        if (reaplicado != STATUS_OK) {
+            *status = reaplicado;
+            return raiz;
+        }
+        geracao++;
+        reaplicados++;
+    }
+
+    if (reaplicados > 0) {
+        // O último diário continua recebendo as operações
+        caminhoDiario(caminho, geracao);
+        diario.arquivo = fopen(caminho, "ab");
+        diario.geracao = geracao;
     } else {
-        // Espaço vazio caso o nó não exista
-        for (int p = 0; p < compr; p++) wprintf(L" ");
+        diario.geracao = geracao + 1;
+        diario.arquivo = criarDiario(diario.geracao);
     }
 
-    // Linha horizontal para o filho direito
-    for (int p = 0; p < halfPad * compr; p++)
-        wprintf(no && no->direito ? L"─" : L" ");
+    diario.lote = lote > 0 ? lote : 1;
+    diario.registrados = diario.sincronizados = 0;
+    diario.sincronizando = diario.falhou = 0;
+    if (diario.arquivo == NULL) *status = STATUS_INVALIDO;
+
+    return raiz;
+}
+
+/**
+ * Sincroniza com o disco os registros já escritos no diário, compartilhando a
+ * sincronização com as threads que chegarem enquanto ela acontece. Deve ser
+ * chamada com a trava do diário.
+ * @param alvo Quantidade de registros que precisam estar no disco
+ */
+void sincronizarAte(const unsigned long long alvo) {
+    while (diario.sincronizados < alvo && !diario.falhou) {
+        if (diario.sincronizando) {
+            // Outra thread já está sincronizando: espera por ela e confere de novo
+            pthread_cond_wait(&diario.sinal, &diario.trava);
+            continue;
+        }
+
+        // Esta thread sincroniza tudo o que foi registrado até agora, fora da trava
+        const unsigned long long registrados = diario.registrados;
+        diario.sincronizando = 1;
+        const int ok = fflush(diario.arquivo) == 0;
+        pthread_mutex_unlock(&diario.trava);
 
-    // Conector para o filho direito
-    center(no && no->direito ? L"┐" : L" ", 1, compr, 1, L"─", L" ");
+#ifdef _WIN32
+        const int sincronizado = ok && _commit(_fileno(diario.arquivo)) == 0;
+#else
+        const int sincronizado = ok && fsync(fileno(diario.arquivo)) == 0;
+#endif
 
-    // Espaços finais
-    for (int p = 0; p < halfPad * compr; p++) wprintf(L" ");
+        pthread_mutex_lock(&diario.trava);
+        diario.sincronizando = 0;
+        if (sincronizado) {
+            if (registrados > diario.sincronizados) diario.sincronizados = registrados;
+        } else {
+            diario.falhou = 1;
+        }
+        pthread_cond_broadcast(&diario.sinal);
+    }
 }
 
 /**
- * Imprime uma camada (nível) inteira da árvore AVL.
- * Também prepara a próxima camada com os filhos dos nós atuais.
- *
- * @param camada Vetor de nós da camada atual
- * @param n Quantidade de nós na camada
- * @param altura Altura atual da árvore
- * @param compr Largura padrão dos nós
- * @return Vetor contendo a próxima camada
+ * Registra uma operação já aplicada na árvore, podendo ser chamada por várias threads.
+ * Retorna depois que o registro foi escrito e, se ele completou um lote, depois
+ * que o lote chegou ao disco.
+ * @param operacao OP_INSERIR ou OP_REMOVER
+ * @param chave Chave da operação
+ * @return STATUS_OK ou STATUS_INVALIDO (não há diário aberto ou houve erro de escrita)
+ */
+Status registrarOperacao(const int operacao, const int chave) {
+    unsigned char registro[DIARIO_REGISTRO];
+    registro[0] = (unsigned char) operacao;
+    escreverInt32(registro + 1, chave);
+    registro[DIARIO_REGISTRO - 1] = verificacaoDiario(registro);
+
+    pthread_mutex_lock(&diario.trava);
+    if (diario.arquivo == NULL || diario.falhou || fwrite(registro, DIARIO_REGISTRO, 1, diario.arquivo) != 1) {
+        pthread_mutex_unlock(&diario.trava);
+        return STATUS_INVALIDO;
+    }
+
+    const unsigned long long numero = ++diario.registrados;
+    if (numero - diario.sincronizados >= (unsigned long long) diario.lote) sincronizarAte(numero);
+    const int falhou = diario.falhou;
+    pthread_mutex_unlock(&diario.trava);
+
+    return falhou ? STATUS_INVALIDO : STATUS_OK;
+}
+
+/**
+ * Grava no disco todos os registros do diário, mesmo com o lote incompleto.
+ * @return STATUS_OK ou STATUS_INVALIDO (não há diário aberto ou houve erro de escrita)
+ */
+Status sincronizarDiario(void) {
+    pthread_mutex_lock(&diario.trava);
+    if (diario.arquivo) sincronizarAte(diario.registrados);
+    const Status status = diario.arquivo && !diario.falhou ? STATUS_OK : STATUS_INVALIDO;
+    pthread_mutex_unlock(&diario.trava);
+
+    return status;
+}
+
+/**
+ * Grava o instantâneo copiado pela compactação e, depois que ele está no disco,
+ * apaga os diários que ele inclui.
  */
-No** imprimeCamada(No **camada, const int n, const int altura, const int compr) {
-    if (!camada) {
-        wprintf(L"Erro, camada não alocada\n");
-        return camada;
+void* gravarCompactacao(void *argumento) {
+    Compactacao *compactacao = argumento;
+    char temporario[DIARIO_CAMINHO], caminho[DIARIO_CAMINHO];
+    caminhoInstantaneo(temporario, ".tmp");
+    caminhoInstantaneo(caminho, "");
+
+    // O instantâneo anterior só é substituído quando o novo está completo
+    compactacao->status = gravarInstantaneo(compactacao->chaves, compactacao->contagens, compactacao->posicoes,
+                                            compactacao->n, compactacao->geracao, temporario);
+    if (compactacao->status == STATUS_OK && !substituirArquivo(temporario, caminho)) {
+        compactacao->status = STATUS_INVALIDO;
     }
+    if (compactacao->status == STATUS_OK) apagarDiarios(compactacao->geracao);
+
+    free(compactacao->chaves);
+    free(compactacao->contagens);
+    free(compactacao->posicoes);
+    return NULL;
+}
 
-    // Aloca espaço para a próxima camada (dobro de nós)
-    No** prox_camada = malloc(sizeof(No*) * n * 2);
+/**
+ * Espera o fim da compactação em segundo plano, se houver uma.
+ * @return Resultado da última compactação (STATUS_OK se não houve nenhuma)
+ */
+Status aguardarCompactacao(void) {
+    if (!diario.compactando) return STATUS_OK;
 
-    for (int i = 0; i < n; i++) {
-        const No* no = camada[i];
+    pthread_join(diario.thread, NULL);
+    diario.compactando = 0;
+    return diario.compactacao.status;
+}
 
-        // Imprime o nó atual
-        imprimeNo(no, altura, compr, i % 2);
+/**
+ * Compacta o diário em um novo instantâneo. A árvore é copiada para dois vetores
+ * e o diário passa para a geração seguinte; a gravação do instantâneo, que é a
+ * parte demorada, continua em segundo plano enquanto novas operações são registradas.
+ * A árvore não pode ser alterada durante a chamada.
+ * @param raiz Raiz da árvore, com todas as operações já registradas
+ * @return STATUS_OK, STATUS_INVALIDO (não há diário aberto, ou um arquivo não pôde
+ *         ser gravado) ou STATUS_SEM_MEMORIA
+ */
+Status compactarDiario(const No *raiz) {
+    if (diario.arquivo == NULL) return STATUS_INVALIDO;
 
-        // Espaçamento entre os nós
-        for (int p = 0; p < compr; p++) wprintf(L" ");
+    // Uma compactação por vez: a anterior precisa terminar antes
+    Status status = aguardarCompactacao();
+    if (status != STATUS_OK) return status;
 
-        // Preenche a próxima camada com os filhos
-        prox_camada[i * 2]     = no ? no->esquerdo : NULL;
-        prox_camada[i * 2 + 1] = no ? no->direito  : NULL;
+    const int n = contarNos(raiz);
+    Compactacao *compactacao = &diario.compactacao;
+    if (!alocarInstantaneo(n, &compactacao->chaves, &compactacao->contagens, &compactacao->posicoes)) {
+        return STATUS_SEM_MEMORIA;
     }
 
-    // Quebra de linha ao final da camada
-    wprintf(L"\n");
+    int i = 0;
+    coletarInstantaneo(raiz, alturaNegra(raiz), compactacao->chaves, compactacao->contagens, compactacao->posicoes, &i);
+    compactacao->n = n;
 
-    // Libera a camada atual
-    free(camada);
+    // Troca o diário: os registros do atual precisam estar no disco antes de ele ser fechado
+    pthread_mutex_lock(&diario.trava);
+    sincronizarAte(diario.registrados);
+    FILE *proximo = diario.falhou ? NULL : criarDiario(diario.geracao + 1);
+    if (proximo) {
+        fclose(diario.arquivo);
+        diario.arquivo = proximo;
+        compactacao->geracao = diario.geracao++;
+        diario.registrados = diario.sincronizados = 0;
+    }
+    pthread_mutex_unlock(&diario.trava);
+
+    if (proximo == NULL || pthread_create(&diario.thread, NULL, gravarCompactacao, compactacao) != 0) {
+        free(compactacao->chaves);
+        free(compactacao->contagens);
+        free(compactacao->posicoes);
+        return STATUS_INVALIDO;
+    }
 
-    return prox_camada;
+    diario.compactando = 1;
+    return STATUS_OK;
 }
 
 /**
- * Imprime graficamente toda a árvore AVL, nível por nível.
- * Utiliza caracteres Unicode para representar a estrutura.
- *
- * @param raiz Raiz da árvore
+ * Sincroniza e fecha o diário, esperando a compactação em andamento.
+ * @return STATUS_OK ou STATUS_INVALIDO (houve erro de escrita)
  */
-void imprimeArvore(No* raiz) {
-    // Altura total da árvore
-    const int altura = alturaNo(raiz);
+Status fecharDiario(void) {
+    if (diario.arquivo == NULL) return STATUS_OK;
 
-    // Caso a árvore esteja vazia
-    if (altura <= 0) {
-        wprintf(L"A árvore está vazia.\n");
-        return;
+    Status status = sincronizarDiario();
+    if (aguardarCompactacao() != STATUS_OK) status = STATUS_INVALIDO;
+    if (fclose(diario.arquivo) != 0) status = STATUS_INVALIDO;
+    diario.arquivo = NULL;
+
+    return status;
+}
+
+/**
+ * Mede o custo do diário: insere n chaves aleatórias registrando cada uma,
+ * compacta o diário enquanto remove metade das chaves e, por fim, recupera a
+ * árvore dos arquivos. Escreve uma linha CSV:
+ * motor,modo,n,lote,ops_por_s,compactar_ms,recuperar_ms
+ * A coluna compactar_ms é o tempo em que as operações ficam bloqueadas pela compactação.
+ * @param n Quantidade de chaves
+ * @param base Prefixo dos arquivos, que ainda não deve ter dados
+ * @param lote Quantidade de operações por sincronização com o disco
+ * @return Código de saída do programa
+ */
+int executarDuravel(const unsigned int n, const char *base, const int lote) {
+    Status status;
+
+    if (n == 0 || lote <= 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves e o lote devem ser positivos\n");
+        return 1;
     }
 
-    // Determina a largura necessária para impressão
-    const int compr = maiorComprimento(raiz);
+    No *raiz = abrirDiario(base, lote, &status);
+    if (status != STATUS_OK || raiz != NULL) {
+        fprintf(stderr, "ERRO: não foi possível criar um diário vazio em %s\n", base);
+        fecharDiario();
+        poolDestruir(&poolNos);
+        return 1;
+    }
 
-    // Inicializa a primeira camada com a raiz
-    No** camada = malloc(sizeof(No*));
-    camada[0] = raiz;
+    long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n && status == STATUS_OK; i++) {
+        raiz = inserirNoRN(raiz, chaveBench(i, 0), &status);
+        if (status == STATUS_OK) status = registrarOperacao(OP_INSERIR, chaveBench(i, 0));
+    }
+    if (status == STATUS_OK) status = sincronizarDiario();
+    const long long inserir = agoraNs() - inicio;
 
-    int n = 1;
+    inicio = agoraNs();
+    if (status == STATUS_OK) status = compactarDiario(raiz);
+    const long long compactar = agoraNs() - inicio;
 
-    // Imprime cada nível da árvore
-    for (int a = altura; a > 0; a--) {
-        camada = imprimeCamada(camada, n, a, compr);
-        n *= 2;
+    // As remoções são registradas enquanto o instantâneo é gravado
+    for (unsigned int i = 0; i < n / 2 && status == STATUS_OK; i++) {
+        raiz = removeNoRN(raiz, chaveBench(i, 0), &status);
+        if (status == STATUS_OK) status = registrarOperacao(OP_REMOVER, chaveBench(i, 0));
+        if (status == STATUS_AUSENTE) status = STATUS_OK;
     }
+    if (fecharDiario() != STATUS_OK) status = STATUS_INVALIDO;
 
-    // Libera a última camada
-    free(camada);
-}
+    const int esperados = contarNos(raiz);
+    poolDestruir(&poolNos);
+    if (status != STATUS_OK) {
+        fprintf(stderr, "ERRO: não foi possível gravar o diário em %s\n", base);
+        return 1;
+    }
 
-void preOrdem(const No *raiz){
-    wprintf(L"%d ", raiz->valor);
+    inicio = agoraNs();
+    raiz = abrirDiario(base, lote, &status);
+    const long long recuperar = agoraNs() - inicio;
+    fecharDiario();
 
-    if(raiz->esquerdo != NULL){
-        preOrdem(raiz->esquerdo);
+    if (status != STATUS_OK || contarNos(raiz) != esperados) {
+        fprintf(stderr, "ERRO: a árvore recuperada de %s não confere\n", base);
+        poolDestruir(&poolNos);
+        return 1;
     }
-    if(raiz->direito != NULL){
-        preOrdem(raiz->direito);
+
+    printf("rn,diario,%u,%d,%.0f,%.3f,%.3f\n", n, lote, n / (inserir / 1e9), compactar / 1e6, recuperar / 1e6);
+
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+/**
+ * Rastreador utilizado pelo menu, exibindo cada nó visitado durante a pesquisa.
+ */
+void exibirVisita(Evento evento, int valor) {
+    if (evento == EVENTO_VISITA) {
+        wprintf(L"Verificando nó com valor %d...\n", valor);
     }
 }
 
-int main() {
+/**
+ * Visitante utilizado pelo menu, exibindo cada valor de uma consulta por faixa.
+ */
+int exibirValor(int valor, void *contexto) {
+    (void) contexto;
+    wprintf(L"%d ", valor);
+    return 0;
+}
+
+/**
+ * Lê do menu o caminho de um arquivo, convertido para a codificação do sistema
+ * @return 1 se o caminho foi lido, 0 caso contrário
+ */
+int lerCaminho(char *arquivo, const size_t tamanho) {
+    wchar_t caminho[1024];
+
+    wprintf(L"\nInforme o caminho do arquivo: ");
+    if (wscanf(L"%1023ls", caminho) != 1) return 0;
+
+    const size_t convertidos = wcstombs(arquivo, caminho, tamanho);
+    return convertidos != (size_t) -1 && convertidos < tamanho;
+}
+
+int main(int argc, char *argv[]) {
+    // Modo benchmark: questao02 --bench <n> [aleatoria|ordenada] [compacta|descendente]
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        const int ordenada = argc >= 4 && strcmp(argv[3], "ordenada") == 0;
+        Motor motor = MOTOR_PONTEIROS;
+        if (argc >= 5 && strcmp(argv[4], "compacta") == 0) motor = MOTOR_COMPACTA;
+        if (argc >= 5 && strcmp(argv[4], "descendente") == 0) motor = MOTOR_DESCENDENTE;
+        return executarBenchmark((unsigned int) strtoul(argv[2], NULL, 10), ordenada, motor);
+    }
+
+    // Operações de conjunto: questao02 --conjuntos <n> [threads]
+    if (argc >= 3 && strcmp(argv[1], "--conjuntos") == 0) {
+        const int threads = argc >= 4 ? atoi(argv[3]) : processadores();
+        return executarConjuntos((unsigned int) strtoul(argv[2], NULL, 10), threads);
+    }
+
+    // Árvore particionada: questao02 --particionada <n> [threads] [fatias] [aleatoria|ordenada]
+    if (argc >= 3 && strcmp(argv[1], "--particionada") == 0) {
+        const int threads = argc >= 4 ? atoi(argv[3]) : processadores();
+        const int fatias = argc >= 5 ? atoi(argv[4]) : threads;
+        const int ordenada = argc >= 6 && strcmp(argv[5], "ordenada") == 0;
+        return executarParticionada((unsigned int) strtoul(argv[2], NULL, 10), threads, fatias, ordenada);
+    }
+
+    // Instantâneo em arquivo: questao02 --instantaneo <n> [arquivo]
+    if (argc >= 3 && strcmp(argv[1], "--instantaneo") == 0) {
+        return executarInstantaneo((unsigned int) strtoul(argv[2], NULL, 10), argc >= 4 ? argv[3] : "instantaneo.rn");
+    }
+
+    // Exportação: questao02 --exportar <n> <arquivo> [dot|json]
+    if (argc >= 4 && strcmp(argv[1], "--exportar") == 0) {
+        const FormatoExportacao formato = argc >= 5 && strcmp(argv[4], "json") == 0 ? EXPORTAR_JSON : EXPORTAR_DOT;
+        return executarExportacao((unsigned int) strtoul(argv[2], NULL, 10), argv[3], formato);
+    }
+
+    // Árvores genéricas: questao02 --generica <n>
+    if (argc >= 3 && strcmp(argv[1], "--generica") == 0) {
+        return executarGenerica((unsigned int) strtoul(argv[2], NULL, 10));
+    }
+
+    // Diário com sincronização em grupo: questao02 --duravel <n> <base> [lote]
+    if (argc >= 4 && strcmp(argv[1], "--duravel") == 0) {
+        const int lote = argc >= 5 ? atoi(argv[4]) : 1;
+        return executarDuravel((unsigned int) strtoul(argv[2], NULL, 10), argv[3], lote);
+    }
+
+    // Modo em lote: questao02 --lote [arquivo], lendo da entrada padrão quando o arquivo é omitido
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) {
+        FILE *entrada = argc >= 3 ? fopen(argv[2], "rb") : stdin;
+        if (entrada == NULL) {
+            fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+            return 1;
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        const int resultado = executarLote(entrada, stdout);
+        if (entrada != stdin) fclose(entrada);
+        return resultado;
+    }
+
+    // Menu com diário: questao02 --diario <base> [lote], recuperando a árvore dos arquivos do prefixo
+    const char *base = NULL;
+    int lote = 1;
+    if (argc >= 3 && strcmp(argv[1], "--diario") == 0) {
+        base = argv[2];
+        lote = argc >= 4 ? atoi(argv[3]) : 1;
+    }
+
     // Set locale to support wide characters
     setlocale(LC_ALL, "");
 
@@ -704,10 +5385,21 @@ int main() {
 #endif
 
     int escolha, valor;
+    Status status;
     No *raiz = NULL;
 
+    if (base) {
+        raiz = abrirDiario(base, lote, &status);
+        if (status != STATUS_OK) {
+            wprintf(L"ERRO: não foi possível recuperar a árvore de %s.\n", base);
+            fecharDiario();
+            poolDestruir(&poolNos);
+            return 1;
+        }
+    }
+
     do{
-        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n");
+        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n6 - Construir a partir de uma lista\n7 - Contadores\n8 - Congelar\n9 - Pesquisar no instantâneo congelado\n10 - Posição de um valor\n11 - K-ésimo menor valor\n12 - Contar valores em um intervalo\n13 - Listar valores em um intervalo\n14 - Piso e teto de um valor\n15 - Dividir em um valor\n16 - União, interseção ou diferença com uma lista\n17 - Salvar em arquivo\n18 - Carregar de arquivo\n19 - Compactar o diário\n20 - Imprimir uma subárvore\n21 - Exportar para DOT ou JSON\n");
         wprintf(L"Escolha uma opção: ");
         wscanf(L"%d", &escolha);
 
@@ -719,21 +5411,41 @@ int main() {
             case 1:
                 wprintf(L"\nInforme o valor que deseja inserir: ");
                 wscanf(L"%d", &valor);
-                raiz = inserirNoRN(raiz, valor);
+                raiz = inserirNoRN(raiz, valor, &status);
+                if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                } else if (diario.arquivo && registrarOperacao(OP_INSERIR, valor) != STATUS_OK) {
+                    wprintf(L"ERRO: não foi possível gravar o diário.\n");
+                }
                 break;
 
             case 2:
                 wprintf(L"\nInforme o valor que deseja remover: ");
                 wscanf(L"%d", &valor);
-                raiz = removeNoRN(raiz, valor);
+                raiz = removeNoRN(raiz, valor, &status);
+                if (status == STATUS_AUSENTE) {
+                    wprintf(L"Valor não encontrado na árvore.\n");
+                } else if (diario.arquivo && registrarOperacao(OP_REMOVER, valor) != STATUS_OK) {
+                    wprintf(L"ERRO: não foi possível gravar o diário.\n");
+                }
                 break;
 
             case 3:
                 wprintf(L"\nInforme o valor que deseja pesquisar: ");
                 wscanf(L"%d", &valor);
-                const No* resultado = pesquisaNo(raiz, valor, 1);
+#if RASTREAMENTO
+                rastreador = exibirVisita;
+#endif
+                const No* resultado = pesquisaNo(raiz, valor);
+#if RASTREAMENTO
+                rastreador = NULL;
+#endif
                 if (resultado) {
-                    wprintf(L"Valor %d encontrado na árvore.\n", valor);
+                    wprintf(L"Valor %d encontrado na árvore", valor);
+#if MULTICONJUNTO
+                    wprintf(L" (%d ocorrência(s))", resultado->contagem);
+#endif
+                    wprintf(L".\n");
                 } else {
                     wprintf(L"Valor %d não encontrado na árvore.\n", valor);
                 }
@@ -747,12 +5459,269 @@ int main() {
                 preOrdem(raiz);
                 break;
 
+            case 6:
+                wprintf(L"\nInforme a quantidade de valores: ");
+                wscanf(L"%d", &valor);
+                if (valor <= 0) {
+                    wprintf(L"Quantidade inválida.\n");
+                    break;
+                }
+
+                int *valores = malloc(sizeof(int) * valor);
+                if (valores == NULL) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a lista de valores.\n");
+                    break;
+                }
+
+                wprintf(L"\nInforme os valores: ");
+                for (int i = 0; i < valor; i++) {
+                    wscanf(L"%d", &valores[i]);
+                }
+
+                // A árvore atual é descartada e a nova é construída de uma só vez
+                poolDestruir(&poolNos);
+                raiz = construirArvore(valores, valor, &status);
+                free(valores);
+
+                if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                }
+                break;
+
+            case 7:
+                exibirContadores(stdout);
+                break;
+
+            case 8:
+                if (congelar(raiz) == STATUS_OK) {
+                    wprintf(L"Instantâneo congelado com %d valores.\n", congelada.n);
+                } else {
+                    wprintf(L"ERRO: não foi possível alocar memória para o instantâneo.\n");
+                }
+                break;
+
+            case 9:
+                wprintf(L"\nInforme o valor que deseja pesquisar: ");
+                wscanf(L"%d", &valor);
+                if (pesquisaCongelada(valor)) {
+                    wprintf(L"Valor %d encontrado no instantâneo.\n", valor);
+                } else {
+                    wprintf(L"Valor %d não encontrado no instantâneo.\n", valor);
+                }
+                break;
+
+#if ESTATISTICA_ORDEM
+            case 10:
+                wprintf(L"\nInforme o valor: ");
+                wscanf(L"%d", &valor);
+                wprintf(L"Há %d valores menores que %d na árvore.\n", posicao(raiz, valor), valor);
+                break;
+
+            case 11:
+                wprintf(L"\nInforme a posição k: ");
+                wscanf(L"%d", &valor);
+                const No *kesimo = selecionar(raiz, valor);
+                if (kesimo) {
+                    wprintf(L"O %dº menor valor é %d.\n", valor, kesimo->valor);
+                } else {
+                    wprintf(L"A árvore não tem uma posição %d.\n", valor);
+                }
+                break;
+
+            case 12: {
+                int fim;
+                wprintf(L"\nInforme o início e o fim do intervalo: ");
+                wscanf(L"%d %d", &valor, &fim);
+                wprintf(L"Há %d valores em [%d, %d].\n", contarFaixa(raiz, valor, fim), valor, fim);
+                break;
+            }
+#endif
+
+            case 13: {
+                int fim;
+                wprintf(L"\nInforme o início e o fim do intervalo: ");
+                wscanf(L"%d %d", &valor, &fim);
+                visitarFaixa(raiz, valor, fim, exibirValor, NULL);
+                wprintf(L"\n");
+                break;
+            }
+
+            case 14: {
+                wprintf(L"\nInforme o valor: ");
+                wscanf(L"%d", &valor);
+                const No *menorIgual = piso(raiz, valor);
+                const No *maiorIgual = teto(raiz, valor);
+                if (menorIgual) {
+                    wprintf(L"Piso: %d\n", menorIgual->valor);
+                } else {
+                    wprintf(L"Não há valores menores ou iguais a %d.\n", valor);
+                }
+                if (maiorIgual) {
+                    wprintf(L"Teto: %d\n", maiorIgual->valor);
+                } else {
+                    wprintf(L"Não há valores maiores ou iguais a %d.\n", valor);
+                }
+                break;
+            }
+
+            case 15: {
+                wprintf(L"\nInforme o valor de corte: ");
+                wscanf(L"%d", &valor);
+
+                // Exibe as duas partes e as junta novamente
+                No *maiores;
+                No *menores = dividir(raiz, valor, &maiores);
+                wprintf(L"\nValores menores que %d:\n", valor);
+                imprimeArvore(menores);
+                wprintf(L"\nValores maiores ou iguais a %d:\n", valor);
+                imprimeArvore(maiores);
+                raiz = juntarArvores(menores, maiores);
+                break;
+            }
+
+            case 16: {
+                int operacao;
+                wprintf(L"\n1 - União\n2 - Interseção\n3 - Diferença (árvore - lista)\nEscolha a operação: ");
+                wscanf(L"%d", &operacao);
+                if (operacao < 1 || operacao > 3) {
+                    wprintf(L"\nOpcao invalida!!!!");
+                    break;
+                }
+
+                wprintf(L"\nInforme a quantidade de valores: ");
+                wscanf(L"%d", &valor);
+                if (valor <= 0) {
+                    wprintf(L"Quantidade inválida.\n");
+                    break;
+                }
+
+                int *lista = malloc(sizeof(int) * valor);
+                if (lista == NULL) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a lista de valores.\n");
+                    break;
+                }
+
+                wprintf(L"\nInforme os valores: ");
+                for (int i = 0; i < valor; i++) {
+                    wscanf(L"%d", &lista[i]);
+                }
+
+                No *outra = construirArvore(lista, valor, &status);
+                free(lista);
+                if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                    break;
+                }
+
+                raiz = conjuntoParalelo((OperacaoConjunto) (operacao - 1), raiz, outra, processadores());
+                break;
+            }
+
+            case 17:
+            case 18: {
+                char arquivo[1024];
+                if (!lerCaminho(arquivo, sizeof(arquivo))) {
+                    wprintf(L"Caminho inválido.\n");
+                    break;
+                }
+
+                if (escolha == 17) {
+                    status = salvarInstantaneo(raiz, arquivo);
+                    if (status == STATUS_OK) {
+                        wprintf(L"Árvore salva.\n");
+                    } else if (status == STATUS_SEM_MEMORIA) {
+                        wprintf(L"ERRO: não foi possível alocar memória para a gravação.\n");
+                    } else {
+                        wprintf(L"ERRO: não foi possível gravar o arquivo.\n");
+                    }
+                    break;
+                }
+
+                // A árvore atual é descartada e a nova é reconstruída de uma só vez
+                poolDestruir(&poolNos);
+                raiz = carregarInstantaneo(arquivo, NULL, &status);
+                if (status == STATUS_OK) {
+                    wprintf(L"Árvore carregada com %d valores.\n", contarNos(raiz));
+                } else if (status == STATUS_AUSENTE) {
+                    wprintf(L"ERRO: não foi possível abrir o arquivo.\n");
+                } else if (status == STATUS_INVALIDO) {
+                    wprintf(L"ERRO: o arquivo não é um instantâneo rubro-negro válido.\n");
+                } else {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                }
+                break;
+            }
+
+            case 19:
+                if (diario.arquivo == NULL) {
+                    wprintf(L"O programa não foi iniciado com --diario.\n");
+                } else if (compactarDiario(raiz) == STATUS_OK) {
+                    wprintf(L"Compactação iniciada.\n");
+                } else {
+                    wprintf(L"ERRO: não foi possível compactar o diário.\n");
+                }
+                break;
+
+            case 20: {
+                int niveis;
+                wprintf(L"\nInforme o valor da raiz da subárvore: ");
+                wscanf(L"%d", &valor);
+                wprintf(L"\nInforme a quantidade de níveis: ");
+                wscanf(L"%d", &niveis);
+
+                const No *subarvore = pesquisaNo(raiz, valor);
+                if (subarvore == NULL) {
+                    wprintf(L"Valor %d não encontrado na árvore.\n", valor);
+                } else {
+                    imprimeSubarvore(subarvore, niveis);
+                }
+                break;
+            }
+
+            case 21: {
+                int formato;
+                wprintf(L"\nInforme o formato (1 - DOT, 2 - JSON): ");
+                wscanf(L"%d", &formato);
+                if (formato != EXPORTAR_DOT && formato != EXPORTAR_JSON) {
+                    wprintf(L"Formato inválido.\n");
+                    break;
+                }
+
+                char arquivo[1024];
+                if (!lerCaminho(arquivo, sizeof(arquivo))) {
+                    wprintf(L"Caminho inválido.\n");
+                    break;
+                }
+
+                long long bytes;
+                status = exportarArvore(raiz, arquivo, (FormatoExportacao) formato, &bytes);
+                if (status == STATUS_OK) {
+                    wprintf(L"Árvore exportada (%lld bytes).\n", bytes);
+                } else if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a exportação.\n");
+                } else {
+                    wprintf(L"ERRO: não foi possível gravar o arquivo.\n");
+                }
+                break;
+            }
+
             default:
                 wprintf(L"\nOpcao invalida!!!!");
         }
 
+        // As operações em bloco não passam pelo diário: a árvore inteira vai para um novo instantâneo
+        if (diario.arquivo && (escolha == 6 || escolha == 16 || escolha == 18) && compactarDiario(raiz) != STATUS_OK) {
+            wprintf(L"ERRO: não foi possível compactar o diário.\n");
+        }
+
     }while (escolha != 0);
 
-    freeArvore(raiz);
+    if (fecharDiario() != STATUS_OK) {
+        wprintf(L"ERRO: não foi possível gravar o diário.\n");
+    }
+
+    // Libera todos os nós da árvore de uma só vez
+    destruirCongelada();
+    poolDestruir(&poolNos);
     return 0;
 }
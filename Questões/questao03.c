@@ -0,0 +1,1072 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <wchar.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/resource.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Alunos:
+Murilo Henrique Conde da Luz
+Nathielly Neves de Castro */
+
+/* ============================================================
+   DEFINIÇÃO DA ESTRUTURA DO NÓ
+   ============================================================ */
+
+#define LINHA_CACHE 64
+
+#define MAX_CHAVES 15               // chaves de um nó interno: chaves e quantidade ocupam a primeira linha de cache
+#define MAX_CHAVES_FOLHA 14         // chaves de uma folha: chaves, próxima folha e quantidade ocupam uma linha de cache
+#define MIN_CHAVES (MAX_CHAVES_FOLHA / 2) // ocupação mínima de um nó que não é a raiz (igual para os dois tipos)
+
+/*
+ * Os nós são ligados por índices de 32 bits nos seus pools, e não por ponteiros.
+ * O bit mais alto do índice indica se o nó é uma folha, de modo que o tipo do
+ * filho é conhecido antes de acessá-lo e o nó não precisa guardá-lo.
+ */
+typedef uint32_t Indice;
+
+#define NULO 0u                     // a posição 0 de cada pool é reservada
+#define INDICE_FOLHA 0x80000000u    // bit que marca os índices de folhas
+
+/**
+ * Estrutura que representa um nó da árvore B+.
+ * As chaves ficam no início do nó, alinhadas a uma linha de cache, e a pesquisa
+ * dentro do nó compara as 16 primeiras posições de uma vez, descartando as que
+ * passam da quantidade de chaves.
+ * - Nós internos (128 bytes): até MAX_CHAVES chaves separadoras na primeira
+ *   linha e MAX_CHAVES + 1 filhos na segunda (o filho i contém as chaves
+ *   maiores ou iguais à chave i - 1 e menores que a chave i)
+ * - Folhas (64 bytes): até MAX_CHAVES_FOLHA chaves e o índice da próxima folha,
+ *   que ocupa a posição da última chave de um nó interno; o vetor de filhos
+ *   não é alocado para as folhas
+ */
+typedef struct no {
+    union {
+        int chaves[MAX_CHAVES];
+        struct {
+            int chavesFolha[MAX_CHAVES_FOLHA]; // mesmas posições de chaves (apenas folhas)
+            Indice proximo;                    // próxima folha, em ordem crescente (apenas folhas)
+        };
+    };
+    int quantidade;
+    Indice filhos[]; // apenas nós internos
+} No;
+
+#define TAMANHO_FOLHA   sizeof(No)
+#define TAMANHO_INTERNO (sizeof(No) + sizeof(Indice) * (MAX_CHAVES + 1))
+
+_Static_assert(TAMANHO_FOLHA == LINHA_CACHE, "a folha deve ocupar uma linha de cache");
+_Static_assert(TAMANHO_INTERNO == 2 * LINHA_CACHE, "o nó interno deve ocupar duas linhas de cache");
+
+/* ============================================================
+   CÓDIGOS DE RETORNO
+   ============================================================ */
+
+/**
+ * Resultado das operações da árvore. As operações não escrevem nada na tela:
+ * cabe a quem as chama decidir o que fazer com o resultado.
+ */
+typedef enum {
+    STATUS_OK = 0,         // operação realizada (ou chave encontrada)
+    STATUS_AUSENTE = 1,    // chave não encontrada
+    STATUS_DUPLICADA = 2,  // chave já existente, inserção ignorada
+    STATUS_INVALIDO = 3,   // operação desconhecida (usado no modo em lote)
+    STATUS_SEM_MEMORIA = 4 // não foi possível alocar um novo nó
+} Status;
+
+/* ============================================================
+   ALOCADOR DE NÓS (POOL)
+   ============================================================ */
+
+#define POOL_BLOCO_BITS 12 // cada bloco tem 2^12 nós, para que o índice encontre o bloco com um deslocamento
+#define POOL_BLOCO      (1u << POOL_BLOCO_BITS)
+
+/**
+ * Bloco contíguo de nós.
+ */
+typedef struct {
+    void *memoria;      // endereço devolvido pelo malloc
+    unsigned char *nos; // início dos nós, alinhado a uma linha de cache
+} Bloco;
+
+/**
+ * Pool de nós de um mesmo tamanho: entrega nós a partir de blocos de tamanho
+ * fixo e reaproveita os nós removidos através de uma lista de livres
+ * (encadeada pelo campo proximo). Um índice é a posição do bloco na tabela,
+ * seguida da posição do nó no bloco.
+ * Folhas e nós internos têm tamanhos diferentes e, por isso, pools separados.
+ */
+typedef struct {
+    Bloco *blocos;       // tabela de blocos
+    size_t quantidade;   // blocos em uso
+    size_t capacidade;   // capacidade da tabela
+    size_t usados;       // quantidade de nós já entregues do último bloco
+    size_t tamanho;      // tamanho de cada nó (múltiplo de uma linha de cache)
+    Indice livres;       // nós devolvidos, prontos para reutilização
+    Indice tipo;         // INDICE_FOLHA nas folhas, 0 nos nós internos
+} Pool;
+
+static Pool poolFolhas = {NULL, 0, 0, 0, TAMANHO_FOLHA, NULO, INDICE_FOLHA};
+static Pool poolInternos = {NULL, 0, 0, 0, TAMANHO_INTERNO, NULO, 0};
+
+/**
+ * Retorna o nó correspondente a um índice (que não pode ser NULO).
+ */
+No* noIndice(const Indice indice) {
+    const Pool *pool = (indice & INDICE_FOLHA) ? &poolFolhas : &poolInternos;
+    const Indice i = indice & ~INDICE_FOLHA;
+    return (No *) (pool->blocos[i >> POOL_BLOCO_BITS].nos + (size_t) (i & (POOL_BLOCO - 1)) * pool->tamanho);
+}
+
+/**
+ * Indica se o índice corresponde a uma folha.
+ */
+int ehFolha(const Indice indice) {
+    return (indice & INDICE_FOLHA) != 0;
+}
+
+/**
+ * Obtém um nó do pool, priorizando os nós devolvidos.
+ * Quando o bloco atual se esgota, um novo bloco é alocado.
+ * @param pool Pool de onde o nó será retirado
+ * @return Índice do nó, não inicializado, ou NULO, caso não haja memória
+ */
+Indice poolAlocar(Pool *pool) {
+    // Reaproveita um nó da lista de livres
+    if (pool->livres != NULO) {
+        const Indice indice = pool->livres;
+        pool->livres = noIndice(indice)->proximo;
+        return indice;
+    }
+
+    // Aloca um novo bloco quando o atual está cheio (ou ainda não existe)
+    while (pool->quantidade == 0 || pool->usados == POOL_BLOCO) {
+        if ((pool->quantidade + 1) << POOL_BLOCO_BITS > INDICE_FOLHA) return NULO;
+
+        if (pool->quantidade == pool->capacidade) {
+            const size_t capacidade = pool->capacidade ? pool->capacidade * 2 : 16;
+            Bloco *tabela = realloc(pool->blocos, sizeof(Bloco) * capacidade);
+            if (tabela == NULL) return NULO;
+            pool->blocos = tabela;
+            pool->capacidade = capacidade;
+        }
+
+        // Espaço extra para alinhar o primeiro nó a uma linha de cache
+        void *memoria = malloc(LINHA_CACHE + POOL_BLOCO * pool->tamanho);
+        if (memoria == NULL) return NULO;
+
+        Bloco *bloco = &pool->blocos[pool->quantidade++];
+        bloco->memoria = memoria;
+        bloco->nos = (unsigned char *) (((uintptr_t) memoria + LINHA_CACHE - 1) & ~(uintptr_t) (LINHA_CACHE - 1));
+
+        // A primeira posição do primeiro bloco corresponde a NULO e nunca é entregue
+        pool->usados = pool->quantidade == 1 ? 1 : 0;
+    }
+
+    return (Indice) (((pool->quantidade - 1) << POOL_BLOCO_BITS) + pool->usados++) | pool->tipo;
+}
+
+/**
+ * Devolve um nó ao pool, para que seja reutilizado em uma próxima alocação.
+ */
+void poolLiberar(Pool *pool, const Indice indice) {
+    noIndice(indice)->proximo = pool->livres;
+    pool->livres = indice;
+}
+
+/**
+ * Libera todos os blocos do pool de uma só vez.
+ */
+void poolDestruir(Pool *pool) {
+    for (size_t b = 0; b < pool->quantidade; b++) {
+        free(pool->blocos[b].memoria);
+    }
+    free(pool->blocos);
+
+    pool->blocos = NULL;
+    pool->quantidade = 0;
+    pool->capacidade = 0;
+    pool->usados = 0;
+    pool->livres = NULO;
+}
+
+/**
+ * Cria um nó vazio da árvore B+.
+ * @param folha Indica se o nó é uma folha
+ * @return Índice do novo nó ou NULO, caso não haja memória
+ */
+Indice novoNo(const int folha) {
+    const Indice indice = poolAlocar(folha ? &poolFolhas : &poolInternos);
+
+    if (indice != NULO) {
+        No *no = noIndice(indice);
+        no->quantidade = 0;
+        if (folha) no->proximo = NULO;
+    }
+
+    return indice;
+}
+
+/**
+ * Devolve um nó ao pool correspondente ao seu tipo.
+ */
+void liberarNo(const Indice indice) {
+    poolLiberar(ehFolha(indice) ? &poolFolhas : &poolInternos, indice);
+}
+
+/**
+ * Libera todos os nós da árvore de uma só vez.
+ */
+void liberarArvore(void) {
+    poolDestruir(&poolFolhas);
+    poolDestruir(&poolInternos);
+}
+
+/* ============================================================
+   PESQUISA DENTRO DO NÓ (SIMD)
+   ============================================================ */
+
+/**
+ * Conta quantas chaves do nó são menores que o valor.
+ * As 16 primeiras posições do nó são comparadas de uma vez (AVX2: 2 comparações
+ * de 8 posições; SSE2: 4 comparações de 4 posições), e a máscara descarta as
+ * posições que passam da quantidade de chaves (incluindo a própria quantidade
+ * e o índice da próxima folha, que ficam na mesma linha de cache).
+ */
+int contarMenores(const No *no, const int valor) {
+    const unsigned int validas = (1u << no->quantidade) - 1;
+#if defined(__AVX2__)
+    const __m256i v = _mm256_set1_epi32(valor);
+    const __m256i a = _mm256_loadu_si256((const __m256i *) no->chaves);
+    const __m256i b = _mm256_loadu_si256((const __m256i *) (no->chaves + 8));
+    const unsigned int mascara =
+        (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, a))) |
+        (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, b))) << 8;
+    return __builtin_popcount(mascara & validas);
+#elif defined(__SSE2__)
+    const __m128i v = _mm_set1_epi32(valor);
+    unsigned int mascara = 0;
+    for (int i = 0; i < 16; i += 4) {
+        const __m128i c = _mm_loadu_si128((const __m128i *) (no->chaves + i));
+        mascara |= (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, c))) << i;
+    }
+    mascara &= validas;
+#ifdef __GNUC__
+    return __builtin_popcount(mascara);
+#else
+    int total = 0;
+    for (; mascara; mascara &= mascara - 1) total++;
+    return total;
+#endif
+#else
+    (void) validas;
+    int total = 0;
+    for (int i = 0; i < no->quantidade; i++) {
+        total += no->chaves[i] < valor;
+    }
+    return total;
+#endif
+}
+
+/**
+ * Conta quantas chaves do nó são menores ou iguais ao valor, que é o índice do
+ * filho de um nó interno onde o valor deve estar.
+ */
+int indiceFilho(const No *no, const int valor) {
+    // Chaves menores ou iguais a valor são as menores que valor + 1 (sem estouro para INT_MAX)
+    if (valor == INT_MAX) return no->quantidade;
+    return contarMenores(no, valor + 1);
+}
+
+/* ============================================================
+   FUNÇÕES DE PESQUISA
+   ============================================================ */
+
+/**
+ * Busca um valor na árvore B+.
+ * @param raiz Raiz da árvore
+ * @param valor Valor que será buscado
+ * @return A folha que contém o valor ou NULL, caso ele não esteja presente na árvore
+ */
+No* pesquisaNo(Indice raiz, const int valor) {
+    if (raiz == NULO) return NULL;
+
+    // Desce pelos nós internos até a folha
+    while (!ehFolha(raiz)) {
+        const No *no = noIndice(raiz);
+        raiz = no->filhos[indiceFilho(no, valor)];
+    }
+
+    No *folha = noIndice(raiz);
+    const int pos = contarMenores(folha, valor);
+    return (pos < folha->quantidade && folha->chaves[pos] == valor) ? folha : NULL;
+}
+
+/**
+ * Calcula a altura da árvore (quantidade de níveis).
+ */
+int alturaArvore(Indice raiz) {
+    int altura = 0;
+
+    while (raiz != NULO) {
+        altura++;
+        raiz = ehFolha(raiz) ? NULO : noIndice(raiz)->filhos[0];
+    }
+
+    return altura;
+}
+
+/* ============================================================
+   INSERÇÃO NA ÁRVORE B+
+   ============================================================ */
+
+/**
+ * Insere um valor na subárvore, dividindo os nós que ficarem cheios.
+ * O irmão de um nó interno cheio é alocado antes da descida, de modo que a
+ * falta de memória seja detectada antes de qualquer divisão: nesse caso, a
+ * árvore fica exatamente como estava.
+ * @param indice Raiz da subárvore
+ * @param valor Valor a ser inserido
+ * @param separador Recebe a chave que separa o nó do novo irmão, em caso de divisão
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA
+ * @return Novo irmão à direita, caso o nó tenha sido dividido, ou NULO
+ */
+Indice inserirRec(const Indice indice, const int valor, int *separador, Status *status) {
+    No *no = noIndice(indice);
+
+    if (ehFolha(indice)) {
+        const int pos = contarMenores(no, valor);
+
+        if (pos < no->quantidade && no->chaves[pos] == valor) {
+            *status = STATUS_DUPLICADA;
+            return NULO;
+        }
+
+        // Há espaço na folha: basta deslocar as chaves maiores
+        if (no->quantidade < MAX_CHAVES_FOLHA) {
+            memmove(no->chaves + pos + 1, no->chaves + pos, sizeof(int) * (no->quantidade - pos));
+            no->chaves[pos] = valor;
+            no->quantidade++;
+            *status = STATUS_OK;
+            return NULO;
+        }
+
+        // Folha cheia: as MAX_CHAVES_FOLHA + 1 chaves são divididas entre a folha e uma nova irmã
+        const Indice novo = novoNo(1);
+        if (novo == NULO) {
+            *status = STATUS_SEM_MEMORIA;
+            return NULO;
+        }
+        *status = STATUS_OK;
+        No *irmao = noIndice(novo);
+
+        int todas[MAX_CHAVES_FOLHA + 1];
+        memcpy(todas, no->chaves, sizeof(int) * pos);
+        todas[pos] = valor;
+        memcpy(todas + pos + 1, no->chaves + pos, sizeof(int) * (MAX_CHAVES_FOLHA - pos));
+
+        const int esquerda = (MAX_CHAVES_FOLHA + 2) / 2;
+        const int direita = MAX_CHAVES_FOLHA + 1 - esquerda;
+        memcpy(no->chaves, todas, sizeof(int) * esquerda);
+        memcpy(irmao->chaves, todas + esquerda, sizeof(int) * direita);
+
+        no->quantidade = esquerda;
+        irmao->quantidade = direita;
+        irmao->proximo = no->proximo;
+        no->proximo = novo;
+
+        *separador = irmao->chaves[0];
+        return novo;
+    }
+
+    // Nó interno cheio: o irmão que receberá metade das chaves é reservado antes da descida
+    Indice reservado = NULO;
+    if (no->quantidade == MAX_CHAVES) {
+        reservado = novoNo(0);
+        if (reservado == NULO) {
+            *status = STATUS_SEM_MEMORIA;
+            return NULO;
+        }
+    }
+
+    const int i = indiceFilho(no, valor);
+    int chaveFilho;
+    const Indice novoFilho = inserirRec(no->filhos[i], valor, &chaveFilho, status);
+    if (novoFilho == NULO) {
+        if (reservado != NULO) liberarNo(reservado);
+        return NULO;
+    }
+
+    // O filho foi dividido: a chave separadora e o novo filho entram após a posição i
+    if (no->quantidade < MAX_CHAVES) {
+        memmove(no->chaves + i + 1, no->chaves + i, sizeof(int) * (no->quantidade - i));
+        memmove(no->filhos + i + 2, no->filhos + i + 1, sizeof(Indice) * (no->quantidade - i));
+        no->chaves[i] = chaveFilho;
+        no->filhos[i + 1] = novoFilho;
+        no->quantidade++;
+        return NULO;
+    }
+
+    // A chave do meio sobe e as demais são divididas com o irmão reservado
+    No *irmao = noIndice(reservado);
+
+    int chaves[MAX_CHAVES + 1];
+    Indice filhos[MAX_CHAVES + 2];
+    memcpy(chaves, no->chaves, sizeof(int) * i);
+    chaves[i] = chaveFilho;
+    memcpy(chaves + i + 1, no->chaves + i, sizeof(int) * (MAX_CHAVES - i));
+    memcpy(filhos, no->filhos, sizeof(Indice) * (i + 1));
+    filhos[i + 1] = novoFilho;
+    memcpy(filhos + i + 2, no->filhos + i + 1, sizeof(Indice) * (MAX_CHAVES - i));
+
+    const int esquerda = MAX_CHAVES / 2;
+    const int direita = MAX_CHAVES - esquerda;
+    memcpy(no->chaves, chaves, sizeof(int) * esquerda);
+    memcpy(no->filhos, filhos, sizeof(Indice) * (esquerda + 1));
+    memcpy(irmao->chaves, chaves + esquerda + 1, sizeof(int) * direita);
+    memcpy(irmao->filhos, filhos + esquerda + 1, sizeof(Indice) * (direita + 1));
+
+    no->quantidade = esquerda;
+    irmao->quantidade = direita;
+
+    *separador = chaves[esquerda];
+    return reservado;
+}
+
+/**
+ * Insere um valor na árvore B+.
+ * Quando a raiz está cheia, a nova raiz é alocada antes da inserção, para que
+ * uma divisão nunca fique sem ter onde ser ligada.
+ * @param raiz Raiz da árvore
+ * @param valor Valor a ser inserido
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA
+ * @return Nova raiz da árvore
+ */
+Indice insercao(Indice raiz, const int valor, Status *status) {
+    if (raiz == NULO) {
+        raiz = novoNo(1);
+        if (raiz == NULO) {
+            *status = STATUS_SEM_MEMORIA;
+            return NULO;
+        }
+    }
+
+    Indice novaRaiz = NULO;
+    if (noIndice(raiz)->quantidade == (ehFolha(raiz) ? MAX_CHAVES_FOLHA : MAX_CHAVES)) {
+        novaRaiz = novoNo(0);
+        if (novaRaiz == NULO) {
+            *status = STATUS_SEM_MEMORIA;
+            return raiz;
+        }
+    }
+
+    int separador;
+    const Indice irmao = inserirRec(raiz, valor, &separador, status);
+    if (irmao == NULO) {
+        if (novaRaiz != NULO) liberarNo(novaRaiz);
+        return raiz;
+    }
+
+    // A raiz foi dividida: a árvore cresce um nível
+    No *no = noIndice(novaRaiz);
+    no->chaves[0] = separador;
+    no->filhos[0] = raiz;
+    no->filhos[1] = irmao;
+    no->quantidade = 1;
+
+    return novaRaiz;
+}
+
+/* ============================================================
+   REMOÇÃO NA ÁRVORE B+
+   ============================================================ */
+
+/**
+ * Remove a chave e o filho à sua direita de um nó interno.
+ */
+void removerSeparador(No *no, const int i) {
+    memmove(no->chaves + i, no->chaves + i + 1, sizeof(int) * (no->quantidade - i - 1));
+    memmove(no->filhos + i + 1, no->filhos + i + 2, sizeof(Indice) * (no->quantidade - i - 1));
+    no->quantidade--;
+}
+
+/**
+ * Junta o filho i + 1 ao filho i de um nó interno, liberando o filho i + 1.
+ */
+void juntarFilhos(No *pai, const int i) {
+    const Indice indiceDir = pai->filhos[i + 1];
+    No *esq = noIndice(pai->filhos[i]);
+    No *dir = noIndice(indiceDir);
+
+    if (ehFolha(indiceDir)) {
+        memcpy(esq->chaves + esq->quantidade, dir->chaves, sizeof(int) * dir->quantidade);
+        esq->quantidade += dir->quantidade;
+        esq->proximo = dir->proximo;
+    } else {
+        // A chave separadora desce para o nó resultante
+        esq->chaves[esq->quantidade] = pai->chaves[i];
+        memcpy(esq->chaves + esq->quantidade + 1, dir->chaves, sizeof(int) * dir->quantidade);
+        memcpy(esq->filhos + esq->quantidade + 1, dir->filhos, sizeof(Indice) * (dir->quantidade + 1));
+        esq->quantidade += dir->quantidade + 1;
+    }
+
+    liberarNo(indiceDir);
+    removerSeparador(pai, i);
+}
+
+/**
+ * Corrige o filho i de um nó interno que ficou com menos de MIN_CHAVES chaves,
+ * emprestando uma chave de um irmão ou juntando-o com um irmão.
+ */
+void corrigirFilho(No *pai, const int i) {
+    const int folha = ehFolha(pai->filhos[i]);
+    No *filho = noIndice(pai->filhos[i]);
+    No *esq = i > 0 ? noIndice(pai->filhos[i - 1]) : NULL;
+    No *dir = i < pai->quantidade ? noIndice(pai->filhos[i + 1]) : NULL;
+
+    // Empréstimo do irmão esquerdo
+    if (esq && esq->quantidade > MIN_CHAVES) {
+        memmove(filho->chaves + 1, filho->chaves, sizeof(int) * filho->quantidade);
+
+        if (folha) {
+            filho->chaves[0] = esq->chaves[esq->quantidade - 1];
+            pai->chaves[i - 1] = filho->chaves[0];
+        } else {
+            memmove(filho->filhos + 1, filho->filhos, sizeof(Indice) * (filho->quantidade + 1));
+            filho->chaves[0] = pai->chaves[i - 1];
+            filho->filhos[0] = esq->filhos[esq->quantidade];
+            pai->chaves[i - 1] = esq->chaves[esq->quantidade - 1];
+        }
+
+        filho->quantidade++;
+        esq->quantidade--;
+    }
+    // Empréstimo do irmão direito
+    else if (dir && dir->quantidade > MIN_CHAVES) {
+        if (folha) {
+            filho->chaves[filho->quantidade] = dir->chaves[0];
+            memmove(dir->chaves, dir->chaves + 1, sizeof(int) * (dir->quantidade - 1));
+            pai->chaves[i] = dir->chaves[0];
+        } else {
+            filho->chaves[filho->quantidade] = pai->chaves[i];
+            filho->filhos[filho->quantidade + 1] = dir->filhos[0];
+            pai->chaves[i] = dir->chaves[0];
+            memmove(dir->chaves, dir->chaves + 1, sizeof(int) * (dir->quantidade - 1));
+            memmove(dir->filhos, dir->filhos + 1, sizeof(Indice) * dir->quantidade);
+        }
+
+        filho->quantidade++;
+        dir->quantidade--;
+    }
+    // Nenhum irmão pode emprestar: junta com um deles
+    else if (esq) {
+        juntarFilhos(pai, i - 1);
+    } else {
+        juntarFilhos(pai, i);
+    }
+}
+
+/**
+ * Remove um valor da subárvore, corrigindo os filhos que ficarem com poucas chaves.
+ * @param indice Raiz da subárvore
+ * @param valor Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ */
+void removerRec(const Indice indice, const int valor, Status *status) {
+    No *no = noIndice(indice);
+
+    if (ehFolha(indice)) {
+        const int pos = contarMenores(no, valor);
+
+        if (pos >= no->quantidade || no->chaves[pos] != valor) {
+            *status = STATUS_AUSENTE;
+            return;
+        }
+        *status = STATUS_OK;
+
+        memmove(no->chaves + pos, no->chaves + pos + 1, sizeof(int) * (no->quantidade - pos - 1));
+        no->quantidade--;
+        return;
+    }
+
+    const int i = indiceFilho(no, valor);
+    removerRec(no->filhos[i], valor, status);
+
+    if (noIndice(no->filhos[i])->quantidade < MIN_CHAVES) {
+        corrigirFilho(no, i);
+    }
+}
+
+/**
+ * Remove um valor da árvore B+.
+ * @param raiz Raiz da árvore
+ * @param valor Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Nova raiz da árvore
+ */
+Indice remover(const Indice raiz, const int valor, Status *status) {
+    if (raiz == NULO) {
+        *status = STATUS_AUSENTE;
+        return NULO;
+    }
+
+    removerRec(raiz, valor, status);
+
+    const No *no = noIndice(raiz);
+    if (no->quantidade > 0) return raiz;
+
+    // A raiz interna sem chaves é substituída pelo seu único filho: a árvore diminui um nível.
+    // A árvore fica vazia quando a raiz é uma folha sem chaves.
+    const Indice filho = ehFolha(raiz) ? NULO : no->filhos[0];
+    liberarNo(raiz);
+    return filho;
+}
+
+/* ============================================================
+   FUNÇÕES DE IMPRESSÃO
+   ============================================================ */
+
+/**
+ * Imprime as chaves de um nó no formato [k1 k2 ... kn].
+ */
+void imprimeChaves(const No *no) {
+    wprintf(L"[");
+    for (int i = 0; i < no->quantidade; i++) {
+        wprintf(i ? L" %d" : L"%d", no->chaves[i]);
+    }
+    wprintf(L"]");
+}
+
+/**
+ * Imprime todos os nós de um nível da árvore, da esquerda para a direita.
+ * @param indice Raiz da subárvore
+ * @param nivel Nível a ser impresso, relativo à raiz da subárvore
+ */
+void imprimeNivel(const Indice indice, const int nivel) {
+    const No *no = noIndice(indice);
+
+    if (nivel == 0) {
+        imprimeChaves(no);
+        wprintf(L" ");
+        return;
+    }
+
+    for (int i = 0; i <= no->quantidade; i++) {
+        imprimeNivel(no->filhos[i], nivel - 1);
+    }
+}
+
+/**
+ * Imprime a árvore B+ nível por nível, com um nó entre colchetes.
+ * @param raiz Raiz da árvore
+ */
+void imprimeArvore(const Indice raiz) {
+    if (raiz == NULO) {
+        wprintf(L"A árvore está vazia.\n");
+        return;
+    }
+
+    const int altura = alturaArvore(raiz);
+    for (int nivel = 0; nivel < altura; nivel++) {
+        wprintf(L"Nível %d: ", nivel);
+        imprimeNivel(raiz, nivel);
+        wprintf(L"\n");
+    }
+}
+
+/**
+ * Realiza o percurso pré-ordem na árvore B+, imprimindo as chaves de cada nó.
+ * @param raiz Índice da raiz da árvore
+ */
+void preOrdem(const Indice raiz) {
+    if (raiz == NULO) return;
+
+    const No *no = noIndice(raiz);
+    imprimeChaves(no);
+    wprintf(L" ");
+
+    if (!ehFolha(raiz)) {
+        for (int i = 0; i <= no->quantidade; i++) {
+            preOrdem(no->filhos[i]);
+        }
+    }
+}
+
+/* ============================================================
+   MODO BENCHMARK
+   ============================================================ */
+
+#define BENCH_AMOSTRAS 1048576 // máximo de latências amostradas por operação
+
+#define BENCH_INSERIR   0
+#define BENCH_PESQUISAR 1
+#define BENCH_AUSENTE   2
+#define BENCH_REMOVER   3
+
+/**
+ * Embaralha um inteiro de 32 bits (finalizador do MurmurHash3).
+ * A função é bijetora, portanto índices distintos sempre geram chaves distintas.
+ */
+unsigned int embaralhar(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Gera a i-ésima chave da sequência do benchmark.
+ * A mesma sequência é gerada em todos os programas, para que as árvores sejam comparáveis.
+ * @param i Índice da chave
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ */
+int chaveBench(const unsigned int i, const int ordenada) {
+    return ordenada ? (int) i : (int) embaralhar(i);
+}
+
+/**
+ * Retorna o instante atual em nanossegundos.
+ */
+long long agoraNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Retorna o pico de memória residente do processo, em kilobytes (0 quando indisponível).
+ */
+long picoMemoriaKb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * Compara duas latências, para a ordenação com qsort.
+ */
+int compararLatencias(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Aplica a operação do benchmark correspondente ao índice i.
+ * @param raiz Raiz da árvore
+ * @param operacao Operação a ser aplicada (BENCH_*)
+ * @param chave Chave da operação
+ * @param encontrados Contador de pesquisas bem-sucedidas (evita que a pesquisa seja descartada pelo compilador)
+ * @return Nova raiz da árvore
+ */
+Indice aplicarBench(const Indice raiz, const int operacao, const int chave, unsigned int *encontrados) {
+    Status status;
+
+    switch (operacao) {
+        case BENCH_INSERIR:
+            return insercao(raiz, chave, &status);
+        case BENCH_REMOVER:
+            return remover(raiz, chave, &status);
+        default:
+            *encontrados += pesquisaNo(raiz, chave) != NULL;
+            return raiz;
+    }
+}
+
+/**
+ * Gera a chave da i-ésima repetição de uma operação do benchmark.
+ * As pesquisas bem-sucedidas sorteiam chaves já inseridas, e as sem sucesso usam
+ * chaves que nunca foram inseridas.
+ */
+int chaveOperacao(const int operacao, const unsigned int i, const unsigned int n, const int ordenada) {
+    switch (operacao) {
+        case BENCH_PESQUISAR:
+            return chaveBench(embaralhar(i ^ 0x9e3779b9u) % n, ordenada);
+        case BENCH_AUSENTE:
+            return chaveBench(n + i, ordenada);
+        default:
+            return chaveBench(i, ordenada);
+    }
+}
+
+/**
+ * Executa n repetições de uma operação e escreve uma linha CSV com os resultados:
+ * motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura
+ * @return Nova raiz da árvore
+ */
+Indice medirBench(Indice raiz, const int operacao, const unsigned int n, const int ordenada) {
+    static long long amostras[BENCH_AMOSTRAS];
+    const char *nomes[] = {"inserir", "pesquisar", "pesquisar_ausente", "remover"};
+
+    // Apenas uma a cada "passo" operações tem a latência medida individualmente
+    const unsigned int passo = n / BENCH_AMOSTRAS + 1;
+    unsigned int encontrados = 0;
+    size_t qtd = 0;
+
+    const long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) {
+        const int chave = chaveOperacao(operacao, i, n, ordenada);
+
+        if (i % passo == 0) {
+            const long long t0 = agoraNs();
+            raiz = aplicarBench(raiz, operacao, chave, &encontrados);
+            amostras[qtd++] = agoraNs() - t0;
+        } else {
+            raiz = aplicarBench(raiz, operacao, chave, &encontrados);
+        }
+    }
+    const long long total = agoraNs() - inicio;
+
+    qsort(amostras, qtd, sizeof(long long), compararLatencias);
+
+    printf("bmais,%s,%s,%u,%.0f,%.2f,%lld,%lld,%lld,%ld,%d\n",
+           ordenada ? "ordenada" : "aleatoria", nomes[operacao], n,
+           n / (total / 1e9), (double) total / n,
+           amostras[qtd / 2], amostras[qtd * 99 / 100], amostras[qtd * 999 / 1000],
+           picoMemoriaKb(), alturaArvore(raiz));
+
+    if (operacao == BENCH_PESQUISAR && encontrados != n) {
+        fprintf(stderr, "ERRO: %u de %u chaves foram encontradas\n", encontrados, n);
+    }
+
+    return raiz;
+}
+
+/**
+ * Executa o benchmark completo (inserção, pesquisa, pesquisa sem sucesso e remoção) sem interação.
+ * @param n Quantidade de chaves
+ * @param ordenada Tipo de carga
+ * @return Código de saída do programa
+ */
+int executarBenchmark(const unsigned int n, const int ordenada) {
+    Indice raiz = NULO;
+
+    if (n == 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    for (int operacao = BENCH_INSERIR; operacao <= BENCH_REMOVER; operacao++) {
+        raiz = medirBench(raiz, operacao, n, ordenada);
+    }
+
+    liberarArvore();
+    return 0;
+}
+
+/* ============================================================
+   MODO EM LOTE (FLUXO BINÁRIO)
+   ============================================================ */
+
+/*
+ * Formato dos registros (inteiros em little-endian):
+ * - requisição: 1 byte de operação + 4 bytes de chave
+ * - resposta:   1 byte de status + 4 bytes de valor
+ */
+#define LOTE_REGISTRO 5     // tamanho, em bytes, de uma requisição ou resposta
+#define LOTE_BUFFER   4096  // quantidade de registros lidos/escritos por chamada
+
+#define OP_INSERIR   1
+#define OP_REMOVER   2
+#define OP_PESQUISAR 3
+
+/* O status de cada resposta é o próprio Status retornado pela operação */
+
+/**
+ * Lê um inteiro de 32 bits em little-endian.
+ */
+int lerInt32(const unsigned char *p) {
+    return (int) ((unsigned int) p[0] | (unsigned int) p[1] << 8 |
+                  (unsigned int) p[2] << 16 | (unsigned int) p[3] << 24);
+}
+
+/**
+ * Escreve um inteiro de 32 bits em little-endian.
+ */
+void escreverInt32(unsigned char *p, const int valor) {
+    const unsigned int v = (unsigned int) valor;
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+    p[2] = (unsigned char) (v >> 16);
+    p[3] = (unsigned char) (v >> 24);
+}
+
+/**
+ * Aplica uma requisição do fluxo binário na árvore.
+ * @param raiz Raiz da árvore
+ * @param requisicao Registro de requisição (operação + chave)
+ * @param resposta Registro onde a resposta (status + valor) será escrita
+ * @return Nova raiz da árvore
+ */
+Indice processarRegistro(Indice raiz, const unsigned char *requisicao, unsigned char *resposta) {
+    const int chave = lerInt32(requisicao + 1);
+    Status status = STATUS_OK;
+
+    switch (requisicao[0]) {
+        case OP_INSERIR:
+            raiz = insercao(raiz, chave, &status);
+            break;
+
+        case OP_REMOVER:
+            raiz = remover(raiz, chave, &status);
+            break;
+
+        case OP_PESQUISAR:
+            if (!pesquisaNo(raiz, chave)) status = STATUS_AUSENTE;
+            break;
+
+        default:
+            status = STATUS_INVALIDO;
+    }
+
+    resposta[0] = (unsigned char) status;
+    escreverInt32(resposta + 1, chave);
+
+    return raiz;
+}
+
+/**
+ * Processa um fluxo binário de requisições, sem nenhuma interação com o usuário,
+ * escrevendo uma resposta para cada requisição recebida.
+ * @param entrada Fluxo de requisições
+ * @param saida Fluxo de respostas
+ * @return Código de saída do programa
+ */
+int executarLote(FILE *entrada, FILE *saida) {
+    static unsigned char requisicoes[LOTE_BUFFER * LOTE_REGISTRO];
+    static unsigned char respostas[LOTE_BUFFER * LOTE_REGISTRO];
+    Indice raiz = NULO;
+    size_t lidos;
+
+    while ((lidos = fread(requisicoes, LOTE_REGISTRO, LOTE_BUFFER, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            raiz = processarRegistro(raiz, requisicoes + i * LOTE_REGISTRO, respostas + i * LOTE_REGISTRO);
+        }
+
+        if (fwrite(respostas, LOTE_REGISTRO, lidos, saida) != lidos) {
+            fprintf(stderr, "ERRO: falha ao escrever as respostas\n");
+            liberarArvore();
+            return 1;
+        }
+    }
+
+    fflush(saida);
+    liberarArvore();
+    return ferror(entrada) ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Modo benchmark: questao03 --bench <n> [aleatoria|ordenada]
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        const int ordenada = argc >= 4 && strcmp(argv[3], "ordenada") == 0;
+        return executarBenchmark((unsigned int) strtoul(argv[2], NULL, 10), ordenada);
+    }
+
+    // Modo em lote: questao03 --lote [arquivo], lendo da entrada padrão quando o arquivo é omitido
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) {
+        FILE *entrada = argc >= 3 ? fopen(argv[2], "rb") : stdin;
+        if (entrada == NULL) {
+            fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+            return 1;
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        const int resultado = executarLote(entrada, stdout);
+        if (entrada != stdin) fclose(entrada);
+        return resultado;
+    }
+
+    // Set locale to support wide characters
+    setlocale(LC_ALL, "");
+
+#ifdef _WIN32
+    // For Windows, specifically set the console output mode
+    // _O_U16TEXT might need a #define _O_U16TEXT 0x20000 on some older compilers
+    _setmode(_fileno(stdout), _O_U16TEXT);
+#else
+    // For POSIX systems, fwide(stdout, 1) can set the stream to wide orientation
+    fwide(stdout, 1);
+#endif
+
+    int escolha, valor;
+    Status status;
+    Indice raiz = NULO;
+
+    do{
+        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n");
+        wprintf(L"Escolha uma opção: ");
+        wscanf(L"%d", &escolha);
+
+        switch (escolha){
+            case 0:
+                wprintf(L"Finalizando...");
+                break;
+
+            case 1:
+                wprintf(L"\nInforme o valor que deseja inserir: ");
+                wscanf(L"%d", &valor);
+                raiz = insercao(raiz, valor, &status);
+                if (status == STATUS_DUPLICADA) {
+                    wprintf(L"A inserção não foi realizada, pois %d já existe\n", valor);
+                } else if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                }
+                break;
+
+            case 2:
+                wprintf(L"\nInforme o valor que deseja remover: ");
+                wscanf(L"%d", &valor);
+                raiz = remover(raiz, valor, &status);
+                if (status == STATUS_AUSENTE) {
+                    wprintf(L"Valor não encontrado na árvore.\n");
+                }
+                break;
+
+            case 3:
+                wprintf(L"\nInforme o valor que deseja pesquisar: ");
+                wscanf(L"%d", &valor);
+                if (pesquisaNo(raiz, valor)) {
+                    wprintf(L"Valor %d encontrado na árvore.\n", valor);
+                } else {
+                    wprintf(L"Valor %d não encontrado na árvore.\n", valor);
+                }
+                break;
+
+            case 4:
+                imprimeArvore(raiz);
+                break;
+
+            case 5:
+                preOrdem(raiz);
+                break;
+
+            default:
+                wprintf(L"\nOpcao invalida!!!!");
+        }
+
+    }while (escolha != 0);
+
+    // Libera todos os nós da árvore de uma só vez
+    liberarArvore();
+    return 0;
+}
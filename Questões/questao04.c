@@ -0,0 +1,1670 @@
+// Expõe nanosleep mesmo quando compilado com -std=c11
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <wchar.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+/* Alunos:
+Murilo Henrique Conde da Luz
+Nathielly Neves de Castro */
+
+/* ============================================================
+   DEFINIÇÃO DA ESTRUTURA DO NÓ
+   ============================================================ */
+
+/*
+ * Árvore AVL concorrente, no estilo de Bronson, Casper, Chafi e Olukotun
+ * ("A Practical Concurrent Binary Search Tree"):
+ * - cada nó tem a sua trava e uma versão, alterada sempre que uma rotação
+ *   reduz a faixa de chaves da sua subárvore
+ * - as pesquisas não usam travas: descem de mão em mão, validando a versão do
+ *   pai depois de ler o filho, e recomeçam do pai quando ela mudou
+ * - as escritas travam apenas os nós que alteram, e o balanceamento é relaxado:
+ *   cada thread conserta, de baixo para cima, as alturas e os desequilíbrios
+ *   que causou, travando só o nó e o seu pai em cada passo
+ * - a remoção de um nó com dois filhos apenas o marca como ausente (nó de
+ *   roteamento); os nós de roteamento com menos de dois filhos são desligados
+ * - os nós desligados são liberados por épocas, enquanto as threads ainda operam
+ */
+
+#define VERSAO_DESLIGADO  1UL // o nó foi retirado da árvore
+#define VERSAO_ENCOLHENDO 2UL // uma rotação está reduzindo a faixa de chaves da subárvore
+#define VERSAO_INCREMENTO 4UL // cada rotação concluída soma este valor à versão
+
+/**
+ * Estrutura que representa um nó da árvore AVL concorrente.
+ * Os campos alterados depois da criação são atômicos, pois são lidos sem trava.
+ * A altura segue a convenção do artigo: 0 para NULL e 1 para uma folha.
+ */
+typedef struct no {
+    int valor;
+    atomic_int presente;            // 0 em um nó de roteamento (valor removido)
+    atomic_int altura;
+    atomic_ulong versao;
+    _Atomic(struct no *) pai;
+    _Atomic(struct no *) esquerdo;
+    _Atomic(struct no *) direito;
+    pthread_mutex_t trava;
+    struct no *proximoDesligado;    // lista de nós desligados, aguardando liberação
+    unsigned long epocaDesligado;   // época global quando o nó foi desligado
+} No;
+
+/*
+ * Os nós desligados são recuperados por épocas: cada thread anuncia a época
+ * global ao começar uma operação, e um nó desligado na época e só é liberado
+ * quando nenhuma operação em andamento anunciou uma época <= e. Cada thread
+ * ocupa uma vaga, com a sua própria lista de nós desligados, de modo que
+ * desligar um nó não disputa nada com as outras threads.
+ */
+#define PARTICIPANTES_MAXIMO 128
+#define RECOLHER_LIMIAR      64 // nós desligados por uma thread antes de tentar liberá-los
+
+/**
+ * Vaga de uma thread na recuperação por épocas, uma por linha de cache para
+ * que as threads não disputem a mesma linha.
+ */
+typedef struct {
+    _Alignas(64) atomic_ulong epoca; // época anunciada (0 fora de uma operação)
+    atomic_int ocupada;
+    No *desligados;                  // nós desligados por quem ocupa a vaga
+    int quantidade;
+} Participante;
+
+/**
+ * A árvore é uma sentinela cujo filho direito é a raiz, de modo que toda
+ * rotação tenha um pai para travar. A sentinela nunca encolhe.
+ */
+typedef struct {
+    No sentinela;
+    atomic_ulong epoca; // época global, avançada a cada tentativa de liberação
+    Participante participantes[PARTICIPANTES_MAXIMO];
+} ArvoreConcorrente;
+
+static ArvoreConcorrente arvore = {.sentinela = {.trava = PTHREAD_MUTEX_INITIALIZER}, .epoca = 1};
+
+static _Thread_local int participanteAtual = -1; // vaga da thread (-1 enquanto não ocupou nenhuma)
+
+/* ============================================================
+   CÓDIGOS DE RETORNO
+   ============================================================ */
+
+/**
+ * Resultado das operações da árvore. As operações não escrevem nada na tela:
+ * cabe a quem as chama decidir o que fazer com o resultado.
+ */
+typedef enum {
+    STATUS_OK = 0,         // operação realizada (ou chave encontrada)
+    STATUS_AUSENTE = 1,    // chave não encontrada
+    STATUS_DUPLICADA = 2,  // chave já existente, inserção ignorada
+    STATUS_INVALIDO = 3,   // operação desconhecida (usado no modo em lote)
+    STATUS_SEM_MEMORIA = 4 // não foi possível alocar um novo nó
+} Status;
+
+#define REPETIR -1 // a validação falhou: a operação recomeça a partir do pai
+
+/* ============================================================
+   FUNÇÕES AUXILIARES DOS NÓS
+   ============================================================ */
+
+/**
+ * Cria e inicializa um novo nó folha.
+ * @param num Valor a ser armazenado no nó
+ * @param pai Pai do novo nó
+ * @return Ponteiro para o novo nó criado ou NULL, caso não haja memória
+ */
+No* novoNo(const int num, No *pai) {
+    No *novo = malloc(sizeof(No));
+
+    if (novo) {
+        novo->valor = num;
+        atomic_init(&novo->presente, 1);
+        atomic_init(&novo->altura, 1);
+        atomic_init(&novo->versao, 0);
+        atomic_init(&novo->pai, pai);
+        atomic_init(&novo->esquerdo, NULL);
+        atomic_init(&novo->direito, NULL);
+        pthread_mutex_init(&novo->trava, NULL);
+        novo->proximoDesligado = NULL;
+        novo->epocaDesligado = 0;
+    }
+
+    return novo;
+}
+
+/**
+ * Retorna a altura de um nó (0 se for NULL).
+ */
+int alturaNo(No *no) {
+    return no ? atomic_load(&no->altura) : 0;
+}
+
+/**
+ * Retorna o filho na direção indicada (negativa: esquerdo, positiva: direito).
+ */
+No* filho(No *no, const int direcao) {
+    return direcao < 0 ? atomic_load(&no->esquerdo) : atomic_load(&no->direito);
+}
+
+/**
+ * Retorna o maior valor entre dois inteiros.
+ */
+int maior(const int a, const int b) {
+    return a > b ? a : b;
+}
+
+/**
+ * Compara duas chaves, retornando a direção a seguir (negativa, zero ou positiva).
+ */
+int compararChaves(const int a, const int b) {
+    return (a > b) - (a < b);
+}
+
+/**
+ * Indica se a versão corresponde a um nó desligado ou encolhendo.
+ */
+int instavel(const unsigned long versao) {
+    return (versao & (VERSAO_DESLIGADO | VERSAO_ENCOLHENDO)) != 0;
+}
+
+#define ESPERA_GIROS 100 // leituras da versão antes de esperar pela trava
+
+/**
+ * Espera o fim da rotação que está encolhendo um nó. As rotações acontecem com
+ * a trava do nó, portanto, se a versão não mudar logo, basta obter a trava.
+ */
+void aguardarEncolhimento(No *no, const unsigned long versao) {
+    if (!(versao & VERSAO_ENCOLHENDO)) return;
+
+    for (int i = 0; i < ESPERA_GIROS; i++) {
+        if (atomic_load(&no->versao) != versao) return;
+    }
+
+    pthread_mutex_lock(&no->trava);
+    pthread_mutex_unlock(&no->trava);
+}
+
+/* ============================================================
+   RECUPERAÇÃO DE MEMÓRIA POR ÉPOCAS
+   ============================================================ */
+
+/**
+ * Libera um nó que nenhuma thread pode mais estar lendo.
+ */
+void liberarNo(No *no) {
+    pthread_mutex_destroy(&no->trava);
+    free(no);
+}
+
+/**
+ * Ocupa uma vaga livre para a thread atual, esperando se todas estiverem ocupadas.
+ * A vaga pode trazer nós desligados por quem a ocupou antes, que passam a ser desta thread.
+ */
+void ocuparVaga(void) {
+    while (1) {
+        for (int i = 0; i < PARTICIPANTES_MAXIMO; i++) {
+            int livre = 0;
+            if (atomic_compare_exchange_strong(&arvore.participantes[i].ocupada, &livre, 1)) {
+                participanteAtual = i;
+                return;
+            }
+        }
+        sched_yield();
+    }
+}
+
+/**
+ * Começa uma operação: anuncia a época global, protegendo todos os nós que a
+ * operação alcançar até sairOperacao.
+ */
+void entrarOperacao(void) {
+    if (participanteAtual < 0) ocuparVaga();
+    atomic_store(&arvore.participantes[participanteAtual].epoca, atomic_load(&arvore.epoca));
+}
+
+/**
+ * Libera os nós desligados pela thread atual que nenhuma operação em andamento
+ * pode estar lendo. Deve ser chamada fora de uma operação.
+ */
+void recolherVaga(void) {
+    Participante *vaga = &arvore.participantes[participanteAtual];
+
+    // Operações que começarem depois daqui não alcançam mais nenhum nó da lista
+    unsigned long minima = atomic_fetch_add(&arvore.epoca, 1) + 1;
+    for (int i = 0; i < PARTICIPANTES_MAXIMO; i++) {
+        const unsigned long epoca = atomic_load(&arvore.participantes[i].epoca);
+        if (epoca != 0 && epoca < minima) minima = epoca;
+    }
+
+    No **anterior = &vaga->desligados;
+    while (*anterior != NULL) {
+        No *no = *anterior;
+        if (no->epocaDesligado < minima) {
+            *anterior = no->proximoDesligado;
+            liberarNo(no);
+            vaga->quantidade--;
+        } else {
+            anterior = &no->proximoDesligado;
+        }
+    }
+}
+
+/**
+ * Encerra uma operação e, se a thread já acumulou nós desligados suficientes,
+ * tenta liberá-los.
+ */
+void sairOperacao(void) {
+    Participante *vaga = &arvore.participantes[participanteAtual];
+
+    atomic_store_explicit(&vaga->epoca, 0, memory_order_release);
+    if (vaga->quantidade >= RECOLHER_LIMIAR) recolherVaga();
+}
+
+/**
+ * Devolve a vaga da thread atual, que deve ser chamada antes de a thread terminar.
+ * Os nós desligados que ainda não puderam ser liberados ficam na vaga para quem a ocupar depois.
+ */
+void desocuparVaga(void) {
+    if (participanteAtual < 0) return;
+
+    recolherVaga();
+    atomic_store(&arvore.participantes[participanteAtual].ocupada, 0);
+    participanteAtual = -1;
+}
+
+/**
+ * Coloca um nó desligado na lista da thread atual. Outras threads podem ainda
+ * estar lendo o nó, por isso ele só é liberado quando todas as operações que
+ * começaram antes do desligamento terminarem.
+ */
+void aposentar(No *no) {
+    Participante *vaga = &arvore.participantes[participanteAtual];
+
+    no->epocaDesligado = atomic_load(&arvore.epoca);
+    no->proximoDesligado = vaga->desligados;
+    vaga->desligados = no;
+    vaga->quantidade++;
+}
+
+/* ============================================================
+   BALANCEAMENTO RELAXADO
+   ============================================================ */
+
+#define CONDICAO_NADA       -3 // altura correta e nó balanceado
+#define CONDICAO_REBALANCEAR -2
+#define CONDICAO_DESLIGAR   -1 // nó de roteamento com menos de dois filhos
+
+/**
+ * Avalia o que precisa ser consertado em um nó.
+ * @return Uma das condições acima ou, se só a altura estiver errada, a altura correta
+ */
+int condicaoNo(No *no) {
+    No *esq = atomic_load(&no->esquerdo);
+    No *dir = atomic_load(&no->direito);
+
+    if ((esq == NULL || dir == NULL) && !atomic_load(&no->presente)) return CONDICAO_DESLIGAR;
+
+    const int alturaEsq = alturaNo(esq);
+    const int alturaDir = alturaNo(dir);
+    const int alturaNova = 1 + maior(alturaEsq, alturaDir);
+    const int fator = alturaEsq - alturaDir;
+
+    if (fator < -1 || fator > 1) return CONDICAO_REBALANCEAR;
+    return alturaNova != atomic_load(&no->altura) ? alturaNova : CONDICAO_NADA;
+}
+
+/**
+ * Corrige a altura de um nó travado.
+ * @return O próximo nó a ser consertado (o pai, o próprio nó ou NULL se nada mais for necessário)
+ */
+No* corrigirAltura(No *no) {
+    const int condicao = condicaoNo(no);
+
+    switch (condicao) {
+        case CONDICAO_REBALANCEAR:
+        case CONDICAO_DESLIGAR:
+            return no; // exige a trava do pai
+        case CONDICAO_NADA:
+            return NULL;
+        default:
+            atomic_store(&no->altura, condicao);
+            return atomic_load(&no->pai);
+    }
+}
+
+/**
+ * Tenta retirar da árvore um nó com no máximo um filho. O pai e o nó devem estar travados.
+ * @return 1 se o nó foi desligado ou 0 se a estrutura mudou
+ */
+int desligarNo(No *pai, No *no) {
+    No *paiEsq = atomic_load(&pai->esquerdo);
+    No *paiDir = atomic_load(&pai->direito);
+    if (paiEsq != no && paiDir != no) return 0;
+
+    No *esq = atomic_load(&no->esquerdo);
+    No *dir = atomic_load(&no->direito);
+    if (esq != NULL && dir != NULL) return 0;
+
+    No *unico = esq ? esq : dir;
+    if (paiEsq == no) {
+        atomic_store(&pai->esquerdo, unico);
+    } else {
+        atomic_store(&pai->direito, unico);
+    }
+    if (unico) atomic_store(&unico->pai, pai);
+
+    atomic_store(&no->versao, VERSAO_DESLIGADO);
+    atomic_store(&no->presente, 0);
+    aposentar(no);
+    return 1;
+}
+
+/**
+ * Troca o filho "de" do pai por "para". O pai deve estar travado.
+ */
+void substituirFilho(No *pai, No *de, No *para) {
+    if (atomic_load(&pai->esquerdo) == de) {
+        atomic_store(&pai->esquerdo, para);
+    } else {
+        atomic_store(&pai->direito, para);
+    }
+    atomic_store(&para->pai, pai);
+}
+
+/**
+ * Rotação simples à direita de n, com pai, n e o filho esquerdo travados.
+ * As alturas usadas são as lidas com as travas.
+ * @return O próximo nó a ser consertado
+ */
+No* rotacaoDir(No *pai, No *n, No *esq, const int alturaDir, const int alturaEsqEsq,
+               No *esqDir, const int alturaEsqDir) {
+    const unsigned long versao = atomic_load(&n->versao);
+
+    atomic_store(&n->versao, versao | VERSAO_ENCOLHENDO);
+    atomic_store(&n->esquerdo, esqDir);
+    if (esqDir) atomic_store(&esqDir->pai, n);
+    atomic_store(&esq->direito, n);
+    atomic_store(&n->pai, esq);
+    substituirFilho(pai, n, esq);
+
+    const int alturaN = 1 + maior(alturaEsqDir, alturaDir);
+    atomic_store(&n->altura, alturaN);
+    atomic_store(&esq->altura, 1 + maior(alturaEsqEsq, alturaN));
+    atomic_store(&n->versao, versao + VERSAO_INCREMENTO);
+
+    // n ficou mais baixo: ele é o primeiro a ser verificado
+    const int fatorN = alturaEsqDir - alturaDir;
+    if (fatorN < -1 || fatorN > 1) return n;
+    if ((esqDir == NULL || alturaDir == 0) && !atomic_load(&n->presente)) return n;
+
+    const int fatorEsq = alturaEsqEsq - alturaN;
+    if (fatorEsq < -1 || fatorEsq > 1) return esq;
+    if (alturaEsqEsq == 0 && !atomic_load(&esq->presente)) return esq;
+
+    return corrigirAltura(pai);
+}
+
+/**
+ * Rotação simples à esquerda de n, com pai, n e o filho direito travados.
+ * @return O próximo nó a ser consertado
+ */
+No* rotacaoEsq(No *pai, No *n, const int alturaEsq, No *dir, No *dirEsq,
+               const int alturaDirEsq, const int alturaDirDir) {
+    const unsigned long versao = atomic_load(&n->versao);
+
+    atomic_store(&n->versao, versao | VERSAO_ENCOLHENDO);
+    atomic_store(&n->direito, dirEsq);
+    if (dirEsq) atomic_store(&dirEsq->pai, n);
+    atomic_store(&dir->esquerdo, n);
+    atomic_store(&n->pai, dir);
+    substituirFilho(pai, n, dir);
+
+    const int alturaN = 1 + maior(alturaEsq, alturaDirEsq);
+    atomic_store(&n->altura, alturaN);
+    atomic_store(&dir->altura, 1 + maior(alturaN, alturaDirDir));
+    atomic_store(&n->versao, versao + VERSAO_INCREMENTO);
+
+    const int fatorN = alturaDirEsq - alturaEsq;
+    if (fatorN < -1 || fatorN > 1) return n;
+    if ((dirEsq == NULL || alturaEsq == 0) && !atomic_load(&n->presente)) return n;
+
+    const int fatorDir = alturaDirDir - alturaN;
+    if (fatorDir < -1 || fatorDir > 1) return dir;
+    if (alturaDirDir == 0 && !atomic_load(&dir->presente)) return dir;
+
+    return corrigirAltura(pai);
+}
+
+/**
+ * Rotação dupla Esquerda-Direita de n, com pai, n, o filho esquerdo e o neto travados.
+ * @return O próximo nó a ser consertado
+ */
+No* rotacaoEsqDir(No *pai, No *n, No *esq, const int alturaDir, const int alturaEsqEsq,
+                  No *esqDir, const int alturaEsqDirEsq) {
+    const unsigned long versaoN = atomic_load(&n->versao);
+    const unsigned long versaoEsq = atomic_load(&esq->versao);
+    No *esqDirEsq = atomic_load(&esqDir->esquerdo);
+    No *esqDirDir = atomic_load(&esqDir->direito);
+    const int alturaEsqDirDir = alturaNo(esqDirDir);
+
+    atomic_store(&n->versao, versaoN | VERSAO_ENCOLHENDO);
+    atomic_store(&esq->versao, versaoEsq | VERSAO_ENCOLHENDO);
+
+    atomic_store(&n->esquerdo, esqDirDir);
+    if (esqDirDir) atomic_store(&esqDirDir->pai, n);
+    atomic_store(&esq->direito, esqDirEsq);
+    if (esqDirEsq) atomic_store(&esqDirEsq->pai, esq);
+    atomic_store(&esqDir->esquerdo, esq);
+    atomic_store(&esq->pai, esqDir);
+    atomic_store(&esqDir->direito, n);
+    atomic_store(&n->pai, esqDir);
+    substituirFilho(pai, n, esqDir);
+
+    const int alturaN = 1 + maior(alturaEsqDirDir, alturaDir);
+    atomic_store(&n->altura, alturaN);
+    const int alturaEsq = 1 + maior(alturaEsqEsq, alturaEsqDirEsq);
+    atomic_store(&esq->altura, alturaEsq);
+    atomic_store(&esqDir->altura, 1 + maior(alturaEsq, alturaN));
+
+    atomic_store(&n->versao, versaoN + VERSAO_INCREMENTO);
+    atomic_store(&esq->versao, versaoEsq + VERSAO_INCREMENTO);
+
+    const int fatorN = alturaEsqDirDir - alturaDir;
+    if (fatorN < -1 || fatorN > 1) return n;
+    if ((esqDirDir == NULL || alturaDir == 0) && !atomic_load(&n->presente)) return n;
+
+    const int fator = alturaEsq - alturaN;
+    if (fator < -1 || fator > 1) return esqDir;
+
+    return corrigirAltura(pai);
+}
+
+/**
+ * Rotação dupla Direita-Esquerda de n, com pai, n, o filho direito e o neto travados.
+ * @return O próximo nó a ser consertado
+ */
+No* rotacaoDirEsq(No *pai, No *n, const int alturaEsq, No *dir, No *dirEsq,
+                  const int alturaDirDir, const int alturaDirEsqDir) {
+    const unsigned long versaoN = atomic_load(&n->versao);
+    const unsigned long versaoDir = atomic_load(&dir->versao);
+    No *dirEsqEsq = atomic_load(&dirEsq->esquerdo);
+    No *dirEsqDir = atomic_load(&dirEsq->direito);
+    const int alturaDirEsqEsq = alturaNo(dirEsqEsq);
+
+    atomic_store(&n->versao, versaoN | VERSAO_ENCOLHENDO);
+    atomic_store(&dir->versao, versaoDir | VERSAO_ENCOLHENDO);
+
+    atomic_store(&n->direito, dirEsqEsq);
+    if (dirEsqEsq) atomic_store(&dirEsqEsq->pai, n);
+    atomic_store(&dir->esquerdo, dirEsqDir);
+    if (dirEsqDir) atomic_store(&dirEsqDir->pai, dir);
+    atomic_store(&dirEsq->direito, dir);
+    atomic_store(&dir->pai, dirEsq);
+    atomic_store(&dirEsq->esquerdo, n);
+    atomic_store(&n->pai, dirEsq);
+    substituirFilho(pai, n, dirEsq);
+
+    const int alturaN = 1 + maior(alturaEsq, alturaDirEsqEsq);
+    atomic_store(&n->altura, alturaN);
+    const int alturaDir = 1 + maior(alturaDirEsqDir, alturaDirDir);
+    atomic_store(&dir->altura, alturaDir);
+    atomic_store(&dirEsq->altura, 1 + maior(alturaN, alturaDir));
+
+    atomic_store(&n->versao, versaoN + VERSAO_INCREMENTO);
+    atomic_store(&dir->versao, versaoDir + VERSAO_INCREMENTO);
+
+    const int fatorN = alturaDirEsqEsq - alturaEsq;
+    if (fatorN < -1 || fatorN > 1) return n;
+    if ((dirEsqEsq == NULL || alturaEsq == 0) && !atomic_load(&n->presente)) return n;
+
+    const int fator = alturaDir - alturaN;
+    if (fator < -1 || fator > 1) return dirEsq;
+
+    return corrigirAltura(pai);
+}
+
+No* rebalancearParaEsquerda(No *pai, No *n, No *dir, const int alturaEsq);
+
+/**
+ * Conserta um nó cuja subárvore esquerda está alta demais, travando o filho
+ * esquerdo (e, se preciso, o neto). As alturas são relidas com as travas.
+ * @return O próximo nó a ser consertado
+ */
+No* rebalancearParaDireita(No *pai, No *n, No *esq, const int alturaDir) {
+    No *proximo = n; // repetir, caso a estrutura tenha mudado
+
+    pthread_mutex_lock(&esq->trava);
+    if (atomic_load(&esq->altura) - alturaDir > 1) {
+        No *esqDir = atomic_load(&esq->direito);
+        const int alturaEsqEsq = alturaNo(atomic_load(&esq->esquerdo));
+        const int alturaEsqDir = alturaNo(esqDir);
+
+        if (alturaEsqEsq >= alturaEsqDir) {
+            proximo = rotacaoDir(pai, n, esq, alturaDir, alturaEsqEsq, esqDir, alturaEsqDir);
+        } else {
+            int feito = 0;
+
+            pthread_mutex_lock(&esqDir->trava);
+            const int alturaEsqDirTravada = atomic_load(&esqDir->altura);
+            if (alturaEsqEsq >= alturaEsqDirTravada) {
+                proximo = rotacaoDir(pai, n, esq, alturaDir, alturaEsqEsq, esqDir, alturaEsqDirTravada);
+                feito = 1;
+            } else {
+                // A rotação dupla só é feita se o filho esquerdo não ficar desbalanceado
+                const int alturaEsqDirEsq = alturaNo(atomic_load(&esqDir->esquerdo));
+                const int fator = alturaEsqEsq - alturaEsqDirEsq;
+                if (fator >= -1 && fator <= 1) {
+                    if (!((alturaEsqEsq == 0 || alturaEsqDirEsq == 0) && !atomic_load(&esq->presente))) {
+                        proximo = rotacaoEsqDir(pai, n, esq, alturaDir, alturaEsqEsq, esqDir, alturaEsqDirEsq);
+                    } else {
+                        // A rotação dupla deixaria o filho esquerdo como um nó de roteamento a
+                        // desligar fora do caminho de conserto; rotacionando só ele, o nó a
+                        // desligar, o neto e n ficam na mesma linha de ancestrais
+                        proximo = rotacaoEsq(n, esq, alturaEsqEsq, esqDir, atomic_load(&esqDir->esquerdo),
+                                             alturaEsqDirEsq, alturaNo(atomic_load(&esqDir->direito)));
+                    }
+                    feito = 1;
+                }
+            }
+            pthread_mutex_unlock(&esqDir->trava);
+
+            // Caso contrário, o filho esquerdo é rotacionado sozinho; n é consertado depois
+            if (!feito) proximo = rebalancearParaEsquerda(n, esq, esqDir, alturaEsqEsq);
+        }
+    }
+    pthread_mutex_unlock(&esq->trava);
+
+    return proximo;
+}
+
+/**
+ * Conserta um nó cuja subárvore direita está alta demais (simétrica à anterior).
+ * @return O próximo nó a ser consertado
+ */
+No* rebalancearParaEsquerda(No *pai, No *n, No *dir, const int alturaEsq) {
+    No *proximo = n;
+
+    pthread_mutex_lock(&dir->trava);
+    if (alturaEsq - atomic_load(&dir->altura) < -1) {
+        No *dirEsq = atomic_load(&dir->esquerdo);
+        const int alturaDirEsq = alturaNo(dirEsq);
+        const int alturaDirDir = alturaNo(atomic_load(&dir->direito));
+
+        if (alturaDirDir >= alturaDirEsq) {
+            proximo = rotacaoEsq(pai, n, alturaEsq, dir, dirEsq, alturaDirEsq, alturaDirDir);
+        } else {
+            int feito = 0;
+
+            pthread_mutex_lock(&dirEsq->trava);
+            const int alturaDirEsqTravada = atomic_load(&dirEsq->altura);
+            if (alturaDirDir >= alturaDirEsqTravada) {
+                proximo = rotacaoEsq(pai, n, alturaEsq, dir, dirEsq, alturaDirEsqTravada, alturaDirDir);
+                feito = 1;
+            } else {
+                const int alturaDirEsqDir = alturaNo(atomic_load(&dirEsq->direito));
+                const int fator = alturaDirDir - alturaDirEsqDir;
+                if (fator >= -1 && fator <= 1) {
+                    if (!((alturaDirDir == 0 || alturaDirEsqDir == 0) && !atomic_load(&dir->presente))) {
+                        proximo = rotacaoDirEsq(pai, n, alturaEsq, dir, dirEsq, alturaDirDir, alturaDirEsqDir);
+                    } else {
+                        proximo = rotacaoDir(n, dir, dirEsq, alturaDirDir, alturaNo(atomic_load(&dirEsq->esquerdo)),
+                                             atomic_load(&dirEsq->direito), alturaDirEsqDir);
+                    }
+                    feito = 1;
+                }
+            }
+            pthread_mutex_unlock(&dirEsq->trava);
+
+            if (!feito) proximo = rebalancearParaDireita(n, dir, dirEsq, alturaDirDir);
+        }
+    }
+    pthread_mutex_unlock(&dir->trava);
+
+    return proximo;
+}
+
+/**
+ * Conserta um nó com o pai e o próprio nó travados: desliga um nó de roteamento,
+ * rotaciona um nó desbalanceado ou corrige a sua altura.
+ * @return O próximo nó a ser consertado
+ */
+No* rebalancearNo(No *pai, No *n) {
+    No *esq = atomic_load(&n->esquerdo);
+    No *dir = atomic_load(&n->direito);
+
+    if ((esq == NULL || dir == NULL) && !atomic_load(&n->presente)) {
+        return desligarNo(pai, n) ? corrigirAltura(pai) : n;
+    }
+
+    const int alturaEsq = alturaNo(esq);
+    const int alturaDir = alturaNo(dir);
+    const int alturaNova = 1 + maior(alturaEsq, alturaDir);
+    const int fator = alturaEsq - alturaDir;
+
+    if (fator > 1) return rebalancearParaDireita(pai, n, esq, alturaDir);
+    if (fator < -1) return rebalancearParaEsquerda(pai, n, dir, alturaEsq);
+
+    if (alturaNova != atomic_load(&n->altura)) {
+        atomic_store(&n->altura, alturaNova);
+        return corrigirAltura(pai);
+    }
+    return NULL;
+}
+
+/**
+ * Sobe a partir de um nó danificado por uma escrita, consertando alturas,
+ * desequilíbrios e nós de roteamento até que nada mais precise ser feito.
+ */
+void corrigirAlturaEBalancear(No *no) {
+    while (no != NULL && atomic_load(&no->pai) != NULL) {
+        const int condicao = condicaoNo(no);
+        if (atomic_load(&no->versao) & VERSAO_DESLIGADO) return;
+
+        if (condicao == CONDICAO_NADA) {
+            // Uma rotação que parou em um nó mais baixo pode ter deixado o pai do nó
+            // com a altura antiga: ele é conferido antes de encerrar
+            No *pai = atomic_load(&no->pai);
+            if (pai == NULL || atomic_load(&pai->pai) == NULL || condicaoNo(pai) == CONDICAO_NADA) return;
+            no = pai;
+            continue;
+        }
+
+        if (condicao != CONDICAO_DESLIGAR && condicao != CONDICAO_REBALANCEAR) {
+            // Só a altura está errada: basta a trava do próprio nó
+            pthread_mutex_lock(&no->trava);
+            No *proximo = corrigirAltura(no);
+            pthread_mutex_unlock(&no->trava);
+            no = proximo;
+        } else {
+            // A trava do pai vem antes da trava do filho
+            No *pai = atomic_load(&no->pai);
+            pthread_mutex_lock(&pai->trava);
+            if (!(atomic_load(&pai->versao) & VERSAO_DESLIGADO) && atomic_load(&no->pai) == pai) {
+                pthread_mutex_lock(&no->trava);
+                No *proximo = rebalancearNo(pai, no);
+                pthread_mutex_unlock(&no->trava);
+                // Sem mais nada abaixo, o pai ainda é conferido (e, por ele, o avô)
+                no = proximo ? proximo : pai;
+            }
+            pthread_mutex_unlock(&pai->trava);
+        }
+    }
+}
+
+/* ============================================================
+   FUNÇÕES DE PESQUISA
+   ============================================================ */
+
+/**
+ * Continua uma pesquisa a partir de um nó cuja versão foi lida antes de descer.
+ * Depois de ler cada filho, a versão do nó é conferida: se mudou, uma rotação
+ * pode ter tirado a chave da subárvore, e a pesquisa volta para o pai.
+ * @return 1 se encontrou, 0 se não encontrou ou REPETIR
+ */
+int tentarPesquisa(const int valor, No *no, const int direcao, const unsigned long versao) {
+    while (1) {
+        No *proximo = filho(no, direcao);
+
+        if (proximo == NULL) {
+            return atomic_load(&no->versao) != versao ? REPETIR : 0;
+        }
+
+        const int cmp = compararChaves(valor, proximo->valor);
+        if (cmp == 0) return atomic_load(&proximo->presente);
+
+        const unsigned long versaoProximo = atomic_load(&proximo->versao);
+        if (instavel(versaoProximo)) {
+            aguardarEncolhimento(proximo, versaoProximo);
+            if (atomic_load(&no->versao) != versao) return REPETIR;
+        } else if (proximo != filho(no, direcao)) {
+            if (atomic_load(&no->versao) != versao) return REPETIR;
+        } else {
+            if (atomic_load(&no->versao) != versao) return REPETIR;
+
+            // A partir daqui, o caminho até proximo é válido e não depende mais de no
+            const int resultado = tentarPesquisa(valor, proximo, cmp, versaoProximo);
+            if (resultado != REPETIR) return resultado;
+        }
+    }
+}
+
+/**
+ * Pesquisa um valor na árvore, sem travas.
+ * @param valor Valor a ser pesquisado
+ * @return 1 se o valor existir na árvore, 0 caso contrário
+ */
+int pesquisaNo(const int valor) {
+    entrarOperacao();
+    // A versão da sentinela nunca muda, portanto a pesquisa nunca repete a partir dela
+    const int encontrado = tentarPesquisa(valor, &arvore.sentinela, 1, 0) == 1;
+    sairOperacao();
+
+    return encontrado;
+}
+
+/**
+ * Retorna a altura da árvore (0 se estiver vazia).
+ */
+int alturaArvore(void) {
+    return alturaNo(atomic_load(&arvore.sentinela.direito));
+}
+
+/* ============================================================
+   INSERÇÃO E REMOÇÃO
+   ============================================================ */
+
+/**
+ * Insere ou remove o valor de um nó que já tem a chave procurada.
+ * @return Status da operação ou REPETIR
+ */
+int tentarAtualizarNo(const int inserir, No *pai, No *no) {
+    if (!inserir && !atomic_load(&no->presente)) return STATUS_AUSENTE;
+
+    if (!inserir && (atomic_load(&no->esquerdo) == NULL || atomic_load(&no->direito) == NULL)) {
+        // O nó pode ser desligado: trava o pai e depois o nó
+        pthread_mutex_lock(&pai->trava);
+        if ((atomic_load(&pai->versao) & VERSAO_DESLIGADO) || atomic_load(&no->pai) != pai) {
+            pthread_mutex_unlock(&pai->trava);
+            return REPETIR;
+        }
+
+        pthread_mutex_lock(&no->trava);
+        if (!atomic_load(&no->presente)) {
+            pthread_mutex_unlock(&no->trava);
+            pthread_mutex_unlock(&pai->trava);
+            return STATUS_AUSENTE;
+        }
+        if (!desligarNo(pai, no)) {
+            pthread_mutex_unlock(&no->trava);
+            pthread_mutex_unlock(&pai->trava);
+            return REPETIR;
+        }
+        pthread_mutex_unlock(&no->trava);
+
+        No *danificado = corrigirAltura(pai);
+        pthread_mutex_unlock(&pai->trava);
+
+        corrigirAlturaEBalancear(danificado);
+        return STATUS_OK;
+    }
+
+    // Inserção em um nó de roteamento ou remoção que mantém o nó como roteamento
+    int resultado;
+    pthread_mutex_lock(&no->trava);
+    if (atomic_load(&no->versao) & VERSAO_DESLIGADO) {
+        resultado = REPETIR;
+    } else if (inserir) {
+        resultado = atomic_load(&no->presente) ? STATUS_DUPLICADA : STATUS_OK;
+        atomic_store(&no->presente, 1);
+    } else if (!atomic_load(&no->presente)) {
+        resultado = STATUS_AUSENTE;
+    } else if (atomic_load(&no->esquerdo) == NULL || atomic_load(&no->direito) == NULL) {
+        resultado = REPETIR; // agora o nó pode ser desligado
+    } else {
+        atomic_store(&no->presente, 0);
+        resultado = STATUS_OK;
+    }
+    pthread_mutex_unlock(&no->trava);
+
+    return resultado;
+}
+
+/**
+ * Continua uma inserção ou remoção a partir de um nó cuja versão foi lida antes
+ * de descer, validando o caminho como na pesquisa.
+ * @return Status da operação ou REPETIR
+ */
+int tentarAtualizar(const int valor, const int inserir, No *pai, No *no, const unsigned long versao) {
+    const int cmp = compararChaves(valor, no->valor);
+    if (cmp == 0) return tentarAtualizarNo(inserir, pai, no);
+
+    while (1) {
+        No *proximo = filho(no, cmp);
+        if (atomic_load(&no->versao) != versao) return REPETIR;
+
+        if (proximo == NULL) {
+            if (!inserir) return STATUS_AUSENTE;
+
+            // A nova folha é pendurada com a trava do nó, revalidando a versão
+            pthread_mutex_lock(&no->trava);
+            if (atomic_load(&no->versao) != versao) {
+                pthread_mutex_unlock(&no->trava);
+                return REPETIR;
+            }
+            if (filho(no, cmp) != NULL) {
+                // Outra thread inseriu ali primeiro: tenta de novo a partir deste nó
+                pthread_mutex_unlock(&no->trava);
+                continue;
+            }
+
+            No *novo = novoNo(valor, no);
+            if (novo == NULL) {
+                pthread_mutex_unlock(&no->trava);
+                return STATUS_SEM_MEMORIA;
+            }
+            if (cmp < 0) {
+                atomic_store(&no->esquerdo, novo);
+            } else {
+                atomic_store(&no->direito, novo);
+            }
+            No *danificado = corrigirAltura(no);
+            pthread_mutex_unlock(&no->trava);
+
+            corrigirAlturaEBalancear(danificado);
+            return STATUS_OK;
+        }
+
+        const unsigned long versaoProximo = atomic_load(&proximo->versao);
+        if (instavel(versaoProximo)) {
+            aguardarEncolhimento(proximo, versaoProximo);
+        } else if (proximo == filho(no, cmp)) {
+            if (atomic_load(&no->versao) != versao) return REPETIR;
+
+            const int resultado = tentarAtualizar(valor, inserir, no, proximo, versaoProximo);
+            if (resultado != REPETIR) return resultado;
+        }
+    }
+}
+
+/**
+ * Insere ou remove um valor, recomeçando da raiz sempre que a validação falhar nela.
+ */
+Status atualizar(const int valor, const int inserir) {
+    No *sentinela = &arvore.sentinela;
+
+    while (1) {
+        No *raiz = atomic_load(&sentinela->direito);
+
+        if (raiz == NULL) {
+            if (!inserir) return STATUS_AUSENTE;
+
+            // Árvore vazia: a raiz é criada com a trava da sentinela
+            Status status = STATUS_OK;
+            int inserido = 0;
+            pthread_mutex_lock(&sentinela->trava);
+            if (atomic_load(&sentinela->direito) == NULL) {
+                No *novo = novoNo(valor, sentinela);
+                if (novo) {
+                    atomic_store(&sentinela->direito, novo);
+                    atomic_store(&sentinela->altura, 2);
+                } else {
+                    status = STATUS_SEM_MEMORIA;
+                }
+                inserido = 1;
+            }
+            pthread_mutex_unlock(&sentinela->trava);
+
+            if (inserido) return status;
+        } else {
+            const unsigned long versao = atomic_load(&raiz->versao);
+
+            if (instavel(versao)) {
+                aguardarEncolhimento(raiz, versao);
+            } else if (raiz == atomic_load(&sentinela->direito)) {
+                const int resultado = tentarAtualizar(valor, inserir, sentinela, raiz, versao);
+                if (resultado != REPETIR) return (Status) resultado;
+            }
+        }
+    }
+}
+
+/**
+ * Insere um valor na árvore; pode ser chamada por várias threads ao mesmo tempo.
+ * @param num Valor a ser inserido
+ * @return STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA
+ */
+Status insercao(const int num) {
+    entrarOperacao();
+    const Status status = atualizar(num, 1);
+    sairOperacao();
+
+    return status;
+}
+
+/**
+ * Remove um valor da árvore; pode ser chamada por várias threads ao mesmo tempo.
+ * @param chave Valor a ser removido
+ * @return STATUS_OK ou STATUS_AUSENTE
+ */
+Status remover(const int chave) {
+    entrarOperacao();
+    const Status status = atualizar(chave, 0);
+    sairOperacao();
+
+    return status;
+}
+
+/* ============================================================
+   LIBERAÇÃO DE MEMÓRIA
+   ============================================================ */
+
+/**
+ * Libera os nós desligados de todas as vagas, sem esperar pelas épocas. Só pode
+ * ser chamada quando nenhuma outra thread estiver operando na árvore.
+ */
+void recolherDesligados(void) {
+    for (int i = 0; i < PARTICIPANTES_MAXIMO; i++) {
+        Participante *vaga = &arvore.participantes[i];
+        No *no = vaga->desligados;
+
+        while (no != NULL) {
+            No *proximo = no->proximoDesligado;
+            liberarNo(no);
+            no = proximo;
+        }
+        vaga->desligados = NULL;
+        vaga->quantidade = 0;
+    }
+}
+
+/**
+ * Libera todos os nós de uma subárvore.
+ */
+void liberarSubarvore(No *raiz) {
+    if (raiz == NULL) return;
+
+    liberarSubarvore(atomic_load(&raiz->esquerdo));
+    liberarSubarvore(atomic_load(&raiz->direito));
+    liberarNo(raiz);
+}
+
+/**
+ * Libera a árvore inteira, sem nenhuma operação em andamento.
+ */
+void liberarArvore(void) {
+    liberarSubarvore(atomic_load(&arvore.sentinela.direito));
+    atomic_store(&arvore.sentinela.direito, NULL);
+    atomic_store(&arvore.sentinela.altura, 0);
+    recolherDesligados();
+}
+
+/* ============================================================
+   VERIFICAÇÃO DA ÁRVORE
+   ============================================================ */
+
+/**
+ * Verifica uma subárvore sem operações em andamento: ordem das chaves, ponteiros
+ * para o pai, alturas, balanceamento AVL e ausência de nós de roteamento que
+ * deveriam ter sido desligados.
+ * @param raiz Raiz da subárvore
+ * @param pai Pai esperado da raiz
+ * @param minimo Limite inferior exclusivo das chaves
+ * @param maximo Limite superior exclusivo das chaves
+ * @param presentes Recebe a soma dos valores presentes encontrados
+ * @return Altura da subárvore ou -1 se alguma regra foi violada
+ */
+int verificarSubarvore(No *raiz, No *pai, const long long minimo, const long long maximo, long long *presentes) {
+    if (raiz == NULL) return 0;
+
+    No *esq = atomic_load(&raiz->esquerdo);
+    No *dir = atomic_load(&raiz->direito);
+
+    if (raiz->valor <= minimo || raiz->valor >= maximo) return -1;
+    if (atomic_load(&raiz->pai) != pai || atomic_load(&raiz->versao) & VERSAO_DESLIGADO) return -1;
+    if (!atomic_load(&raiz->presente) && (esq == NULL || dir == NULL)) return -1;
+
+    const int alturaEsq = verificarSubarvore(esq, raiz, minimo, raiz->valor, presentes);
+    const int alturaDir = verificarSubarvore(dir, raiz, raiz->valor, maximo, presentes);
+    if (alturaEsq < 0 || alturaDir < 0) return -1;
+
+    const int altura = 1 + maior(alturaEsq, alturaDir);
+    if (altura != atomic_load(&raiz->altura) || abs(alturaEsq - alturaDir) > 1) return -1;
+
+    *presentes += atomic_load(&raiz->presente);
+    return altura;
+}
+
+/**
+ * Verifica a árvore inteira.
+ * @param presentes Recebe a quantidade de valores presentes
+ * @return 1 se a árvore é uma AVL válida, 0 caso contrário
+ */
+int verificarArvore(long long *presentes) {
+    *presentes = 0;
+    return verificarSubarvore(atomic_load(&arvore.sentinela.direito), &arvore.sentinela,
+                              (long long) INT32_MIN - 1, (long long) INT32_MAX + 1, presentes) >= 0;
+}
+
+/* ============================================================
+   FUNÇÕES DE IMPRESSÃO
+   ============================================================ */
+
+/**
+ * Imprime todos os nós de um nível da árvore, da esquerda para a direita.
+ * Os nós de roteamento (valores removidos) aparecem entre parênteses.
+ * @param no Raiz da subárvore
+ * @param nivel Nível a ser impresso, relativo à raiz da subárvore
+ */
+void imprimeNivel(No *no, const int nivel) {
+    if (no == NULL) return;
+
+    if (nivel == 0) {
+        wprintf(atomic_load(&no->presente) ? L"%d " : L"(%d) ", no->valor);
+        return;
+    }
+
+    imprimeNivel(atomic_load(&no->esquerdo), nivel - 1);
+    imprimeNivel(atomic_load(&no->direito), nivel - 1);
+}
+
+/**
+ * Imprime a árvore nível por nível.
+ */
+void imprimeArvore(void) {
+    No *raiz = atomic_load(&arvore.sentinela.direito);
+
+    if (raiz == NULL) {
+        wprintf(L"A árvore está vazia.\n");
+        return;
+    }
+
+    const int altura = alturaNo(raiz);
+    for (int nivel = 0; nivel < altura; nivel++) {
+        wprintf(L"Nível %d: ", nivel);
+        imprimeNivel(raiz, nivel);
+        wprintf(L"\n");
+    }
+}
+
+/**
+ * Realiza o percurso pré-ordem, imprimindo apenas os valores presentes.
+ * @param raiz Ponteiro para a raiz da árvore
+ */
+void preOrdem(No *raiz) {
+    if (raiz == NULL) return;
+
+    if (atomic_load(&raiz->presente)) wprintf(L"%d ", raiz->valor);
+    preOrdem(atomic_load(&raiz->esquerdo));
+    preOrdem(atomic_load(&raiz->direito));
+}
+
+/* ============================================================
+   MODO BENCHMARK
+   ============================================================ */
+
+#define BENCH_AMOSTRAS 1048576 // máximo de latências amostradas por operação
+
+#define BENCH_INSERIR   0
+#define BENCH_PESQUISAR 1
+#define BENCH_AUSENTE   2
+#define BENCH_REMOVER   3
+
+/**
+ * Embaralha um inteiro de 32 bits (finalizador do MurmurHash3).
+ * A função é bijetora, portanto índices distintos sempre geram chaves distintas.
+ */
+unsigned int embaralhar(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Gera a i-ésima chave da sequência do benchmark.
+ * A mesma sequência é gerada em todos os programas, para que as árvores sejam comparáveis.
+ * @param i Índice da chave
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ */
+int chaveBench(const unsigned int i, const int ordenada) {
+    return ordenada ? (int) i : (int) embaralhar(i);
+}
+
+/**
+ * Retorna o instante atual em nanossegundos.
+ */
+long long agoraNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Retorna o pico de memória residente do processo, em kilobytes (0 quando indisponível).
+ */
+long picoMemoriaKb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * Retorna a quantidade de processadores disponíveis (1 quando indisponível).
+ */
+int processadores(void) {
+#if defined(_SC_NPROCESSORS_ONLN)
+    const long quantidade = sysconf(_SC_NPROCESSORS_ONLN);
+    return quantidade > 0 ? (int) quantidade : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Compara duas latências, para a ordenação com qsort.
+ */
+int compararLatencias(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Aplica a operação do benchmark correspondente ao índice i.
+ * @param operacao Operação a ser aplicada (BENCH_*)
+ * @param chave Chave da operação
+ * @param encontrados Contador de pesquisas bem-sucedidas (evita que a pesquisa seja descartada pelo compilador)
+ */
+void aplicarBench(const int operacao, const int chave, unsigned int *encontrados) {
+    switch (operacao) {
+        case BENCH_INSERIR:
+            insercao(chave);
+            break;
+        case BENCH_REMOVER:
+            remover(chave);
+            break;
+        default:
+            *encontrados += pesquisaNo(chave);
+    }
+}
+
+/**
+ * Gera a chave da i-ésima repetição de uma operação do benchmark.
+ * As pesquisas bem-sucedidas sorteiam chaves já inseridas, e as sem sucesso usam
+ * chaves que nunca foram inseridas.
+ */
+int chaveOperacao(const int operacao, const unsigned int i, const unsigned int n, const int ordenada) {
+    switch (operacao) {
+        case BENCH_PESQUISAR:
+            return chaveBench(embaralhar(i ^ 0x9e3779b9u) % n, ordenada);
+        case BENCH_AUSENTE:
+            return chaveBench(n + i, ordenada);
+        default:
+            return chaveBench(i, ordenada);
+    }
+}
+
+/**
+ * Executa n repetições de uma operação em uma única thread e escreve uma linha
+ * CSV com os resultados:
+ * motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura
+ */
+void medirBench(const int operacao, const unsigned int n, const int ordenada) {
+    static long long amostras[BENCH_AMOSTRAS];
+    const char *nomes[] = {"inserir", "pesquisar", "pesquisar_ausente", "remover"};
+
+    // Apenas uma a cada "passo" operações tem a latência medida individualmente
+    const unsigned int passo = n / BENCH_AMOSTRAS + 1;
+    unsigned int encontrados = 0;
+    size_t qtd = 0;
+
+    const long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) {
+        const int chave = chaveOperacao(operacao, i, n, ordenada);
+
+        if (i % passo == 0) {
+            const long long t0 = agoraNs();
+            aplicarBench(operacao, chave, &encontrados);
+            amostras[qtd++] = agoraNs() - t0;
+        } else {
+            aplicarBench(operacao, chave, &encontrados);
+        }
+    }
+    const long long total = agoraNs() - inicio;
+
+    qsort(amostras, qtd, sizeof(long long), compararLatencias);
+
+    // A altura segue a convenção dos outros programas: 0 para a árvore vazia e 1 para uma folha
+    printf("avlc,%s,%s,%u,%.0f,%.2f,%lld,%lld,%lld,%ld,%d\n",
+           ordenada ? "ordenada" : "aleatoria", nomes[operacao], n,
+           n / (total / 1e9), (double) total / n,
+           amostras[qtd / 2], amostras[qtd * 99 / 100], amostras[qtd * 999 / 1000],
+           picoMemoriaKb(), alturaArvore());
+
+    if (operacao == BENCH_PESQUISAR && encontrados != n) {
+        fprintf(stderr, "ERRO: %u de %u chaves foram encontradas\n", encontrados, n);
+    }
+}
+
+/**
+ * Executa o benchmark completo (inserção, pesquisa, pesquisa sem sucesso e remoção) sem interação.
+ * @param n Quantidade de chaves
+ * @param ordenada Tipo de carga
+ * @return Código de saída do programa
+ */
+int executarBenchmark(const unsigned int n, const int ordenada) {
+    if (n == 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    for (int operacao = BENCH_INSERIR; operacao <= BENCH_REMOVER; operacao++) {
+        medirBench(operacao, n, ordenada);
+    }
+
+    liberarArvore();
+    return 0;
+}
+
+/* ============================================================
+   CARGAS CONCORRENTES
+   ============================================================ */
+
+#define THREADS_MAXIMO 64
+#define CONCORRENTE_DURACAO_MS 1000 // duração da medição da carga mista
+
+/**
+ * Parâmetros e resultado de uma thread das cargas concorrentes.
+ */
+typedef struct {
+    pthread_t thread;
+    unsigned int id;
+    unsigned int faixa;          // as chaves sorteadas vêm de [0, faixa)
+    unsigned int escritas;       // porcentagem de inserções e remoções
+    unsigned long long limite;   // quantidade de operações (0: até o sinal de parada)
+    unsigned long long operacoes;
+    long long *saldo;            // inserções menos remoções bem-sucedidas, por chave (ou NULL)
+} Carga;
+
+static atomic_int pararCarga;
+
+/**
+ * Laço de uma thread de carga: sorteia chaves e operações até atingir o limite
+ * ou até o sinal de parada.
+ */
+void* executarCarga(void *argumento) {
+    Carga *carga = argumento;
+    unsigned long long i = 0;
+
+    while (carga->limite ? i < carga->limite : !atomic_load_explicit(&pararCarga, memory_order_relaxed)) {
+        const unsigned int sorteio = embaralhar((unsigned int) i ^ embaralhar(carga->id + 1));
+        const unsigned int indice = sorteio % carga->faixa;
+        const int chave = chaveBench(indice, 0);
+        const unsigned int tipo = (sorteio >> 16) % 100;
+
+        if (tipo < carga->escritas / 2) {
+            if (insercao(chave) == STATUS_OK && carga->saldo) carga->saldo[indice]++;
+        } else if (tipo < carga->escritas) {
+            if (remover(chave) == STATUS_OK && carga->saldo) carga->saldo[indice]--;
+        } else {
+            pesquisaNo(chave);
+        }
+        i++;
+    }
+
+    desocuparVaga();
+    carga->operacoes = i;
+    return NULL;
+}
+
+/**
+ * Inicia as threads de carga e aguarda o seu término.
+ * @return Quantidade de threads efetivamente criadas
+ */
+int rodarCargas(Carga *cargas, const int threads, const long long duracaoNs) {
+    int criadas = 0;
+
+    atomic_store(&pararCarga, 0);
+    for (; criadas < threads; criadas++) {
+        if (pthread_create(&cargas[criadas].thread, NULL, executarCarga, &cargas[criadas]) != 0) break;
+    }
+
+    if (duracaoNs > 0) {
+        const long long inicio = agoraNs();
+        while (agoraNs() - inicio < duracaoNs) {
+#ifndef _WIN32
+            const struct timespec espera = {0, 1000000};
+            nanosleep(&espera, NULL);
+#endif
+        }
+        atomic_store(&pararCarga, 1);
+    }
+
+    for (int i = 0; i < criadas; i++) {
+        pthread_join(cargas[i].thread, NULL);
+    }
+    return criadas;
+}
+
+/**
+ * Mede a vazão de uma carga mista de pesquisas, inserções e remoções sobre
+ * 2n chaves, das quais n começam inseridas, escrevendo uma linha CSV:
+ * motor,carga,n,threads,escritas_pct,ops_por_seg
+ * @param n Quantidade de chaves inseridas inicialmente
+ * @param threads Quantidade de threads
+ * @param escritas Porcentagem de inserções e remoções
+ * @return Código de saída do programa
+ */
+int executarConcorrente(const unsigned int n, int threads, const unsigned int escritas) {
+    static Carga cargas[THREADS_MAXIMO];
+
+    if (n == 0 || threads <= 0 || escritas > 100) {
+        fprintf(stderr, "ERRO: parâmetros inválidos\n");
+        return 1;
+    }
+    if (threads > THREADS_MAXIMO) threads = THREADS_MAXIMO;
+
+    for (unsigned int i = 0; i < n; i++) {
+        if (insercao(chaveBench(i, 0)) == STATUS_SEM_MEMORIA) {
+            fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+            liberarArvore();
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < threads; i++) {
+        cargas[i] = (Carga) {0};
+        cargas[i].id = (unsigned int) i;
+        cargas[i].faixa = 2 * n;
+        cargas[i].escritas = escritas;
+    }
+
+    const long long inicio = agoraNs();
+    const int criadas = rodarCargas(cargas, threads, CONCORRENTE_DURACAO_MS * 1000000LL);
+    const long long total = agoraNs() - inicio;
+
+    unsigned long long operacoes = 0;
+    for (int i = 0; i < criadas; i++) {
+        operacoes += cargas[i].operacoes;
+    }
+
+    printf("avlc,mista,%u,%d,%u,%.0f\n", n, criadas, escritas, operacoes / (total / 1e9));
+
+    liberarArvore();
+    return 0;
+}
+
+/**
+ * Teste de estresse: várias threads inserem, removem e pesquisam chaves de uma
+ * faixa pequena (muita disputa pelos mesmos nós). Ao final, confere se a árvore
+ * é uma AVL válida e se cada chave está presente exatamente quando o saldo de
+ * inserções e remoções bem-sucedidas de todas as threads é 1.
+ * @param threads Quantidade de threads
+ * @param operacoes Operações por thread
+ * @param faixa Quantidade de chaves distintas
+ * @return Código de saída do programa (0 se a árvore passou na verificação)
+ */
+int executarEstresse(int threads, const unsigned long long operacoes, const unsigned int faixa) {
+    static Carga cargas[THREADS_MAXIMO];
+    int falhas = 0;
+
+    if (threads <= 0 || operacoes == 0 || faixa == 0) {
+        fprintf(stderr, "ERRO: parâmetros inválidos\n");
+        return 1;
+    }
+    if (threads > THREADS_MAXIMO) threads = THREADS_MAXIMO;
+
+    long long *saldos = calloc((size_t) threads * faixa, sizeof(long long));
+    if (saldos == NULL) {
+        fprintf(stderr, "ERRO: não foi possível alocar memória\n");
+        return 1;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        cargas[i] = (Carga) {0};
+        cargas[i].id = (unsigned int) i;
+        cargas[i].faixa = faixa;
+        cargas[i].escritas = 80;
+        cargas[i].limite = operacoes;
+        cargas[i].saldo = saldos + (size_t) i * faixa;
+    }
+
+    const int criadas = rodarCargas(cargas, threads, 0);
+
+    long long presentes;
+    if (!verificarArvore(&presentes)) {
+        fprintf(stderr, "ERRO: a árvore não é uma AVL válida\n");
+        falhas++;
+    }
+
+    long long esperados = 0;
+    for (unsigned int chave = 0; chave < faixa; chave++) {
+        long long saldo = 0;
+        for (int i = 0; i < criadas; i++) {
+            saldo += cargas[i].saldo[chave];
+        }
+
+        if (saldo != pesquisaNo(chaveBench(chave, 0))) {
+            if (falhas++ < 10) fprintf(stderr, "ERRO: saldo %lld para a chave %d\n", saldo, chaveBench(chave, 0));
+        }
+        esperados += saldo;
+    }
+    if (esperados != presentes) {
+        fprintf(stderr, "ERRO: %lld chaves na árvore, %lld esperadas\n", presentes, esperados);
+        falhas++;
+    }
+
+    printf("%s: %d threads, %llu operações cada, %lld chaves, altura %d\n",
+           falhas ? "FALHOU" : "OK", criadas, operacoes, presentes, alturaArvore());
+
+    free(saldos);
+    liberarArvore();
+    return falhas ? 1 : 0;
+}
+
+/* ============================================================
+   MODO EM LOTE (FLUXO BINÁRIO)
+   ============================================================ */
+
+/*
+ * Formato dos registros (inteiros em little-endian):
+ * - requisição: 1 byte de operação + 4 bytes de chave
+ * - resposta:   1 byte de status + 4 bytes de valor
+ */
+#define LOTE_REGISTRO 5     // tamanho, em bytes, de uma requisição ou resposta
+#define LOTE_BUFFER   4096  // quantidade de registros lidos/escritos por chamada
+
+#define OP_INSERIR   1
+#define OP_REMOVER   2
+#define OP_PESQUISAR 3
+
+/* O status de cada resposta é o próprio Status retornado pela operação */
+
+/**
+ * Lê um inteiro de 32 bits em little-endian.
+ */
+int lerInt32(const unsigned char *p) {
+    return (int) ((unsigned int) p[0] | (unsigned int) p[1] << 8 |
+                  (unsigned int) p[2] << 16 | (unsigned int) p[3] << 24);
+}
+
+/**
+ * Escreve um inteiro de 32 bits em little-endian.
+ */
+void escreverInt32(unsigned char *p, const int valor) {
+    const unsigned int v = (unsigned int) valor;
+    p[0] = (unsigned char) v;
+    p[1] = (unsigned char) (v >> 8);
+    p[2] = (unsigned char) (v >> 16);
+    p[3] = (unsigned char) (v >> 24);
+}
+
+/**
+ * Aplica uma requisição do fluxo binário na árvore.
+ * @param requisicao Registro de requisição (operação + chave)
+ * @param resposta Registro onde a resposta (status + valor) será escrita
+ */
+void processarRegistro(const unsigned char *requisicao, unsigned char *resposta) {
+    const int chave = lerInt32(requisicao + 1);
+    Status status;
+
+    switch (requisicao[0]) {
+        case OP_INSERIR:
+            status = insercao(chave);
+            break;
+
+        case OP_REMOVER:
+            status = remover(chave);
+            break;
+
+        case OP_PESQUISAR:
+            status = pesquisaNo(chave) ? STATUS_OK : STATUS_AUSENTE;
+            break;
+
+        default:
+            status = STATUS_INVALIDO;
+    }
+
+    resposta[0] = (unsigned char) status;
+    escreverInt32(resposta + 1, chave);
+}
+
+/**
+ * Processa um fluxo binário de requisições, sem nenhuma interação com o usuário,
+ * escrevendo uma resposta para cada requisição recebida.
+ * @param entrada Fluxo de requisições
+ * @param saida Fluxo de respostas
+ * @return Código de saída do programa
+ */
+int executarLote(FILE *entrada, FILE *saida) {
+    static unsigned char requisicoes[LOTE_BUFFER * LOTE_REGISTRO];
+    static unsigned char respostas[LOTE_BUFFER * LOTE_REGISTRO];
+    size_t lidos;
+
+    while ((lidos = fread(requisicoes, LOTE_REGISTRO, LOTE_BUFFER, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            processarRegistro(requisicoes + i * LOTE_REGISTRO, respostas + i * LOTE_REGISTRO);
+        }
+        recolherDesligados();
+
+        if (fwrite(respostas, LOTE_REGISTRO, lidos, saida) != lidos) {
+            fprintf(stderr, "ERRO: falha ao escrever as respostas\n");
+            liberarArvore();
+            return 1;
+        }
+    }
+
+    fflush(saida);
+    liberarArvore();
+    return ferror(entrada) ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Modo benchmark: questao04 --bench <n> [aleatoria|ordenada]
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        const int ordenada = argc >= 4 && strcmp(argv[3], "ordenada") == 0;
+        return executarBenchmark((unsigned int) strtoul(argv[2], NULL, 10), ordenada);
+    }
+
+    // Carga mista: questao04 --concorrente <n> [threads] [escritas_pct]
+    if (argc >= 3 && strcmp(argv[1], "--concorrente") == 0) {
+        const int threads = argc >= 4 ? atoi(argv[3]) : processadores();
+        const unsigned int escritas = argc >= 5 ? (unsigned int) strtoul(argv[4], NULL, 10) : 20;
+        return executarConcorrente((unsigned int) strtoul(argv[2], NULL, 10), threads, escritas);
+    }
+
+    // Teste de estresse: questao04 --estresse <threads> <operacoes> [faixa]
+    if (argc >= 4 && strcmp(argv[1], "--estresse") == 0) {
+        const unsigned int faixa = argc >= 5 ? (unsigned int) strtoul(argv[4], NULL, 10) : 1000;
+        return executarEstresse(atoi(argv[2]), strtoull(argv[3], NULL, 10), faixa);
+    }
+
+    // Modo em lote: questao04 --lote [arquivo], lendo da entrada padrão quando o arquivo é omitido
+    if (argc >= 2 && strcmp(argv[1], "--lote") == 0) {
+        FILE *entrada = argc >= 3 ? fopen(argv[2], "rb") : stdin;
+        if (entrada == NULL) {
+            fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+            return 1;
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        const int resultado = executarLote(entrada, stdout);
+        if (entrada != stdin) fclose(entrada);
+        return resultado;
+    }
+
+    // Set locale to support wide characters
+    setlocale(LC_ALL, "");
+
+#ifdef _WIN32
+    // For Windows, specifically set the console output mode
+    // _O_U16TEXT might need a #define _O_U16TEXT 0x20000 on some older compilers
+    _setmode(_fileno(stdout), _O_U16TEXT);
+#else
+    // For POSIX systems, fwide(stdout, 1) can set the stream to wide orientation
+    fwide(stdout, 1);
+#endif
+
+    int escolha, valor;
+    Status status;
+
+    do{
+        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n");
+        wprintf(L"Escolha uma opção: ");
+        wscanf(L"%d", &escolha);
+
+        switch (escolha){
+            case 0:
+                wprintf(L"Finalizando...");
+                break;
+
+            case 1:
+                wprintf(L"\nInforme o valor que deseja inserir: ");
+                wscanf(L"%d", &valor);
+                status = insercao(valor);
+                if (status == STATUS_DUPLICADA) {
+                    wprintf(L"A inserção não foi realizada, pois %d já existe\n", valor);
+                } else if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                }
+                break;
+
+            case 2:
+                wprintf(L"\nInforme o valor que deseja remover: ");
+                wscanf(L"%d", &valor);
+                if (remover(valor) == STATUS_AUSENTE) {
+                    wprintf(L"Valor não encontrado na árvore.\n");
+                }
+                // Sem outras threads, os nós desligados podem ser liberados na hora
+                recolherDesligados();
+                break;
+
+            case 3:
+                wprintf(L"\nInforme o valor que deseja pesquisar: ");
+                wscanf(L"%d", &valor);
+                if (pesquisaNo(valor)) {
+                    wprintf(L"Valor %d encontrado na árvore.\n", valor);
+                } else {
+                    wprintf(L"Valor %d não encontrado na árvore.\n", valor);
+                }
+                break;
+
+            case 4:
+                imprimeArvore();
+                break;
+
+            case 5:
+                preOrdem(atomic_load(&arvore.sentinela.direito));
+                break;
+
+            default:
+                wprintf(L"\nOpcao invalida!!!!");
+        }
+
+    }while (escolha != 0);
+
+    liberarArvore();
+    return 0;
+}
@@ -0,0 +1,893 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <wchar.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/* Alunos:
+Murilo Henrique Conde da Luz
+Nathielly Neves de Castro */
+
+/* ============================================================
+   DEFINIÇÃO DA ESTRUTURA DO NÓ
+   ============================================================ */
+
+/*
+ * Árvore WAVL ("weak AVL"), a árvore balanceada por postos de Haeupler, Sen e
+ * Tarjan ("Rank-Balanced Trees"):
+ * - cada nó guarda um posto, e o posto de uma subárvore vazia é -1
+ * - a diferença de posto entre um nó e cada filho é sempre 1 ou 2
+ * - toda folha tem posto 0 (não existem folhas 2,2)
+ * Sem remoções, a árvore é exatamente uma AVL, com a mesma altura. A remoção
+ * corrige o caminho rebaixando postos e faz no máximo uma rotação simples ou
+ * dupla, enquanto a remoção da AVL pode rotacionar em todos os níveis.
+ */
+
+/**
+ * Estrutura que representa um nó da árvore WAVL.
+ * Cada nó armazena:
+ * - um valor inteiro
+ * - o posto do nó (que limita a altura da subárvore, sem ser igual a ela)
+ * - ponteiros para os filhos esquerdo e direito
+ */
+typedef struct no {
+    int valor;
+    int posto;
+    struct no *esquerdo;
+    struct no *direito;
+} No;
+
+/* ============================================================
+   CÓDIGOS DE RETORNO
+   ============================================================ */
+
+/**
+ * Resultado das operações da árvore. As operações não escrevem nada na tela:
+ * cabe a quem as chama decidir o que fazer com o resultado.
+ */
+typedef enum {
+    STATUS_OK = 0,         // operação realizada (ou chave encontrada)
+    STATUS_AUSENTE = 1,    // chave não encontrada
+    STATUS_DUPLICADA = 2,  // chave já existente, inserção ignorada
+    STATUS_INVALIDO = 3,   // operação desconhecida
+    STATUS_SEM_MEMORIA = 4 // não foi possível alocar um novo nó
+} Status;
+
+/* ============================================================
+   CONTADORES DE INSTRUMENTAÇÃO
+   ============================================================ */
+
+/*
+ * Contadores do rebalanceamento, separados entre inserções e remoções para
+ * mostrar quantas rotações cada remoção realmente faz. Com -DCONTADORES=0 as
+ * chamadas de CONTAR desaparecem na compilação.
+ */
+#ifndef CONTADORES
+#define CONTADORES 1
+#endif
+
+typedef struct {
+    unsigned long long insercoes;          // inserções que criaram um nó
+    unsigned long long remocoes;           // remoções que liberaram um nó
+    unsigned long long promocoes;          // postos incrementados na inserção
+    unsigned long long rebaixamentos;      // postos decrementados na remoção (os duplos contam uma vez)
+    unsigned long long rotacoesInsercao;   // rotações simples e duplas feitas pelas inserções
+    unsigned long long rotacoesRemocao;    // rotações simples e duplas feitas pelas remoções
+} Contadores;
+
+#if CONTADORES
+static Contadores contadores;
+#define CONTAR(campo) (contadores.campo++)
+#else
+#define CONTAR(campo) ((void) 0)
+#endif
+
+/**
+ * Escreve os contadores acumulados até o momento no menu.
+ */
+void exibirContadores(void) {
+#if CONTADORES
+    wprintf(L"Inserções: %llu | Promoções: %llu | Rotações: %llu\n",
+            contadores.insercoes, contadores.promocoes, contadores.rotacoesInsercao);
+    wprintf(L"Remoções: %llu | Rebaixamentos: %llu | Rotações: %llu\n",
+            contadores.remocoes, contadores.rebaixamentos, contadores.rotacoesRemocao);
+    if (contadores.remocoes) {
+        wprintf(L"Rotações por remoção: %.3f\n", (double) contadores.rotacoesRemocao / contadores.remocoes);
+    }
+#else
+    wprintf(L"Contadores desativados na compilação (-DCONTADORES=0).\n");
+#endif
+}
+
+/* ============================================================
+   ALOCADOR DE NÓS (POOL)
+   ============================================================ */
+
+#define POOL_BLOCO_INICIAL 1024     // capacidade do primeiro bloco (em nós)
+#define POOL_BLOCO_MAXIMO  1048576  // limite para o crescimento dos blocos
+
+/**
+ * Bloco contíguo de nós. Os blocos formam uma lista ligada para que possam
+ * ser liberados todos de uma vez ao destruir o pool.
+ */
+typedef struct bloco {
+    struct bloco *proximo;
+    size_t capacidade;
+    No nos[];
+} Bloco;
+
+/**
+ * Pool de nós: entrega nós a partir de blocos grandes e reaproveita os nós
+ * removidos através de uma lista de livres (encadeada pelo ponteiro esquerdo).
+ */
+typedef struct {
+    Bloco *blocos;  // bloco atual (início da lista de blocos)
+    size_t usados;  // quantidade de nós já entregues do bloco atual
+    No *livres;     // nós devolvidos, prontos para reutilização
+} Pool;
+
+/**
+ * Pool utilizado por todos os nós da árvore.
+ */
+static Pool poolNos = {NULL, 0, NULL};
+
+/**
+ * Obtém um nó do pool, priorizando os nós devolvidos.
+ * Quando o bloco atual se esgota, um novo bloco com o dobro da capacidade é alocado.
+ * @param pool Pool de onde o nó será retirado
+ * @return Nó não inicializado ou NULL, caso não haja memória
+ */
+No* poolAlocar(Pool *pool) {
+    // Reaproveita um nó da lista de livres
+    if (pool->livres) {
+        No *no = pool->livres;
+        pool->livres = no->esquerdo;
+        return no;
+    }
+
+    // Aloca um novo bloco quando o atual está cheio (ou ainda não existe)
+    if (pool->blocos == NULL || pool->usados == pool->blocos->capacidade) {
+        size_t capacidade = pool->blocos ? pool->blocos->capacidade * 2 : POOL_BLOCO_INICIAL;
+        if (capacidade > POOL_BLOCO_MAXIMO) capacidade = POOL_BLOCO_MAXIMO;
+
+        Bloco *bloco = malloc(sizeof(Bloco) + capacidade * sizeof(No));
+        if (bloco == NULL) return NULL;
+
+        bloco->proximo = pool->blocos;
+        bloco->capacidade = capacidade;
+        pool->blocos = bloco;
+        pool->usados = 0;
+    }
+
+    return &pool->blocos->nos[pool->usados++];
+}
+
+/**
+ * Devolve um nó ao pool, para que seja reutilizado em uma próxima alocação.
+ * @param pool Pool de onde o nó foi retirado
+ * @param no Nó que será devolvido
+ */
+void poolLiberar(Pool *pool, No *no) {
+    no->esquerdo = pool->livres;
+    pool->livres = no;
+}
+
+/**
+ * Libera todos os blocos do pool de uma só vez.
+ * Todos os nós entregues pelo pool (e, portanto, a árvore inteira) deixam de ser válidos.
+ * @param pool Pool que será destruído
+ */
+void poolDestruir(Pool *pool) {
+    while (pool->blocos) {
+        Bloco *proximo = pool->blocos->proximo;
+        free(pool->blocos);
+        pool->blocos = proximo;
+    }
+
+    pool->usados = 0;
+    pool->livres = NULL;
+}
+
+/* ============================================================
+   FUNÇÕES AUXILIARES DOS NÓS
+   ============================================================ */
+
+/**
+ * Cria e inicializa um novo nó folha, com posto 0.
+ * @param num Valor a ser armazenado no nó
+ * @return Ponteiro para o novo nó criado ou NULL, caso não haja memória
+ */
+No* novoNo(const int num) {
+    No *novo = poolAlocar(&poolNos);
+
+    if (novo) {
+        novo->valor = num;
+        novo->posto = 0;
+        novo->esquerdo = NULL;
+        novo->direito = NULL;
+    }
+
+    return novo;
+}
+
+/**
+ * Retorna o posto de um nó.
+ * @param no Ponteiro para o nó
+ * @return Posto do nó ou -1 se for NULL
+ */
+int postoNo(const No *no) {
+    return no ? no->posto : -1;
+}
+
+/**
+ * Indica se um nó é uma folha.
+ */
+int folha(const No *no) {
+    return no->esquerdo == NULL && no->direito == NULL;
+}
+
+/**
+ * Retorna o maior valor entre dois inteiros.
+ */
+int maior(const int a, const int b) {
+    return a > b ? a : b;
+}
+
+/**
+ * Calcula a altura real de uma subárvore percorrendo todos os seus nós.
+ * Depois de remoções, o posto deixa de ser igual à altura e serve apenas de limite.
+ * @param raiz Raiz da subárvore
+ * @return Altura da subárvore (folha com altura 0) ou -1 se for NULL
+ */
+int alturaNo(const No *raiz) {
+    if (raiz == NULL) return -1;
+    return 1 + maior(alturaNo(raiz->esquerdo), alturaNo(raiz->direito));
+}
+
+/* ============================================================
+   ROTAÇÕES
+   ============================================================ */
+
+/*
+ * As rotações só religam os ponteiros. Os postos são ajustados por quem as
+ * chama, pois cada caso da inserção e da remoção altera postos diferentes.
+ */
+
+/**
+ * Realiza rotação simples à esquerda.
+ * @return Nova raiz da subárvore (o antigo filho direito)
+ */
+No* rotacaoEsq(No *raiz) {
+    No *u = raiz->direito;
+
+    raiz->direito = u->esquerdo;
+    u->esquerdo = raiz;
+
+    return u;
+}
+
+/**
+ * Realiza rotação simples à direita.
+ * @return Nova raiz da subárvore (o antigo filho esquerdo)
+ */
+No* rotacaoDir(No *raiz) {
+    No *u = raiz->esquerdo;
+
+    raiz->esquerdo = u->direito;
+    u->direito = raiz;
+
+    return u;
+}
+
+/**
+ * Rotaciona a raiz na direção de um dos filhos, que sobe para o seu lugar.
+ * @param raiz Raiz da subárvore
+ * @param filho Filho que sobe (esquerdo ou direito da raiz)
+ * @return Nova raiz da subárvore
+ */
+No* subir(No *raiz, const No *filho) {
+    return filho == raiz->esquerdo ? rotacaoDir(raiz) : rotacaoEsq(raiz);
+}
+
+/**
+ * Rotação dupla: o neto interno sobe duas posições, passando pelo filho.
+ * @param raiz Raiz da subárvore
+ * @param filho Filho da raiz cujo filho interno sobe
+ * @return Nova raiz da subárvore (o antigo neto interno)
+ */
+No* subirDuplo(No *raiz, No *filho) {
+    if (filho == raiz->esquerdo) {
+        raiz->esquerdo = rotacaoEsq(filho);
+        return rotacaoDir(raiz);
+    }
+
+    raiz->direito = rotacaoDir(filho);
+    return rotacaoEsq(raiz);
+}
+
+/* ============================================================
+   BALANCEAMENTO POR POSTOS
+   ============================================================ */
+
+/*
+ * A inserção e a remoção descem de forma iterativa, guardando em uma pilha o
+ * endereço de cada ligação do caminho (o ponteiro do pai, ou a própria raiz),
+ * para que a correção possa subir e religar as subárvores rotacionadas.
+ */
+#define WAVL_CAMINHO 96 // maior que a altura de qualquer WAVL com até 2^31 nós (no máximo 2 log n = 62)
+
+/**
+ * Corrige os postos depois da inserção de uma folha. Enquanto o nó x tiver o
+ * mesmo posto do pai (um filho 0) e o irmão for um filho 1, o pai é promovido
+ * e o problema sobe. Quando o irmão é um filho 2, uma rotação simples ou dupla
+ * encerra a correção, exatamente como na AVL.
+ * @param caminho Endereço da ligação de cada ancestral do nó inserido, a partir da raiz
+ * @param topo Quantidade de ancestrais no caminho
+ * @param x Nó inserido
+ */
+void ajustarInsercao(No **caminho[], int topo, No *x) {
+    while (topo > 0) {
+        No **ligacao = caminho[--topo];
+        No *pai = *ligacao;
+
+        // Diferença 1 ou 2 entre o pai e x: as regras voltaram a valer
+        if (pai->posto != x->posto) return;
+
+        No *irmao = x == pai->esquerdo ? pai->direito : pai->esquerdo;
+        if (pai->posto - postoNo(irmao) == 1) {
+            pai->posto++;
+            CONTAR(promocoes);
+            x = pai;
+            continue;
+        }
+
+        // O irmão é um filho 2: decide a rotação pelo filho interno de x
+        No *interno = x == pai->esquerdo ? x->direito : x->esquerdo;
+        CONTAR(rotacoesInsercao);
+        if (x->posto - postoNo(interno) == 2) {
+            *ligacao = subir(pai, x);
+            pai->posto--;
+        } else {
+            *ligacao = subirDuplo(pai, x);
+            interno->posto++;
+            x->posto--;
+            pai->posto--;
+        }
+        return;
+    }
+}
+
+/**
+ * Corrige os postos depois que o nó que saiu da árvore foi substituído por x
+ * (possivelmente NULL). Uma folha 2,2 é rebaixada, e um filho 3 é corrigido
+ * rebaixando o pai (quando o irmão é um filho 2) ou o pai e o irmão (quando o
+ * irmão é um filho 1 com dois filhos 2), e o problema sobe. Nos demais casos,
+ * uma única rotação simples ou dupla encerra a correção.
+ * @param caminho Endereço da ligação de cada ancestral de x, a partir da raiz
+ * @param topo Quantidade de ancestrais no caminho
+ * @param x Subárvore que ocupou o lugar do nó removido
+ */
+void ajustarRemocao(No **caminho[], int topo, No *x) {
+    while (topo > 0) {
+        No **ligacao = caminho[--topo];
+        No *pai = *ligacao;
+
+        // O pai ficou sem filhos: uma folha 2,2 volta a ter posto 0
+        if (folha(pai)) {
+            if (pai->posto == 0) return;
+            pai->posto = 0;
+            CONTAR(rebaixamentos);
+            x = pai;
+            continue;
+        }
+
+        // Diferença 1 ou 2 entre o pai e x: as regras voltaram a valer
+        if (pai->posto - postoNo(x) < 3) return;
+
+        const int esquerda = x == pai->esquerdo;
+        No *irmao = esquerda ? pai->direito : pai->esquerdo;
+        if (pai->posto - irmao->posto == 2) {
+            pai->posto--;
+            CONTAR(rebaixamentos);
+            x = pai;
+            continue;
+        }
+
+        // O irmão é um filho 1: se os dois filhos dele são filhos 2, ambos descem
+        No *externo = esquerda ? irmao->direito : irmao->esquerdo;
+        No *interno = esquerda ? irmao->esquerdo : irmao->direito;
+        if (irmao->posto - postoNo(externo) == 2 && irmao->posto - postoNo(interno) == 2) {
+            pai->posto--;
+            irmao->posto--;
+            CONTAR(rebaixamentos);
+            x = pai;
+            continue;
+        }
+
+        CONTAR(rotacoesRemocao);
+        if (irmao->posto - postoNo(externo) == 1) {
+            // Rotação simples: o irmão sobe, e o pai desce mais um posto se virar uma folha 2,2
+            *ligacao = subir(pai, irmao);
+            irmao->posto++;
+            pai->posto -= folha(pai) ? 2 : 1;
+        } else {
+            // Rotação dupla: o filho interno do irmão sobe dois postos
+            *ligacao = subirDuplo(pai, irmao);
+            interno->posto += 2;
+            irmao->posto--;
+            pai->posto -= 2;
+        }
+        return;
+    }
+}
+
+/* ============================================================
+   FUNÇÕES DE PESQUISA
+   ============================================================ */
+
+/**
+ * Procura um valor na árvore.
+ * @param raiz Raiz da árvore
+ * @param chave Valor procurado
+ * @return Nó que contém o valor ou NULL, caso ele não esteja na árvore
+ */
+No* pesquisaNo(No *raiz, const int chave) {
+    while (raiz != NULL && raiz->valor != chave) {
+        raiz = chave < raiz->valor ? raiz->esquerdo : raiz->direito;
+    }
+
+    return raiz;
+}
+
+/* ============================================================
+   INSERÇÃO E REMOÇÃO
+   ============================================================ */
+
+/**
+ * Insere um valor na árvore WAVL.
+ * Após a inserção, os ancestrais são promovidos até que as regras de posto
+ * voltem a valer, com no máximo uma rotação simples ou dupla.
+ * @param raiz Raiz da árvore
+ * @param num Valor a ser inserido
+ * @param status Recebe STATUS_OK, STATUS_DUPLICADA ou STATUS_SEM_MEMORIA
+ * @return Nova raiz da árvore
+ */
+No* insercao(No *raiz, const int num, Status *status) {
+    No **caminho[WAVL_CAMINHO];
+    int topo = 0;
+    No **ligacao = &raiz;
+
+    while (*ligacao != NULL) {
+        No *no = *ligacao;
+
+        if (num == no->valor) {
+            *status = STATUS_DUPLICADA;
+            return raiz;
+        }
+
+        caminho[topo++] = ligacao;
+        ligacao = num < no->valor ? &no->esquerdo : &no->direito;
+    }
+
+    *ligacao = novoNo(num);
+    if (*ligacao == NULL) {
+        *status = STATUS_SEM_MEMORIA;
+        return raiz;
+    }
+    *status = STATUS_OK;
+    CONTAR(insercoes);
+
+    ajustarInsercao(caminho, topo, *ligacao);
+    return raiz;
+}
+
+/**
+ * Remove um valor da árvore WAVL.
+ * Após a remoção, os ancestrais são rebaixados até que as regras de posto
+ * voltem a valer, com no máximo uma rotação simples ou dupla.
+ * @param raiz Raiz da árvore
+ * @param chave Valor a ser removido
+ * @param status Recebe STATUS_OK ou STATUS_AUSENTE
+ * @return Nova raiz da árvore
+ */
+No* remover(No *raiz, const int chave, Status *status) {
+    No **caminho[WAVL_CAMINHO];
+    int topo = 0;
+    No **ligacao = &raiz;
+
+    while (*ligacao != NULL && (*ligacao)->valor != chave) {
+        caminho[topo++] = ligacao;
+        ligacao = chave < (*ligacao)->valor ? &(*ligacao)->esquerdo : &(*ligacao)->direito;
+    }
+
+    if (*ligacao == NULL) {
+        *status = STATUS_AUSENTE;
+        return raiz;
+    }
+    *status = STATUS_OK;
+    CONTAR(remocoes);
+
+    No *no = *ligacao;
+    if (no->esquerdo != NULL && no->direito != NULL) {
+        // Nó com dois filhos: recebe o valor do predecessor, que sai da árvore no seu lugar
+        caminho[topo++] = ligacao;
+        ligacao = &no->esquerdo;
+        while ((*ligacao)->direito != NULL) {
+            caminho[topo++] = ligacao;
+            ligacao = &(*ligacao)->direito;
+        }
+
+        no->valor = (*ligacao)->valor;
+        no = *ligacao;
+    }
+
+    // O nó que sai tem no máximo um filho, que ocupa o seu lugar
+    *ligacao = no->esquerdo ? no->esquerdo : no->direito;
+    poolLiberar(&poolNos, no);
+
+    ajustarRemocao(caminho, topo, *ligacao);
+    return raiz;
+}
+
+/* ============================================================
+   VERIFICAÇÃO DA ÁRVORE
+   ============================================================ */
+
+/**
+ * Confere recursivamente a ordem das chaves e as regras de posto de uma subárvore.
+ * @param raiz Raiz da subárvore
+ * @param minimo Menor valor permitido na subárvore
+ * @param maximo Maior valor permitido na subárvore
+ * @return Quantidade de nós da subárvore ou -1, caso alguma regra seja violada
+ */
+long long verificarSubarvore(const No *raiz, const long long minimo, const long long maximo) {
+    if (raiz == NULL) return 0;
+    if (raiz->valor < minimo || raiz->valor > maximo) return -1;
+
+    // Diferença 1 ou 2 para cada filho, e nenhuma folha 2,2
+    const int difEsq = raiz->posto - postoNo(raiz->esquerdo);
+    const int difDir = raiz->posto - postoNo(raiz->direito);
+    if (difEsq < 1 || difEsq > 2 || difDir < 1 || difDir > 2) return -1;
+    if (folha(raiz) && raiz->posto != 0) return -1;
+
+    const long long esquerda = verificarSubarvore(raiz->esquerdo, minimo, (long long) raiz->valor - 1);
+    const long long direita = verificarSubarvore(raiz->direito, (long long) raiz->valor + 1, maximo);
+    if (esquerda < 0 || direita < 0) return -1;
+
+    return esquerda + direita + 1;
+}
+
+/**
+ * Confere se a árvore inteira respeita a ordem das chaves e as regras de posto.
+ * @param raiz Raiz da árvore
+ * @return Quantidade de nós da árvore ou -1, caso alguma regra seja violada
+ */
+long long verificarArvore(const No *raiz) {
+    return verificarSubarvore(raiz, INT32_MIN, INT32_MAX);
+}
+
+/* ============================================================
+   FUNÇÕES DE IMPRESSÃO
+   ============================================================ */
+
+/**
+ * Imprime todos os nós de um nível da árvore, da esquerda para a direita,
+ * com o posto de cada nó entre colchetes.
+ * @param no Raiz da subárvore
+ * @param nivel Nível a ser impresso, relativo à raiz da subárvore
+ */
+void imprimeNivel(const No *no, const int nivel) {
+    if (no == NULL) return;
+
+    if (nivel == 0) {
+        wprintf(L"%d[%d] ", no->valor, no->posto);
+        return;
+    }
+
+    imprimeNivel(no->esquerdo, nivel - 1);
+    imprimeNivel(no->direito, nivel - 1);
+}
+
+/**
+ * Imprime a árvore nível por nível.
+ * @param raiz Raiz da árvore
+ */
+void imprimeArvore(const No *raiz) {
+    if (raiz == NULL) {
+        wprintf(L"A árvore está vazia.\n");
+        return;
+    }
+
+    const int altura = alturaNo(raiz);
+    for (int nivel = 0; nivel <= altura; nivel++) {
+        wprintf(L"Nível %d: ", nivel);
+        imprimeNivel(raiz, nivel);
+        wprintf(L"\n");
+    }
+}
+
+/**
+ * Realiza o percurso pré-ordem na árvore WAVL.
+ * @param raiz Ponteiro para a raiz da árvore
+ */
+void preOrdem(const No *raiz) {
+    if (raiz == NULL) return;
+
+    wprintf(L"%d ", raiz->valor);
+    preOrdem(raiz->esquerdo);
+    preOrdem(raiz->direito);
+}
+
+/* ============================================================
+   MODO BENCHMARK
+   ============================================================ */
+
+#define BENCH_AMOSTRAS 1048576 // máximo de latências amostradas por operação
+
+#define BENCH_INSERIR   0
+#define BENCH_PESQUISAR 1
+#define BENCH_AUSENTE   2
+#define BENCH_REMOVER   3
+
+/**
+ * Embaralha um inteiro de 32 bits (finalizador do MurmurHash3).
+ * A função é bijetora, portanto índices distintos sempre geram chaves distintas.
+ */
+unsigned int embaralhar(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Gera a i-ésima chave da sequência do benchmark.
+ * A mesma sequência é gerada em todos os programas, para que as árvores sejam comparáveis.
+ * @param i Índice da chave
+ * @param ordenada Indica se a carga é ordenada (chaves crescentes) ou aleatória
+ */
+int chaveBench(const unsigned int i, const int ordenada) {
+    return ordenada ? (int) i : (int) embaralhar(i);
+}
+
+/**
+ * Retorna o instante atual em nanossegundos.
+ */
+long long agoraNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Retorna o pico de memória residente do processo, em kilobytes (0 quando indisponível).
+ */
+long picoMemoriaKb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * Compara duas latências, para a ordenação com qsort.
+ */
+int compararLatencias(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Aplica a operação do benchmark correspondente ao índice i.
+ * @param raiz Raiz da árvore do benchmark, atualizada pelas inserções e remoções
+ * @param operacao Operação a ser aplicada (BENCH_*)
+ * @param chave Chave da operação
+ * @param encontrados Contador de pesquisas bem-sucedidas (evita que a pesquisa seja descartada pelo compilador)
+ */
+void aplicarBench(No **raiz, const int operacao, const int chave, unsigned int *encontrados) {
+    Status status;
+
+    switch (operacao) {
+        case BENCH_INSERIR:
+            *raiz = insercao(*raiz, chave, &status);
+            break;
+        case BENCH_REMOVER:
+            *raiz = remover(*raiz, chave, &status);
+            break;
+        default:
+            *encontrados += pesquisaNo(*raiz, chave) != NULL;
+    }
+}
+
+/**
+ * Gera a chave da i-ésima repetição de uma operação do benchmark.
+ * As pesquisas bem-sucedidas sorteiam chaves já inseridas, e as sem sucesso usam
+ * chaves que nunca foram inseridas.
+ */
+int chaveOperacao(const int operacao, const unsigned int i, const unsigned int n, const int ordenada) {
+    switch (operacao) {
+        case BENCH_PESQUISAR:
+            return chaveBench(embaralhar(i ^ 0x9e3779b9u) % n, ordenada);
+        case BENCH_AUSENTE:
+            return chaveBench(n + i, ordenada);
+        default:
+            return chaveBench(i, ordenada);
+    }
+}
+
+/**
+ * Executa n repetições de uma operação e escreve uma linha CSV com os resultados:
+ * motor,carga,operacao,n,ops_por_seg,ns_por_op,p50_ns,p99_ns,p999_ns,pico_rss_kb,altura
+ * @param raiz Raiz da árvore do benchmark
+ * @param operacao Operação a ser medida (BENCH_*)
+ * @param n Quantidade de repetições
+ * @param ordenada Tipo de carga
+ */
+void medirBench(No **raiz, const int operacao, const unsigned int n, const int ordenada) {
+    static long long amostras[BENCH_AMOSTRAS];
+    const char *nomes[] = {"inserir", "pesquisar", "pesquisar_ausente", "remover"};
+
+    // Apenas uma a cada "passo" operações tem a latência medida individualmente
+    const unsigned int passo = n / BENCH_AMOSTRAS + 1;
+    unsigned int encontrados = 0;
+    size_t qtd = 0;
+
+    const long long inicio = agoraNs();
+    for (unsigned int i = 0; i < n; i++) {
+        const int chave = chaveOperacao(operacao, i, n, ordenada);
+
+        if (i % passo == 0) {
+            const long long t0 = agoraNs();
+            aplicarBench(raiz, operacao, chave, &encontrados);
+            amostras[qtd++] = agoraNs() - t0;
+        } else {
+            aplicarBench(raiz, operacao, chave, &encontrados);
+        }
+    }
+    const long long total = agoraNs() - inicio;
+
+    qsort(amostras, qtd, sizeof(long long), compararLatencias);
+
+    // A altura é escrita na convenção da AVL (questão 01)
+    printf("wavl,%s,%s,%u,%.0f,%.2f,%lld,%lld,%lld,%ld,%d\n",
+           ordenada ? "ordenada" : "aleatoria", nomes[operacao], n,
+           n / (total / 1e9), (double) total / n,
+           amostras[qtd / 2], amostras[qtd * 99 / 100], amostras[qtd * 999 / 1000],
+           picoMemoriaKb(), alturaNo(*raiz) + 1);
+
+    if (operacao == BENCH_PESQUISAR && encontrados != n) {
+        fprintf(stderr, "ERRO: %u de %u chaves foram encontradas\n", encontrados, n);
+    }
+}
+
+/**
+ * Executa o benchmark completo (inserção, pesquisa, pesquisa sem sucesso e remoção) sem interação.
+ * @param n Quantidade de chaves
+ * @param ordenada Tipo de carga
+ * @return Código de saída do programa
+ */
+int executarBenchmark(const unsigned int n, const int ordenada) {
+    No *raiz = NULL;
+
+    if (n == 0) {
+        fprintf(stderr, "ERRO: a quantidade de chaves deve ser positiva\n");
+        return 1;
+    }
+
+    for (int operacao = BENCH_INSERIR; operacao <= BENCH_REMOVER; operacao++) {
+        medirBench(&raiz, operacao, n, ordenada);
+    }
+
+    poolDestruir(&poolNos);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Modo benchmark: questao05 --bench <n> [aleatoria|ordenada]
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+        const int ordenada = argc >= 4 && strcmp(argv[3], "ordenada") == 0;
+        return executarBenchmark((unsigned int) strtoul(argv[2], NULL, 10), ordenada);
+    }
+
+    // Set locale to support wide characters
+    setlocale(LC_ALL, "");
+
+#ifdef _WIN32
+    // For Windows, specifically set the console output mode
+    // _O_U16TEXT might need a #define _O_U16TEXT 0x20000 on some older compilers
+    _setmode(_fileno(stdout), _O_U16TEXT);
+#else
+    // For POSIX systems, fwide(stdout, 1) can set the stream to wide orientation
+    fwide(stdout, 1);
+#endif
+
+    No *raiz = NULL;
+    int escolha, valor;
+    long long nos;
+    Status status;
+
+    do{
+        wprintf(L"\n0 - Sair\n1 - Inserir\n2 - Remover\n3 - Pesquisar\n4 - Imprimir\n5 - Pré-ordem\n6 - Contadores\n7 - Verificar as regras de posto\n");
+        wprintf(L"Escolha uma opção: ");
+        wscanf(L"%d", &escolha);
+
+        switch (escolha){
+            case 0:
+                wprintf(L"Finalizando...");
+                break;
+
+            case 1:
+                wprintf(L"\nInforme o valor que deseja inserir: ");
+                wscanf(L"%d", &valor);
+                raiz = insercao(raiz, valor, &status);
+                if (status == STATUS_DUPLICADA) {
+                    wprintf(L"A inserção não foi realizada, pois %d já existe\n", valor);
+                } else if (status == STATUS_SEM_MEMORIA) {
+                    wprintf(L"ERRO: não foi possível alocar memória para a criação de um novo nó.\n");
+                }
+                break;
+
+            case 2:
+                wprintf(L"\nInforme o valor que deseja remover: ");
+                wscanf(L"%d", &valor);
+                raiz = remover(raiz, valor, &status);
+                if (status == STATUS_AUSENTE) {
+                    wprintf(L"Valor não encontrado na árvore.\n");
+                }
+                break;
+
+            case 3:
+                wprintf(L"\nInforme o valor que deseja pesquisar: ");
+                wscanf(L"%d", &valor);
+                if (pesquisaNo(raiz, valor)) {
+                    wprintf(L"Valor %d encontrado na árvore.\n", valor);
+                } else {
+                    wprintf(L"Valor %d não encontrado na árvore.\n", valor);
+                }
+                break;
+
+            case 4:
+                imprimeArvore(raiz);
+                break;
+
+            case 5:
+                preOrdem(raiz);
+                break;
+
+            case 6:
+                exibirContadores();
+                break;
+
+            case 7:
+                nos = verificarArvore(raiz);
+                if (nos < 0) {
+                    wprintf(L"ERRO: a árvore viola as regras de posto.\n");
+                } else {
+                    wprintf(L"Árvore válida com %lld nós, altura %d e posto da raiz %d.\n",
+                            nos, alturaNo(raiz), postoNo(raiz));
+                }
+                break;
+
+            default:
+                wprintf(L"\nOpcao invalida!!!!");
+        }
+
+    }while (escolha != 0);
+
+    poolDestruir(&poolNos);
+    return 0;
+}